@@ -0,0 +1,283 @@
+#include "AnimationPlayer.h"
+
+static inline uint16_t read16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+AnimationPlayer::AnimationPlayer()
+    : _pixels(0)
+    , _fileSize(0)
+    , _frame(nullptr)
+    , _window(nullptr)
+    , _capacity(0)
+    , _pos(0)
+    , _len(0)
+    , _readLoops(0)
+    , _eof(false)
+    , _frameIndex(0)
+    , _delayMs(ANIM_DEFAULT_DELAY_MS)
+    , _haveKey(false)
+    , _finished(false)
+    , _error(false)
+    , _framesDecoded(0)
+    , _loopsPlayed(0)
+    , _bytesRead(0)
+    , _readUs(0)
+    , _underruns(0)
+{
+    memset(&_header, 0, sizeof(_header));
+}
+
+AnimationPlayer::~AnimationPlayer() {
+    close();
+}
+
+bool AnimationPlayer::readHeader(File& file, AnimationHeader& header) {
+    uint8_t raw[ANIM_HEADER_SIZE];
+    if (!file.seek(0) || file.read(raw, sizeof(raw)) != sizeof(raw) ||
+        memcmp(raw, ANIM_MAGIC, 4) != 0) {
+        return false;
+    }
+    header.width = read16(raw + 4);
+    header.height = read16(raw + 6);
+    header.frameCount = read16(raw + 8);
+    header.loops = read16(raw + 10);
+    return header.width > 0 && header.height > 0 && header.frameCount > 0;
+}
+
+// ═══════════════════════════════════════════
+// Apertura / chiusura
+// ═══════════════════════════════════════════
+
+bool AnimationPlayer::open(File file, uint16_t maxWidth, uint16_t maxHeight) {
+    close();
+    _file = file;
+
+    if (!_file || !readHeader(_file, _header)) {
+        DEBUG_PRINTLN(F("[Anim] Invalid header"));
+        close();
+        return false;
+    }
+    if (_header.width > maxWidth || _header.height > maxHeight) {
+        DEBUG_PRINTF("[Anim] %ux%u larger than canvas %ux%u\n",
+                     _header.width, _header.height, maxWidth, maxHeight);
+        close();
+        return false;
+    }
+
+    _fileSize = _file.size();
+    if (_fileSize < ANIM_HEADER_SIZE + ANIM_RECORD_HEADER) {
+        DEBUG_PRINTLN(F("[Anim] No frames"));
+        close();
+        return false;
+    }
+
+    // La finestra deve contenere almeno un keyframe intero
+    _pixels = (size_t)_header.width * _header.height;
+    _capacity = _pixels * sizeof(uint16_t) + ANIM_RECORD_HEADER;
+    if (_capacity < ANIM_WINDOW_BYTES) _capacity = ANIM_WINDOW_BYTES;
+
+    _frame = (uint16_t*)malloc(_pixels * sizeof(uint16_t));
+    _window = (uint8_t*)malloc(_capacity);
+    if (!_frame || !_window) {
+        DEBUG_PRINTLN(F("[Anim] Failed to allocate buffers!"));
+        close();
+        return false;
+    }
+    memset(_frame, 0, _pixels * sizeof(uint16_t));
+
+    _pos = 0;
+    _len = 0;
+    _readLoops = 0;
+    _eof = false;
+    _frameIndex = 0;
+    _delayMs = ANIM_DEFAULT_DELAY_MS;
+    _haveKey = false;
+    _finished = false;
+    _error = false;
+    _framesDecoded = 0;
+    _loopsPlayed = 0;
+    _bytesRead = 0;
+    _readUs = 0;
+    _underruns = 0;
+
+    // Finestra piena prima del primo frame
+    fill(_capacity);
+
+    DEBUG_PRINTF("[Anim] Open %ux%u, %u frames, %u bytes, window %u bytes\n",
+                 _header.width, _header.height, _header.frameCount,
+                 (unsigned)_fileSize, (unsigned)_capacity);
+    return true;
+}
+
+void AnimationPlayer::close() {
+    if (_file) {
+        _file.close();
+    }
+    _file = File();
+    free(_frame);
+    free(_window);
+    _frame = nullptr;
+    _window = nullptr;
+    _capacity = 0;
+    _pos = 0;
+    _len = 0;
+}
+
+// ═══════════════════════════════════════════
+// Lettura da flash
+// ═══════════════════════════════════════════
+
+// Legge fino a maxBytes in coda alla finestra; a fine file riparte dal
+// primo frame finché restano loop da leggere
+size_t AnimationPlayer::readBlock(size_t maxBytes) {
+    if (_eof) return 0;
+
+    // Spazio in coda insufficiente: i byte non consumati tornano all'inizio
+    if (_capacity - _len < maxBytes && _pos > 0) {
+        memmove(_window, _window + _pos, _len - _pos);
+        _len -= _pos;
+        _pos = 0;
+    }
+
+    size_t space = _capacity - _len;
+    if (space == 0) return 0;
+    if (space > maxBytes) space = maxBytes;
+
+    uint32_t position = _file.position();
+    if (position >= _fileSize) {
+        _readLoops++;
+        if (_header.loops > 0 && _readLoops >= _header.loops) {
+            _eof = true;
+            return 0;
+        }
+        _file.seek(ANIM_HEADER_SIZE);
+        position = ANIM_HEADER_SIZE;
+    }
+    if (space > _fileSize - position) space = _fileSize - position;
+
+    uint32_t t0 = micros();
+    size_t got = _file.read(_window + _len, space);
+    _readUs += micros() - t0;
+
+    if (got == 0) {
+        DEBUG_PRINTLN(F("[Anim] Read failed"));
+        _eof = true;
+        return 0;
+    }
+    _len += got;
+    _bytesRead += got;
+    return got;
+}
+
+bool AnimationPlayer::fill(size_t needed) {
+    while (_len - _pos < needed) {
+        if (readBlock(ANIM_READ_BLOCK) == 0) break;
+    }
+    return _len - _pos >= needed;
+}
+
+void AnimationPlayer::readAhead() {
+    if (!_window || _eof) return;
+    // Solo blocchi interi: niente letture piccole a finestra quasi piena
+    if (_capacity - (_len - _pos) >= ANIM_READ_BLOCK) {
+        readBlock(ANIM_READ_BLOCK);
+    }
+}
+
+// ═══════════════════════════════════════════
+// Decodifica
+// ═══════════════════════════════════════════
+
+bool AnimationPlayer::nextFrame() {
+    if (!_frame || _finished || _error) return false;
+
+    bool underrun = false;
+    if (_len - _pos < ANIM_RECORD_HEADER) {
+        underrun = !_eof;
+        if (!fill(ANIM_RECORD_HEADER)) {
+            // Fine dei dati: pulita solo se non resta un record a metà
+            if (_len - _pos == 0) {
+                _finished = true;
+            } else {
+                DEBUG_PRINTLN(F("[Anim] Truncated frame header"));
+                _error = true;
+            }
+            return false;
+        }
+    }
+
+    const uint8_t* record = _window + _pos;
+    uint8_t type = record[0];
+    uint16_t delayMs = read16(record + 2);
+    uint32_t size = read32(record + 4);
+
+    if (size > _capacity - ANIM_RECORD_HEADER) {
+        DEBUG_PRINTF("[Anim] Frame %u too large: %u bytes\n", _frameIndex, size);
+        _error = true;
+        return false;
+    }
+    if (_len - _pos < ANIM_RECORD_HEADER + size) {
+        underrun = true;
+        if (!fill(ANIM_RECORD_HEADER + size)) {
+            DEBUG_PRINTF("[Anim] Truncated frame %u\n", _frameIndex);
+            _error = true;
+            return false;
+        }
+        record = _window + _pos;    // fill() può aver compattato la finestra
+    }
+    if (underrun) _underruns++;
+
+    const uint8_t* payload = record + ANIM_RECORD_HEADER;
+    bool ok;
+    if (type == ANIM_FRAME_KEY) {
+        ok = size == _pixels * sizeof(uint16_t);
+        if (ok) {
+            memcpy(_frame, payload, size);
+            _haveKey = true;
+        }
+    } else if (type == ANIM_FRAME_DELTA) {
+        ok = _haveKey && applyDelta(payload, size);
+    } else {
+        ok = false;
+    }
+    if (!ok) {
+        DEBUG_PRINTF("[Anim] Bad frame %u (type %u, %u bytes)\n", _frameIndex, type, size);
+        _error = true;
+        return false;
+    }
+
+    _pos += ANIM_RECORD_HEADER + size;
+    _delayMs = delayMs > 0 ? delayMs : ANIM_DEFAULT_DELAY_MS;
+    _framesDecoded++;
+    if (++_frameIndex >= _header.frameCount) {
+        _frameIndex = 0;
+        _loopsPlayed++;
+    }
+    return true;
+}
+
+// Blocchi (skip, count, pixel) in ordine di indice lineare
+bool AnimationPlayer::applyDelta(const uint8_t* data, size_t size) {
+    size_t pixel = 0;
+    size_t offset = 0;
+
+    while (offset < size) {
+        if (size - offset < 4) return false;
+        size_t skip = read16(data + offset);
+        size_t count = read16(data + offset + 2);
+        offset += 4;
+
+        pixel += skip;
+        if (pixel + count > _pixels || offset + count * sizeof(uint16_t) > size) return false;
+
+        memcpy(_frame + pixel, data + offset, count * sizeof(uint16_t));
+        pixel += count;
+        offset += count * sizeof(uint16_t);
+    }
+    return true;
+}
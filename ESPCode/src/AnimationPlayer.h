@@ -0,0 +1,104 @@
+#ifndef ANIMATION_PLAYER_H
+#define ANIMATION_PLAYER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "Debug.h"
+
+// Formato .anm (little-endian):
+//   header  "ANM1", u16 width, u16 height, u16 frameCount, u16 loops (0 = infinito), u32 riservato
+//   frame   u8 type, u8 riservato, u16 delayMs, u32 payloadSize, payload
+//     ANIM_FRAME_KEY    width*height pixel RGB565
+//     ANIM_FRAME_DELTA  blocchi (u16 skip, u16 count, count pixel RGB565) sul frame precedente
+#define ANIM_MAGIC "ANM1"
+#define ANIM_HEADER_SIZE 16
+#define ANIM_RECORD_HEADER 8
+#define ANIM_FRAME_KEY 0x01
+#define ANIM_FRAME_DELTA 0x02
+
+#define ANIM_WINDOW_BYTES 16384         // Finestra di read-ahead (minimo: un keyframe)
+#define ANIM_READ_BLOCK 4096            // Lettura flash per giro (blocco LittleFS)
+#define ANIM_DEFAULT_DELAY_MS 100       // delay 0 = come i browser con le GIF
+
+struct AnimationHeader {
+    uint16_t width;
+    uint16_t height;
+    uint16_t frameCount;
+    uint16_t loops;
+};
+
+/**
+ * AnimationPlayer - Decodifica in streaming di un'animazione .anm da LittleFS
+ *
+ * RAM fissa qualunque sia il numero di frame: un frame RGB565 (il canvas
+ * dei delta) più una finestra di read-ahead. readAhead() legge un blocco
+ * per volta mentre si aspetta il frame successivo, nextFrame() legge in
+ * modo sincrono solo se la finestra non contiene il record intero
+ * (underrun). Il ritorno all'inizio per il loop avviene in lettura: il
+ * primo keyframe è già nella finestra quando finisce l'ultimo frame.
+ */
+class AnimationPlayer {
+public:
+    AnimationPlayer();
+    ~AnimationPlayer();
+
+    // file aperto in lettura; frame più grandi di maxWidth x maxHeight rifiutati
+    bool open(File file, uint16_t maxWidth, uint16_t maxHeight);
+    void close();
+    bool isOpen() const { return _frame != nullptr; }
+
+    // Decodifica il frame successivo; false a fine animazione o su errore
+    bool nextFrame();
+    void readAhead();
+
+    const uint16_t* getFrame() const { return _frame; }
+    uint16_t getFrameDelay() const { return _delayMs; }
+    const AnimationHeader& getHeader() const { return _header; }
+    uint16_t getFrameIndex() const { return _frameIndex; }
+    bool isFinished() const { return _finished; }
+    bool hasError() const { return _error; }
+
+    // Statistiche
+    uint32_t getFramesDecoded() const { return _framesDecoded; }
+    uint32_t getLoopsPlayed() const { return _loopsPlayed; }
+    uint32_t getBytesRead() const { return _bytesRead; }
+    uint32_t getReadUs() const { return _readUs; }
+    uint32_t getUnderruns() const { return _underruns; }
+    size_t getWindowBytes() const { return _capacity; }
+    size_t getBufferedBytes() const { return _len - _pos; }
+
+    static bool readHeader(File& file, AnimationHeader& header);
+
+private:
+    File _file;
+    AnimationHeader _header;
+    size_t _pixels;
+    uint32_t _fileSize;
+
+    uint16_t* _frame;
+    uint8_t* _window;
+    size_t _capacity;
+    size_t _pos;                // Primo byte non consumato
+    size_t _len;                // Byte validi nella finestra
+
+    uint16_t _readLoops;        // Passate complete lette dal file
+    bool _eof;                  // Niente più da leggere (loop esauriti)
+
+    uint16_t _frameIndex;       // Prossimo record da decodificare
+    uint16_t _delayMs;
+    bool _haveKey;
+    bool _finished;
+    bool _error;
+
+    uint32_t _framesDecoded;
+    uint32_t _loopsPlayed;
+    uint32_t _bytesRead;
+    uint32_t _readUs;
+    uint32_t _underruns;
+
+    bool fill(size_t needed);
+    size_t readBlock(size_t maxBytes);
+    bool applyDelta(const uint8_t* data, size_t size);
+};
+
+#endif // ANIMATION_PLAYER_H
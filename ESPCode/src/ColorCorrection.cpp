@@ -0,0 +1,25 @@
+#include "ColorCorrection.h"
+
+void ColorCorrection::build(uint16_t gamma100, uint8_t whiteR, uint8_t whiteG, uint8_t whiteB) {
+    if (gamma100 < COLOR_GAMMA_MIN) gamma100 = COLOR_GAMMA_MIN;
+    if (gamma100 > COLOR_GAMMA_MAX) gamma100 = COLOR_GAMMA_MAX;
+
+    gamma = gamma100;
+    white[0] = whiteR;
+    white[1] = whiteG;
+    white[2] = whiteB;
+
+    float exponent = gamma100 / 100.0f;
+    fillLut(lutR, 32, exponent, whiteR);
+    fillLut(lutG, 64, exponent, whiteG);
+    fillLut(lutB, 32, exponent, whiteB);
+}
+
+void ColorCorrection::fillLut(uint8_t* lut, uint8_t entries, float exponent, uint8_t whiteLevel) {
+    float max = entries - 1;
+    for (uint8_t i = 0; i < entries; i++) {
+        uint8_t value = (uint8_t)(powf(i / max, exponent) * whiteLevel + 0.5f);
+        if (i > 0 && value == 0 && whiteLevel > 0) value = 1;
+        lut[i] = value;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef COLOR_CORRECTION_H
+#define COLOR_CORRECTION_H
+
+#include <Arduino.h>
+
+// Default: gamma 2.2 (x100), bianco pieno su tutti i canali
+#define COLOR_GAMMA_DEFAULT 220
+#define COLOR_GAMMA_MIN 100
+#define COLOR_GAMMA_MAX 300
+
+/**
+ * ColorCorrection - Pipeline colore applicata al flush verso il pannello.
+ *
+ * Tre LUT indicizzate dalle componenti RGB565 (32/64/32 voci, 128 byte)
+ * danno direttamente il valore RGB888 per il driver: curva gamma e
+ * bilanciamento del bianco per canale (il bianco di ogni canale è il valore
+ * massimo in uscita). Ricalcolate solo quando cambia la configurazione.
+ *
+ * Le componenti non nulle non scendono mai a 0: i colori scuri dei temi
+ * notte restano visibili invece di spegnersi.
+ * Il driver HUB75 è compilato con NO_CIE1931, questa è l'unica curva.
+ * La luminosità resta quella del driver (setBrightness8, via OE): ridurla
+ * nelle LUT toglierebbe livelli di colore.
+ *
+ * Dithering temporale: con ditherBits > 0 i bit bassi persi dal driver
+ * (luminosità bassa) diventano una soglia: il valore viene arrotondato al
+ * multiplo di 2^bits superiore con probabilità pari alla parte persa, la
+ * soglia cambia per pixel e per frame (vedi DisplayManager::ditherFrame()).
+ */
+class ColorCorrection {
+public:
+    ColorCorrection() : ditherBits(0), ditherMask(0) { build(COLOR_GAMMA_DEFAULT, 255, 255, 255); }
+
+    // gamma100 = gamma x 100 (100 = lineare)
+    void build(uint16_t gamma100, uint8_t whiteR, uint8_t whiteG, uint8_t whiteB);
+
+    inline void apply(uint16_t c, uint8_t& r, uint8_t& g, uint8_t& b) const {
+        r = lutR[c >> 11];
+        g = lutG[(c >> 5) & 0x3F];
+        b = lutB[c & 0x1F];
+    }
+
+    // Bit bassi da simulare nel tempo (0 = dithering spento, max 5)
+    void setDitherBits(uint8_t bits) {
+        ditherBits = bits > 5 ? 5 : bits;
+        ditherMask = (1 << ditherBits) - 1;
+    }
+    uint8_t getDitherBits() const { return ditherBits; }
+
+    // true = almeno un canale ha bit persi: il pixel va reinviato a ogni frame
+    inline bool isDithered(uint16_t c) const {
+        return ((lutR[c >> 11] | lutG[(c >> 5) & 0x3F] | lutB[c & 0x1F]) & ditherMask) != 0;
+    }
+
+    // threshold 0..2^bits-1 (fase del pixel nel frame corrente)
+    inline void applyDithered(uint16_t c, uint8_t threshold, uint8_t& r, uint8_t& g, uint8_t& b) const {
+        apply(c, r, g, b);
+        r = quantize(r, threshold);
+        g = quantize(g, threshold);
+        b = quantize(b, threshold);
+    }
+
+    uint16_t getGamma() const { return gamma; }
+    uint8_t getWhiteR() const { return white[0]; }
+    uint8_t getWhiteG() const { return white[1]; }
+    uint8_t getWhiteB() const { return white[2]; }
+
+private:
+    uint8_t lutR[32];
+    uint8_t lutG[64];
+    uint8_t lutB[32];
+    uint16_t gamma;
+    uint8_t white[3];
+    uint8_t ditherBits;
+    uint8_t ditherMask;
+
+    inline uint8_t quantize(uint8_t value, uint8_t threshold) const {
+        uint16_t base = value & ~ditherMask;
+        if ((value & ditherMask) > threshold) base += ditherMask + 1;
+        return base > 255 ? 255 : base;
+    }
+
+    static void fillLut(uint8_t* lut, uint8_t entries, float exponent, uint8_t whiteLevel);
+};
+
+#endif // COLOR_CORRECTION_H
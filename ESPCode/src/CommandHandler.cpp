@@ -1,9 +1,17 @@
 #include "CommandHandler.h"
 #include "WebSocketManager.h"
+#include "RenderTask.h"
 #include "Version.h"
 #include "effects/ScrollTextEffect.h"
 #include "effects/PongEffect.h"
 #include "effects/SnakeEffect.h"
+#include "effects/StreamEffect.h"
+#include "effects/RealtimeEffect.h"
+#include "effects/AnimationEffect.h"
+#include "effects/DynamicImageEffect.h"
+#include "ImageUploader.h"
+#include "SpriteRenderer.h"
+#include "pacman_assets.h"
 #include <esp_ota_ops.h>
 #include <Preferences.h>
 
@@ -19,6 +27,14 @@ CommandHandler::CommandHandler()
     , _scrollTextEffect(nullptr)
     , _pongEffect(nullptr)
     , _snakeEffect(nullptr)
+    , _streamEffect(nullptr)
+    , _renderTask(nullptr)
+    , _realtimeReceiver(nullptr)
+    , _realtimeEffect(nullptr)
+    , _animationEffect(nullptr)
+    , _dynamicImageEffect(nullptr)
+    , _imageUploader(nullptr)
+    , _animExpectedChunk(0)
     , _otaInProgress(false)
     , _otaSize(0)
     , _otaWritten(0)
@@ -26,6 +42,7 @@ CommandHandler::CommandHandler()
     , _otaExpectedMD5("")
     , _otaStartTime(0)
     , _otaLastActivity(0)
+    , _commandClientId(0)
 {}
 
 void CommandHandler::init(TimeManager* time, EffectManager* effects, DisplayManager* display, Settings* settings, WiFiManager* wifi, ImageManager* imgMgr, TextScheduleManager* schedMgr) {
@@ -54,6 +71,164 @@ void CommandHandler::setSnakeEffect(SnakeEffect* snake) {
     _snakeEffect = snake;
 }
 
+void CommandHandler::setStreamEffect(StreamEffect* stream) {
+    _streamEffect = stream;
+}
+
+void CommandHandler::setRealtime(RealtimeReceiver* receiver, RealtimeEffect* effect) {
+    _realtimeReceiver = receiver;
+    _realtimeEffect = effect;
+}
+
+void CommandHandler::setAnimationEffect(AnimationEffect* animation) {
+    _animationEffect = animation;
+}
+
+void CommandHandler::setDynamicImageEffect(DynamicImageEffect* images) {
+    _dynamicImageEffect = images;
+}
+
+void CommandHandler::setImageUploader(ImageUploader* uploader) {
+    _imageUploader = uploader;
+}
+
+void CommandHandler::setRenderTask(RenderTask* render) {
+    _renderTask = render;
+}
+
+// ═══════════════════════════════════════════
+// Command Dispatch (task di rete → task di render)
+// ═══════════════════════════════════════════
+
+bool CommandHandler::isAsyncDispatch() const {
+    return _renderTask && _renderTask->isRunning();
+}
+
+// Comandi che non toccano lo stato di render ma bloccano a lungo:
+// restano sul task che li ha ricevuti
+bool CommandHandler::runsOnNetworkTask(const String& command) {
+    return command.equalsIgnoreCase("wifiscan");
+}
+
+bool CommandHandler::enqueueWsCommand(uint32_t clientId, const String& command) {
+    if (!isAsyncDispatch() || runsOnNetworkTask(command)) {
+        _commandClientId = clientId;
+        String response = processCommand(command);
+        _commandClientId = 0;
+        if (_wsManager && !response.isEmpty()) {
+            _wsManager->sendToClient(clientId, response);
+        }
+        return true;
+    }
+
+    QueuedCommand queued;
+    queued.command = command;
+    queued.source = CMD_SOURCE_WS;
+    queued.clientId = clientId;
+    return _netQueue.push(queued);
+}
+
+String CommandHandler::executeBlocking(const String& command) {
+    if (!isAsyncDispatch() || runsOnNetworkTask(command)) {
+        return processCommand(command);
+    }
+
+    // Attesa limitata: un render bloccato non deve fermare il task AsyncTCP.
+    // Dopo il timeout il comando può ancora essere eseguito, ma la risposta
+    // va persa (la scrive il render nella PendingReply condivisa)
+    std::shared_ptr<PendingReply> reply = std::make_shared<PendingReply>();
+    reply->waiter = xTaskGetCurrentTaskHandle();
+
+    QueuedCommand queued;
+    queued.command = command;
+    queued.source = CMD_SOURCE_HTTP;
+    queued.reply = reply;
+    if (!_netQueue.push(queued)) {
+        return "ERR,busy";
+    }
+
+    // Notifiche rimaste da un'attesa precedente scaduta: si ricontrolla done
+    uint32_t start = millis();
+    while (true) {
+        portENTER_CRITICAL(&reply->mux);
+        bool done = reply->done;
+        uint32_t elapsed = millis() - start;
+        if (!done && elapsed >= CMD_HTTP_TIMEOUT_MS) reply->abandoned = true;
+        portEXIT_CRITICAL(&reply->mux);
+
+        if (done) return reply->response;
+        if (elapsed >= CMD_HTTP_TIMEOUT_MS) break;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CMD_HTTP_TIMEOUT_MS - elapsed));
+    }
+
+    DEBUG_PRINTF("[CMD] HTTP command timed out: %s\n", command.c_str());
+    return "ERR,timeout";
+}
+
+void CommandHandler::enqueueSerial(const String& line) {
+    if (!isAsyncDispatch()) {
+        processSerial(line);
+        return;
+    }
+
+    QueuedCommand queued;
+    queued.command = line;
+    queued.source = CMD_SOURCE_SERIAL;
+    if (!_localQueue.push(queued)) {
+        DEBUG_PRINTLN("ERR,busy");
+    }
+}
+
+void CommandHandler::processQueuedCommands() {
+    // Budget per frame: un flood di comandi non può affamare il rendering,
+    // ma almeno un comando per frame viene sempre eseguito
+    uint32_t start = micros();
+    QueuedCommand queued;
+
+    do {
+        bool popped = _netQueue.pop(queued) || _localQueue.pop(queued);
+        if (!popped) break;
+        executeQueued(queued);
+    } while (micros() - start < CMD_BUDGET_US);
+}
+
+void CommandHandler::executeQueued(QueuedCommand& queued) {
+    switch (queued.source) {
+        case CMD_SOURCE_WS: {
+            _commandClientId = queued.clientId;
+            String response = processCommand(queued.command);
+            _commandClientId = 0;
+            if (_wsManager && !response.isEmpty()) {
+                _wsManager->sendToClient(queued.clientId, response);
+            }
+            break;
+        }
+
+        case CMD_SOURCE_HTTP: {
+            // Scrittura sempre sicura (heap condiviso), done solo se c'è ancora chi attende
+            PendingReply* reply = queued.reply.get();
+            reply->response = processCommand(queued.command);
+
+            portENTER_CRITICAL(&reply->mux);
+            bool abandoned = reply->abandoned;
+            if (!abandoned) {
+                reply->done = true;
+            }
+            portEXIT_CRITICAL(&reply->mux);
+
+            if (!abandoned) {
+                xTaskNotifyGive(reply->waiter);
+            }
+            queued.reply.reset();
+            break;
+        }
+
+        case CMD_SOURCE_SERIAL:
+            processSerial(queued.command);
+            break;
+    }
+}
+
 // ═══════════════════════════════════════════
 // OTA Watchdog - Boot Status Check
 // ═══════════════════════════════════════════
@@ -113,6 +288,72 @@ void CommandHandler::checkOTABootStatus() {
     prefs.end();
 }
 
+// ═══════════════════════════════════════════
+// Stream - Idle Timeout
+// ═══════════════════════════════════════════
+
+void CommandHandler::checkStreamIdle() {
+    if (!_streamEffect || !_streamEffect->isIdle()) return;
+
+    DEBUG_PRINTLN(F("[Stream] No frames, closing stream"));
+    stopStream();
+    if (_wsManager) {
+        _wsManager->broadcast("STREAM_END,idle");
+    }
+}
+
+// ═══════════════════════════════════════════
+// Realtime - Sorgente UDP attiva
+// ═══════════════════════════════════════════
+
+void CommandHandler::checkRealtime() {
+    if (!_realtimeReceiver || !_realtimeEffect) return;
+
+    bool active = _realtimeReceiver->isActive();
+    if (active && !_realtimeTakeover.active) {
+        beginTakeover(_realtimeTakeover, _realtimeEffect);
+        if (_wsManager) {
+            _wsManager->broadcast("REALTIME_START," +
+                                  String(RealtimeReceiver::protocolName(_realtimeReceiver->getProtocol())) + "," +
+                                  IPAddress(_realtimeReceiver->getSourceIp()).toString());
+        }
+    } else if (!active && _realtimeTakeover.active) {
+        endTakeover(_realtimeTakeover, _realtimeEffect);
+        if (_wsManager) {
+            _wsManager->broadcast("REALTIME_END,timeout");
+        }
+    }
+}
+
+// ═══════════════════════════════════════════
+// Display Takeover (stream, realtime)
+// ═══════════════════════════════════════════
+
+// Mostra effect sospendendo l'auto-switch; endTakeover() ripristina
+void CommandHandler::beginTakeover(DisplayTakeover& takeover, Effect* effect) {
+    if (!takeover.active) {
+        takeover.prevEffect = _effectManager->getCurrentEffectIndex();
+        takeover.prevAutoSwitch = _effectManager->isAutoSwitch();
+        takeover.active = true;
+        _effectManager->setAutoSwitch(false);
+    }
+    if (_effectManager->getCurrentEffect() != effect) {
+        _effectManager->switchToEffect(effect->getName());
+    }
+}
+
+void CommandHandler::endTakeover(DisplayTakeover& takeover, Effect* effect) {
+    if (!takeover.active) return;
+    takeover.active = false;
+    _effectManager->setAutoSwitch(takeover.prevAutoSwitch);
+
+    // Torna all'effetto precedente solo se effect è ancora a schermo
+    if (_effectManager->getCurrentEffect() == effect && takeover.prevEffect >= 0) {
+        _effectManager->switchToEffect(takeover.prevEffect);
+    }
+    takeover.prevEffect = -1;
+}
+
 // ═══════════════════════════════════════════
 // OTA Watchdog - Timeout Monitor
 // ═══════════════════════════════════════════
@@ -249,6 +490,9 @@ String CommandHandler::processCommand(const String& command) {
     if (mainCmd == "autoswitch") {
         return handleAutoSwitch(parts);
     }
+    if (mainCmd == "transition") {
+        return handleTransition(parts);
+    }
     if (mainCmd == "wifi") {
         return handleWiFi(parts);
     }
@@ -264,6 +508,12 @@ String CommandHandler::processCommand(const String& command) {
     if (mainCmd == "snake") {
         return handleSnake(parts);
     }
+    if (mainCmd == "stream") {
+        return handleStream(parts);
+    }
+    if (mainCmd == "realtime") {
+        return handleRealtime(parts);
+    }
     if (mainCmd == "ntp") {
         return handleNTP(parts);
     }
@@ -282,12 +532,27 @@ String CommandHandler::processCommand(const String& command) {
     if (mainCmd == "image") {
         return handleImage(parts);
     }
+    if (mainCmd == "anim") {
+        return handleAnimation(parts);
+    }
     if (mainCmd == "schedtext") {
         return handleScheduledText(parts);
     }
     if (mainCmd == "wifiscan") {
         return handleWiFiScan();
     }
+    if (mainCmd == "display") {
+        return handleDisplay(parts);
+    }
+    if (mainCmd == "bench") {
+        return handleBench(parts);
+    }
+    if (mainCmd == "render") {
+        return handleRender(parts);
+    }
+    if (mainCmd == "perf") {
+        return handlePerf(parts);
+    }
 
     return "ERR,unknown command: " + mainCmd;
 }
@@ -741,6 +1006,43 @@ String CommandHandler::handleDuration(const ParsedCommand& parts) {
     return "OK,duration " + String(ms);
 }
 
+String CommandHandler::handleTransition(const ParsedCommand& parts) {
+    if (!_effectManager) {
+        return "ERR,effect manager not available";
+    }
+
+    // transition,TYPE[,MS]
+    if (parts.size() >= 2) {
+        TransitionType type;
+        if (!Transition::parseType(parts[1], type)) {
+            return "ERR,transition must be fade|wipe|none";
+        }
+
+        uint16_t ms = _effectManager->getTransitionDuration();
+        if (parts.size() >= 3) {
+            int value = parts[2].toInt();
+            if (value < 50 || value > 5000) {
+                return "ERR,transition must be 50-5000 ms";
+            }
+            ms = value;
+        }
+
+        _effectManager->setTransition(type, ms);
+        if (_settings) {
+            _settings->setTransition(type, ms);
+        }
+    }
+
+    // transition → stato corrente
+    const Transition& transition = _effectManager->getTransition();
+    String response = "TRANSITION";
+    response += "," + String(Transition::typeName(transition.getType()));
+    response += "," + String(transition.getDuration());
+    response += "," + String(transition.getAvgCostUs());
+    response += "," + String(transition.getMaxCostUs());
+    return response;
+}
+
 String CommandHandler::handleAutoSwitch(const ParsedCommand& parts) {
     if (parts.size() < 2) {
         return "ERR,autoswitch needs 0|1";
@@ -1057,6 +1359,139 @@ String CommandHandler::handleSnake(const ParsedCommand& parts) {
     return "ERR,unknown snake subcommand: " + subCmd;
 }
 
+String CommandHandler::handleStream(const ParsedCommand& parts) {
+    if (!_streamEffect) {
+        return "ERR,stream effect not available";
+    }
+
+    if (parts.size() < 2) {
+        return "ERR,stream needs subcommand";
+    }
+
+    String subCmd = parts[1];
+    subCmd.toLowerCase();
+
+    // stream,start[,JITTER_MS]
+    if (subCmd == "start") {
+        if (parts.size() >= 3) {
+            _streamEffect->setJitterMs(constrain(parts[2].toInt(), 0, STREAM_JITTER_MS_MAX));
+        }
+        if (!_streamEffect->open(_commandClientId)) {
+            return "ERR,stream no memory";
+        }
+        beginTakeover(_streamTakeover, _streamEffect);
+        return "STREAM_READY," + String(_displayManager->getCanvasWidth()) + "," +
+               String(_displayManager->getCanvasHeight()) + "," +
+               String(_streamEffect->getJitterMs());
+    }
+
+    // stream,stop
+    if (subCmd == "stop") {
+        if (!_streamEffect->isOpen()) {
+            return "ERR,stream not open";
+        }
+        stopStream();
+        return "OK,stream,stop";
+    }
+
+    // stream,jitter,MS
+    if (subCmd == "jitter") {
+        if (parts.size() < 3) {
+            return "ERR,stream jitter needs MS";
+        }
+        _streamEffect->setJitterMs(constrain(parts[2].toInt(), 0, STREAM_JITTER_MS_MAX));
+        return "OK,stream,jitter," + String(_streamEffect->getJitterMs());
+    }
+
+    // stream,stats
+    if (subCmd == "stats") {
+        return "STREAM," + String(_streamEffect->isOpen() ? 1 : 0) + "," +
+               String(_streamEffect->getReceived()) + "," +
+               String(_streamEffect->getShown()) + "," +
+               String(_streamEffect->getDropped()) + "," +
+               String(_streamEffect->getLost()) + "," +
+               String(_streamEffect->getErrors()) + "," +
+               String(_streamEffect->getAvgLatencyUs()) + "," +
+               String(_streamEffect->getMaxLatencyUs()) + "," +
+               String(_streamEffect->getJitterMs()) + "," +
+               String(_streamEffect->getQueued());
+    }
+
+    // stream,reset
+    if (subCmd == "reset") {
+        _streamEffect->resetStats();
+        return "OK,stream,reset";
+    }
+
+    return "ERR,unknown stream subcommand";
+}
+
+void CommandHandler::stopStream() {
+    _streamEffect->close();
+    endTakeover(_streamTakeover, _streamEffect);
+}
+
+String CommandHandler::handleRealtime(const ParsedCommand& parts) {
+    if (!_realtimeReceiver) {
+        return "ERR,realtime not available";
+    }
+
+    String subCmd = parts.size() >= 2 ? parts[1] : "";
+    subCmd.toLowerCase();
+
+    // realtime,enable|disable
+    if (subCmd == "enable" || subCmd == "disable") {
+        bool enable = subCmd == "enable";
+        if (enable) {
+            if (!_realtimeReceiver->begin(_displayManager->getCanvasWidth(), _displayManager->getCanvasHeight())) {
+                return "ERR,realtime no memory";
+            }
+        } else {
+            _realtimeReceiver->end();
+            checkRealtime();    // Sorgente persa: torna all'effetto precedente
+        }
+        _settings->setRealtimeEnabled(enable);
+        return "OK,realtime," + subCmd;
+    }
+
+    // realtime,map,UNIVERSE[,PIXELS]
+    if (subCmd == "map") {
+        if (parts.size() < 3) {
+            return "ERR,realtime map needs UNIVERSE[,PIXELS]";
+        }
+        uint16_t universe = constrain(parts[2].toInt(), 0, 32767);
+        uint8_t pixels = parts.size() >= 4 ? constrain(parts[3].toInt(), 1, REALTIME_UNIVERSE_PIXELS)
+                                           : _realtimeReceiver->getUniversePixels();
+        _realtimeReceiver->setUniverseMap(universe, pixels);
+        _settings->setRealtimeMap(universe, pixels);
+        return "OK,realtime,map," + String(universe) + "," + String(pixels);
+    }
+
+    // realtime,reset
+    if (subCmd == "reset") {
+        _realtimeReceiver->resetStats();
+        return "OK,realtime,reset";
+    }
+
+    // realtime
+    if (subCmd.isEmpty() || subCmd == "stats") {
+        return "REALTIME," + String(_realtimeReceiver->isRunning() ? 1 : 0) + "," +
+               String(_realtimeReceiver->isActive() ? 1 : 0) + "," +
+               RealtimeReceiver::protocolName(_realtimeReceiver->getProtocol()) + "," +
+               IPAddress(_realtimeReceiver->getSourceIp()).toString() + "," +
+               String(_realtimeReceiver->getSourcePriority()) + "," +
+               String(_realtimeReceiver->getPackets()) + "," +
+               String(_realtimeReceiver->getFrames()) + "," +
+               String(_realtimeReceiver->getIgnored()) + "," +
+               String(_realtimeReceiver->getErrors()) + "," +
+               String(_realtimeReceiver->getSyncs()) + "," +
+               String(_realtimeReceiver->getStartUniverse()) + "," +
+               String(_realtimeReceiver->getUniversePixels());
+    }
+
+    return "ERR,unknown realtime subcommand";
+}
+
 String CommandHandler::handleNTP(const ParsedCommand& parts) {
     if (parts.size() < 2) {
         return "ERR,ntp needs subcommand (enable/disable/sync)";
@@ -1149,6 +1584,7 @@ void CommandHandler::updateBrightness() {
     if (_settings && _timeManager && _displayManager) {
         int hour = _timeManager->getHour();
         uint8_t brightness = _settings->getCurrentBrightness(hour);
+        _displayManager->setDithering(_settings->isDitherActive(hour));
         _displayManager->setBrightness(brightness);
         
         DEBUG_PRINTF("[Brightness] Updated to %d (hour=%d, night=%s)\n", 
@@ -1455,14 +1891,101 @@ String CommandHandler::handleImage(const ParsedCommand& parts) {
         String name = parts[2];
         String base64Data = parts[3];
 
+        // Picco di heap stimato: il buffer di decodifica si alloca dentro uploadImage()
+        uint32_t heap = ESP.getFreeHeap();
+        uint32_t t0 = micros();
         if (_imageManager->uploadImage(name, base64Data)) {
+            if (_imageUploader) {
+                _imageUploader->recordBase64(base64Data.length(), micros() - t0,
+                                             heap > IMAGE_SIZE ? heap - IMAGE_SIZE : 0);
+            }
             return "OK,Image uploaded: " + name;
         } else {
             return "ERR,Failed to upload image";
         }
     }
 
-    // image,list
+    // image,begin,NAME,SIZE,CRC32
+    else if (subCmd == "begin") {
+        if (!_imageUploader) {
+            return "ERR,Binary upload not available";
+        }
+        if (parts.size() < 5) {
+            return "ERR,Begin requires: image,begin,NAME,SIZE,CRC32";
+        }
+
+        uint32_t crc = strtoul(parts[4].c_str(), nullptr, 16);
+        int32_t offset = _imageUploader->begin(parts[2], parts[3].toInt(), crc, _commandClientId);
+        if (offset == UPLOAD_BUSY) {
+            return "ERR,Image upload in progress";
+        }
+        if (offset < 0) {
+            return "ERR,Image upload init failed";
+        }
+        return "UPLOAD_READY," + parts[2] + "," + String(offset);
+    }
+
+    // image,commit[,RESIZE]
+    else if (subCmd == "commit") {
+        if (!_imageUploader || !_imageUploader->isActive()) {
+            return "ERR,No image upload in progress";
+        }
+        String name = _imageUploader->getName();
+        bool resize = parts.size() < 3 || parts[2].toInt() != 0;
+        if (!_imageUploader->commit(resize)) {
+            return "ERR,Image upload failed";
+        }
+        return "OK,Image uploaded: " + name;
+    }
+
+    // image,abort
+    else if (subCmd == "abort") {
+        if (!_imageUploader) {
+            return "ERR,Binary upload not available";
+        }
+        _imageUploader->abort();
+        return "OK,Image upload aborted";
+    }
+
+    // image,upstats
+    else if (subCmd == "upstats") {
+        if (!_imageUploader) {
+            return "ERR,Binary upload not available";
+        }
+        String response = "UPLOAD_STATS";
+        response += ",";
+        response += _imageUploader->getLastMode();
+        response += "," + String(_imageUploader->getLastBytes());
+        response += "," + String(_imageUploader->getLastMs());
+        response += "," + String(_imageUploader->getLastKBps());
+        response += "," + String(_imageUploader->getLastMinFreeHeap());
+        response += "," + String(ESP.getFreeHeap());
+        response += "," + String(_imageUploader->getResumed());
+        response += "," + String(_imageUploader->getNacks());
+
+        return response;
+    }
+
+    // image,list,OFFSET,COUNT (pagina dal manifest, niente accesso a flash)
+    else if (subCmd == "list" && parts.size() >= 3) {
+        size_t total = _imageManager->getImageCount();
+        size_t offset = min((size_t)max(0L, parts[2].toInt()), total);
+        size_t count = parts.size() >= 4 ? (size_t)max(0L, parts[3].toInt()) : IMAGE_LIST_PAGE_MAX;
+        count = min(min(count, (size_t)IMAGE_LIST_PAGE_MAX), total - offset);
+
+        String response = "IMAGES_PAGE," + String(total) + "," + String(offset) + "," + String(count);
+        for (size_t i = offset; i < offset + count; i++) {
+            const ImageEntry* entry = _imageManager->getImageEntry(i);
+            response += ",";
+            response += entry->name;
+            response += "," + String(entry->size);
+            response += entry->format == IMAGE_FORMAT_QIM ? ",qim" : ",raw";
+        }
+
+        return response;
+    }
+
+    // image,list (lista completa, formato usato dall'app)
     else if (subCmd == "list") {
         auto images = _imageManager->listImages();
         String response = "IMAGES," + String(images.size());
@@ -1502,9 +2025,202 @@ String CommandHandler::handleImage(const ParsedCommand& parts) {
         return response;
     }
 
+    // image,stats
+    else if (subCmd == "stats") {
+        auto images = _imageManager->listImages();
+        size_t compressed = 0;
+        size_t stored = 0;
+        for (const auto& img : images) {
+            if (img.compressed) compressed++;
+            stored += img.size;
+        }
+        size_t raw = images.size() * IMAGE_SIZE;
+
+        String response = "IMAGE_STATS";
+        response += "," + String(images.size());
+        response += "," + String(compressed);
+        response += "," + String(raw);
+        response += "," + String(stored);
+        response += "," + String(raw > 0 ? stored * 100 / raw : 0);
+        response += "," + String(_imageManager->getLastLoadUs());
+        response += "," + String(_imageManager->getAvgLoadUs());
+
+        return response;
+    }
+
+    // image,cache
+    else if (subCmd == "cache") {
+        if (!_dynamicImageEffect) {
+            return "ERR,Image effect not available";
+        }
+        String response = "IMAGE_CACHE";
+        response += "," + String(_dynamicImageEffect->getCacheSlots());
+        response += "," + String(_dynamicImageEffect->getCacheUsed());
+        response += "," + String(_dynamicImageEffect->getCacheHits());
+        response += "," + String(_dynamicImageEffect->getCacheMisses());
+        response += "," + String(_dynamicImageEffect->getPrefetched());
+        response += "," + String(_dynamicImageEffect->getLastSwapUs());
+
+        return response;
+    }
+
+    // image,compact
+    else if (subCmd == "compact") {
+        return "OK,image,compact," + String(_imageManager->compactImages());
+    }
+
+    // image,reindex
+    else if (subCmd == "reindex") {
+        if (!_imageManager->rebuildManifest()) {
+            return "ERR,Failed to rebuild image index";
+        }
+        return "OK,image,reindex," + String(_imageManager->getImageCount());
+    }
+
     return "ERR,Unknown image subcommand: " + subCmd;
 }
 
+// ═══════════════════════════════════════════
+// Animation Upload/Playback Handler
+// ═══════════════════════════════════════════
+
+String CommandHandler::handleAnimation(const ParsedCommand& parts) {
+    if (!_imageManager || !_animationEffect) {
+        return "ERR,Animation not available";
+    }
+
+    String subCmd = parts.size() >= 2 ? parts[1] : "";
+    subCmd.toLowerCase();
+
+    // anim,start,NAME,SIZE
+    if (subCmd == "start") {
+        if (parts.size() < 4) {
+            return "ERR,Upload requires: anim,start,NAME,SIZE";
+        }
+        if (!_imageManager->beginAnimationUpload(parts[2], parts[3].toInt())) {
+            return "ERR,Animation upload init failed";
+        }
+        _animExpectedChunk = 0;
+        return "ANIM_READY";
+    }
+
+    // anim,data,CHUNK_NUM,BASE64
+    if (subCmd == "data") {
+        if (!_imageManager->isAnimationUploading()) {
+            return "ERR,No animation upload in progress";
+        }
+        if (parts.size() < 4) {
+            return "ERR,anim data requires chunk_num and data";
+        }
+
+        int chunkNum = parts[2].toInt();
+        if (chunkNum != _animExpectedChunk) {
+            return "ANIM_NACK," + String(_animExpectedChunk);
+        }
+
+        static uint8_t decodedBuffer[4096];
+        size_t decodedLen = base64Decode(parts[3], decodedBuffer, sizeof(decodedBuffer));
+        if (decodedLen == 0) {
+            return "ANIM_NACK," + String(chunkNum);
+        }
+        if (!_imageManager->writeAnimationChunk(decodedBuffer, decodedLen)) {
+            _imageManager->abortAnimationUpload();
+            return "ERR,Animation write failed";
+        }
+
+        _animExpectedChunk++;
+        return "ANIM_ACK," + String(chunkNum);
+    }
+
+    // anim,end
+    if (subCmd == "end") {
+        if (!_imageManager->isAnimationUploading()) {
+            return "ERR,No animation upload in progress";
+        }
+        // Il file in riproduzione con lo stesso nome sta per essere sostituito
+        if (_animationEffect->getAnimationName() == _imageManager->getAnimationUploadName()) {
+            _animationEffect->stop();
+        }
+        if (!_imageManager->endAnimationUpload()) {
+            return "ERR,Invalid animation";
+        }
+        return "OK,Animation uploaded";
+    }
+
+    // anim,abort
+    if (subCmd == "abort") {
+        if (!_imageManager->isAnimationUploading()) {
+            return "ERR,No animation upload in progress";
+        }
+        _imageManager->abortAnimationUpload();
+        return "OK,Animation upload aborted";
+    }
+
+    // anim,play,NAME
+    if (subCmd == "play") {
+        if (parts.size() < 3) {
+            return "ERR,Play requires: anim,play,NAME";
+        }
+        if (!_animationEffect->play(parts[2])) {
+            return "ERR,Failed to play animation: " + parts[2];
+        }
+        if (_effectManager->getCurrentEffect() != _animationEffect) {
+            _effectManager->switchToEffect(_animationEffect->getName());
+        }
+        const AnimationHeader& header = _animationEffect->getPlayer().getHeader();
+        return "ANIM_PLAY," + parts[2] + "," + String(header.width) + "," +
+               String(header.height) + "," + String(header.frameCount);
+    }
+
+    // anim,stop
+    if (subCmd == "stop") {
+        _animationEffect->stop();
+        return "OK,anim,stop";
+    }
+
+    // anim,list
+    if (subCmd == "list") {
+        auto anims = _imageManager->listAnimations();
+        String response = "ANIMS," + String(anims.size());
+        for (const auto& anim : anims) {
+            response += "," + anim.name + "," + String(anim.size);
+        }
+        return response;
+    }
+
+    // anim,delete,NAME
+    if (subCmd == "delete") {
+        if (parts.size() < 3) {
+            return "ERR,Delete requires: anim,delete,NAME";
+        }
+        if (_animationEffect->getAnimationName() == parts[2]) {
+            _animationEffect->stop();
+        }
+        if (_imageManager->deleteAnimation(parts[2])) {
+            return "OK,Animation deleted: " + parts[2];
+        }
+        return "ERR,Failed to delete animation";
+    }
+
+    // anim,stats
+    if (subCmd.isEmpty() || subCmd == "stats") {
+        const AnimationPlayer& player = _animationEffect->getPlayer();
+        return "ANIM," + _animationEffect->getAnimationName() + "," +
+               String(player.isOpen() && !player.isFinished() ? 1 : 0) + "," +
+               String(player.getFrameIndex()) + "," +
+               String(player.getHeader().frameCount) + "," +
+               String(player.getLoopsPlayed()) + "," +
+               String(_animationEffect->getPlaybackFPS(), 1) + "," +
+               String(_animationEffect->getReadKBps()) + "," +
+               String(player.getBytesRead()) + "," +
+               String(player.getUnderruns()) + "," +
+               String(_animationEffect->getLate()) + "," +
+               String(player.getWindowBytes());
+    }
+
+    return "ERR,Unknown anim subcommand: " + subCmd;
+}
+
 // ═══════════════════════════════════════════
 // Scheduled Text Handler
 // ═══════════════════════════════════════════
@@ -1634,4 +2350,396 @@ String CommandHandler::handleWiFiScan() {
     }
 
     return _wifiManager->scanNetworks();
-}
\ No newline at end of file
+}
+
+// ═══════════════════════════════════════════
+// Display Handler
+// ═══════════════════════════════════════════
+
+String CommandHandler::handleDisplay(const ParsedCommand& parts) {
+    if (!_displayManager) {
+        return "ERR,display not available";
+    }
+
+    if (parts.size() < 2) {
+        return "ERR,Display command requires subcommand";
+    }
+
+    String subCmd = parts[1];
+    subCmd.toLowerCase();
+
+    // display,flush,pixel|runs
+    if (subCmd == "flush") {
+        if (parts.size() < 3) {
+            return String("OK,flush,") + (_displayManager->getFlushMode() == FLUSH_RUNS ? "runs" : "pixel");
+        }
+        String mode = parts[2];
+        mode.toLowerCase();
+        if (mode == "runs") {
+            _displayManager->setFlushMode(FLUSH_RUNS);
+        } else if (mode == "pixel") {
+            _displayManager->setFlushMode(FLUSH_PIXEL);
+        } else {
+            return "ERR,flush mode must be pixel or runs";
+        }
+        return "OK,flush," + mode;
+    }
+
+    // display,bench[,FRAMES]
+    if (subCmd == "bench") {
+        int frames = parts.size() >= 3 ? parts[2].toInt() : 20;
+        if (frames < 1 || frames > 500) {
+            return "ERR,frames must be 1-500";
+        }
+
+        uint32_t pixelUs = _displayManager->benchmarkFlush(FLUSH_PIXEL, frames);
+        uint32_t runsUs = _displayManager->benchmarkFlush(FLUSH_RUNS, frames);
+
+        DEBUG_PRINTF("[Bench] Full flush x%d: pixel=%lu us, runs=%lu us\n",
+                     frames, (unsigned long)pixelUs, (unsigned long)runsUs);
+
+        return "BENCH,flush," + String(frames) + "," + String(pixelUs) + "," + String(runsUs);
+    }
+
+    // display,info
+    if (subCmd == "info") {
+        String response = "DISPLAY";
+        response += "," + String(_displayManager->getCanvasWidth());
+        response += "," + String(_displayManager->getCanvasHeight());
+        response += "," + String(_displayManager->isDoubleBuffered() ? "1" : "0");
+        response += "," + String(_displayManager->getDmaBytes());
+        response += "," + String(_displayManager->getBufferBytes());
+        response += "," + String(_displayManager->getFlushMode() == FLUSH_RUNS ? "runs" : "pixel");
+        response += "," + String(_displayManager->getPanelCols());
+        response += "," + String(_displayManager->getPanelRows());
+        response += "," + String(DisplayManager::layoutName(_displayManager->getChainLayout()));
+        response += "," + String(DisplayManager::formatName(_displayManager->getPixelFormat()));
+        return response;
+    }
+
+    // display,palette
+    if (subCmd == "palette") {
+        const Palette& palette = _displayManager->getPalette();
+        String response = "PALETTE";
+        response += "," + String(DisplayManager::formatName(_displayManager->getPixelFormat()));
+        response += "," + String(palette.getUsed());
+        response += "," + String(palette.getReserved());
+        response += "," + String(palette.getApproximations());
+        return response;
+    }
+
+    // display,glyphs
+    if (subCmd == "glyphs") {
+        const GlyphCache& glyphs = _displayManager->getGlyphCache();
+        String response = "GLYPHS";
+        response += "," + String(glyphs.getHits());
+        response += "," + String(glyphs.getMisses());
+        response += "," + String(glyphs.getUsedEntries());
+        response += "," + String(GLYPH_CACHE_SIZE);
+        response += "," + String(glyphs.getBytes());
+        return response;
+    }
+
+    // display,color[,GAMMA[,R,G,B]]
+    if (subCmd == "color") {
+        const ColorCorrection& current = _displayManager->getColorCorrection();
+        if (parts.size() >= 3) {
+            float gamma = parts[2].toFloat();
+            if (gamma < COLOR_GAMMA_MIN / 100.0f || gamma > COLOR_GAMMA_MAX / 100.0f) {
+                return "ERR,gamma must be 1.0-3.0";
+            }
+            uint8_t white[3] = {current.getWhiteR(), current.getWhiteG(), current.getWhiteB()};
+            if (parts.size() >= 6) {
+                for (int i = 0; i < 3; i++) {
+                    int value = parts[3 + i].toInt();
+                    if (value < 0 || value > 255) {
+                        return "ERR,white balance must be 0-255";
+                    }
+                    white[i] = value;
+                }
+            } else if (parts.size() > 3) {
+                return "ERR,Usage: display,color[,GAMMA[,R,G,B]]";
+            }
+
+            uint16_t gamma100 = (uint16_t)(gamma * 100 + 0.5f);
+            _displayManager->setColorCorrection(gamma100, white[0], white[1], white[2]);
+            if (_settings) {
+                _settings->setColorCorrection(gamma100, white[0], white[1], white[2]);
+            }
+        }
+
+        uint16_t gamma100 = current.getGamma();
+        char gammaStr[8];
+        snprintf(gammaStr, sizeof(gammaStr), "%u.%02u", gamma100 / 100, gamma100 % 100);
+        String response = "COLOR";
+        response += "," + String(gammaStr);
+        response += "," + String(current.getWhiteR());
+        response += "," + String(current.getWhiteG());
+        response += "," + String(current.getWhiteB());
+        return response;
+    }
+
+    // display,dither[,off|on|night]
+    if (subCmd == "dither") {
+        if (parts.size() >= 3) {
+            if (!_settings) {
+                return "ERR,settings not available";
+            }
+            String mode = parts[2];
+            mode.toLowerCase();
+            if (mode == "off") {
+                _settings->setDitherMode(DITHER_OFF);
+            } else if (mode == "on") {
+                _settings->setDitherMode(DITHER_ON);
+            } else if (mode == "night") {
+                _settings->setDitherMode(DITHER_NIGHT);
+            } else {
+                return "ERR,dither must be off|on|night";
+            }
+            updateBrightness();
+        }
+
+        String response = "DITHER";
+        response += "," + String(_settings ? Settings::ditherModeName(_settings->getDitherMode()) : "off");
+        response += "," + String(_displayManager->isDitheringEnabled() ? "1" : "0");
+        response += "," + String(_displayManager->getDitherBits());
+        response += "," + String(_displayManager->getDitherPasses());
+        response += "," + String(_displayManager->getDitherAvgUs());
+        response += "," + String(_displayManager->getDitherMaxUs());
+        response += "," + String(_displayManager->getDitherAvgPixels());
+        return response;
+    }
+
+    // display,doublebuffer,0|1
+    if (subCmd == "doublebuffer") {
+        if (parts.size() < 3) {
+            return "ERR,Usage: display,doublebuffer,0|1";
+        }
+        if (!_settings) {
+            return "ERR,settings not available";
+        }
+        bool enabled = parts[2].toInt() != 0;
+        _settings->setDoubleBuffer(enabled);
+        _settings->save();
+        return String("OK,doublebuffer,") + (enabled ? "1" : "0") + ",restart required";
+    }
+
+    return "ERR,Unknown display subcommand: " + subCmd;
+}
+
+// ═══════════════════════════════════════════
+// Benchmark Handler
+// ═══════════════════════════════════════════
+
+String CommandHandler::handleBench(const ParsedCommand& parts) {
+    if (!_displayManager) {
+        return "ERR,display not available";
+    }
+
+    if (parts.size() < 2) {
+        return "ERR,Bench command requires subcommand";
+    }
+
+    String subCmd = parts[1];
+    subCmd.toLowerCase();
+
+    // bench,sprites[,ITER]
+    if (subCmd == "sprites") {
+        int iterations = parts.size() >= 3 ? parts[2].toInt() : 100;
+        if (iterations < 1 || iterations > 5000) {
+            return "ERR,iterations must be 1-5000";
+        }
+
+        int w = _displayManager->getCanvasWidth();
+        int h = _displayManager->getCanvasHeight();
+
+        // Il benchmark disegna nel framebuffer: salva e ripristina il contenuto
+        uint16_t* saved = (uint16_t*)malloc(w * h * sizeof(uint16_t));
+        if (!saved) {
+            return "ERR,out of memory";
+        }
+        _displayManager->copyFrame(saved);
+
+        SpriteRenderer renderer(_displayManager);
+        CompiledSprite pacman;
+        SpriteRenderer::compile(pacman, PACMAN_SPRITE_1, PACMAN_SPRITE_SIZE, PACMAN_SPRITE_SIZE,
+                                0x0000, true, false);
+
+        _displayManager->beginFrame();
+
+        // Percorso originale: pgm_read + mask + RGB888 + drawPixel per pixel
+        unsigned long start = micros();
+        for (int i = 0; i < iterations; i++) {
+            renderer.drawSpritePixels(MARIO_IDLE, 23, 40, MARIO_IDLE_SIZE[0], MARIO_IDLE_SIZE[1]);
+            renderer.drawSpritePixels(MARIO_JUMP, 8, 30, MARIO_JUMP_SIZE[0], MARIO_JUMP_SIZE[1], true);
+            renderer.drawSpritePixels(BLOCK, 8, 8, BLOCK_SIZE[0], BLOCK_SIZE[1]);
+            for (int dy = 0; dy < PACMAN_SPRITE_SIZE; dy++) {
+                for (int dx = 0; dx < PACMAN_SPRITE_SIZE; dx++) {
+                    uint16_t color = pgm_read_word(&PACMAN_SPRITE_1[dy * PACMAN_SPRITE_SIZE + dx]);
+                    if (color != 0x0000) {
+                        uint8_t r = (color >> 11) << 3;
+                        uint8_t g = ((color >> 5) & 0x3F) << 2;
+                        uint8_t b = (color & 0x1F) << 3;
+                        _displayManager->drawPixel(32 + dx, 32 + dy, r, g, b);
+                    }
+                }
+            }
+        }
+        uint32_t pixelUs = (micros() - start) / iterations;
+
+        // Sprite compilati a run (la prima chiamata compila e mette in cache)
+        renderer.drawSprite(MARIO_IDLE, 23, 40, MARIO_IDLE_SIZE[0], MARIO_IDLE_SIZE[1]);
+        renderer.drawSpriteFlipped(MARIO_JUMP, 8, 30, MARIO_JUMP_SIZE[0], MARIO_JUMP_SIZE[1], true);
+        renderer.drawSprite(BLOCK, 8, 8, BLOCK_SIZE[0], BLOCK_SIZE[1]);
+
+        start = micros();
+        for (int i = 0; i < iterations; i++) {
+            renderer.drawSprite(MARIO_IDLE, 23, 40, MARIO_IDLE_SIZE[0], MARIO_IDLE_SIZE[1]);
+            renderer.drawSpriteFlipped(MARIO_JUMP, 8, 30, MARIO_JUMP_SIZE[0], MARIO_JUMP_SIZE[1], true);
+            renderer.drawSprite(BLOCK, 8, 8, BLOCK_SIZE[0], BLOCK_SIZE[1]);
+            renderer.blit(pacman, 32, 32);
+        }
+        uint32_t runsUs = (micros() - start) / iterations;
+
+        // Ripristino: il flush non invia nulla se il pannello era allineato
+        _displayManager->blitRect(0, 0, w, h, saved, w);
+        _displayManager->endFrame();
+        free(saved);
+
+        DEBUG_PRINTF("[Bench] Sprites x%d: pixel=%lu us, runs=%lu us\n",
+                     iterations, (unsigned long)pixelUs, (unsigned long)runsUs);
+
+        return "BENCH,sprites," + String(iterations) + "," + String(pixelUs) + "," + String(runsUs);
+    }
+
+    // bench,kernels[,ITER]
+    if (subCmd == "kernels") {
+        int iterations = parts.size() >= 3 ? parts[2].toInt() : 50;
+        if (iterations < 1 || iterations > 1000) {
+            return "ERR,iterations must be 1-1000";
+        }
+
+        // Buffer di prova propri: il framebuffer non viene toccato
+        PixelKernels::BenchResult result;
+        if (!PixelKernels::benchmark(_displayManager->getCanvasWidth(), _displayManager->getCanvasHeight(),
+                                     iterations, result)) {
+            return "ERR,out of memory";
+        }
+
+        static const char* names[5] = { "fill", "fade", "blend", "addsat", "scale" };
+        String response = "BENCH,kernels," + String(iterations) + "," + String(result.errors);
+        for (int i = 0; i < 5; i++) {
+            response += "," + String(result.refUs[i]) + "," + String(result.swarUs[i]);
+            DEBUG_PRINTF("[Bench] Kernel %-6s: scalar=%lu us, swar=%lu us\n", names[i],
+                         (unsigned long)result.refUs[i], (unsigned long)result.swarUs[i]);
+        }
+        DEBUG_PRINTF("[Bench] Kernel self test: %lu errors\n", (unsigned long)result.errors);
+        return response;
+    }
+
+    return "ERR,Unknown bench subcommand: " + subCmd;
+}
+
+// ═══════════════════════════════════════════
+// Render Task Handler
+// ═══════════════════════════════════════════
+
+String CommandHandler::handleRender(const ParsedCommand& parts) {
+    if (!_renderTask || !_renderTask->isRunning()) {
+        return "ERR,render task not running";
+    }
+
+    if (parts.size() < 2) {
+        return "ERR,Render command requires subcommand";
+    }
+
+    String subCmd = parts[1];
+    subCmd.toLowerCase();
+
+    // render,stats
+    if (subCmd == "stats") {
+        String response = "RENDER";
+        response += "," + String(_renderTask->getCore());
+        response += "," + String(_renderTask->getFrameMs());
+        response += "," + String(_renderTask->getFrames());
+        response += "," + String(_renderTask->getAvgPeriodUs());
+        response += "," + String(_renderTask->getAvgJitterUs());
+        response += "," + String(_renderTask->getMaxJitterUs());
+        response += "," + String(_renderTask->getMaxWorkUs());
+        response += "," + String(_renderTask->getLateFrames());
+        response += "," + String(_netQueue.size() + _localQueue.size());
+        response += "," + String(_netQueue.getDropped() + _localQueue.getDropped());
+        response += "," + String(_netQueue.getHighWater());
+        return response;
+    }
+
+    // render,period,MS
+    if (subCmd == "period") {
+        if (parts.size() < 3) {
+            return "OK,render,period," + String(_renderTask->getFrameMs());
+        }
+        int ms = parts[2].toInt();
+        if (ms < 1 || ms > 1000) {
+            return "ERR,period must be 1-1000 ms";
+        }
+        _renderTask->setFrameMs(ms);
+        if (_effectManager) {
+            _effectManager->setFramePeriod(ms);
+        }
+        return "OK,render,period," + String(ms);
+    }
+
+    // render,reset
+    if (subCmd == "reset") {
+        _renderTask->resetStats();
+        return "OK,render,reset";
+    }
+
+    return "ERR,Unknown render subcommand: " + subCmd;
+}
+
+// ═══════════════════════════════════════════
+// Perf Handler
+// ═══════════════════════════════════════════
+
+String CommandHandler::handlePerf(const ParsedCommand& parts) {
+    if (!_effectManager) {
+        return "ERR,effect manager not available";
+    }
+
+    String subCmd = parts.size() >= 2 ? parts[1] : "";
+    subCmd.toLowerCase();
+
+    // perf,reset[,INDEX]
+    if (subCmd == "reset") {
+        if (parts.size() >= 3) {
+            Effect* effect = _effectManager->getEffect(parts[2].toInt());
+            if (!effect) {
+                return "ERR,invalid effect index";
+            }
+            effect->getProfile().reset();
+            return "OK,perf,reset," + parts[2];
+        }
+        for (int i = 0; i < _effectManager->getEffectCount(); i++) {
+            _effectManager->getEffect(i)->getProfile().reset();
+        }
+        return "OK,perf,reset";
+    }
+
+    // perf[,INDEX]
+    int index = subCmd.isEmpty() ? _effectManager->getCurrentEffectIndex() : subCmd.toInt();
+    Effect* effect = _effectManager->getEffect(index);
+    if (!effect) {
+        return "ERR,invalid effect index";
+    }
+
+    EffectProfile& profile = effect->getProfile();
+    String response = "PERF";
+    response += "," + String(index);
+    response += "," + String(effect->getName());
+    response += "," + String(profile.update.getCount());
+    response += "," + profile.update.toCsv();
+    response += "," + profile.draw.toCsv();
+    response += "," + profile.flush.toCsv();
+    return response;
+}
@@ -10,6 +10,7 @@
 #include "WiFiManager.h"
 #include "ImageManager.h"
 #include "TextScheduleManager.h"
+#include "CommandQueue.h"
 #include "Debug.h"
 
 // Struttura per parsing comandi senza allocazioni dinamiche
@@ -35,11 +36,27 @@ struct ParsedCommand {
 };
 
 
+// Effetto che prende lo schermo (stream, realtime): stato da ripristinare
+struct DisplayTakeover {
+    bool active;
+    int prevEffect;
+    bool prevAutoSwitch;
+
+    DisplayTakeover() : active(false), prevEffect(-1), prevAutoSwitch(false) {}
+};
+
 // Forward declaration
 class WebSocketManager;
+class RenderTask;
 class ScrollTextEffect;
 class PongEffect;
 class SnakeEffect;
+class StreamEffect;
+class RealtimeEffect;
+class RealtimeReceiver;
+class AnimationEffect;
+class DynamicImageEffect;
+class ImageUploader;
 
 /**
  * CommandHandler - Gestione comandi con protocollo CSV
@@ -65,6 +82,7 @@ class SnakeEffect;
  *   nighttime,START,END            - Orari notte (0-23)
  *   duration,MS                    - Durata effetti in ms
  *   autoswitch,0|1                 - Auto-switch on/off
+ *   transition[,fade|wipe|none[,MS]] - Transizione tra effetti (MS 50-5000)
  *   wifi,SSID,PASSWORD,AP_MODE     - Configura WiFi (AP_MODE: 0=STA, 1=AP)
  *   devicename,NAME                - Nome dispositivo
  *   scrolltext,TEXT[,COLOR]        - Imposta testo scorrevole (COLOR opzionale RGB565)
@@ -85,6 +103,15 @@ class SnakeEffect;
  *   snake,resume                   - Riprendi partita
  *   snake,reset                    - Reset partita
  *   snake,state                    - Richiedi stato gioco
+ *   stream,start[,JITTER_MS]       - Apre lo stream binario e mostra l'effetto Stream (auto-switch sospeso; frame solo da questo client)
+ *   stream,stop                    - Chiude lo stream e torna all'effetto precedente
+ *   stream,jitter,MS               - Ritardo del jitter buffer (0-500 ms)
+ *   stream,stats                   - Statistiche stream (latenza, frame scartati/persi)
+ *   stream,reset                   - Azzera le statistiche stream
+ *   realtime                       - Stato ricevitore UDP DDP (4048) / E1.31 (5568) / Art-Net (6454)
+ *   realtime,enable|disable        - Apre/chiude le porte UDP (save per salvare)
+ *   realtime,map,UNIVERSE[,PIXELS] - Primo universo E1.31/Art-Net e pixel per universo (1-170)
+ *   realtime,reset                 - Azzera le statistiche realtime
  *   ntp,enable                     - Abilita NTP sync
  *   ntp,disable                    - Disabilita NTP sync
  *   ntp,sync                       - Forza sync NTP ora
@@ -96,19 +123,71 @@ class SnakeEffect;
  *   ota,end,MD5                    - Finalizza OTA con verifica MD5
  *   ota,abort                      - Annulla OTA in corso
  *   image,upload,NAME,BASE64       - Upload immagine (nome + RGB565 base64)
+ *   image,begin,NAME,SIZE,CRC32    - Upload binario riprendibile (CRC32 in hex, .img, .qim o PNG; chunk solo da questo client)
+ *   image,commit[,RESIZE]          - Verifica CRC e salva l'immagine (PNG: RESIZE 0 = solo 64x64)
+ *   image,abort                    - Annulla upload binario (scarta il file temporaneo)
+ *   image,upstats                  - Throughput e heap dell'ultimo upload
  *   image,list                     - Lista immagini salvate
+ *   image,list,OFFSET[,COUNT]      - Pagina della lista (max 32 per risposta)
  *   image,delete,NAME              - Elimina immagine
  *   image,info                     - Info storage immagini
+ *   image,stats                    - Compressione e tempo di caricamento immagini
+ *   image,compact                  - Ricomprime le immagini .img raw in .qim
+ *   image,reindex                  - Ricostruisce il manifest scansionando /images
+ *   image,cache                    - Stato cache LRU e prefetch dello slideshow
  *   image,show,NAME                - Mostra immagine specifica
  *   image,next                     - Prossima immagine nello slideshow
  *   image,prev                     - Immagine precedente nello slideshow
  *   image,slideshow,0|1            - Abilita/disabilita slideshow automatico
+ *   anim,start,NAME,SIZE           - Inizia upload animazione .anm (SIZE in bytes)
+ *   anim,data,CHUNK_NUM,BASE64     - Chunk animazione (max 4 KB decodificati)
+ *   anim,end                       - Verifica l'header e salva l'animazione
+ *   anim,abort                     - Annulla upload animazione
+ *   anim,play,NAME                 - Mostra animazione (effetto Animation)
+ *   anim,stop                      - Ferma l'animazione (l'auto-switch prosegue)
+ *   anim,list                      - Lista animazioni salvate
+ *   anim,delete,NAME               - Elimina animazione
+ *   anim,stats                     - Statistiche riproduzione (FPS, lettura flash)
  *   schedtext,list                 - Lista scritte programmate
  *   schedtext,add,TEXT,COLOR,HH,MM[,REPEATDAYS,YEAR,MONTH,DAY,LOOPCOUNT] - Aggiungi scritta programmata
  *   schedtext,update,ID,TEXT,COLOR,HH,MM[,REPEATDAYS,YEAR,MONTH,DAY,LOOPCOUNT] - Aggiorna scritta programmata
  *   schedtext,delete,ID            - Elimina scritta programmata
  *   schedtext,enable,ID            - Abilita scritta programmata
  *   schedtext,disable,ID           - Disabilita scritta programmata
+ *   display,flush,pixel|runs       - Modalità flush framebuffer (per pixel / run orizzontali)
+ *   display,bench[,FRAMES]         - Benchmark flush completo nelle due modalità
+ *   display,info                   - Info display (risoluzione, RAM DMA e buffer)
+ *   display,glyphs                 - Statistiche cache glifi GFX
+ *   display,palette                - Formato framebuffer e uso della palette
+ *   display,color[,GAMMA[,R,G,B]]  - Pipeline colore: gamma 1.0-3.0 e bianco per canale 0-255 (save per salvare)
+ *   display,dither[,off|on|night]  - Dithering temporale a luminosità bassa (default night = fascia notturna)
+ *   display,doublebuffer,0|1       - Double buffering DMA (salvato, attivo dopo riavvio)
+ *   bench,sprites[,ITER]           - Benchmark sprite Mario/PacMan (per pixel vs run compilati)
+ *   bench,kernels[,ITER]           - Self test + benchmark kernel RGB565 (scalare vs 2 pixel/word)
+ *   render,stats                   - Statistiche task di render (jitter frame, code comandi)
+ *   render,period[,MS]             - Periodo frame del task di render (1-1000 ms)
+ *   render,reset                   - Azzera le statistiche di render
+ *   perf[,INDEX]                   - Profilo tempi effetto (corrente o INDEX)
+ *   perf,reset[,INDEX]             - Azzera i profili (tutti o solo INDEX)
+ *
+ * Esecuzione: con il task di render attivo i comandi WebSocket/HTTP/seriale
+ * sono accodati (SPSC lock-free) ed eseguiti dal task di render tra un frame
+ * e l'altro; le risposte WS partono verso il client che ha inviato il comando.
+ * Coda piena → ERR,busy. wifiscan resta sul task di rete (scan bloccante).
+ *
+ * Anteprima (solo WebSocket, gestita da WebSocketManager sul task di rete):
+ *   preview,FPS                    - Ricevi il framebuffer come messaggi binari (1-30 fps, max 2 client)
+ *   preview,off                    - Ferma l'anteprima (automatico alla disconnessione)
+ *   preview,stats                  - Statistiche anteprima
+ * Messaggi binari: header 8 byte (tipo 1=keyframe/2=delta, 0, w, h, seq; u16 LE),
+ * keyframe = pixel RGB565 LE, delta = blocchi (skip u16, count u16, count × XOR u16)
+ * contro l'ultimo frame inviato al client. Snapshot singolo: HTTP GET /api/frame
+ * (RGB565 LE, header X-Frame-Width/X-Frame-Height).
+ *
+ * Stream (App → ESP32, messaggi binari WebSocket dopo stream,start):
+ *   header 12 byte u16 LE: tipo 0x10 + flag (u8, bit 0 = fine frame), seq, x, y, w, h;
+ *   poi w*h pixel RGB565 LE. Un frame = uno o più rettangoli con lo stesso seq,
+ *   composti sopra il frame precedente. Un solo client alla volta.
  *
  * Risposte (ESP32 → App):
  *   OK,comando                     - Comando eseguito
@@ -125,6 +204,34 @@ class SnakeEffect;
  *   TIME,HH:MM:SS                  - Notifica cambio ora
  *   PONG_STATE,state,score1,score2,p1Mode,p2Mode,ballX,ballY - Stato gioco Pong
  *   SNAKE_STATE,state,score,highScore,level,length,foodX,foodY,foodType,direction,playerJoined - Stato gioco Snake
+ *   BENCH,flush,frames,pixelUs,runsUs - µs medi per flush completo (per pixel / run)
+ *   DISPLAY,width,height,doubleBuffer,dmaBytes,bufferBytes,flushMode,panelsX,panelsY,layout,pixelFormat - Info display (canvas virtuale)
+ *   GLYPHS,hits,misses,used,slots,bytes - Cache glifi (contatori azzerati dalle stats periodiche)
+ *   COLOR,gamma,whiteR,whiteG,whiteB - Pipeline colore al flush (gamma con due decimali)
+ *   DITHER,mode,enabled,bits,passes,avgUs,maxUs,avgPixels - Dithering (bits = bit simulati, costo per passaggio)
+ *   STREAM_READY,width,height,jitterMs - Stream aperto
+ *   STREAM_END,reason              - Stream chiuso (idle = nessun frame per 10 s)
+ *   STREAM,open,received,shown,dropped,lost,errors,avgLatencyUs,maxLatencyUs,jitterMs,queued - Stats stream (latenza = frame decodificato → a schermo)
+ *   REALTIME,enabled,active,protocol,sourceIp,priority,packets,frames,ignored,errors,syncs,universe,universePixels - Ricevitore UDP
+ *   REALTIME_START,protocol,sourceIp / REALTIME_END,timeout - Una sorgente UDP prende / lascia lo schermo
+ *   IMAGE_STATS,images,compressed,rawBytes,storedBytes,ratioPct,lastLoadUs,avgLoadUs - Immagini su flash (ratio = stored/raw)
+ *   UPLOAD_READY,name,offset       - Upload binario pronto (offset > 0 = ripresa)
+ *   UPLOAD_ACK,offset / UPLOAD_NACK,expectedOffset - Chunk binario 0x20 scritto / scartato
+ *   UPLOAD_STATS,mode,bytes,ms,KBps,minFreeHeap,freeHeap,resumed,nacks - Ultimo upload (binary = primo → ultimo chunk, base64 = decodifica + salvataggio)
+ *   IMAGES_PAGE,total,offset,count,name,size,raw|qim,... - Pagina della lista immagini
+ *   IMAGE_CACHE,slots,used,hits,misses,prefetched,lastSwapUs - Cache slideshow (miss = caricamento sincrono)
+ *   ANIM_READY / ANIM_ACK,chunk / ANIM_NACK,expectedChunk - Upload animazione
+ *   ANIMS,count,name1,size1,...    - Lista animazioni
+ *   ANIM_PLAY,name,width,height,frames - Animazione avviata
+ *   ANIM,name,playing,frame,frames,loops,fps,readKBps,bytesRead,underruns,late,windowBytes - Stats animazione (underruns = frame letti da flash senza read-ahead)
+ *   PREVIEW,fps,width,height       - Anteprima attiva (segue un keyframe binario)
+ *   MIRROR,subscribers,frames,bytes,skipped - Stats anteprima (skipped = catture saltate per lock occupato)
+ *   PALETTE,format,used,reserved,approximations - Palette (rgb565|indexed8; approximations = colori fuori palette)
+ *   BENCH,sprites,iter,pixelUs,runsUs - µs medi per set di sprite (Mario idle+jump, blocco, PacMan)
+ *   BENCH,kernels,iter,errors,fillRef,fill,fadeRef,fade,blendRef,blend,addRef,add,scaleRef,scale - µs per frame (errors = discrepanze vs riferimento)
+ *   PERF,index,name,frames,updP50,updP95,updP99,updMax,drawP50,drawP95,drawP99,drawMax,flushP50,flushP95,flushP99,flushMax - µs
+ *   TRANSITION,type,ms,avgUs,maxUs - Transizione corrente e costo compose per frame (ultima transizione)
+ *   RENDER,core,frameMs,frames,avgPeriodUs,avgJitterUs,maxJitterUs,maxWorkUs,late,queued,dropped,highWater - Stats render
  *   SCHEDULED_TEXTS,count,id1,text1,color1,hour1,min1,repeat1,year1,month1,day1,loop1,enabled1,... - Lista scritte programmate
  */
 class CommandHandler {
@@ -136,6 +243,18 @@ public:
     void setScrollTextEffect(ScrollTextEffect* scrollText);
     void setPongEffect(PongEffect* pong);
     void setSnakeEffect(SnakeEffect* snake);
+    void setStreamEffect(StreamEffect* stream);
+    void setRealtime(RealtimeReceiver* receiver, RealtimeEffect* effect);
+    void setAnimationEffect(AnimationEffect* animation);
+    void setDynamicImageEffect(DynamicImageEffect* images);
+    void setImageUploader(ImageUploader* uploader);
+    void setRenderTask(RenderTask* render);
+
+    // Dispatch verso il task di render (inline se il task non è attivo)
+    bool enqueueWsCommand(uint32_t clientId, const String& command);  // false = coda piena
+    String executeBlocking(const String& command);                    // HTTP: attende la risposta
+    void enqueueSerial(const String& line);
+    void processQueuedCommands();                                     // Chiamato dal task di render
     
     // Processa comando e ritorna risposta
     String processCommand(const String& command);
@@ -161,6 +280,12 @@ public:
     void checkOTAWatchdog();              // Chiamare nel loop per monitorare timeout
     static void checkOTABootStatus();     // Chiamare nel setup per verificare boot dopo OTA
 
+    // Stream: chiude la sessione dopo STREAM_IDLE_TIMEOUT_MS senza frame
+    void checkStreamIdle();
+
+    // Realtime: mostra l'effetto Realtime finché c'è una sorgente UDP attiva
+    void checkRealtime();
+
 private:
     TimeManager* _timeManager;
     EffectManager* _effectManager;
@@ -173,6 +298,35 @@ private:
     ScrollTextEffect* _scrollTextEffect;
     PongEffect* _pongEffect;
     SnakeEffect* _snakeEffect;
+    StreamEffect* _streamEffect;
+    RenderTask* _renderTask;
+
+    RealtimeReceiver* _realtimeReceiver;
+    RealtimeEffect* _realtimeEffect;
+    AnimationEffect* _animationEffect;
+    DynamicImageEffect* _dynamicImageEffect;
+    ImageUploader* _imageUploader;
+    int _animExpectedChunk;
+
+    DisplayTakeover _streamTakeover;
+    DisplayTakeover _realtimeTakeover;
+    void beginTakeover(DisplayTakeover& takeover, Effect* effect);
+    void endTakeover(DisplayTakeover& takeover, Effect* effect);
+
+    // Code comandi verso il task di render: una per produttore
+    CommandQueue _netQueue;         // Produttore: AsyncTCP (WebSocket + HTTP)
+    CommandQueue _localQueue;       // Produttore: loopTask (seriale)
+    uint32_t _commandClientId;      // Client WebSocket del comando in esecuzione, 0 = HTTP/seriale
+
+    bool isAsyncDispatch() const;
+    static bool runsOnNetworkTask(const String& command);
+    void executeQueued(QueuedCommand& queued);
+
+    // Attesa massima di executeBlocking() sul task AsyncTCP
+    static constexpr uint32_t CMD_HTTP_TIMEOUT_MS = 3000;
+
+    // Budget per frame per i comandi accodati (almeno uno per frame)
+    static constexpr uint32_t CMD_BUDGET_US = 4000;
     
     // Parser helper
     ParsedCommand splitCommand(const String& cmd, char delimiter = ',');
@@ -186,19 +340,28 @@ private:
     String handleNightTime(const ParsedCommand& parts);
     String handleDuration(const ParsedCommand& parts);
     String handleAutoSwitch(const ParsedCommand& parts);
+    String handleTransition(const ParsedCommand& parts);
     String handleWiFi(const ParsedCommand& parts);
     String handleDeviceName(const ParsedCommand& parts);
     String handleScrollText(const ParsedCommand& parts);
     String handlePong(const ParsedCommand& parts);
     String handleSnake(const ParsedCommand& parts);
+    String handleStream(const ParsedCommand& parts);
+    void stopStream();
+    String handleRealtime(const ParsedCommand& parts);
     String handleNTP(const ParsedCommand& parts);
     String handleTimezone(const ParsedCommand& parts);
     String handleSave();
     String handleRestart();
     String handleOTA(const ParsedCommand& parts);
     String handleImage(const ParsedCommand& parts);
+    String handleAnimation(const ParsedCommand& parts);
     String handleScheduledText(const ParsedCommand& parts);
     String handleWiFiScan();
+    String handleDisplay(const ParsedCommand& parts);
+    String handleBench(const ParsedCommand& parts);
+    String handleRender(const ParsedCommand& parts);
+    String handlePerf(const ParsedCommand& parts);
 
     // OTA state
     bool _otaInProgress;
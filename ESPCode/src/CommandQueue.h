@@ -0,0 +1,99 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <memory>
+
+// Comandi in attesa per coda (un produttore, un consumatore)
+#ifndef CMD_QUEUE_SIZE
+#define CMD_QUEUE_SIZE 16
+#endif
+
+enum CommandSource : uint8_t {
+    CMD_SOURCE_WS,      // Risposta al client WebSocket clientId
+    CMD_SOURCE_HTTP,    // Risposta scritta in reply, poi notifica al waiter
+    CMD_SOURCE_SERIAL   // Risposta stampata su seriale
+};
+
+// Risposta HTTP condivisa tra chi attende e il task di render: vive sullo
+// heap finché uno dei due la referenzia, anche se l'attesa va in timeout
+struct PendingReply {
+    String response;
+    TaskHandle_t waiter;
+    bool done;                      // Scritto dal render sotto mux
+    bool abandoned;                 // Scritto dal waiter sotto mux (timeout)
+    portMUX_TYPE mux;
+
+    PendingReply() : waiter(nullptr), done(false), abandoned(false), mux(portMUX_INITIALIZER_UNLOCKED) {}
+};
+
+struct QueuedCommand {
+    String command;
+    CommandSource source;
+    uint32_t clientId;
+    std::shared_ptr<PendingReply> reply;
+
+    QueuedCommand() : source(CMD_SOURCE_SERIAL), clientId(0) {}
+};
+
+/**
+ * Ring buffer lock-free single-producer / single-consumer.
+ * push() va chiamato da un solo task (es. AsyncTCP), pop() da un solo
+ * altro task (render). Head e tail sono scritti ciascuno da un solo lato:
+ * bastano load/store acquire-release, nessun mutex.
+ */
+class CommandQueue {
+private:
+    QueuedCommand slots[CMD_QUEUE_SIZE];
+    std::atomic<uint16_t> head;     // Scritto solo dal produttore
+    std::atomic<uint16_t> tail;     // Scritto solo dal consumatore
+    uint32_t dropped;               // Comandi rifiutati a coda piena (lato produttore)
+    uint16_t highWater;
+
+public:
+    CommandQueue() : head(0), tail(0), dropped(0), highWater(0) {}
+
+    // Produttore: false se la coda è piena (il comando non viene accodato)
+    bool push(QueuedCommand& cmd) {
+        uint16_t h = head.load(std::memory_order_relaxed);
+        uint16_t next = (h + 1) % CMD_QUEUE_SIZE;
+        uint16_t t = tail.load(std::memory_order_acquire);
+        if (next == t) {
+            dropped++;
+            return false;
+        }
+
+        slots[h] = std::move(cmd);
+        head.store(next, std::memory_order_release);
+
+        uint16_t depth = (next + CMD_QUEUE_SIZE - t) % CMD_QUEUE_SIZE;
+        if (depth > highWater) highWater = depth;
+        return true;
+    }
+
+    // Consumatore: false se la coda è vuota
+    bool pop(QueuedCommand& out) {
+        uint16_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        out = std::move(slots[t]);
+        slots[t].command = String();    // Libera subito la memoria del comando
+        slots[t].reply.reset();
+        tail.store((t + 1) % CMD_QUEUE_SIZE, std::memory_order_release);
+        return true;
+    }
+
+    uint16_t size() const {
+        uint16_t h = head.load(std::memory_order_acquire);
+        uint16_t t = tail.load(std::memory_order_acquire);
+        return (h + CMD_QUEUE_SIZE - t) % CMD_QUEUE_SIZE;
+    }
+
+    uint32_t getDropped() const { return dropped; }
+    uint16_t getHighWater() const { return highWater; }
+};
+
+#endif // COMMAND_QUEUE_H
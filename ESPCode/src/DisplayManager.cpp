@@ -1,46 +1,273 @@
 #include "DisplayManager.h"
+#include <glcdfont.c>   // Font 5x7 classico di Adafruit GFX (font[] in PROGMEM)
 
 DisplayManager::DisplayManager(uint16_t panelWidth, uint16_t panelHeight,
-                               uint8_t panelsNumber, uint8_t pinE)
-    : width(panelWidth * panelsNumber), height(panelHeight), brightness(200),
-      frameBuffer(nullptr), bufferingEnabled(false),
+                               uint8_t panelsNumber, uint8_t pinE, bool doubleBuffer,
+                               uint8_t panelRows, ChainLayout layout)
+    : display(nullptr), brightness(200),
+      ditherEnabled(false), ditherPhase(0), ditherPasses(0),
+      ditherUsTotal(0), ditherUsMax(0), ditherPixelsTotal(0),
+      panelW(panelWidth), panelH(panelHeight), chainLayout(layout),
+      pixelFormat(PIXEL_RGB565), bufferingEnabled(false),
+      dirtyMinX(nullptr), dirtyMaxX(nullptr),
+      lastFlushPixels(0), flushCount(0), flushPixelsTotal(0), flushUs(0),
+      flushMode(FLUSH_RUNS), offscreen(false),
+      doubleBuffered(doubleBuffer), backIndex(0), frameDirty(false),
+      prevDirtyMinX(nullptr), prevDirtyMaxX(nullptr), dmaBytes(0),
       bufCursorX(0), bufCursorY(0), currentFont(nullptr),
-      currentTextColor(0xFFFF), currentTextSize(1) {
+      currentTextColor(0xFFFF), currentTextSize(1), textWrap(true) {
+
+    // Canvas virtuale: panelsNumber pannelli in panelRows righe
+    if (panelRows == 0 || panelsNumber % panelRows != 0) {
+        DEBUG_PRINTF("[Display] %u panels can't form %u rows, using a single row\n",
+                     panelsNumber, panelRows);
+        panelRows = 1;
+    }
+    this->panelRows = panelRows;
+    panelCols = panelsNumber / panelRows;
+    width = panelWidth * panelCols;
+    height = panelHeight * panelRows;
+    identityMap = (panelRows == 1);
+    resetViewport();
 
     HUB75_I2S_CFG mxconfig;
+    mxconfig.mx_width = panelWidth;
     mxconfig.mx_height = panelHeight;
     mxconfig.chain_length = panelsNumber;
     mxconfig.gpio.e = pinE;
     mxconfig.clkphase = false;
     mxconfig.latch_blanking = 4;
+    mxconfig.double_buff = doubleBuffer;
 
     display = new MatrixPanel_I2S_DMA(mxconfig);
 
-    // Allocate framebuffer (RGB565, ~8KB for 64x64)
-    frameBuffer = new uint16_t[width * height];
+    // Allocate framebuffer (RGB565, ~8KB for 64x64; l'indicizzato la metà)
+    frame565.setPalette(&palette);
+    frame8.setPalette(&palette);
+    frame565.allocate((size_t)width * height);
+
+    // Shadow di ogni buffer DMA + span sporchi per riga (~8KB per buffer + 4 byte/riga)
+    int buffers = doubleBuffered ? 2 : 1;
+    shadowBuffers[1] = nullptr;
+    for (int i = 0; i < buffers; i++) {
+        shadowBuffers[i] = new uint16_t[width * height];
+        memset(shadowBuffers[i], 0, width * height * sizeof(uint16_t));
+    }
+    shadowValid[0] = shadowValid[1] = false;
+    dirtyMinX = new int16_t[height];
+    dirtyMaxX = new int16_t[height];
+
+    if (doubleBuffered) {
+        prevDirtyMinX = new int16_t[height];
+        prevDirtyMaxX = new int16_t[height];
+        for (int y = 0; y < height; y++) {
+            prevDirtyMinX[y] = width;
+            prevDirtyMaxX[y] = -1;
+        }
+    }
+
+    clearDirty();
 }
 
 DisplayManager::~DisplayManager() {
-    delete[] frameBuffer;
+    delete[] shadowBuffers[0];
+    delete[] shadowBuffers[1];
+    delete[] dirtyMinX;
+    delete[] dirtyMaxX;
+    delete[] prevDirtyMinX;
+    delete[] prevDirtyMaxX;
     if (display) {
         delete display;
     }
 }
 
 bool DisplayManager::begin() {
+    uint32_t heapBefore = ESP.getFreeHeap();
     if (!display->begin()) {
         DEBUG_PRINTLN("ERROR: I2S memory allocation failed");
         return false;
     }
+    dmaBytes = heapBefore - ESP.getFreeHeap();
+
+    DEBUG_PRINTF("[Display] %dx%d (%ux%u panels, %s) | DMA: %lu bytes | buffers: %lu bytes | double buffer: %s\n",
+                 width, height, panelCols, panelRows, layoutName(chainLayout),
+                 (unsigned long)dmaBytes, (unsigned long)getBufferBytes(),
+                 doubleBuffered ? "ON" : "OFF");
+
     display->setBrightness8(brightness);
     return true;
 }
 
+uint32_t DisplayManager::getBufferBytes() const {
+    size_t pixels = (size_t)width * height;
+    uint32_t shadowBytes = FrameBuffer<uint16_t>::bytesFor(pixels) * (doubleBuffered ? 2 : 1);
+    uint32_t frameBytes = isIndexed() ? FrameBuffer<uint8_t>::bytesFor(pixels) + sizeof(Palette)
+                                      : FrameBuffer<uint16_t>::bytesFor(pixels);
+    return frameBytes + shadowBytes;
+}
+
+// ═══════════════════════════════════════════
+// Formato pixel e palette
+// ═══════════════════════════════════════════
+
+bool DisplayManager::setPixelFormat(PixelFormat format) {
+    size_t pixels = (size_t)width * height;
+    if (format == pixelFormat) {
+        palette.reset();
+        // Indici del frame precedente senza significato nella palette nuova
+        if (isIndexed()) frame8.fill(0, pixels, 0x0000);
+        return true;
+    }
+
+    // Nuovo buffer prima di liberare il vecchio: se manca RAM nulla cambia
+    bool ok = (format == PIXEL_INDEXED8) ? frame8.allocate(pixels) : frame565.allocate(pixels);
+    if (!ok) {
+        DEBUG_PRINTF("[Display] Not enough RAM for %s framebuffer, keeping %s\n",
+                     formatName(format), formatName(pixelFormat));
+        return false;
+    }
+
+    if (format == PIXEL_INDEXED8) {
+        frame565.release();
+    } else {
+        frame8.release();
+    }
+    palette.reset();
+    pixelFormat = format;
+
+    DEBUG_PRINTF("[Display] Framebuffer %s: %lu bytes\n", formatName(format),
+                 (unsigned long)(format == PIXEL_INDEXED8 ? FrameBuffer<uint8_t>::bytesFor(pixels)
+                                                          : FrameBuffer<uint16_t>::bytesFor(pixels)));
+    return true;
+}
+
+const char* DisplayManager::formatName(PixelFormat format) {
+    return format == PIXEL_INDEXED8 ? "indexed8" : "rgb565";
+}
+
+void DisplayManager::setPaletteColor(uint8_t index, uint16_t color565) {
+    if (palette.color(index) == color565) return;
+    palette.set(index, color565);
+    if (isIndexed()) screenChanged();
+}
+
+void DisplayManager::cyclePalette(uint8_t first, uint8_t count, int8_t step) {
+    palette.rotate(first, count, step);
+    if (isIndexed()) screenChanged();
+}
+
+void DisplayManager::drawPixelIndex(int16_t x, int16_t y, uint8_t index) {
+    if (x < 0 || x >= vpW || y < 0 || y >= vpH) return;
+    x += vpX;
+    y += vpY;
+
+    size_t i = (size_t)y * width + x;
+    if (isIndexed()) {
+        frame8.setRaw(i, index);
+    } else {
+        frame565.setRaw(i, palette.color(index));
+    }
+
+    if (isBuffered()) {
+        markDirty(x, y);
+    } else if (display) {
+        writePixelThrough(x, y);
+    }
+}
+
+// Write-through di un pixel: shadow e pannello ricevono il colore memorizzato
+// (nel formato indicizzato può essere l'approssimazione della palette),
+// passato dalla pipeline colore come nel flush
+void DisplayManager::writePixelThrough(int16_t x, int16_t y) {
+    uint16_t c = framePixel((size_t)y * width + x);
+    shadowBuffers[0][y * width + x] = c;
+    uint8_t r, g, b;
+    outputColor(c, x, y, r, g, b);
+    panelPixel(x, y, r, g, b);
+}
+
+void DisplayManager::copyFrame(uint16_t* dst) const {
+    if (!dst) return;
+    size_t pixels = (size_t)width * height;
+    if (isIndexed()) {
+        frame8.read(0, dst, pixels);
+    } else {
+        frame565.read(0, dst, pixels);
+    }
+}
+
+void DisplayManager::setColorCorrection(uint16_t gamma100, uint8_t whiteR, uint8_t whiteG, uint8_t whiteB) {
+    colorCorrection.build(gamma100, whiteR, whiteG, whiteB);
+
+    // Il shadow contiene i colori prima della correzione: non dice più
+    // cosa c'è sul pannello, tutto il frame va reinviato
+    invalidate();
+    screenChanged();
+}
+
 void DisplayManager::setBrightness(uint8_t level) {
     brightness = level;
     if (display) {
         display->setBrightness8(level);
     }
+    updateDitherBits();
+}
+
+// ═══════════════════════════════════════════
+// Dithering temporale
+// ═══════════════════════════════════════════
+
+void DisplayManager::setDithering(bool enabled) {
+    if (enabled == ditherEnabled) return;
+    ditherEnabled = enabled;
+    resetDitherStats();
+    updateDitherBits();
+}
+
+// Sotto 128 ogni dimezzamento della luminosità azzera un altro bit-plane
+// nel driver; PIXEL_COLOR_DEPTH_BITS < 8 toglie bit in partenza
+void DisplayManager::updateDitherBits() {
+    uint8_t bits = 0;
+    for (uint16_t level = 128; level > 1 && brightness < level; level >>= 1) {
+        bits++;
+    }
+#if defined(PIXEL_COLOR_DEPTH_BITS) && PIXEL_COLOR_DEPTH_BITS < 8
+    bits += 8 - PIXEL_COLOR_DEPTH_BITS;
+#endif
+    if (!ditherEnabled) bits = 0;
+
+    uint8_t previous = colorCorrection.getDitherBits();
+    colorCorrection.setDitherBits(bits);
+    if (colorCorrection.getDitherBits() != previous) {
+        DEBUG_PRINTF("[Display] Dithering: %u bits (brightness %u)\n",
+                     colorCorrection.getDitherBits(), brightness);
+        // I pixel mostrati col vecchio livello vanno reinviati tutti
+        invalidate();
+        if (display) screenChanged();
+    }
+}
+
+// Nuova fase a ogni frame: i pixel con bit persi vanno reinviati anche se
+// il framebuffer non è cambiato. In double buffering il passaggio avviene
+// nel present() che segue, con tutto il frame sporco
+void DisplayManager::ditherFrame() {
+    if (!isDithering()) return;
+    ditherPhase = (ditherPhase + 7) & 15;   // 7 e 16 coprimi: ogni pixel passa tutte le fasi
+    if (!display || offscreen) return;
+
+    markAllDirty();
+    if (!doubleBuffered) {
+        uint32_t start = micros();
+        flushFront();
+        recordDither(micros() - start, lastFlushPixels);
+    }
+}
+
+void DisplayManager::recordDither(uint32_t us, uint32_t pixels) {
+    ditherPasses++;
+    ditherUsTotal += us;
+    ditherPixelsTotal += pixels;
+    if (us > ditherUsMax) ditherUsMax = us;
 }
 
 // ═══════════════════════════════════════════
@@ -52,23 +279,319 @@ void DisplayManager::beginFrame() {
 }
 
 void DisplayManager::endFrame() {
-    if (!bufferingEnabled || !display) {
+    // In double buffering (e durante una transizione) il flush avviene in present()
+    if (!bufferingEnabled || !display || doubleBuffered || offscreen) {
         bufferingEnabled = false;
         return;
     }
 
-    // Flush entire buffer to display in one pass
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            uint16_t c = frameBuffer[y * width + x];
-            uint8_t r = (c >> 11) << 3;
-            uint8_t g = ((c >> 5) & 0x3F) << 2;
-            uint8_t b = (c & 0x1F) << 3;
-            display->drawPixelRGB888(x, y, r, g, b);
+    flushFront();
+    bufferingEnabled = false;
+}
+
+// Flush del framebuffer sul pannello (buffer DMA singolo)
+void DisplayManager::flushFront() {
+    // Se il pannello è stato modificato fuori dal buffer, il shadow non è
+    // affidabile: riallinea tutto in un solo passaggio
+    uint32_t start = micros();
+    bool force = !shadowValid[0];
+    if (force) {
+        markAllDirty();
+    }
+
+    uint32_t pushed = flushDirty(flushMode, force);
+    flushUs += micros() - start;
+
+    clearDirty();
+    shadowValid[0] = true;
+    lastFlushPixels = pushed;
+    flushPixelsTotal += pushed;
+    flushCount++;
+}
+
+void DisplayManager::setOffscreen(bool enabled) {
+    offscreen = enabled;
+}
+
+void DisplayManager::presentComposite(const uint16_t* composite) {
+    if (!display || !composite) return;
+
+    // Il composito sostituisce il framebuffer solo per il flush: il contenuto
+    // dell'effetto entrante resta intatto. Cambia ovunque, quindi tutto il
+    // frame è sporco; il confronto col shadow scarta i pixel invariati
+    PixelFormat format = pixelFormat;
+    uint16_t* own = frame565.attach(const_cast<uint16_t*>(composite));
+    pixelFormat = PIXEL_RGB565;
+    markAllDirty();
+
+    if (doubleBuffered) {
+        present();
+    } else {
+        flushFront();
+    }
+
+    frame565.attach(own);
+    pixelFormat = format;
+}
+
+void DisplayManager::present() {
+    if (!doubleBuffered || !display) return;
+
+    bool force = !shadowValid[backIndex];
+    if (!frameDirty && !force) return;  // Nulla da mostrare: niente flip
+
+    uint32_t start = micros();
+
+    // Il back buffer ha l'ultimo contenuto di due frame fa: aggiorna l'unione
+    // degli span sporchi di questo frame e del precedente
+    for (int16_t y = 0; y < height; y++) {
+        int16_t x0 = dirtyMinX[y];
+        int16_t x1 = dirtyMaxX[y];
+        if (prevDirtyMinX[y] < dirtyMinX[y]) dirtyMinX[y] = prevDirtyMinX[y];
+        if (prevDirtyMaxX[y] > dirtyMaxX[y]) dirtyMaxX[y] = prevDirtyMaxX[y];
+        prevDirtyMinX[y] = x0;
+        prevDirtyMaxX[y] = x1;
+    }
+    if (force) {
+        markAllDirty();
+    }
+
+    uint32_t pushed = flushDirty(flushMode, force);
+
+    display->flipDMABuffer();
+    shadowValid[backIndex] = true;
+    backIndex ^= 1;
+    uint32_t elapsed = micros() - start;
+    flushUs += elapsed;
+    if (isDithering()) recordDither(elapsed, pushed);
+
+    clearDirty();
+    lastFlushPixels = pushed;
+    flushPixelsTotal += pushed;
+    flushCount++;
+}
+
+// Flush solo degli span sporchi, e solo dei pixel realmente cambiati
+// (force = ignora il shadow e invia tutto lo span)
+uint32_t DisplayManager::flushDirty(FlushMode mode, bool force) {
+    uint32_t pushed = 0;
+    for (int16_t y = 0; y < height; y++) {
+        int16_t x0 = dirtyMinX[y];
+        int16_t x1 = dirtyMaxX[y];
+        if (x0 > x1) continue;
+
+        pushed += flushRow(mode, y, x0, x1, force);
+    }
+    return pushed;
+}
+
+uint32_t DisplayManager::flushRow(FlushMode mode, int16_t y, int16_t x0, int16_t x1, bool force) {
+    if (isIndexed()) {
+        return mode == FLUSH_RUNS ? flushRowRuns(frame8, y, x0, x1, force)
+                                  : flushRowPixels(frame8, y, x0, x1, force);
+    }
+    return mode == FLUSH_RUNS ? flushRowRuns(frame565, y, x0, x1, force)
+                              : flushRowPixels(frame565, y, x0, x1, force);
+}
+
+// Il confronto col shadow avviene in RGB565: nel formato indicizzato
+// un cambio di palette raggiunge il pannello senza ridisegnare i pixel
+template <typename Pixel>
+uint32_t DisplayManager::flushRowPixels(const FrameBuffer<Pixel>& frame, int16_t y, int16_t x0, int16_t x1, bool force) {
+    const Pixel* src = frame.data() + y * width;
+    uint16_t* shadow = &shadowBuffers[backIndex][y * width];
+    uint32_t pushed = 0;
+
+    bool dithering = isDithering();
+    for (int16_t x = x0; x <= x1; x++) {
+        uint16_t c = frame.toColor(src[x]);
+        bool dithered = dithering && colorCorrection.isDithered(c);
+        if (!force && c == shadow[x] && !dithered) continue;
+        shadow[x] = c;
+        uint8_t r, g, b;
+        outputColor(c, x, y, r, g, b);
+        panelPixel(x, y, r, g, b);
+        pushed++;
+    }
+    return pushed;
+}
+
+template <typename Pixel>
+uint32_t DisplayManager::flushRowRuns(const FrameBuffer<Pixel>& frame, int16_t y, int16_t x0, int16_t x1, bool force) {
+    const Pixel* src = frame.data() + y * width;
+    uint16_t* shadow = &shadowBuffers[backIndex][y * width];
+    uint32_t pushed = 0;
+
+    bool dithering = isDithering();
+    int16_t x = x0;
+    while (x <= x1) {
+        Pixel p = src[x];
+        uint16_t c = frame.toColor(p);
+        bool dithered = dithering && colorCorrection.isDithered(c);
+        if (!force && c == shadow[x] && !dithered) {
+            x++;
+            continue;
+        }
+
+        // Il run parte da un pixel cambiato e si estende finché il colore
+        // resta uguale: il driver calcola i bit-plane una volta sola per run
+        int16_t start = x;
+        while (x <= x1 && src[x] == p) {
+            shadow[x] = c;
+            x++;
+        }
+        int16_t len = x - start;
+
+        uint8_t r, g, b;
+        if (dithered) {
+            // Soglia diversa per ogni pixel: niente run
+            for (int16_t i = start; i < x; i++) {
+                outputColor(c, i, y, r, g, b);
+                panelPixel(i, y, r, g, b);
+            }
+        } else {
+            colorCorrection.apply(c, r, g, b);
+            panelHLine(start, y, len, r, g, b);
         }
+        pushed += len;
     }
+    return pushed;
+}
 
-    bufferingEnabled = false;
+// ═══════════════════════════════════════════
+// Virtual canvas → catena DMA
+// ═══════════════════════════════════════════
+
+bool DisplayManager::mapToChain(int16_t& x, int16_t& y) const {
+    uint8_t col = x / panelW;
+    uint8_t row = y / panelH;
+    int16_t lx = x - col * panelW;
+    int16_t ly = y - row * panelH;
+
+    // Serpentina: le righe dispari scorrono all'indietro, pannelli ruotati di 180°
+    bool flipped = (chainLayout == CHAIN_SERPENTINE) && (row & 1);
+    uint16_t index = row * panelCols + (flipped ? panelCols - 1 - col : col);
+    if (flipped) {
+        lx = panelW - 1 - lx;
+        ly = panelH - 1 - ly;
+    }
+
+    x = index * panelW + lx;
+    y = ly;
+    return flipped;
+}
+
+void DisplayManager::panelPixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
+    if (!identityMap) mapToChain(x, y);
+    display->drawPixelRGB888(x, y, r, g, b);
+}
+
+// Un run del canvas diventa un run per pannello attraversato (specchiato
+// sui pannelli capovolti): il costo resta proporzionale ai pixel inviati
+void DisplayManager::panelHLine(int16_t x, int16_t y, int16_t len, uint8_t r, uint8_t g, uint8_t b) {
+    if (identityMap) {
+        chainHLine(x, y, len, r, g, b);
+        return;
+    }
+
+    while (len > 0) {
+        int16_t segment = panelW - (x % panelW);
+        if (segment > len) segment = len;
+
+        int16_t px = x;
+        int16_t py = y;
+        bool flipped = mapToChain(px, py);
+        chainHLine(flipped ? px - segment + 1 : px, py, segment, r, g, b);
+
+        x += segment;
+        len -= segment;
+    }
+}
+
+void DisplayManager::chainHLine(int16_t x, int16_t y, int16_t len, uint8_t r, uint8_t g, uint8_t b) {
+#ifndef NO_FAST_FUNCTIONS
+    if (len > 1) {
+        display->drawFastHLine(x, y, len, r, g, b);
+    } else {
+        display->drawPixelRGB888(x, y, r, g, b);
+    }
+#else
+    for (int16_t i = 0; i < len; i++) {
+        display->drawPixelRGB888(x + i, y, r, g, b);
+    }
+#endif
+}
+
+const char* DisplayManager::layoutName(ChainLayout layout) {
+    switch (layout) {
+        case CHAIN_ROWS:       return "rows";
+        case CHAIN_SERPENTINE: return "serpentine";
+        default:               return "horizontal";
+    }
+}
+
+// ═══════════════════════════════════════════
+// Viewport
+// ═══════════════════════════════════════════
+
+void DisplayManager::setViewport(int16_t x, int16_t y, uint16_t w, uint16_t h) {
+    // Sempre dentro il canvas
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x > width) x = width;
+    if (y > height) y = height;
+    if (w > width - x) w = width - x;
+    if (h > height - y) h = height - y;
+
+    vpX = x;
+    vpY = y;
+    vpW = w;
+    vpH = h;
+}
+
+void DisplayManager::centerViewport(uint16_t w, uint16_t h) {
+    int16_t x = w < width ? (width - w) / 2 : 0;
+    int16_t y = h < height ? (height - h) / 2 : 0;
+    setViewport(x, y, w, h);
+}
+
+uint32_t DisplayManager::benchmarkFlush(FlushMode mode, int iterations) {
+    if (!display || iterations <= 0) return 0;
+
+    // Flush completo forzato del contenuto attuale: il pannello non cambia
+    unsigned long start = micros();
+    for (int i = 0; i < iterations; i++) {
+        markAllDirty();
+        flushDirty(mode, true);
+    }
+    unsigned long elapsed = micros() - start;
+
+    // Al prossimo frame riallinea tutto (in double buffering il benchmark
+    // ha scritto solo nel buffer nascosto)
+    markAllDirty();
+    invalidate();
+    return elapsed / iterations;
+}
+
+void DisplayManager::invalidate() {
+    shadowValid[0] = false;
+    shadowValid[1] = false;
+}
+
+void DisplayManager::markAllDirty() {
+    for (int y = 0; y < height; y++) {
+        dirtyMinX[y] = 0;
+        dirtyMaxX[y] = width - 1;
+    }
+    frameDirty = true;
+}
+
+void DisplayManager::clearDirty() {
+    for (int y = 0; y < height; y++) {
+        dirtyMinX[y] = width;
+        dirtyMaxX[y] = -1;
+    }
+    frameDirty = false;
 }
 
 // ═══════════════════════════════════════════
@@ -76,36 +599,128 @@ void DisplayManager::endFrame() {
 // ═══════════════════════════════════════════
 
 void DisplayManager::fillScreen(uint8_t r, uint8_t g, uint8_t b) {
-    if (bufferingEnabled) {
-        uint16_t c = color565(r, g, b);
-        int total = width * height;
-        for (int i = 0; i < total; i++) {
-            frameBuffer[i] = c;
+    uint16_t c = color565(r, g, b);
+
+    // Con un viewport si riempie solo la sua area
+    if (hasViewport()) {
+        for (int16_t y = 0; y < vpH; y++) {
+            fillSpan(y, 0, vpW - 1, c);
         }
+        return;
+    }
+
+    // Nessun pixel usa più i vecchi colori: la palette si svuota e non si
+    // satura con effetti che cambiano colori a ogni frame
+    if (isIndexed()) palette.reclaim();
+
+    int total = width * height;
+    storeFill(0, total, c);
+
+    if (isBuffered()) {
+        markAllDirty();
     } else if (display) {
+        // Write-through: buffer e shadow restano allineati al pannello
+        c = framePixel(0);
+        PixelKernels::fill(shadowBuffers[0], total, c);
+        colorCorrection.apply(c, r, g, b);
         display->fillScreenRGB888(r, g, b);
     }
 }
 
+// Indicizzato: stesso risultato per pixel, ma su 256 colori invece di w*h pixel
+void DisplayManager::fadeScreen(uint16_t amount565) {
+    if (isIndexed()) {
+        palette.fade(amount565);
+    } else {
+        PixelKernels::fade(frame565.data(), (size_t)width * height, amount565);
+    }
+    screenChanged();
+}
+
+void DisplayManager::scaleScreen(uint8_t level) {
+    if (isIndexed()) {
+        palette.scale(level);
+    } else {
+        PixelKernels::scale(frame565.data(), (size_t)width * height, level);
+    }
+    screenChanged();
+}
+
+// Tutto il framebuffer modificato: sporco nel frame o inviato subito
+void DisplayManager::screenChanged() {
+    if (isBuffered()) {
+        markAllDirty();
+    } else if (display) {
+        for (int16_t y = 0; y < height; y++) {
+            flushRow(flushMode, y, 0, width - 1, !shadowValid[0]);
+        }
+    }
+}
+
 void DisplayManager::drawPixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    if (x < 0 || x >= vpW || y < 0 || y >= vpH) return;
+    x += vpX;
+    y += vpY;
+
+    storePixel((size_t)y * width + x, color565(r, g, b));
 
-    if (bufferingEnabled) {
-        frameBuffer[y * width + x] = color565(r, g, b);
+    if (isBuffered()) {
+        markDirty(x, y);
     } else if (display) {
-        display->drawPixelRGB888(x, y, r, g, b);
+        writePixelThrough(x, y);
     }
 }
 
 void DisplayManager::drawPixel(int16_t x, int16_t y, uint16_t col565) {
-    if (x < 0 || x >= width || y < 0 || y >= height) return;
+    if (x < 0 || x >= vpW || y < 0 || y >= vpH) return;
+    x += vpX;
+    y += vpY;
 
-    if (bufferingEnabled) {
-        frameBuffer[y * width + x] = col565;
-    } else {
-        uint8_t r, g, b;
-        rgb565ToRgb888(col565, r, g, b);
-        if (display) display->drawPixelRGB888(x, y, r, g, b);
+    storePixel((size_t)y * width + x, col565);
+
+    if (isBuffered()) {
+        markDirty(x, y);
+    } else if (display) {
+        writePixelThrough(x, y);
+    }
+}
+
+void DisplayManager::blitRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                              const uint16_t* src, int16_t srcStride) {
+    if (!src) return;
+
+    // Clipping una volta sola per rettangolo (sul viewport), poi in canvas
+    if (x < 0) { src -= x; w += x; x = 0; }
+    if (y < 0) { src -= y * srcStride; h += y; y = 0; }
+    if (x + w > vpW) w = vpW - x;
+    if (y + h > vpH) h = vpH - y;
+    if (w <= 0 || h <= 0) return;
+    x += vpX;
+    y += vpY;
+
+    bool buffered = isBuffered();
+    for (int16_t row = 0; row < h; row++) {
+        int16_t py = y + row;
+        storeSpan((size_t)py * width + x, src + row * srcStride, w);
+
+        if (buffered) {
+            markDirtySpan(py, x, x + w - 1);
+        } else if (display) {
+            // Fuori da un frame: invia subito solo i pixel cambiati della riga
+            flushRow(flushMode, py, x, x + w - 1, !shadowValid[0]);
+        }
+    }
+}
+
+void DisplayManager::writeSpan(int16_t x, int16_t y, const uint16_t* src, int16_t len) {
+    x += vpX;
+    y += vpY;
+    storeSpan((size_t)y * width + x, src, len);
+
+    if (isBuffered()) {
+        markDirtySpan(y, x, x + len - 1);
+    } else if (display) {
+        flushRow(flushMode, y, x, x + len - 1, !shadowValid[0]);
     }
 }
 
@@ -125,6 +740,7 @@ void DisplayManager::setTextSize(uint8_t size) {
 }
 
 void DisplayManager::setTextWrap(bool wrap) {
+    textWrap = wrap;
     if (display) display->setTextWrap(wrap);
 }
 
@@ -135,65 +751,108 @@ void DisplayManager::setCursor(int16_t x, int16_t y) {
 }
 
 void DisplayManager::print(const String& text) {
-    if (bufferingEnabled && currentFont) {
-        // Render GFX font directly into framebuffer
-        for (unsigned int i = 0; i < text.length(); i++) {
+    // Tutto il testo passa dal framebuffer: dentro un frame diventa dirty
+    // tracking, fuori da un frame fillSpan() fa write-through per span
+    for (unsigned int i = 0; i < text.length(); i++) {
+        if (currentFont) {
             bufferRenderChar(text.charAt(i));
+        } else {
+            bufferRenderDefaultChar(text.charAt(i));
         }
-    } else if (display) {
-        display->print(text);
     }
 }
 
 void DisplayManager::bufferRenderChar(char c) {
     if (!currentFont) return;
 
-    uint8_t first = pgm_read_byte(&currentFont->first);
-    uint8_t last = pgm_read_byte(&currentFont->last);
+    const CachedGlyph* glyph = glyphCache.get(currentFont, c);
+    if (!glyph) return;
 
-    if (c < first || c > last) return;
+    const uint8_t* span = glyph->spans.data();
+    uint16_t count = glyph->spanCount();
+    int16_t baseX = bufCursorX + glyph->xOffset * currentTextSize;
+    int16_t baseY = bufCursorY + glyph->yOffset * currentTextSize;
 
-    GFXglyph* glyphTable = (GFXglyph*)pgm_read_ptr(&currentFont->glyph);
-    GFXglyph glyph;
-    memcpy_P(&glyph, &glyphTable[c - first], sizeof(GFXglyph));
+    for (uint16_t i = 0; i < count; i++, span += 3) {
+        int16_t x0 = baseX + span[1] * currentTextSize;
+        int16_t x1 = x0 + span[2] * currentTextSize - 1;
+        int16_t y = baseY + span[0] * currentTextSize;
+        for (uint8_t sy = 0; sy < currentTextSize; sy++) {
+            fillSpan(y + sy, x0, x1, currentTextColor);
+        }
+    }
 
-    uint8_t* bitmapData = (uint8_t*)pgm_read_ptr(&currentFont->bitmap);
+    bufCursorX += glyph->xAdvance * currentTextSize;
+}
 
-    uint16_t bitmapOffset = glyph.bitmapOffset;
-    uint8_t gw = glyph.width;
-    uint8_t gh = glyph.height;
-    uint8_t xAdvance = glyph.xAdvance;
-    int8_t xo = glyph.xOffset;
-    int8_t yo = glyph.yOffset;
+void DisplayManager::fillSpan(int16_t y, int16_t x0, int16_t x1, uint16_t color) {
+    if (y < 0 || y >= vpH) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 >= vpW) x1 = vpW - 1;
+    if (x0 > x1) return;
+    x0 += vpX;
+    x1 += vpX;
+    y += vpY;
 
-    uint8_t bit = 0;
-    uint8_t bits = 0;
+    storeFill((size_t)y * width + x0, x1 - x0 + 1, color);
+
+    if (isBuffered()) {
+        markDirtySpan(y, x0, x1);
+    } else if (display) {
+        flushRow(flushMode, y, x0, x1, !shadowValid[0]);
+    }
+}
+
+// Font classico 5x7 (cella 6x8) con la stessa semantica di Adafruit_GFX::write():
+// '\n' va a capo, '\r' ignorato, wrap a fine riga, scala = setTextSize
+void DisplayManager::bufferRenderDefaultChar(char c) {
+    uint8_t size = currentTextSize;
 
-    for (int yy = 0; yy < gh; yy++) {
-        for (int xx = 0; xx < gw; xx++) {
-            if (!(bit & 7)) {
-                bits = pgm_read_byte(&bitmapData[bitmapOffset++]);
+    if (c == '\n') {
+        bufCursorX = 0;
+        bufCursorY += size * 8;
+        return;
+    }
+    if (c == '\r') return;
+
+    if (textWrap && (bufCursorX + size * 6) > vpW) {
+        bufCursorX = 0;
+        bufCursorY += size * 8;
+    }
+
+    int16_t x = bufCursorX;
+    int16_t y = bufCursorY;
+    bufCursorX += size * 6;
+
+    if (x >= vpW || y >= vpH || (x + 6 * size - 1) < 0 || (y + 8 * size - 1) < 0) return;
+
+    uint8_t ch = (uint8_t)c;
+    if (ch >= 176) ch++;  // Stesso offset di GFX senza cp437()
+
+    // Ogni colonna è un byte (LSB in alto): raccoglie i pixel accesi riga
+    // per riga in span orizzontali, poi li scala
+    uint8_t cols[5];
+    for (uint8_t i = 0; i < 5; i++) {
+        cols[i] = pgm_read_byte(&font[ch * 5 + i]);
+    }
+
+    for (uint8_t j = 0; j < 8; j++) {
+        uint8_t i = 0;
+        while (i < 5) {
+            if (!(cols[i] & (1 << j))) {
+                i++;
+                continue;
             }
-            if (bits & 0x80) {
-                int px = bufCursorX + (xo + xx) * currentTextSize;
-                int py = bufCursorY + (yo + yy) * currentTextSize;
-                // Draw scaled pixel
-                for (int sy = 0; sy < currentTextSize; sy++) {
-                    for (int sx = 0; sx < currentTextSize; sx++) {
-                        int fx = px + sx;
-                        int fy = py + sy;
-                        if (fx >= 0 && fx < width && fy >= 0 && fy < height) {
-                            frameBuffer[fy * width + fx] = currentTextColor;
-                        }
-                    }
-                }
+            uint8_t start = i;
+            while (i < 5 && (cols[i] & (1 << j))) i++;
+
+            int16_t x0 = x + start * size;
+            int16_t x1 = x + i * size - 1;
+            for (uint8_t sy = 0; sy < size; sy++) {
+                fillSpan(y + j * size + sy, x0, x1, currentTextColor);
             }
-            bits <<= 1;
-            bit++;
         }
     }
-
-    bufCursorX += xAdvance * currentTextSize;
 }
 
 uint16_t DisplayManager::color565(uint8_t r, uint8_t g, uint8_t b) {
@@ -213,37 +872,41 @@ void DisplayManager::rgb565ToRgb888(uint16_t color565, uint8_t& r, uint8_t& g, u
 void DisplayManager::showOTAProgress(int percent) {
     if (!display) return;
 
-    display->clearScreen();
+    // Frame bufferizzato: tra un chunk e l'altro cambiano solo cifre e barra
+    beginFrame();
+    resetViewport();
+    fillScreen(0, 0, 0);
+    centerViewport(SCENE_SIZE, SCENE_SIZE);
 
     // ✅ Reset font al default (importante se un effetto ha impostato font custom)
-    display->setFont(nullptr);
+    setFont(nullptr);
 
     // Titolo "OTA"
-    display->setTextSize(2);
-    display->setTextColor(color565(255, 165, 0)); // Arancione
-    display->setCursor(14, 12);
-    display->print("OTA");
+    setTextSize(2);
+    setTextColor(color565(255, 165, 0)); // Arancione
+    setCursor(14, 12);
+    print("OTA");
 
     // Percentuale
-    display->setTextSize(2);
-    display->setTextColor(color565(0, 255, 255)); // Cyan
-    display->setCursor(8, 30);
-    display->print(String(percent) + "%");
+    setTextSize(2);
+    setTextColor(color565(0, 255, 255)); // Cyan
+    setCursor(8, 30);
+    print(String(percent) + "%");
 
     // Barra di progresso (48x8 pixel, centrata)
     int barWidth = 48;
     int barHeight = 6;
-    int barX = (width - barWidth) / 2;
+    int barX = (vpW - barWidth) / 2;
     int barY = 54;
 
     // Bordo barra
     for (int x = 0; x < barWidth; x++) {
-        display->drawPixelRGB888(barX + x, barY, 100, 100, 100);
-        display->drawPixelRGB888(barX + x, barY + barHeight - 1, 100, 100, 100);
+        drawPixel(barX + x, barY, 100, 100, 100);
+        drawPixel(barX + x, barY + barHeight - 1, 100, 100, 100);
     }
     for (int y = 0; y < barHeight; y++) {
-        display->drawPixelRGB888(barX, barY + y, 100, 100, 100);
-        display->drawPixelRGB888(barX + barWidth - 1, barY + y, 100, 100, 100);
+        drawPixel(barX, barY + y, 100, 100, 100);
+        drawPixel(barX + barWidth - 1, barY + y, 100, 100, 100);
     }
 
     // Riempimento barra (proporzionale al progresso)
@@ -254,18 +917,25 @@ void DisplayManager::showOTAProgress(int percent) {
             uint8_t r = 0;
             uint8_t g = 255 - (x * 100 / barWidth);
             uint8_t b = (x * 255 / barWidth);
-            display->drawPixelRGB888(barX + 2 + x, barY + y, r, g, b);
+            drawPixel(barX + 2 + x, barY + y, r, g, b);
         }
     }
+
+    resetViewport();
+    endFrame();
+    present();  // Solo in double buffering (EffectManager è in pausa durante l'OTA)
 }
 
 void DisplayManager::showOTASuccess() {
     if (!display) return;
 
-    display->clearScreen();
+    beginFrame();
+    resetViewport();
+    fillScreen(0, 0, 0);
+    centerViewport(SCENE_SIZE, SCENE_SIZE);
 
     // ✅ Reset font al default
-    display->setFont(nullptr);
+    setFont(nullptr);
 
     // Checkmark grande e centrato (16x16 circa)
     // Centro: x=32, y=20
@@ -274,31 +944,35 @@ void DisplayManager::showOTASuccess() {
     // Parte corta del checkmark (sinistra-basso)
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
-            display->drawPixelRGB888(24 + i, 28 + j, 0, green, 0);
-            display->drawPixelRGB888(25 + i, 29 + j, 0, green, 0);
-            display->drawPixelRGB888(26 + i, 30 + j, 0, green, 0);
+            drawPixel(24 + i, 28 + j, 0, green, 0);
+            drawPixel(25 + i, 29 + j, 0, green, 0);
+            drawPixel(26 + i, 30 + j, 0, green, 0);
         }
     }
 
     // Parte lunga del checkmark (centro-alto destra)
     for (int i = 0; i < 3; i++) {
         for (int j = 0; j < 3; j++) {
-            display->drawPixelRGB888(27 + i, 29 - j, 0, green, 0);
-            display->drawPixelRGB888(28 + i, 28 - j, 0, green, 0);
-            display->drawPixelRGB888(29 + i, 27 - j, 0, green, 0);
-            display->drawPixelRGB888(30 + i, 26 - j, 0, green, 0);
-            display->drawPixelRGB888(31 + i, 25 - j, 0, green, 0);
-            display->drawPixelRGB888(32 + i, 24 - j, 0, green, 0);
-            display->drawPixelRGB888(33 + i, 23 - j, 0, green, 0);
-            display->drawPixelRGB888(34 + i, 22 - j, 0, green, 0);
-            display->drawPixelRGB888(35 + i, 21 - j, 0, green, 0);
-            display->drawPixelRGB888(36 + i, 20 - j, 0, green, 0);
+            drawPixel(27 + i, 29 - j, 0, green, 0);
+            drawPixel(28 + i, 28 - j, 0, green, 0);
+            drawPixel(29 + i, 27 - j, 0, green, 0);
+            drawPixel(30 + i, 26 - j, 0, green, 0);
+            drawPixel(31 + i, 25 - j, 0, green, 0);
+            drawPixel(32 + i, 24 - j, 0, green, 0);
+            drawPixel(33 + i, 23 - j, 0, green, 0);
+            drawPixel(34 + i, 22 - j, 0, green, 0);
+            drawPixel(35 + i, 21 - j, 0, green, 0);
+            drawPixel(36 + i, 20 - j, 0, green, 0);
         }
     }
 
     // Testo "OK!" sotto il checkmark
-    display->setTextSize(2);
-    display->setTextColor(color565(0, 255, 0)); // Verde
-    display->setCursor(20, 45);
-    display->print("OK!");
+    setTextSize(2);
+    setTextColor(color565(0, 255, 0)); // Verde
+    setCursor(20, 45);
+    print("OK!");
+
+    resetViewport();
+    endFrame();
+    present();
 }
@@ -3,45 +3,279 @@
 
 #include <ESP32-HUB75-MatrixPanel-I2S-DMA.h>
 #include "Debug.h"
+#include "GlyphCache.h"
+#include "FrameBuffer.h"
+#include "ColorCorrection.h"
 
+// Double buffering DMA: default da build flag, sovrascrivibile da Settings.
+// Raddoppia la RAM DMA usata dal driver (vedi getDmaBytes())
+#ifndef DISPLAY_DOUBLE_BUFFER
+#define DISPLAY_DOUBLE_BUFFER 0
+#endif
+
+// Modalità di flush del framebuffer verso il driver HUB75
+enum FlushMode {
+    FLUSH_PIXEL,    // Un drawPixelRGB888() per pixel (percorso originale)
+    FLUSH_RUNS      // Run orizzontali dello stesso colore via drawFastHLine()
+};
+
+// Disposizione dei pannelli concatenati nel canvas virtuale.
+// Il pannello i della catena occupa le colonne DMA [i*pw, (i+1)*pw);
+// la catena parte dal pannello in alto a sinistra
+enum ChainLayout : uint8_t {
+    CHAIN_HORIZONTAL,   // Una sola fila di pannelli (comportamento originale)
+    CHAIN_ROWS,         // Righe di pannelli, ognuna da sinistra a destra
+    CHAIN_SERPENTINE    // Righe dispari da destra a sinistra con pannelli capovolti (cablaggio a S)
+};
+
+// Scene a geometria fissa (orologi a sprite, immagini): progettate per 64x64,
+// su un canvas più grande vengono disegnate in un viewport centrato
+#define SCENE_SIZE 64
 
 class DisplayManager {
 private:
     MatrixPanel_I2S_DMA* display;
-    uint16_t width;
+    uint16_t width;             // Canvas virtuale (tutti i pannelli)
     uint16_t height;
     uint8_t brightness;
+    ColorCorrection colorCorrection;    // Gamma + bilanciamento del bianco al flush
+
+    // Dithering temporale: soglia da una matrice Bayer 4x4 (fase del pixel)
+    // più una fase per frame, nessuno stato per pixel in RAM
+    bool ditherEnabled;
+    uint8_t ditherPhase;
+    uint32_t ditherPasses;
+    uint32_t ditherUsTotal;
+    uint32_t ditherUsMax;
+    uint32_t ditherPixelsTotal;
+
+    inline bool isDithering() const { return ditherEnabled && colorCorrection.getDitherBits() > 0; }
+    inline void outputColor(uint16_t c, int16_t x, int16_t y, uint8_t& r, uint8_t& g, uint8_t& b) const {
+        if (isDithering()) {
+            colorCorrection.applyDithered(c, ditherThreshold(x, y), r, g, b);
+        } else {
+            colorCorrection.apply(c, r, g, b);
+        }
+    }
+    inline uint8_t ditherThreshold(int16_t x, int16_t y) const {
+        static const uint8_t BAYER4[4][4] = {
+            { 0,  8,  2, 10},
+            {12,  4, 14,  6},
+            { 3, 11,  1,  9},
+            {15,  7, 13,  5}
+        };
+        uint8_t phase = (BAYER4[y & 3][x & 3] + ditherPhase) & 15;
+        return (phase << colorCorrection.getDitherBits()) >> 4;
+    }
+    void updateDitherBits();
+    void recordDither(uint32_t us, uint32_t pixels);
 
-    // Framebuffer for flicker-free rendering
-    uint16_t* frameBuffer;
+    // Geometria della catena
+    uint16_t panelW;
+    uint16_t panelH;
+    uint8_t panelCols;
+    uint8_t panelRows;
+    ChainLayout chainLayout;
+    bool identityMap;           // Canvas = catena DMA: nessuna rimappatura
+
+    // Viewport corrente (coordinate locali delle primitive di disegno)
+    int16_t vpX, vpY;
+    uint16_t vpW, vpH;
+
+    // Framebuffer for flicker-free rendering: uno solo dei due è allocato,
+    // in base al formato scelto dall'effetto corrente
+    FrameBuffer<uint16_t> frame565;
+    FrameBuffer<uint8_t> frame8;
+    PixelFormat pixelFormat;
+    Palette palette;
     bool bufferingEnabled;
 
+    // Dirty tracking: shadowBuffers = contenuto di ciascun buffer DMA,
+    // dirtyMinX/dirtyMaxX = span sporco per ogni riga (minX > maxX = riga pulita)
+    uint16_t* shadowBuffers[2];
+    bool shadowValid[2];        // false = il buffer è stato toccato fuori dal framebuffer
+    int16_t* dirtyMinX;
+    int16_t* dirtyMaxX;
+    uint32_t lastFlushPixels;   // Pixel inviati al driver nell'ultimo endFrame()
+    uint32_t flushCount;
+    uint32_t flushPixelsTotal;
+    uint32_t flushUs;           // µs spesi nel flush da takeFlushUs() in poi
+    FlushMode flushMode;
+    bool offscreen;             // Transizione: si disegna solo nel framebuffer
+
+    // Double buffering: si disegna sempre nel framebuffer, present() aggiorna
+    // il buffer DMA nascosto (backIndex) e lo scambia con quello visibile
+    bool doubleBuffered;
+    uint8_t backIndex;
+    bool frameDirty;            // Qualcosa è cambiato dall'ultimo present()
+    int16_t* prevDirtyMinX;     // Span del frame precedente: il back buffer
+    int16_t* prevDirtyMaxX;     // è indietro di due frame
+    uint32_t dmaBytes;          // Heap consumato da display->begin()
+
+    inline bool isBuffered() const { return bufferingEnabled || doubleBuffered || offscreen; }
+
+    inline void markDirty(int16_t x, int16_t y) {
+        if (x < dirtyMinX[y]) dirtyMinX[y] = x;
+        if (x > dirtyMaxX[y]) dirtyMaxX[y] = x;
+        frameDirty = true;
+    }
+    inline void markDirtySpan(int16_t y, int16_t x0, int16_t x1) {
+        if (x0 < dirtyMinX[y]) dirtyMinX[y] = x0;
+        if (x1 > dirtyMaxX[y]) dirtyMaxX[y] = x1;
+        frameDirty = true;
+    }
+    void markAllDirty();
+    void screenChanged();
+    void clearDirty();
+    void flushFront();
+    uint32_t flushDirty(FlushMode mode, bool force);
+    uint32_t flushRow(FlushMode mode, int16_t y, int16_t x0, int16_t x1, bool force);
+    template <typename Pixel>
+    uint32_t flushRowPixels(const FrameBuffer<Pixel>& frame, int16_t y, int16_t x0, int16_t x1, bool force);
+    template <typename Pixel>
+    uint32_t flushRowRuns(const FrameBuffer<Pixel>& frame, int16_t y, int16_t x0, int16_t x1, bool force);
+
+    // Accesso al framebuffer nel formato corrente (i = y * width + x)
+    inline bool isIndexed() const { return pixelFormat == PIXEL_INDEXED8; }
+    inline void storePixel(size_t i, uint16_t color) {
+        if (isIndexed()) frame8.set(i, color); else frame565.set(i, color);
+    }
+    inline uint16_t framePixel(size_t i) const {
+        return isIndexed() ? frame8.get(i) : frame565.get(i);
+    }
+    inline void storeFill(size_t i, size_t count, uint16_t color) {
+        if (isIndexed()) frame8.fill(i, count, color); else frame565.fill(i, count, color);
+    }
+    inline void storeSpan(size_t i, const uint16_t* src, size_t count) {
+        if (isIndexed()) frame8.write(i, src, count); else frame565.write(i, src, count);
+    }
+    void writePixelThrough(int16_t x, int16_t y);
+
+    // Uscita verso il driver in coordinate canvas, rimappate sulla catena
+    bool mapToChain(int16_t& x, int16_t& y) const;   // true = pannello capovolto
+    void panelPixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b);
+    void panelHLine(int16_t x, int16_t y, int16_t len, uint8_t r, uint8_t g, uint8_t b);
+    void chainHLine(int16_t x, int16_t y, int16_t len, uint8_t r, uint8_t g, uint8_t b);
+
     // Local state for buffered text rendering
     int16_t bufCursorX, bufCursorY;
     const GFXfont* currentFont;
     uint16_t currentTextColor;
     uint8_t currentTextSize;
+    bool textWrap;
+
+    // Glifi GFXfont già rasterizzati in span (LRU)
+    GlyphCache glyphCache;
 
     // Buffered text helpers
     void bufferRenderChar(char c);
+    void bufferRenderDefaultChar(char c);
+    void fillSpan(int16_t y, int16_t x0, int16_t x1, uint16_t color);
 
 public:
+    // panelsNumber = pannelli nella catena, disposti in panelRows righe
     DisplayManager(uint16_t panelWidth, uint16_t panelHeight,
-                   uint8_t panelsNumber, uint8_t pinE);
+                   uint8_t panelsNumber, uint8_t pinE,
+                   bool doubleBuffer = DISPLAY_DOUBLE_BUFFER,
+                   uint8_t panelRows = 1, ChainLayout layout = CHAIN_HORIZONTAL);
     ~DisplayManager();
 
     bool begin();
     void setBrightness(uint8_t level);
 
+    // Pipeline colore (LUT al flush): gamma x100, bianco per canale 0-255.
+    // Il pannello viene riallineato per intero al prossimo flush
+    void setColorCorrection(uint16_t gamma100, uint8_t whiteR, uint8_t whiteG, uint8_t whiteB);
+    const ColorCorrection& getColorCorrection() const { return colorCorrection; }
+
+    // Dithering temporale per le luminosità basse: i bit persi dal driver
+    // dipendono da setBrightness(), a luminosità alta non fa nulla.
+    // ditherFrame() va chiamato una volta per frame (EffectManager, prima di present())
+    void setDithering(bool enabled);
+    bool isDitheringEnabled() const { return ditherEnabled; }
+    uint8_t getDitherBits() const { return colorCorrection.getDitherBits(); }
+    void ditherFrame();
+
+    // Costo dei passaggi di dithering (flush completo con i pixel a bit persi)
+    uint32_t getDitherPasses() const { return ditherPasses; }
+    uint32_t getDitherAvgUs() const { return ditherPasses ? ditherUsTotal / ditherPasses : 0; }
+    uint32_t getDitherMaxUs() const { return ditherUsMax; }
+    uint32_t getDitherAvgPixels() const { return ditherPasses ? ditherPixelsTotal / ditherPasses : 0; }
+    void resetDitherStats() { ditherPasses = 0; ditherUsTotal = 0; ditherUsMax = 0; ditherPixelsTotal = 0; }
+
     // Framebuffer control (opt-in per effect)
     void beginFrame();
     void endFrame();
+    void invalidate();  // Forza un flush completo al prossimo endFrame()/present()
+
+    // Double buffering: chiamato da EffectManager dopo ogni frame
+    void present();
+    bool isDoubleBuffered() const { return doubleBuffered; }
+
+    // Transizioni: offscreen = nessun flush/write-through, il pannello riceve
+    // solo i frame compositi passati a presentComposite()
+    void setOffscreen(bool enabled);
+    bool isOffscreen() const { return offscreen; }
+    void presentComposite(const uint16_t* composite);
+    uint32_t getDmaBytes() const { return dmaBytes; }
+    uint32_t getBufferBytes() const;
+
+    // Formato del framebuffer (per effetto, vedi Effect::getPixelFormat()).
+    // La palette riparte sempre vuota; il cambio di formato rialloca il
+    // framebuffer (nero), e nell'indicizzato il frame torna comunque nero.
+    // false = RAM insufficiente, resta il formato attuale
+    bool setPixelFormat(PixelFormat format);
+    PixelFormat getPixelFormat() const { return pixelFormat; }
+    static const char* formatName(PixelFormat format);
+
+    // Palette (formato indicizzato). Le voci riservate si animano senza
+    // ridisegnare i pixel: il pannello si aggiorna al prossimo flush.
+    // In RGB565 drawPixelIndex() scrive il colore corrente della voce
+    bool reservePalette(uint8_t count, uint8_t& first) { return palette.reserve(count, first); }
+    void setPaletteColor(uint8_t index, uint16_t color565);
+    void cyclePalette(uint8_t first, uint8_t count, int8_t step = 1);
+    void drawPixelIndex(int16_t x, int16_t y, uint8_t index);
+    const Palette& getPalette() const { return palette; }
+
+    // Statistiche flush (dirty tracking)
+    uint32_t getLastFlushPixels() const { return lastFlushPixels; }
+    uint32_t getFlushCount() const { return flushCount; }
+    uint32_t getAvgFlushPixels() const { return flushCount ? flushPixelsTotal / flushCount : 0; }
+    void resetFlushStats() { flushCount = 0; flushPixelsTotal = 0; }
+
+    // Tempo di flush accumulato (endFrame/present) dall'ultima chiamata
+    uint32_t takeFlushUs() { uint32_t us = flushUs; flushUs = 0; return us; }
+
+    // Modalità flush + benchmark (µs medi per un flush completo del frame)
+    void setFlushMode(FlushMode mode) { flushMode = mode; }
+    FlushMode getFlushMode() const { return flushMode; }
+    uint32_t benchmarkFlush(FlushMode mode, int iterations);
 
     // Metodi di disegno wrapper
     void fillScreen(uint8_t r, uint8_t g, uint8_t b);
+
+    // Operazioni a schermo intero (PixelKernels, due pixel per word;
+    // nel formato indicizzato agiscono sui 256 colori della palette)
+    void fadeScreen(uint16_t amount565);    // Sottrae amount per canale (scia/decay)
+    void scaleScreen(uint8_t level);        // Luminosità 0-32 (32 = invariato)
     void drawPixel(int16_t x, int16_t y, uint8_t r, uint8_t g, uint8_t b);
     void drawPixel(int16_t x, int16_t y, uint16_t color565);
 
+    // Copia un rettangolo RGB565 nel framebuffer, una memcpy per riga.
+    // src punta al pixel (x,y) della sorgente, srcStride = larghezza riga sorgente
+    void blitRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                  const uint16_t* src, int16_t srcStride);
+    // Framebuffer RGB565 diretto: nullptr nel formato indicizzato (usare copyFrame())
+    const uint16_t* getFrameBuffer() const { return frame565.data(); }
+    void copyFrame(uint16_t* dst) const;    // Frame intero convertito in RGB565
+
+    // Copia un run orizzontale già clippato sul viewport (nessun controllo sui limiti)
+    void writeSpan(int16_t x, int16_t y, const uint16_t* src, int16_t len);
+
+    // Statistiche cache glifi
+    const GlyphCache& getGlyphCache() const { return glyphCache; }
+    void resetGlyphStats() { glyphCache.resetStats(); }
+
     // Metodi per testo
     void setFont(const GFXfont* font);
     void setTextColor(uint16_t color);
@@ -50,9 +284,24 @@ public:
     void setCursor(int16_t x, int16_t y);
     void print(const String& text);
 
+    // Viewport: le primitive di disegno (pixel, span, blit, testo, fillScreen)
+    // lavorano in coordinate locali 0..w-1 traslate in (x,y) e clippate;
+    // getWidth()/getHeight() riportano la dimensione del viewport.
+    // fadeScreen/scaleScreen e il framebuffer restano sull'intero canvas
+    void setViewport(int16_t x, int16_t y, uint16_t w, uint16_t h);
+    void centerViewport(uint16_t w, uint16_t h);
+    void resetViewport() { setViewport(0, 0, width, height); }
+    bool hasViewport() const { return vpW != width || vpH != height; }
+
     // Getters
-    uint16_t getWidth() const { return width; }
-    uint16_t getHeight() const { return height; }
+    uint16_t getWidth() const { return vpW; }
+    uint16_t getHeight() const { return vpH; }
+    uint16_t getCanvasWidth() const { return width; }
+    uint16_t getCanvasHeight() const { return height; }
+    uint8_t getPanelCols() const { return panelCols; }
+    uint8_t getPanelRows() const { return panelRows; }
+    ChainLayout getChainLayout() const { return chainLayout; }
+    static const char* layoutName(ChainLayout layout);
     MatrixPanel_I2S_DMA* getDisplay() { return display; }
 
     // Conversione colori
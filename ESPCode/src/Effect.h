@@ -2,22 +2,62 @@
 #define EFFECT_H
 
 #include "DisplayManager.h"
+#include "PerfHistogram.h"
 #include <Arduino.h>
 #include "Debug.h"
 
+// Tick rate di default per gli effetti a passo fisso: 100 Hz = il ritmo
+// nominale del vecchio loop (delay(10)), le velocità restano invariate
+#ifndef EFFECT_TICK_HZ
+#define EFFECT_TICK_HZ 100
+#endif
+
+// Tick massimi recuperati oltre il periodo frame (evita la spirale dopo uno
+// stallo): con periodi lunghi il frame normale si recupera sempre per intero
+#define EFFECT_MAX_CATCHUP_TICKS 5
+
 
 class Effect {
 protected:
     DisplayManager* displayManager;
     unsigned long startTime;
     unsigned long lastUpdate;
-    uint16_t frameCount;
+    uint32_t frameCount;
     bool initialized;
+
+    // Profilo tempi (µs) per update/draw/flush
+    EffectProfile profile;
+    uint32_t drawFlushUs;       // Flush avvenuto dentro draw() (endFrame)
+
+    // Passo fisso: update() gira a tickUs costante indipendentemente dal
+    // frame rate; 0 = un update() per frame (effetti temporizzati con millis())
+    uint32_t tickUs;
+    uint32_t accumulatorUs;
+    unsigned long lastTickUs;
+    float alpha;                // Frazione del tick corrente, per interpolare in draw()
+
+    /**
+     * Abilita l'update a passo fisso (hz tick al secondo, 0 = disabilitato).
+     * Da chiamare nel costruttore dell'effetto.
+     */
+    void setTickRate(uint16_t hz) {
+        tickUs = hz > 0 ? 1000000UL / hz : 0;
+    }
+
+    /**
+     * Interpola tra lo stato al tick precedente e quello corrente.
+     * Con passo variabile alpha = 1 (nessuna interpolazione).
+     */
+    float interpolate(float previous, float current) const {
+        return previous + (current - previous) * alpha;
+    }
     
 public:
     Effect(DisplayManager* dm) 
         : displayManager(dm), startTime(0), lastUpdate(0), 
-          frameCount(0), initialized(false) {}
+          frameCount(0), initialized(false),
+          drawFlushUs(0),
+          tickUs(0), accumulatorUs(0), lastTickUs(0), alpha(1.0f) {}
     
     virtual ~Effect() {}
     
@@ -34,7 +74,8 @@ public:
     virtual void init() = 0;
     
     /**
-     * Aggiorna la logica dell'effetto (chiamato ogni frame)
+     * Aggiorna la logica dell'effetto (chiamato ogni frame, oppure
+     * ogni tick se l'effetto usa setTickRate())
      */
     virtual void update() = 0;
     
@@ -69,6 +110,28 @@ public:
      * @param isDay true = tema giorno, false = tema notte
      */
     virtual void onThemeChange(bool isDay) {}
+
+    /**
+     * true = scena a geometria fissa SCENE_SIZE x SCENE_SIZE (sprite, mappe):
+     * su un canvas più grande EffectManager la disegna in un viewport centrato.
+     * Default: l'effetto si adatta a getWidth()/getHeight() del canvas
+     */
+    virtual bool isFixedScene() const { return false; }
+
+    /**
+     * Formato del framebuffer mentre l'effetto è attivo. Gli effetti con pochi
+     * colori possono usare PIXEL_INDEXED8: metà RAM e palette cycling
+     * (DisplayManager::setPaletteColor()/cyclePalette()).
+     * Default: RGB565
+     */
+    virtual PixelFormat getPixelFormat() const { return PIXEL_RGB565; }
+
+    /**
+     * false = effetto attivato solo da comando (stream, sorgenti esterne):
+     * nextEffect() e l'auto-switch lo saltano.
+     * Default: fa parte della rotazione
+     */
+    virtual bool isAutoSwitchable() const { return true; }
     
     // ========== GESTIONE CICLO DI VITA ==========
     
@@ -83,6 +146,12 @@ public:
         frameCount = 0;
         startTime = millis();
         lastUpdate = startTime;
+        accumulatorUs = 0;
+        lastTickUs = micros();
+        alpha = 1.0f;
+
+        // Framebuffer nel formato dell'effetto, palette vuota per init()
+        displayManager->setPixelFormat(getPixelFormat());
         
         init();  // Chiama l'init dell'effetto concreto
         initialized = true;
@@ -103,15 +172,44 @@ public:
     
     /**
      * Esegue un frame dell'effetto (update + draw)
-     * Chiama activate() automaticamente se non inizializzato
+     * Chiama activate() automaticamente se non inizializzato.
+     * Con passo fisso esegue 0..N update() in base al tempo trascorso;
+     * framePeriodUs = periodo nominale del render, recuperato senza limiti
      */
-    void execute() {
+    void execute(uint32_t framePeriodUs = 0) {
         if (!initialized) {
             DEBUG_PRINTF("[Effect] Activating effect: %s\n", getName());
             activate();
         }
-        update();
+
+        displayManager->takeFlushUs();  // Scarta flush avvenuti fuori dal frame
+        uint32_t t0 = micros();
+
+        if (tickUs == 0) {
+            update();
+        } else {
+            unsigned long now = micros();
+            accumulatorUs += now - lastTickUs;
+            lastTickUs = now;
+
+            uint32_t maxUs = framePeriodUs + tickUs * EFFECT_MAX_CATCHUP_TICKS;
+            if (accumulatorUs > maxUs) {
+                accumulatorUs = maxUs;
+            }
+            while (accumulatorUs >= tickUs) {
+                update();
+                accumulatorUs -= tickUs;
+            }
+            alpha = (float)accumulatorUs / tickUs;
+        }
+
+        uint32_t t1 = micros();
         draw();
+        uint32_t t2 = micros();
+
+        drawFlushUs = displayManager->takeFlushUs();
+        profile.update.record(t1 - t0);
+        profile.draw.record(t2 - t1 - drawFlushUs);
         frameCount++;
         lastUpdate = millis();
     }
@@ -129,8 +227,13 @@ public:
     bool isInitialized() const { return initialized; }
     unsigned long getRuntime() const { return initialized ? (millis() - startTime) : 0; }
     unsigned long getLastUpdateTime() const { return lastUpdate; }
-    uint16_t getFrameCount() const { return frameCount; }
+    uint32_t getFrameCount() const { return frameCount; }
+    uint16_t getTickRate() const { return tickUs ? 1000000UL / tickUs : 0; }
     
+    // Profilo: il flush è registrato da EffectManager dopo present()
+    EffectProfile& getProfile() { return profile; }
+    uint32_t getDrawFlushUs() const { return drawFlushUs; }
+
     float getFPS() const {
         unsigned long runtime = getRuntime();
         return runtime > 0 ? (frameCount * 1000.0f / runtime) : 0;
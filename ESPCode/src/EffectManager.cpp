@@ -2,7 +2,7 @@
 
 EffectManager::EffectManager(DisplayManager* dm, unsigned long duration)
     : displayManager(dm), effectDuration(duration),
-      currentEffectIndex(-1), effectStartTime(0), autoSwitch(true), paused(false) {
+      currentEffectIndex(-1), effectStartTime(0), autoSwitch(true), paused(false), framePeriodUs(0) {
     // Pre-alloca spazio per gli effetti per evitare riallocazioni
     effects.reserve(10);
 }
@@ -26,8 +26,15 @@ void EffectManager::addEffect(Effect* effect) {
 void EffectManager::nextEffect() {
     if (effects.empty()) return;
     
-    int nextIndex = (currentEffectIndex + 1) % effects.size();
-    changeToEffect(nextIndex);
+    // Salta gli effetti fuori rotazione (attivarli darebbe un frame nero)
+    int nextIndex = currentEffectIndex;
+    for (size_t i = 0; i < effects.size(); i++) {
+        nextIndex = (nextIndex + 1) % effects.size();
+        if (effects[nextIndex]->isAutoSwitchable()) {
+            changeToEffect(nextIndex);
+            return;
+        }
+    }
 }
 
 void EffectManager::setEffect(int index) {
@@ -69,8 +76,35 @@ void EffectManager::update() {
     Effect* current = effects[currentEffectIndex];
     if (!current) return;
 
-    // Esegui l'effetto corrente
-    current->execute();
+    // Esegui l'effetto corrente (le scene fisse nel viewport centrato)
+    if (current->isFixedScene()) {
+        displayManager->centerViewport(SCENE_SIZE, SCENE_SIZE);
+    }
+    current->execute(framePeriodUs);
+    displayManager->resetViewport();
+
+    // Dithering notturno: nuova fase, i pixel con bit persi vanno reinviati
+    displayManager->ditherFrame();
+
+    if (transition.isActive()) {
+        // Transizione: il frame entrante resta nel framebuffer, al pannello
+        // va il composito con l'ultimo frame dell'effetto uscente
+        // Nel formato indicizzato il frame entrante va prima convertito in RGB565
+        const uint16_t* incoming = displayManager->getFrameBuffer();
+        if (!incoming) {
+            displayManager->copyFrame(transition.getComposite());
+            incoming = transition.getComposite();
+        }
+        bool done = transition.compose(incoming);
+        displayManager->presentComposite(transition.getComposite());
+        if (done) {
+            endTransition();
+        }
+    } else {
+        // Double buffering: mostra il frame completo (no-op altrimenti)
+        displayManager->present();
+    }
+    current->getProfile().flush.record(current->getDrawFlushUs() + displayManager->takeFlushUs());
     
     // Controlla se è il momento di cambiare effetto (SOLO se autoSwitch è attivo)
     if (autoSwitch) {
@@ -103,12 +137,37 @@ Effect* EffectManager::getCurrentEffect() {
 void EffectManager::printStats() {
     Effect* current = getCurrentEffect();
     if (current) {
-        DEBUG_PRINTF("[Stats] Effect: %s | Runtime: %lu ms | FPS: %.1f | Frames: %d%s\n",
+        DEBUG_PRINTF("[Stats] Effect: %s | Runtime: %lu ms | FPS: %.1f | Frames: %lu%s\n",
                      current->getName(),
                      current->getRuntime(),
                      current->getFPS(),
-                     current->getFrameCount(),
+                     (unsigned long)current->getFrameCount(),
                      autoSwitch ? "" : " [PAUSED]");
+
+        EffectProfile& profile = current->getProfile();
+        DEBUG_PRINTF("[Stats] Perf (p50/p95/p99/max us): update %s | draw %s | flush %s\n",
+                     profile.update.toCsv().c_str(),
+                     profile.draw.toCsv().c_str(),
+                     profile.flush.toCsv().c_str());
+    }
+    if (displayManager && displayManager->getFlushCount() > 0) {
+        DEBUG_PRINTF("[Stats] Flush: last %lu px | avg %lu px/frame | %lu frames\n",
+                     (unsigned long)displayManager->getLastFlushPixels(),
+                     (unsigned long)displayManager->getAvgFlushPixels(),
+                     (unsigned long)displayManager->getFlushCount());
+        displayManager->resetFlushStats();
+    }
+    if (displayManager) {
+        const GlyphCache& glyphs = displayManager->getGlyphCache();
+        uint32_t lookups = glyphs.getHits() + glyphs.getMisses();
+        if (lookups > 0) {
+            DEBUG_PRINTF("[Stats] Glyphs: %lu hit | %lu miss | %.1f%% | %u/%d cached\n",
+                         (unsigned long)glyphs.getHits(),
+                         (unsigned long)glyphs.getMisses(),
+                         glyphs.getHits() * 100.0f / lookups,
+                         glyphs.getUsedEntries(), GLYPH_CACHE_SIZE);
+            displayManager->resetGlyphStats();
+        }
     }
 }
 
@@ -127,6 +186,7 @@ void EffectManager::setAutoSwitch(bool enabled) {
 void EffectManager::pause() {
     // SOLO per OTA: blocca completamente l'esecuzione
     paused = true;
+    endTransition();
     DEBUG_PRINTLN("[EffectManager] PAUSED for OTA - effects stopped");
 }
 
@@ -136,6 +196,17 @@ void EffectManager::resume() {
     DEBUG_PRINTLN("[EffectManager] RESUMED after OTA - effects restarted");
 }
 
+void EffectManager::setTransition(TransitionType type, uint16_t durationMs) {
+    // Transizione interrotta: il pannello mostra ancora un composito
+    if (transition.isActive()) {
+        endTransition();
+        displayManager->invalidate();
+    }
+    transition.setType(type);
+    transition.setDuration(durationMs);
+    DEBUG_PRINTF("[EffectManager] Transition: %s %u ms\n", Transition::typeName(type), durationMs);
+}
+
 void EffectManager::switchToEffect(int index) {
     if (index >= 0 && index < effects.size()) {
         changeToEffect(index);
@@ -2,6 +2,7 @@
 #define EFFECT_MANAGER_H
 
 #include "Effect.h"
+#include "Transition.h"
 #include <vector>
 #include "Debug.h"
 
@@ -15,6 +16,13 @@ private:
     DisplayManager* displayManager;
     bool autoSwitch;
     bool paused;  // Blocca esecuzione durante OTA
+    uint32_t framePeriodUs;  // Periodo del render, per il recupero dei tick
+    Transition transition;
+
+    void endTransition() {
+        transition.end();
+        if (displayManager) displayManager->setOffscreen(false);
+    }
     
     /**
      * Cambia all'effetto specificato (uso interno)
@@ -23,13 +31,37 @@ private:
         if (index < 0 || index >= effects.size()) return;
         
         // Disattiva effetto corrente
+        bool wasRunning = false;
         if (currentEffectIndex >= 0 && currentEffectIndex < effects.size()) {
             DEBUG_PRINTF("[EffectManager] Switching from effect: %s to %s\n",
                           effects[currentEffectIndex]->getName(),
                           effects[index]->getName());
+            wasRunning = effects[currentEffectIndex]->isInitialized();
             effects[currentEffectIndex]->deactivate();
         }
         
+        if (displayManager) {
+            // Transizione: si parte da ciò che è a schermo (frame uscente o
+            // composito di una transizione ancora in corso)
+            bool restart = transition.isActive();
+            if (wasRunning && !paused &&
+                transition.begin(displayManager->getCanvasWidth(), displayManager->getCanvasHeight())) {
+                if (!restart) displayManager->copyFrame(transition.getOutgoing());
+                displayManager->setOffscreen(true);
+            } else {
+                // Taglio netto: il nuovo effetto riparte da un pannello non tracciato
+                endTransition();
+                displayManager->invalidate();
+            }
+        }
+
+        // Scena fissa su un canvas più grande: i margini attorno al viewport
+        // non vengono mai ridisegnati dall'effetto, partono neri
+        if (displayManager && effects[index]->isFixedScene() &&
+            (displayManager->getCanvasWidth() > SCENE_SIZE || displayManager->getCanvasHeight() > SCENE_SIZE)) {
+            displayManager->fillScreen(0, 0, 0);
+        }
+
         // Attiva nuovo effetto
         currentEffectIndex = index;
         effectStartTime = millis();
@@ -46,6 +78,7 @@ public:
     void nextEffect();
     void setEffect(int index);
     void setDuration(unsigned long ms);
+    void setFramePeriod(uint32_t ms) { framePeriodUs = ms * 1000; }
     void start();
     
     // Controllo manuale
@@ -55,12 +88,21 @@ public:
     void switchToEffect(const char* name);
     void pause();
     void resume();
+
+    // Transizioni tra effetti
+    void setTransition(TransitionType type, uint16_t durationMs);
+    TransitionType getTransitionType() const { return transition.getType(); }
+    uint16_t getTransitionDuration() const { return transition.getDuration(); }
+    const Transition& getTransition() const { return transition; }
     
     // Loop principale
     void update();
     
     // Info
     Effect* getCurrentEffect();
+    Effect* getEffect(int index) const {
+        return (index >= 0 && index < effects.size()) ? effects[index] : nullptr;
+    }
     int getCurrentEffectIndex() const { return currentEffectIndex; }
     int getEffectCount() const { return effects.size(); }
     const char* getEffectName(int index) const;
@@ -0,0 +1,129 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <Arduino.h>
+#include "Palette.h"
+#include "PixelKernels.h"
+
+// Formato dei pixel nel framebuffer del DisplayManager (scelto per effetto)
+enum PixelFormat : uint8_t {
+    PIXEL_RGB565,       // 2 byte per pixel, colore diretto (comportamento originale)
+    PIXEL_INDEXED8      // 1 byte per pixel, indice nella Palette a 256 colori
+};
+
+/**
+ * PixelTraits - Conversione tra il formato memorizzato e RGB565.
+ * Il flush verso il pannello e il dirty tracking lavorano sempre in RGB565.
+ */
+template <typename Pixel> struct PixelTraits;
+
+template <> struct PixelTraits<uint16_t> {
+    static const PixelFormat format = PIXEL_RGB565;
+
+    static inline uint16_t toColor(uint16_t p, const Palette*) { return p; }
+    static inline uint16_t fromColor(uint16_t color, Palette*) { return color; }
+
+    static void fill(uint16_t* dst, size_t count, uint16_t p) {
+        PixelKernels::fill(dst, count, p);
+    }
+    static void write(uint16_t* dst, const uint16_t* src, size_t count, Palette*) {
+        memcpy(dst, src, count * sizeof(uint16_t));
+    }
+    static void read(const uint16_t* src, uint16_t* dst, size_t count, const Palette*) {
+        memcpy(dst, src, count * sizeof(uint16_t));
+    }
+};
+
+template <> struct PixelTraits<uint8_t> {
+    static const PixelFormat format = PIXEL_INDEXED8;
+
+    static inline uint16_t toColor(uint8_t p, const Palette* palette) { return palette->color(p); }
+    static inline uint8_t fromColor(uint16_t color, Palette* palette) { return palette->indexOf(color); }
+
+    static void fill(uint8_t* dst, size_t count, uint8_t p) {
+        memset(dst, p, count);
+    }
+    // Sprite e span hanno lunghe sequenze dello stesso colore: un lookup per cambio
+    static void write(uint8_t* dst, const uint16_t* src, size_t count, Palette* palette) {
+        if (count == 0) return;
+        uint16_t last = src[0];
+        uint8_t index = palette->indexOf(last);
+        for (size_t i = 0; i < count; i++) {
+            if (src[i] != last) {
+                last = src[i];
+                index = palette->indexOf(last);
+            }
+            dst[i] = index;
+        }
+    }
+    static void read(const uint8_t* src, uint16_t* dst, size_t count, const Palette* palette) {
+        const uint16_t* colors = palette->data();
+        for (size_t i = 0; i < count; i++) dst[i] = colors[src[i]];
+    }
+};
+
+/**
+ * FrameBuffer - Buffer di pixel in formato Pixel (uint16_t = RGB565,
+ * uint8_t = indicizzato). Le primitive lavorano sempre con colori RGB565,
+ * la conversione passa da PixelTraits.
+ */
+template <typename Pixel>
+class FrameBuffer {
+public:
+    typedef PixelTraits<Pixel> Traits;
+
+    FrameBuffer() : pixels(nullptr), palette(nullptr) {}
+    ~FrameBuffer() { release(); }
+
+    void setPalette(Palette* p) { palette = p; }
+
+    // Buffer azzerato (nero in entrambi i formati)
+    bool allocate(size_t count) {
+        release();
+        pixels = (Pixel*)malloc(count * sizeof(Pixel));
+        if (!pixels) return false;
+        memset(pixels, 0, count * sizeof(Pixel));
+        return true;
+    }
+    void release() {
+        free(pixels);
+        pixels = nullptr;
+    }
+
+    bool isAllocated() const { return pixels != nullptr; }
+    Pixel* data() { return pixels; }
+    const Pixel* data() const { return pixels; }
+
+    // Sostituisce temporaneamente il buffer (non posseduto): ritorna il precedente
+    Pixel* attach(Pixel* other) {
+        Pixel* previous = pixels;
+        pixels = other;
+        return previous;
+    }
+
+    inline void set(size_t i, uint16_t color) { pixels[i] = Traits::fromColor(color, palette); }
+    inline void setRaw(size_t i, Pixel p) { pixels[i] = p; }
+    inline uint16_t get(size_t i) const { return Traits::toColor(pixels[i], palette); }
+    inline uint16_t toColor(Pixel p) const { return Traits::toColor(p, palette); }
+
+    void fill(size_t i, size_t count, uint16_t color) {
+        Traits::fill(pixels + i, count, Traits::fromColor(color, palette));
+    }
+    void write(size_t i, const uint16_t* src, size_t count) {
+        Traits::write(pixels + i, src, count, palette);
+    }
+    void read(size_t i, uint16_t* dst, size_t count) const {
+        Traits::read(pixels + i, dst, count, palette);
+    }
+
+    static size_t bytesFor(size_t count) { return count * sizeof(Pixel); }
+
+private:
+    Pixel* pixels;
+    Palette* palette;
+
+    FrameBuffer(const FrameBuffer&);
+    FrameBuffer& operator=(const FrameBuffer&);
+};
+
+#endif // FRAME_BUFFER_H
@@ -0,0 +1,280 @@
+#include "FrameMirror.h"
+
+static inline void put16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+FrameMirror::FrameMirror()
+    : _lock(nullptr)
+    , _width(0)
+    , _height(0)
+    , _pixels(0)
+    , _snapshot(nullptr)
+    , _scratch(nullptr)
+    , _snapshotSeq(0)
+    , _captureIntervalMs(0)
+    , _snapshotRequested(false)
+    , _lastCaptureMs(0)
+    , _subscribers(0)
+    , _framesSent(0)
+    , _bytesSent(0)
+    , _capturesSkipped(0)
+{
+    memset(_clients, 0, sizeof(_clients));
+}
+
+FrameMirror::~FrameMirror() {
+    for (uint8_t i = 0; i < _subscribers; i++) free(_clients[i].reference);
+    releaseBuffers();
+    if (_lock) vSemaphoreDelete(_lock);
+}
+
+void FrameMirror::begin(uint16_t width, uint16_t height) {
+    _width = width;
+    _height = height;
+    _pixels = (size_t)width * height;
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    DEBUG_PRINTF("[Mirror] Ready %ux%u (%u bytes per frame)\n", width, height, (unsigned)(_pixels * 2));
+}
+
+// ═══════════════════════════════════════════
+// Cattura (task di render)
+// ═══════════════════════════════════════════
+
+void FrameMirror::capture(const DisplayManager* display) {
+    uint32_t interval = _captureIntervalMs;
+    bool requested = _snapshotRequested;
+    if (!requested && interval == 0) return;
+
+    uint32_t now = millis();
+    bool preview = interval > 0 && now - _lastCaptureMs >= interval;
+    if (!requested && !preview) return;
+
+    // Mai in attesa: con lo snapshot in uso dalla rete si salta il frame
+    if (xSemaphoreTake(_lock, 0) != pdTRUE) {
+        _capturesSkipped++;
+        return;
+    }
+    if (_pending) {
+        display->copyFrame(_pending->pixels);
+        _pending->ready.store(true, std::memory_order_release);
+        _pending.reset();
+        _snapshotRequested = false;
+    }
+    if (preview && _snapshot) {
+        display->copyFrame(_snapshot);
+        _snapshotSeq++;
+        _lastCaptureMs = now;
+    }
+    xSemaphoreGive(_lock);
+}
+
+// ═══════════════════════════════════════════
+// Snapshot (/api/frame)
+// ═══════════════════════════════════════════
+
+std::shared_ptr<FrameSnapshot> FrameMirror::requestSnapshot() {
+    if (!_lock || _pixels == 0) return nullptr;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    std::shared_ptr<FrameSnapshot> snapshot = _pending;
+    if (!snapshot) {
+        snapshot = std::make_shared<FrameSnapshot>();
+        snapshot->pixels = (uint16_t*)malloc(_pixels * sizeof(uint16_t));
+        if (snapshot->pixels) {
+            _pending = snapshot;
+            _snapshotRequested = true;
+        } else {
+            snapshot.reset();
+        }
+    }
+    xSemaphoreGive(_lock);
+    return snapshot;
+}
+
+// ═══════════════════════════════════════════
+// Sottoscrizioni anteprima
+// ═══════════════════════════════════════════
+
+bool FrameMirror::subscribe(uint32_t clientId, uint8_t fps) {
+    if (fps == 0) {
+        unsubscribe(clientId);
+        return true;
+    }
+    if (!_lock || _pixels == 0) return false;
+    if (fps > FRAME_MIRROR_MAX_FPS) fps = FRAME_MIRROR_MAX_FPS;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Client* client = findClient(clientId);
+    if (!client) {
+        if (_subscribers >= FRAME_MIRROR_MAX_CLIENTS || !allocateBuffers()) {
+            xSemaphoreGive(_lock);
+            return false;
+        }
+        client = &_clients[_subscribers++];
+        client->id = clientId;
+        client->lastSentMs = 0;
+        client->sentSeq = _snapshotSeq;
+        client->reference = nullptr;
+    }
+    client->fps = fps;
+    updateCaptureInterval();
+    xSemaphoreGive(_lock);
+
+    DEBUG_PRINTF("[Mirror] Client #%u preview at %u fps\n", clientId, fps);
+    return true;
+}
+
+void FrameMirror::unsubscribe(uint32_t clientId) {
+    if (!_lock) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    Client* client = findClient(clientId);
+    if (client) {
+        free(client->reference);
+        *client = _clients[--_subscribers];
+        updateCaptureInterval();
+        if (_subscribers == 0) releaseBuffers();
+        DEBUG_PRINTF("[Mirror] Client #%u preview stopped\n", clientId);
+    }
+    xSemaphoreGive(_lock);
+}
+
+// ═══════════════════════════════════════════
+// Invio anteprima (task di rete)
+// ═══════════════════════════════════════════
+
+void FrameMirror::service(const SendFunction& send) {
+    if (_subscribers == 0) return;
+
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint32_t now = millis();
+    uint32_t seq = _snapshotSeq;
+
+    for (uint8_t i = 0; i < _subscribers && _snapshot && _scratch; i++) {
+        Client& client = _clients[i];
+        if (client.sentSeq == seq) continue;
+        if (now - client.lastSentMs < 1000u / client.fps) continue;
+
+        size_t len = client.reference ? encodeDelta(client.reference, seq) : 0;
+        if (len == FRAME_MIRROR_HEADER) {
+            // Frame identico a quello già inviato
+            client.sentSeq = seq;
+            continue;
+        }
+        if (len == 0) len = encodeKeyframe(seq);
+
+        // Coda del client piena: il riferimento resta l'ultimo frame inviato
+        if (!send(client.id, _scratch, len)) continue;
+
+        if (!client.reference) {
+            client.reference = (uint16_t*)malloc(_pixels * sizeof(uint16_t));
+        }
+        if (client.reference) memcpy(client.reference, _snapshot, _pixels * sizeof(uint16_t));
+        client.sentSeq = seq;
+        client.lastSentMs = now;
+        _framesSent++;
+        _bytesSent += len;
+    }
+    xSemaphoreGive(_lock);
+}
+
+// ═══════════════════════════════════════════
+// Codifica
+// ═══════════════════════════════════════════
+
+void FrameMirror::writeHeader(uint8_t type, uint16_t seq) {
+    _scratch[0] = type;
+    _scratch[1] = 0;
+    put16(_scratch + 2, _width);
+    put16(_scratch + 4, _height);
+    put16(_scratch + 6, seq);
+}
+
+size_t FrameMirror::encodeKeyframe(uint16_t seq) {
+    writeHeader(FRAME_MIRROR_KEYFRAME, seq);
+    memcpy(_scratch + FRAME_MIRROR_HEADER, _snapshot, _pixels * sizeof(uint16_t));
+    return FRAME_MIRROR_HEADER + _pixels * sizeof(uint16_t);
+}
+
+// 0 = il delta non è più corto del keyframe, FRAME_MIRROR_HEADER = nessun cambiamento
+size_t FrameMirror::encodeDelta(const uint16_t* reference, uint16_t seq) {
+    const uint16_t* frame = _snapshot;
+    uint8_t* out = _scratch + FRAME_MIRROR_HEADER;
+    size_t limit = _pixels * sizeof(uint16_t);
+    size_t pos = 0;
+    size_t i = 0;
+
+    while (i < _pixels) {
+        size_t start = i;
+        while (i < _pixels && frame[i] == reference[i] && i - start < 0xFFFF) i++;
+        if (i == _pixels) break;
+        size_t skip = i - start;
+
+        // Un pixel invariato isolato costa 2 byte nel blocco, 4 in un blocco nuovo
+        size_t literal = i;
+        while (i < _pixels && i - literal < 0xFFFF) {
+            if (frame[i] != reference[i]) {
+                i++;
+            } else if (i + 1 < _pixels && frame[i + 1] != reference[i + 1]) {
+                i++;
+            } else {
+                break;
+            }
+        }
+        size_t count = i - literal;
+
+        if (pos + 4 + count * 2 >= limit) return 0;
+        put16(out + pos, skip);
+        put16(out + pos + 2, count);
+        pos += 4;
+        for (size_t k = literal; k < i; k++) {
+            put16(out + pos, frame[k] ^ reference[k]);
+            pos += 2;
+        }
+    }
+
+    if (pos == 0) return FRAME_MIRROR_HEADER;
+    writeHeader(FRAME_MIRROR_DELTA, seq);
+    return FRAME_MIRROR_HEADER + pos;
+}
+
+// ═══════════════════════════════════════════
+// Buffer e client (chiamati con il lock preso)
+// ═══════════════════════════════════════════
+
+// Snapshot e scratch (messaggio codificato) servono solo all'anteprima
+bool FrameMirror::allocateBuffers() {
+    if (!_snapshot) {
+        _snapshot = (uint16_t*)malloc(_pixels * sizeof(uint16_t));
+        if (!_snapshot) return false;
+    }
+    if (!_scratch) {
+        _scratch = (uint8_t*)malloc(FRAME_MIRROR_HEADER + _pixels * sizeof(uint16_t));
+        if (!_scratch) return false;
+    }
+    return true;
+}
+
+void FrameMirror::releaseBuffers() {
+    free(_snapshot);
+    free(_scratch);
+    _snapshot = nullptr;
+    _scratch = nullptr;
+}
+
+void FrameMirror::updateCaptureInterval() {
+    uint8_t maxFps = 0;
+    for (uint8_t i = 0; i < _subscribers; i++) {
+        if (_clients[i].fps > maxFps) maxFps = _clients[i].fps;
+    }
+    _captureIntervalMs = maxFps ? 1000u / maxFps : 0;
+}
+
+FrameMirror::Client* FrameMirror::findClient(uint32_t clientId) {
+    for (uint8_t i = 0; i < _subscribers; i++) {
+        if (_clients[i].id == clientId) return &_clients[i];
+    }
+    return nullptr;
+}
@@ -0,0 +1,125 @@
+#ifndef FRAME_MIRROR_H
+#define FRAME_MIRROR_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "DisplayManager.h"
+#include "Debug.h"
+
+// ═══════════════════════════════════════════
+// Frame Mirror Configuration
+// ═══════════════════════════════════════════
+#ifndef FRAME_MIRROR_MAX_CLIENTS
+#define FRAME_MIRROR_MAX_CLIENTS 2      // Ogni client tiene un frame di riferimento
+#endif
+
+#define FRAME_MIRROR_MAX_FPS 30
+#define FRAME_MIRROR_HEADER 8
+#define FRAME_MIRROR_SNAPSHOT_WAIT_MS 100   // Oltre, /api/frame risponde con un frame nero
+
+// Tipo del messaggio binario di anteprima (byte 0 dell'header)
+#define FRAME_MIRROR_KEYFRAME 0x01
+#define FRAME_MIRROR_DELTA    0x02
+
+// Frame richiesto da /api/frame: lo riempie il task di render, la risposta
+// HTTP lo legge quando ready (vive finché uno dei due lo referenzia)
+struct FrameSnapshot {
+    uint16_t* pixels;
+    std::atomic<bool> ready;
+
+    FrameSnapshot() : pixels(nullptr), ready(false) {}
+    ~FrameSnapshot() { free(pixels); }
+};
+
+/**
+ * FrameMirror - Copia del framebuffer per /api/frame e l'anteprima WebSocket
+ *
+ * Il task di render copia il frame (RGB565, qualsiasi formato interno) in
+ * uno snapshot solo quando qualcuno lo aspetta, al ritmo del client più
+ * veloce. Il lock è preso senza attesa: se la rete sta leggendo lo
+ * snapshot il frame viene saltato, il render non si ferma mai.
+ * Nemmeno la rete aspetta il render: /api/frame riceve subito un
+ * FrameSnapshot e la risposta parte quando il frame è pronto.
+ *
+ * Messaggio binario di anteprima (little endian):
+ *   [0] tipo (1 = keyframe, 2 = delta)  [1] riservato
+ *   [2-3] larghezza  [4-5] altezza  [6-7] numero di sequenza
+ *   keyframe: larghezza*altezza pixel RGB565
+ *   delta:    sequenza di (skip u16, count u16, count × u16 XOR col frame
+ *             precedente); skip = pixel invariati prima del blocco
+ * Il delta è sempre contro l'ultimo frame inviato a quel client; se non
+ * è più corto del keyframe si invia il keyframe.
+ */
+class FrameMirror {
+public:
+    typedef std::function<bool(uint32_t clientId, const uint8_t* data, size_t len)> SendFunction;
+
+    FrameMirror();
+    ~FrameMirror();
+
+    void begin(uint16_t width, uint16_t height);
+
+    // Task di render: copia il frame se richiesto (mai bloccante)
+    void capture(const DisplayManager* display);
+
+    // /api/frame (mai bloccante): frame RGB565 riempito al prossimo capture(),
+    // condiviso tra le richieste in attesa; nullptr = memoria esaurita
+    std::shared_ptr<FrameSnapshot> requestSnapshot();
+    size_t getFrameBytes() const { return _pixels * sizeof(uint16_t); }
+
+    // Anteprima WebSocket (fps 0 = stop)
+    bool subscribe(uint32_t clientId, uint8_t fps);
+    void unsubscribe(uint32_t clientId);
+
+    // Task di rete: invia ai client in scadenza il nuovo frame
+    void service(const SendFunction& send);
+
+    uint16_t getWidth() const { return _width; }
+    uint16_t getHeight() const { return _height; }
+    uint8_t getSubscribers() const { return _subscribers; }
+    uint32_t getFramesSent() const { return _framesSent; }
+    uint32_t getBytesSent() const { return _bytesSent; }
+    uint32_t getCapturesSkipped() const { return _capturesSkipped; }
+
+private:
+    struct Client {
+        uint32_t id;
+        uint8_t fps;
+        uint32_t lastSentMs;
+        uint32_t sentSeq;
+        uint16_t* reference;        // nullptr = serve un keyframe
+    };
+
+    SemaphoreHandle_t _lock;
+    uint16_t _width;
+    uint16_t _height;
+    size_t _pixels;
+
+    uint16_t* _snapshot;
+    uint8_t* _scratch;
+    volatile uint32_t _snapshotSeq;
+    volatile uint32_t _captureIntervalMs;   // 0 = nessun client
+    volatile bool _snapshotRequested;
+    std::shared_ptr<FrameSnapshot> _pending;    // Sotto lock
+    uint32_t _lastCaptureMs;
+
+    Client _clients[FRAME_MIRROR_MAX_CLIENTS];
+    uint8_t _subscribers;
+
+    uint32_t _framesSent;
+    uint32_t _bytesSent;
+    uint32_t _capturesSkipped;
+
+    bool allocateBuffers();
+    void releaseBuffers();
+    void updateCaptureInterval();
+    Client* findClient(uint32_t clientId);
+
+    size_t encodeKeyframe(uint16_t seq);
+    size_t encodeDelta(const uint16_t* reference, uint16_t seq);
+    void writeHeader(uint8_t type, uint16_t seq);
+};
+
+#endif // FRAME_MIRROR_H
@@ -0,0 +1,148 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <vector>
+
+// Numero di glifi rasterizzati tenuti in RAM (LRU)
+#ifndef GLYPH_CACHE_SIZE
+#define GLYPH_CACHE_SIZE 24
+#endif
+
+/**
+ * Glifo GFXfont rasterizzato in span orizzontali a scala 1:
+ * ogni span è [riga][x][len] relativo all'angolo del bitmap del glifo.
+ * La scala (setTextSize) è applicata al momento del blit.
+ */
+struct CachedGlyph {
+    const GFXfont* font;
+    uint8_t c;
+    int8_t xOffset;
+    int8_t yOffset;
+    uint8_t xAdvance;
+    uint32_t lastUse;
+    std::vector<uint8_t> spans;
+
+    CachedGlyph() : font(nullptr), c(0), xOffset(0), yOffset(0), xAdvance(0), lastUse(0) {}
+    uint16_t spanCount() const { return spans.size() / 3; }
+};
+
+/**
+ * Cache LRU di glifi GFXfont già decodificati dal bitmap 1-bit in flash.
+ * Gli orologi ridisegnano sempre le stesse dieci cifre: dopo il primo
+ * frame il testo diventa una sequenza di fill orizzontali.
+ */
+class GlyphCache {
+private:
+    CachedGlyph entries[GLYPH_CACHE_SIZE];
+    uint32_t tick;
+    uint32_t hits;
+    uint32_t misses;
+
+    static void rasterize(CachedGlyph& entry, const GFXfont* font, const GFXglyph& glyph) {
+        entry.spans.clear();
+        entry.xOffset = glyph.xOffset;
+        entry.yOffset = glyph.yOffset;
+        entry.xAdvance = glyph.xAdvance;
+
+        const uint8_t* bitmap = (const uint8_t*)pgm_read_ptr(&font->bitmap);
+        uint16_t offset = glyph.bitmapOffset;
+        uint8_t bit = 0;
+        uint8_t bits = 0;
+
+        for (uint8_t yy = 0; yy < glyph.height; yy++) {
+            int runStart = -1;
+            for (uint8_t xx = 0; xx < glyph.width; xx++) {
+                if (!(bit & 7)) {
+                    bits = pgm_read_byte(&bitmap[offset++]);
+                }
+                bool on = bits & 0x80;
+                bits <<= 1;
+                bit++;
+
+                if (on && runStart < 0) {
+                    runStart = xx;
+                } else if (!on && runStart >= 0) {
+                    entry.spans.push_back(yy);
+                    entry.spans.push_back(runStart);
+                    entry.spans.push_back(xx - runStart);
+                    runStart = -1;
+                }
+            }
+            if (runStart >= 0) {
+                entry.spans.push_back(yy);
+                entry.spans.push_back(runStart);
+                entry.spans.push_back(glyph.width - runStart);
+            }
+        }
+    }
+
+public:
+    GlyphCache() : tick(0), hits(0), misses(0) {}
+
+    /**
+     * Restituisce il glifo rasterizzato di c, o nullptr se c non è nel font.
+     * In caso di miss rimpiazza la entry usata meno di recente.
+     */
+    const CachedGlyph* get(const GFXfont* font, char c) {
+        uint8_t ch = (uint8_t)c;
+        uint8_t first = pgm_read_byte(&font->first);
+        uint8_t last = pgm_read_byte(&font->last);
+        if (ch < first || ch > last) return nullptr;
+
+        tick++;
+        CachedGlyph* victim = &entries[0];
+        for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+            CachedGlyph& e = entries[i];
+            if (e.font == font && e.c == ch) {
+                e.lastUse = tick;
+                hits++;
+                return &e;
+            }
+            if (e.lastUse < victim->lastUse) victim = &e;
+        }
+
+        misses++;
+        GFXglyph* glyphTable = (GFXglyph*)pgm_read_ptr(&font->glyph);
+        GFXglyph glyph;
+        memcpy_P(&glyph, &glyphTable[ch - first], sizeof(GFXglyph));
+
+        victim->font = font;
+        victim->c = ch;
+        victim->lastUse = tick;
+        rasterize(*victim, font, glyph);
+        return victim;
+    }
+
+    void clear() {
+        for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+            entries[i].font = nullptr;
+            entries[i].lastUse = 0;
+            entries[i].spans.clear();
+        }
+    }
+
+    // Statistiche
+    uint32_t getHits() const { return hits; }
+    uint32_t getMisses() const { return misses; }
+    void resetStats() { hits = 0; misses = 0; }
+
+    uint8_t getUsedEntries() const {
+        uint8_t used = 0;
+        for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+            if (entries[i].font) used++;
+        }
+        return used;
+    }
+
+    uint32_t getBytes() const {
+        uint32_t bytes = sizeof(entries);
+        for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+            bytes += entries[i].spans.capacity();
+        }
+        return bytes;
+    }
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "ImageCodec.h"
+
+static inline uint8_t qimHash(uint16_t px) {
+    return ((px >> 11) * 3 + ((px >> 5) & 0x3F) * 5 + (px & 0x1F) * 7) & 63;
+}
+
+// Differenza con segno di un componente a bits bit (modulo 2^bits)
+static inline int wrapDiff(int a, int b, int bits) {
+    int range = 1 << bits;
+    int d = (a - b) & (range - 1);
+    return d >= range / 2 ? d - range : d;
+}
+
+// ═══════════════════════════════════════════
+// Codifica
+// ═══════════════════════════════════════════
+
+size_t qimEncode(const uint16_t* pixels, size_t count, uint8_t* out, size_t capacity) {
+    uint16_t index[64];
+    memset(index, 0, sizeof(index));
+    uint16_t prev = 0;
+    size_t n = 0;
+    uint8_t run = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint16_t px = pixels[i];
+
+        if (px == prev) {
+            run++;
+            if (run == QIM_RUN_MAX || i == count - 1) {
+                if (n + 1 > capacity) return 0;
+                out[n++] = QIM_OP_RUN | (run - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            if (n + 1 > capacity) return 0;
+            out[n++] = QIM_OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        uint8_t hash = qimHash(px);
+        if (index[hash] == px) {
+            if (n + 1 > capacity) return 0;
+            out[n++] = QIM_OP_INDEX | hash;
+        } else {
+            index[hash] = px;
+
+            int dr = wrapDiff(px >> 11, prev >> 11, 5);
+            int dg = wrapDiff((px >> 5) & 0x3F, (prev >> 5) & 0x3F, 6);
+            int db = wrapDiff(px & 0x1F, prev & 0x1F, 5);
+            // LUMA: dr-dg e db-dg modulo 32 (il decoder somma e maschera)
+            int drdg = wrapDiff(dr - dg, 0, 5);
+            int dbdg = wrapDiff(db - dg, 0, 5);
+
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                if (n + 1 > capacity) return 0;
+                out[n++] = QIM_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+            } else if (drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7) {
+                if (n + 2 > capacity) return 0;
+                out[n++] = QIM_OP_LUMA | (dg + 32);
+                out[n++] = ((drdg + 8) << 4) | (dbdg + 8);
+            } else {
+                if (n + QIM_MAX_OP_SIZE > capacity) return 0;
+                out[n++] = QIM_OP_RGB;
+                out[n++] = px & 0xFF;
+                out[n++] = px >> 8;
+            }
+        }
+        prev = px;
+    }
+
+    return n;
+}
+
+// ═══════════════════════════════════════════
+// Decodifica
+// ═══════════════════════════════════════════
+
+void QimDecoder::begin(uint16_t* out, size_t pixels) {
+    _out = out;
+    _pixels = pixels;
+    _pos = 0;
+    _prev = 0;
+    memset(_index, 0, sizeof(_index));
+    _error = false;
+}
+
+size_t QimDecoder::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+
+    while (_pos < _pixels && i < len) {
+        uint8_t op = data[i];
+        uint16_t px;
+
+        if (op == QIM_OP_RGB) {
+            if (len - i < 3) break;
+            px = data[i + 1] | (data[i + 2] << 8);
+            i += 3;
+        } else {
+            switch (op & QIM_MASK) {
+                case QIM_OP_INDEX:
+                    px = _index[op];
+                    i++;
+                    break;
+
+                case QIM_OP_DIFF: {
+                    int r = ((_prev >> 11) + ((op >> 4) & 3) - 2) & 0x1F;
+                    int g = (((_prev >> 5) & 0x3F) + ((op >> 2) & 3) - 2) & 0x3F;
+                    int b = ((_prev & 0x1F) + (op & 3) - 2) & 0x1F;
+                    px = (r << 11) | (g << 5) | b;
+                    i++;
+                    break;
+                }
+
+                case QIM_OP_LUMA: {
+                    if (len - i < 2) return i;
+                    int dg = (op & 0x3F) - 32;
+                    uint8_t rb = data[i + 1];
+                    int r = ((_prev >> 11) + dg + (rb >> 4) - 8) & 0x1F;
+                    int g = (((_prev >> 5) & 0x3F) + dg) & 0x3F;
+                    int b = ((_prev & 0x1F) + dg + (rb & 0x0F) - 8) & 0x1F;
+                    px = (r << 11) | (g << 5) | b;
+                    i += 2;
+                    break;
+                }
+
+                default: {
+                    // RUN (0xFF non è un op valido)
+                    size_t run = (op & 0x3F) + 1;
+                    if (run > QIM_RUN_MAX || _pos + run > _pixels) {
+                        _error = true;
+                        return i;
+                    }
+                    for (size_t k = 0; k < run; k++) _out[_pos++] = _prev;
+                    i++;
+                    continue;
+                }
+            }
+        }
+
+        _index[qimHash(px)] = px;
+        _out[_pos++] = px;
+        _prev = px;
+    }
+
+    return i;
+}
@@ -0,0 +1,53 @@
+#ifndef IMAGE_CODEC_H
+#define IMAGE_CODEC_H
+
+#include <Arduino.h>
+
+// Formato .qim: compressione stile QOI adattata a RGB565
+//   header  "QIM1", u16 width, u16 height (little-endian)
+//   op      0b00iiiiii  INDEX  pixel dalla tabella hash (64 voci)
+//           0b01rrggbb  DIFF   dr/dg/db -2..1 (modulo 32/64/32)
+//           0b10gggggg  LUMA   dg -32..31, poi byte (dr-dg+8)<<4 | (db-dg+8)
+//           0b11nnnnnn  RUN    ripete il pixel precedente n+1 volte (1..62)
+//           0xFE        RGB    pixel RGB565 u16 LE
+// Pixel iniziale nero; la tabella si aggiorna a ogni pixel tranne RUN.
+#define QIM_MAGIC "QIM1"
+#define QIM_HEADER_SIZE 8
+#define QIM_MAX_OP_SIZE 3       // RGB: tag + 2 byte
+
+#define QIM_OP_INDEX 0x00
+#define QIM_OP_DIFF  0x40
+#define QIM_OP_LUMA  0x80
+#define QIM_OP_RUN   0xC0
+#define QIM_OP_RGB   0xFE
+#define QIM_MASK     0xC0
+#define QIM_RUN_MAX  62
+
+/**
+ * Codifica count pixel in out (header escluso). Ritorna i byte scritti,
+ * 0 se il risultato non sta in capacity (conviene il formato raw).
+ */
+size_t qimEncode(const uint16_t* pixels, size_t count, uint8_t* out, size_t capacity);
+
+/**
+ * QimDecoder - Decodifica incrementale: feed() consuma solo op complete e
+ * ritorna i byte usati, il chiamante riporta in testa quelli avanzati.
+ * Nessun buffer oltre all'uscita: decodifica a blocchi dal file.
+ */
+class QimDecoder {
+public:
+    void begin(uint16_t* out, size_t pixels);
+    size_t feed(const uint8_t* data, size_t len);
+    bool isDone() const { return _pos >= _pixels; }
+    bool hasError() const { return _error; }
+
+private:
+    uint16_t* _out;
+    size_t _pixels;
+    size_t _pos;
+    uint16_t _prev;
+    uint16_t _index[64];
+    bool _error;
+};
+
+#endif // IMAGE_CODEC_H
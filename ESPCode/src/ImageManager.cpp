@@ -1,5 +1,11 @@
 #include "ImageManager.h"
+#include "AnimationPlayer.h"
+#include "PngDecoder.h"
 #include "Debug.h"
+#include <rom/crc.h>
+
+#define IMAGE_MANIFEST_PATH "/images/index.bin"
+#define IMAGE_MANIFEST_TMP "/images/index.tmp"
 
 // Helper base64 decode (stesso di CommandHandler)
 static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -13,7 +19,25 @@ static int base64CharIndex(char c) {
     return -1;
 }
 
-ImageManager::ImageManager() : _initialized(false) {}
+ImageManager::ImageManager()
+    : _initialized(false)
+    , _generation(0)
+    , _lastLoadUs(0)
+    , _loadCount(0)
+    , _loadTotalUs(0)
+    , _loadBuffer(nullptr)
+    , _loadCompressed(false)
+    , _loadOffset(0)
+    , _loadRead(0)
+    , _loadCrc(0)
+    , _loadVerify(false)
+    , _loadExpectedSize(0)
+    , _loadExpectedCrc(0)
+    , _loadChunkLen(0)
+    , _loadUs(0)
+    , _animUploadSize(0)
+    , _animUploadWritten(0)
+{}
 
 bool ImageManager::begin() {
     if (!LittleFS.begin(true)) {  // format on fail
@@ -27,6 +51,11 @@ bool ImageManager::begin() {
                  getUsedSpace() / 1024,
                  getFreeSpace() / 1024);
 
+    // Manifest assente o corrotto (primo avvio, firmware precedente): scansione
+    if (!loadManifest()) {
+        rebuildManifest();
+    }
+
     return true;
 }
 
@@ -34,12 +63,25 @@ String ImageManager::getImagePath(const String& name) {
     return "/images/" + name + ".img";
 }
 
+String ImageManager::getCompressedPath(const String& name) {
+    return "/images/" + name + ".qim";
+}
+
+String ImageManager::getAnimationPath(const String& name) {
+    return "/anims/" + name + ".anm";
+}
+
 bool ImageManager::uploadImage(const String& name, const String& base64Data) {
     if (!_initialized) {
         DEBUG_PRINTLN(F("[ImageMgr] Not initialized"));
         return false;
     }
 
+    if (name.length() == 0 || name.length() >= IMAGE_NAME_MAX) {
+        DEBUG_PRINTF("[ImageMgr] Invalid name length: %d\n", name.length());
+        return false;
+    }
+
     // Verifica dimensione base64 (~8KB per 64x64 RGB565)
     if (base64Data.length() < 8000 || base64Data.length() > 12000) {
         DEBUG_PRINTF("[ImageMgr] Invalid base64 size: %d\n", base64Data.length());
@@ -60,83 +102,339 @@ bool ImageManager::uploadImage(const String& name, const String& base64Data) {
         return false;
     }
 
+    bool ok = storeImage(name, (const uint16_t*)imageData);
+    free(imageData);
+    return ok;
+}
+
+// Salva in .qim se la compressione conviene, altrimenti in .img raw;
+// l'altro formato con lo stesso nome viene rimosso
+bool ImageManager::storeImage(const String& name, const uint16_t* pixels) {
     // Crea directory se non esiste
     if (!LittleFS.exists("/images")) {
         LittleFS.mkdir("/images");
     }
 
+    uint8_t* packed = (uint8_t*)malloc(IMAGE_SIZE);
+    size_t packedSize = 0;
+    if (packed) {
+        memcpy(packed, QIM_MAGIC, 4);
+        packed[4] = IMAGE_WIDTH & 0xFF;
+        packed[5] = IMAGE_WIDTH >> 8;
+        packed[6] = IMAGE_HEIGHT & 0xFF;
+        packed[7] = IMAGE_HEIGHT >> 8;
+        size_t encoded = qimEncode(pixels, IMAGE_WIDTH * IMAGE_HEIGHT, packed + QIM_HEADER_SIZE,
+                                   IMAGE_SIZE - QIM_HEADER_SIZE - 1);
+        if (encoded > 0) packedSize = QIM_HEADER_SIZE + encoded;
+    }
+
+    bool compressed = packedSize > 0;
+    String path = compressed ? getCompressedPath(name) : getImagePath(name);
+    const uint8_t* data = compressed ? packed : (const uint8_t*)pixels;
+    size_t size = compressed ? packedSize : IMAGE_SIZE;
+
     // Salva file
-    String path = getImagePath(name);
     File file = LittleFS.open(path, "w");
     if (!file) {
         DEBUG_PRINTF("[ImageMgr] Failed to create file: %s\n", path.c_str());
-        free(imageData);
+        free(packed);
         return false;
     }
 
-    size_t written = file.write(imageData, IMAGE_SIZE);
+    size_t written = file.write(data, size);
     file.close();
-    free(imageData);
+    uint32_t crc = crc32_le(0, data, size);
+    free(packed);
 
-    if (written != IMAGE_SIZE) {
-        DEBUG_PRINTF("[ImageMgr] Write failed: %d/%d bytes\n", written, IMAGE_SIZE);
+    if (written != size) {
+        DEBUG_PRINTF("[ImageMgr] Write failed: %d/%d bytes\n", written, size);
         LittleFS.remove(path);
         return false;
     }
 
-    DEBUG_PRINTF("[ImageMgr] Image '%s' uploaded successfully (%d bytes)\n", name.c_str(), IMAGE_SIZE);
+    LittleFS.remove(compressed ? getImagePath(name) : getCompressedPath(name));
+
+    updateEntry(name, size, compressed ? IMAGE_FORMAT_QIM : IMAGE_FORMAT_RAW, crc);
+    saveManifest();
+
+    DEBUG_PRINTF("[ImageMgr] Image '%s' saved: %d bytes (%s, %d%% of raw)\n", name.c_str(), size,
+                 compressed ? "qim" : "raw", (int)(size * 100 / IMAGE_SIZE));
     return true;
 }
 
-bool ImageManager::loadImage(const String& name, uint16_t* buffer) {
-    if (!_initialized || !buffer) {
+bool ImageManager::installImage(const String& name, const char* tmpPath, uint32_t size, uint32_t crc, bool resize) {
+    if (!_initialized || name.length() == 0 || name.length() >= IMAGE_NAME_MAX) {
         return false;
     }
 
-    String path = getImagePath(name);
-    if (!LittleFS.exists(path)) {
-        DEBUG_PRINTF("[ImageMgr] Image not found: %s\n", path.c_str());
+    uint8_t header[QIM_HEADER_SIZE];
+    File file = LittleFS.open(tmpPath, "r");
+    bool read = file && file.read(header, sizeof(header)) == sizeof(header);
+    if (file) file.close();
+
+    if (read && PngDecoder::isPng(header, sizeof(header))) {
+        return installPng(name, tmpPath, resize);
+    }
+
+    bool compressed = read && size < IMAGE_SIZE && memcmp(header, QIM_MAGIC, 4) == 0 &&
+                      (header[4] | (header[5] << 8)) == IMAGE_WIDTH &&
+                      (header[6] | (header[7] << 8)) == IMAGE_HEIGHT;
+    if (!compressed && (!read || size != IMAGE_SIZE)) {
+        DEBUG_PRINTF("[ImageMgr] Invalid image file: %u bytes\n", size);
+        return false;
+    }
+
+    String path = compressed ? getCompressedPath(name) : getImagePath(name);
+    LittleFS.remove(path);
+    if (!LittleFS.rename(tmpPath, path)) {
+        DEBUG_PRINTF("[ImageMgr] Rename failed: %s\n", path.c_str());
         return false;
     }
+    LittleFS.remove(compressed ? getImagePath(name) : getCompressedPath(name));
+
+    updateEntry(name, size, compressed ? IMAGE_FORMAT_QIM : IMAGE_FORMAT_RAW, crc);
+    saveManifest();
 
-    File file = LittleFS.open(path, "r");
+    DEBUG_PRINTF("[ImageMgr] Image '%s' installed: %u bytes (%s)\n", name.c_str(), size,
+                 compressed ? "qim" : "raw");
+    return true;
+}
+
+// PNG letto a blocchi dal file temporaneo e decodificato riga per riga
+bool ImageManager::installPng(const String& name, const char* tmpPath, bool resize) {
+    File file = LittleFS.open(tmpPath, "r");
     if (!file) {
-        DEBUG_PRINTF("[ImageMgr] Failed to open: %s\n", path.c_str());
         return false;
     }
 
-    size_t read = file.read((uint8_t*)buffer, IMAGE_SIZE);
+    uint32_t t0 = micros();
+    uint16_t* pixels = (uint16_t*)malloc(IMAGE_SIZE);
+    PngDecoder* png = new PngDecoder();
+    bool ok = pixels && png->begin(pixels, IMAGE_WIDTH, IMAGE_HEIGHT, resize);
+
+    uint8_t chunk[IMAGE_DECODE_CHUNK];
+    size_t got;
+    while (ok && !png->isDone() && (got = file.read(chunk, sizeof(chunk))) > 0) {
+        ok = png->feed(chunk, got);
+    }
     file.close();
 
-    if (read != IMAGE_SIZE) {
-        DEBUG_PRINTF("[ImageMgr] Read failed: %d/%d bytes\n", read, IMAGE_SIZE);
+    ok = ok && png->isDone();
+    if (ok) {
+        DEBUG_PRINTF("[ImageMgr] PNG %ux%u decoded in %u us\n", png->getWidth(), png->getHeight(),
+                     micros() - t0);
+    } else {
+        DEBUG_PRINTF("[ImageMgr] PNG decode failed: %s\n", png->getError() ? png->getError() : "truncated");
+    }
+    delete png;
+
+    // Salvato come un upload base64: .qim se conviene, altrimenti .img
+    ok = ok && storeImage(name, pixels);
+    free(pixels);
+    LittleFS.remove(tmpPath);
+    return ok;
+}
+
+bool ImageManager::installDecoded(const String& name, const char* tmpPath, const uint16_t* pixels) {
+    bool ok = storeImage(name, pixels);
+    LittleFS.remove(tmpPath);
+    return ok;
+}
+
+bool ImageManager::loadImage(const String& name, uint16_t* buffer) {
+    if (!beginLoad(name, buffer)) {
+        return false;
+    }
+
+    ImageLoadStatus status;
+    do {
+        status = stepLoad(IMAGE_SIZE);
+    } while (status == IMAGE_LOAD_PENDING);
+
+    return status == IMAGE_LOAD_DONE;
+}
+
+// ═══════════════════════════════════════════
+// Caricamento incrementale
+// ═══════════════════════════════════════════
+
+bool ImageManager::beginLoad(const String& name, uint16_t* buffer) {
+    cancelLoad();
+    if (!_initialized || !buffer) {
+        return false;
+    }
+
+    uint32_t t0 = micros();
+
+    // Formato dal manifest; senza voce si cerca su flash (prima il .qim)
+    int index = findEntry(name);
+    bool compressed;
+    if (index >= 0) {
+        compressed = _manifest[index].format == IMAGE_FORMAT_QIM;
+    } else {
+        compressed = LittleFS.exists(getCompressedPath(name));
+        if (!compressed && !LittleFS.exists(getImagePath(name))) {
+            DEBUG_PRINTF("[ImageMgr] Image not found: %s\n", name.c_str());
+            return false;
+        }
+    }
+    String path = compressed ? getCompressedPath(name) : getImagePath(name);
+
+    _loadFile = LittleFS.open(path, "r");
+    if (!_loadFile) {
+        DEBUG_PRINTF("[ImageMgr] Failed to open: %s\n", path.c_str());
         return false;
     }
 
+    if (compressed) {
+        uint8_t* header = _loadChunk;
+        if (_loadFile.read(header, QIM_HEADER_SIZE) != QIM_HEADER_SIZE || memcmp(header, QIM_MAGIC, 4) != 0 ||
+            (header[4] | (header[5] << 8)) != IMAGE_WIDTH || (header[6] | (header[7] << 8)) != IMAGE_HEIGHT) {
+            DEBUG_PRINTLN(F("[ImageMgr] Invalid compressed header"));
+            _loadFile.close();
+            return false;
+        }
+        _loadDecoder.begin(buffer, IMAGE_WIDTH * IMAGE_HEIGHT);
+        _loadCrc = crc32_le(0, header, QIM_HEADER_SIZE);
+        _loadRead = QIM_HEADER_SIZE;
+    } else {
+        _loadCrc = 0;
+        _loadRead = 0;
+    }
+
+    _loadVerify = index >= 0;
+    if (_loadVerify) {
+        _loadExpectedSize = _manifest[index].size;
+        _loadExpectedCrc = _manifest[index].crc;
+    }
+
+    _loadBuffer = buffer;
+    _loadCompressed = compressed;
+    _loadOffset = 0;
+    _loadChunkLen = 0;
+    _loadUs = micros() - t0;
     return true;
 }
 
+ImageLoadStatus ImageManager::stepLoad(size_t maxBytes) {
+    if (!_loadBuffer) {
+        return IMAGE_LOAD_ERROR;
+    }
+
+    uint32_t t0 = micros();
+    bool done;
+    bool error = false;
+
+    if (!_loadCompressed) {
+        size_t n = IMAGE_SIZE - _loadOffset;
+        if (n > maxBytes) n = maxBytes;
+        size_t got = _loadFile.read((uint8_t*)_loadBuffer + _loadOffset, n);
+        _loadCrc = crc32_le(_loadCrc, (uint8_t*)_loadBuffer + _loadOffset, got);
+        _loadRead += got;
+        _loadOffset += got;
+        error = got == 0;
+        done = _loadOffset == IMAGE_SIZE;
+        if (error) {
+            DEBUG_PRINTF("[ImageMgr] Read failed: %d/%d bytes\n", _loadOffset, IMAGE_SIZE);
+        }
+    } else {
+        // Decodifica a blocchi direttamente nel buffer di destinazione
+        size_t budget = maxBytes;
+        while (budget > 0 && !_loadDecoder.isDone()) {
+            size_t n = sizeof(_loadChunk) - _loadChunkLen;
+            if (n > budget) n = budget;
+            size_t got = _loadFile.read(_loadChunk + _loadChunkLen, n);
+            _loadCrc = crc32_le(_loadCrc, _loadChunk + _loadChunkLen, got);
+            _loadRead += got;
+            budget -= n;
+            _loadChunkLen += got;
+
+            size_t used = _loadDecoder.feed(_loadChunk, _loadChunkLen);
+            if (_loadDecoder.hasError() || (got == 0 && used == 0)) {
+                DEBUG_PRINTLN(F("[ImageMgr] Corrupted compressed image"));
+                error = true;
+                break;
+            }
+            // Un op a cavallo del blocco resta in testa per il giro successivo
+            memmove(_loadChunk, _loadChunk + used, _loadChunkLen - used);
+            _loadChunkLen -= used;
+        }
+        done = _loadDecoder.isDone();
+    }
+
+    _loadUs += micros() - t0;
+
+    if (error) {
+        cancelLoad();
+        return IMAGE_LOAD_ERROR;
+    }
+    if (!done) {
+        return IMAGE_LOAD_PENDING;
+    }
+
+    // CRC solo se il file è stato letto tutto (il .qim finisce con l'ultimo op)
+    if (_loadVerify && _loadRead == _loadExpectedSize && _loadCrc != _loadExpectedCrc) {
+        DEBUG_PRINTF("[ImageMgr] CRC mismatch: %08X != %08X\n", _loadCrc, _loadExpectedCrc);
+        cancelLoad();
+        return IMAGE_LOAD_ERROR;
+    }
+
+    _lastLoadUs = _loadUs;
+    _loadTotalUs += _loadUs;
+    _loadCount++;
+    cancelLoad();
+    return IMAGE_LOAD_DONE;
+}
+
+void ImageManager::cancelLoad() {
+    if (_loadFile) {
+        _loadFile.close();
+    }
+    _loadBuffer = nullptr;
+}
+
 std::vector<ImageInfo> ImageManager::listImages() {
     std::vector<ImageInfo> images;
+    images.reserve(_manifest.size());
+
+    for (const auto& entry : _manifest) {
+        ImageInfo info;
+        info.name = entry.name;
+        info.compressed = entry.format == IMAGE_FORMAT_QIM;
+        info.path = info.compressed ? getCompressedPath(info.name) : getImagePath(info.name);
+        info.size = entry.size;
+        images.push_back(info);
+    }
+    return images;
+}
+
+const ImageEntry* ImageManager::getImageEntry(size_t index) const {
+    return index < _manifest.size() ? &_manifest[index] : nullptr;
+}
+
+std::vector<ImageInfo> ImageManager::listFiles(const char* dir, const char* ext) {
+    std::vector<ImageInfo> images;
 
     if (!_initialized) {
         return images;
     }
 
-    File root = LittleFS.open("/images");
+    File root = LittleFS.open(dir);
     if (!root || !root.isDirectory()) {
         return images;
     }
 
+    String prefix = String(dir) + "/";
     File file = root.openNextFile();
     while (file) {
-        if (!file.isDirectory() && String(file.name()).endsWith(".img")) {
+        if (!file.isDirectory() && String(file.name()).endsWith(ext)) {
             ImageInfo info;
             info.path = file.name();
             info.name = String(file.name());
-            info.name.replace("/images/", "");
-            info.name.replace(".img", "");
+            info.name.replace(prefix, "");
+            info.name.replace(ext, "");
             info.size = file.size();
+            info.compressed = false;
             images.push_back(info);
         }
         file = root.openNextFile();
@@ -150,8 +448,13 @@ bool ImageManager::deleteImage(const String& name) {
         return false;
     }
 
-    String path = getImagePath(name);
-    if (LittleFS.remove(path)) {
+    bool raw = LittleFS.remove(getImagePath(name));
+    bool compressed = LittleFS.remove(getCompressedPath(name));
+    bool listed = removeEntry(name);
+    if (listed) {
+        saveManifest();
+    }
+    if (raw || compressed || listed) {
         DEBUG_PRINTF("[ImageMgr] Deleted: %s\n", name.c_str());
         return true;
     }
@@ -175,7 +478,307 @@ bool ImageManager::exists(const String& name) {
     if (!_initialized) {
         return false;
     }
-    return LittleFS.exists(getImagePath(name));
+    return findEntry(name) >= 0;
+}
+
+int ImageManager::compactImages() {
+    if (!_initialized) {
+        return 0;
+    }
+
+    uint16_t* pixels = (uint16_t*)malloc(IMAGE_SIZE);
+    if (!pixels) {
+        DEBUG_PRINTLN(F("[ImageMgr] Failed to allocate buffer"));
+        return 0;
+    }
+
+    // Nomi copiati prima: storeImage() aggiorna il manifest
+    std::vector<String> raw;
+    for (const auto& entry : _manifest) {
+        if (entry.format == IMAGE_FORMAT_RAW) raw.push_back(entry.name);
+    }
+
+    int converted = 0;
+    for (const auto& name : raw) {
+        // storeImage() lascia il raw se la compressione non conviene
+        if (loadImage(name, pixels) && storeImage(name, pixels) &&
+            _manifest[findEntry(name)].format == IMAGE_FORMAT_QIM) {
+            converted++;
+        }
+    }
+
+    free(pixels);
+    DEBUG_PRINTF("[ImageMgr] Compacted %d images\n", converted);
+    return converted;
+}
+
+// ═══════════════════════════════════════════
+// Manifest
+// ═══════════════════════════════════════════
+
+bool ImageManager::loadManifest() {
+    _manifest.clear();
+
+    File file = LittleFS.open(IMAGE_MANIFEST_PATH, "r");
+    if (!file) {
+        DEBUG_PRINTLN(F("[ImageMgr] No manifest"));
+        return false;
+    }
+
+    uint8_t header[IMAGE_MANIFEST_HEADER];
+    bool ok = file.read(header, sizeof(header)) == sizeof(header) &&
+              memcmp(header, IMAGE_MANIFEST_MAGIC, 4) == 0;
+    uint16_t count = header[4] | (header[5] << 8);
+    uint16_t entrySize = header[6] | (header[7] << 8);
+    ok = ok && entrySize == sizeof(ImageEntry) &&
+         file.size() == IMAGE_MANIFEST_HEADER + (size_t)count * sizeof(ImageEntry);
+
+    if (ok) {
+        _manifest.resize(count);
+        ok = count == 0 || file.read((uint8_t*)_manifest.data(), count * sizeof(ImageEntry)) == count * sizeof(ImageEntry);
+    }
+    file.close();
+
+    if (!ok) {
+        DEBUG_PRINTLN(F("[ImageMgr] Invalid manifest"));
+        _manifest.clear();
+        return false;
+    }
+    for (auto& entry : _manifest) {
+        entry.name[IMAGE_NAME_MAX - 1] = '\0';
+    }
+
+    DEBUG_PRINTF("[ImageMgr] Manifest: %u images\n", _manifest.size());
+    return true;
+}
+
+// Scrittura su file temporaneo e rename: un reset a metà lascia il manifest precedente
+bool ImageManager::saveManifest() {
+    if (!LittleFS.exists("/images")) {
+        LittleFS.mkdir("/images");
+    }
+
+    File file = LittleFS.open(IMAGE_MANIFEST_TMP, "w");
+    if (!file) {
+        DEBUG_PRINTLN(F("[ImageMgr] Failed to create manifest"));
+        return false;
+    }
+
+    uint8_t header[IMAGE_MANIFEST_HEADER];
+    memcpy(header, IMAGE_MANIFEST_MAGIC, 4);
+    header[4] = _manifest.size() & 0xFF;
+    header[5] = _manifest.size() >> 8;
+    header[6] = sizeof(ImageEntry) & 0xFF;
+    header[7] = sizeof(ImageEntry) >> 8;
+
+    size_t bytes = _manifest.size() * sizeof(ImageEntry);
+    bool ok = file.write(header, sizeof(header)) == sizeof(header) &&
+              (bytes == 0 || file.write((const uint8_t*)_manifest.data(), bytes) == bytes);
+    file.close();
+
+    if (!ok || !LittleFS.rename(IMAGE_MANIFEST_TMP, IMAGE_MANIFEST_PATH)) {
+        DEBUG_PRINTLN(F("[ImageMgr] Failed to write manifest"));
+        LittleFS.remove(IMAGE_MANIFEST_TMP);
+        return false;
+    }
+    return true;
+}
+
+bool ImageManager::rebuildManifest() {
+    if (!_initialized) {
+        return false;
+    }
+
+    _manifest.clear();
+    uint8_t chunk[IMAGE_DECODE_CHUNK];
+
+    std::vector<ImageInfo> files = listFiles("/images", ".img");
+    std::vector<ImageInfo> compressed = listFiles("/images", ".qim");
+    for (auto& info : compressed) {
+        info.compressed = true;
+        files.push_back(info);
+    }
+
+    for (const auto& info : files) {
+        if (info.name.length() >= IMAGE_NAME_MAX) {
+            DEBUG_PRINTF("[ImageMgr] Name too long, skipped: %s\n", info.name.c_str());
+            continue;
+        }
+
+        String path = info.compressed ? getCompressedPath(info.name) : getImagePath(info.name);
+        File file = LittleFS.open(path, "r");
+        if (!file) continue;
+
+        uint32_t crc = 0;
+        size_t got;
+        while ((got = file.read(chunk, sizeof(chunk))) > 0) {
+            crc = crc32_le(crc, chunk, got);
+        }
+        file.close();
+
+        // Stesso nome in entrambi i formati: vince il .qim (come loadImage)
+        updateEntry(info.name, info.size, info.compressed ? IMAGE_FORMAT_QIM : IMAGE_FORMAT_RAW, crc);
+    }
+
+    DEBUG_PRINTF("[ImageMgr] Manifest rebuilt: %u images\n", _manifest.size());
+    return saveManifest();
+}
+
+int ImageManager::findEntry(const String& name) const {
+    for (size_t i = 0; i < _manifest.size(); i++) {
+        if (strcmp(_manifest[i].name, name.c_str()) == 0) return i;
+    }
+    return -1;
+}
+
+// Nuova voce in coda (ordine di upload), oppure aggiornata al suo posto
+void ImageManager::updateEntry(const String& name, uint32_t size, ImageFormat format, uint32_t crc) {
+    int index = findEntry(name);
+    if (index < 0) {
+        ImageEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        strncpy(entry.name, name.c_str(), IMAGE_NAME_MAX - 1);
+        _manifest.push_back(entry);
+        index = _manifest.size() - 1;
+    }
+    _manifest[index].size = size;
+    _manifest[index].format = format;
+    _manifest[index].crc = crc;
+    _generation++;
+}
+
+bool ImageManager::removeEntry(const String& name) {
+    int index = findEntry(name);
+    if (index < 0) return false;
+    _manifest.erase(_manifest.begin() + index);
+    _generation++;
+    return true;
+}
+
+// ═══════════════════════════════════════════
+// Animazioni
+// ═══════════════════════════════════════════
+
+bool ImageManager::beginAnimationUpload(const String& name, size_t size) {
+    if (!_initialized) {
+        DEBUG_PRINTLN(F("[ImageMgr] Not initialized"));
+        return false;
+    }
+
+    abortAnimationUpload();
+
+    if (size < ANIM_HEADER_SIZE + ANIM_RECORD_HEADER || size > ANIM_MAX_FILE_SIZE) {
+        DEBUG_PRINTF("[ImageMgr] Invalid animation size: %u\n", size);
+        return false;
+    }
+    if (size > getFreeSpace()) {
+        DEBUG_PRINTF("[ImageMgr] Not enough space: %u > %u\n", size, getFreeSpace());
+        return false;
+    }
+
+    if (!LittleFS.exists("/anims")) {
+        LittleFS.mkdir("/anims");
+    }
+
+    _animUploadFile = LittleFS.open("/anims/upload.tmp", "w");
+    if (!_animUploadFile) {
+        DEBUG_PRINTLN(F("[ImageMgr] Failed to create upload file"));
+        return false;
+    }
+
+    _animUploadName = name;
+    _animUploadSize = size;
+    _animUploadWritten = 0;
+    DEBUG_PRINTF("[ImageMgr] Animation upload '%s' started (%u bytes)\n", name.c_str(), size);
+    return true;
+}
+
+bool ImageManager::writeAnimationChunk(const uint8_t* data, size_t len) {
+    if (!_animUploadFile || _animUploadWritten + len > _animUploadSize) {
+        return false;
+    }
+
+    size_t written = _animUploadFile.write(data, len);
+    _animUploadWritten += written;
+    if (written != len) {
+        DEBUG_PRINTF("[ImageMgr] Animation write failed: %u/%u bytes\n", written, len);
+        abortAnimationUpload();
+        return false;
+    }
+    return true;
+}
+
+bool ImageManager::endAnimationUpload() {
+    if (!_animUploadFile) {
+        return false;
+    }
+    _animUploadFile.close();
+
+    if (_animUploadWritten != _animUploadSize) {
+        DEBUG_PRINTF("[ImageMgr] Animation incomplete: %u/%u bytes\n", _animUploadWritten, _animUploadSize);
+        LittleFS.remove("/anims/upload.tmp");
+        return false;
+    }
+
+    // Header valido prima di sostituire un'animazione con lo stesso nome
+    File check = LittleFS.open("/anims/upload.tmp", "r");
+    AnimationHeader header;
+    bool valid = check && AnimationPlayer::readHeader(check, header);
+    if (check) check.close();
+    if (!valid) {
+        DEBUG_PRINTLN(F("[ImageMgr] Invalid animation header"));
+        LittleFS.remove("/anims/upload.tmp");
+        return false;
+    }
+
+    String path = getAnimationPath(_animUploadName);
+    LittleFS.remove(path);
+    if (!LittleFS.rename("/anims/upload.tmp", path)) {
+        DEBUG_PRINTF("[ImageMgr] Rename failed: %s\n", path.c_str());
+        LittleFS.remove("/anims/upload.tmp");
+        return false;
+    }
+
+    DEBUG_PRINTF("[ImageMgr] Animation '%s' uploaded: %ux%u, %u frames (%u bytes)\n",
+                 _animUploadName.c_str(), header.width, header.height, header.frameCount,
+                 _animUploadSize);
+    return true;
+}
+
+void ImageManager::abortAnimationUpload() {
+    if (!_animUploadFile) return;
+    _animUploadFile.close();
+    LittleFS.remove("/anims/upload.tmp");
+    DEBUG_PRINTLN(F("[ImageMgr] Animation upload aborted"));
+}
+
+File ImageManager::openAnimation(const String& name) {
+    if (!_initialized) {
+        return File();
+    }
+    String path = getAnimationPath(name);
+    if (!LittleFS.exists(path)) {
+        DEBUG_PRINTF("[ImageMgr] Animation not found: %s\n", path.c_str());
+        return File();
+    }
+    return LittleFS.open(path, "r");
+}
+
+std::vector<ImageInfo> ImageManager::listAnimations() {
+    return listFiles("/anims", ".anm");
+}
+
+bool ImageManager::deleteAnimation(const String& name) {
+    if (!_initialized) {
+        return false;
+    }
+
+    if (LittleFS.remove(getAnimationPath(name))) {
+        DEBUG_PRINTF("[ImageMgr] Deleted animation: %s\n", name.c_str());
+        return true;
+    }
+
+    return false;
 }
 
 // Base64 decode
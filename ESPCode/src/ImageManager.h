@@ -5,16 +5,54 @@
 #include <FS.h>
 #include <LittleFS.h>
 #include <vector>
+#include "ImageCodec.h"
 
 // Formato immagine: raw RGB565 64x64 pixels
 #define IMAGE_WIDTH 64
 #define IMAGE_HEIGHT 64
 #define IMAGE_SIZE (IMAGE_WIDTH * IMAGE_HEIGHT * 2)  // 2 bytes per pixel (RGB565)
 
+// Su flash: .qim compresso (ImageCodec.h) se più piccolo, altrimenti .img raw
+#define IMAGE_DECODE_CHUNK 256      // Lettura flash per blocco di decodifica
+
+// Manifest /images/index.bin: header "IMX1", u16 count, u16 entrySize, poi
+// count record ImageEntry nell'ordine di upload. Caricato in RAM al boot,
+// riscritto (file temporaneo + rename) a ogni upload/delete.
+#define IMAGE_NAME_MAX 32           // Terminatore incluso
+#define IMAGE_MANIFEST_MAGIC "IMX1"
+#define IMAGE_MANIFEST_HEADER 8
+#define IMAGE_LIST_PAGE_MAX 32      // Voci massime per image,list,OFFSET,COUNT
+
+enum ImageFormat : uint8_t {
+    IMAGE_FORMAT_RAW = 0,
+    IMAGE_FORMAT_QIM = 1
+};
+
+struct ImageEntry {
+    char name[IMAGE_NAME_MAX];
+    uint32_t size;                  // Byte su flash
+    uint8_t format;                 // ImageFormat
+    uint8_t reserved[3];
+    uint32_t crc;                   // CRC32 del file
+};
+
+// File massimo per l'upload binario (PNG; raw e .qim restano ≤ IMAGE_SIZE)
+#define IMAGE_UPLOAD_MAX_SIZE (64 * 1024)
+
+// Animazioni .anm (formato in AnimationPlayer.h), caricate a chunk
+#define ANIM_MAX_FILE_SIZE (1024 * 1024)
+
+enum ImageLoadStatus {
+    IMAGE_LOAD_ERROR = -1,
+    IMAGE_LOAD_PENDING = 0,
+    IMAGE_LOAD_DONE = 1
+};
+
 struct ImageInfo {
     String name;
     String path;
     size_t size;
+    bool compressed;
 };
 
 class ImageManager {
@@ -26,11 +64,31 @@ public:
     // Upload immagine da base64
     bool uploadImage(const String& name, const String& base64Data);
 
+    // Installa un file già su flash (upload binario, CRC verificato):
+    // .img se è raw IMAGE_SIZE, .qim se ha un header QIM1 64x64, PNG
+    // decodificato a flusso (resize = scala al pannello invece di rifiutare)
+    bool installImage(const String& name, const char* tmpPath, uint32_t size, uint32_t crc, bool resize = true);
+
+    // PNG già decodificato durante l'upload: salva i 64x64 e rimuove tmpPath
+    bool installDecoded(const String& name, const char* tmpPath, const uint16_t* pixels);
+
     // Carica immagine in buffer RGB565
     bool loadImage(const String& name, uint16_t* buffer);
 
-    // Lista immagini disponibili
+    // Caricamento incrementale (un job alla volta, loadImage() lo annulla):
+    // stepLoad() legge al più maxBytes da flash, per spezzarlo su più frame
+    bool beginLoad(const String& name, uint16_t* buffer);
+    ImageLoadStatus stepLoad(size_t maxBytes);
+    void cancelLoad();
+    bool isLoading() const { return _loadBuffer != nullptr; }
+
+    // Lista immagini disponibili (dal manifest in RAM, nessun accesso a flash)
     std::vector<ImageInfo> listImages();
+    size_t getImageCount() const { return _manifest.size(); }
+    const ImageEntry* getImageEntry(size_t index) const;
+
+    // Ricostruisce il manifest dalla scansione di /images
+    bool rebuildManifest();
 
     // Elimina immagine
     bool deleteImage(const String& name);
@@ -43,10 +101,72 @@ public:
     // Verifica se immagine esiste
     bool exists(const String& name);
 
+    // Ricomprime le immagini .img raw; ritorna quante sono state convertite
+    int compactImages();
+
+    // Cambia a ogni immagine salvata, sostituita o cancellata: chi tiene
+    // copie decodificate (cache dello slideshow) le invalida
+    uint32_t getGeneration() const { return _generation; }
+
+    // Tempo di caricamento (lettura + decodifica) in µs
+    uint32_t getLastLoadUs() const { return _lastLoadUs; }
+    uint32_t getAvgLoadUs() const { return _loadCount ? (uint32_t)(_loadTotalUs / _loadCount) : 0; }
+
+    // Animazioni: upload a chunk su file temporaneo, rinominato a fine upload
+    bool beginAnimationUpload(const String& name, size_t size);
+    bool writeAnimationChunk(const uint8_t* data, size_t len);
+    bool endAnimationUpload();
+    void abortAnimationUpload();
+    bool isAnimationUploading() const { return (bool)_animUploadFile; }
+    size_t getAnimationUploadWritten() const { return _animUploadWritten; }
+    const String& getAnimationUploadName() const { return _animUploadName; }
+
+    File openAnimation(const String& name);
+    std::vector<ImageInfo> listAnimations();
+    bool deleteAnimation(const String& name);
+
 private:
     bool _initialized;
 
+    std::vector<ImageEntry> _manifest;
+    uint32_t _generation;
+
+    uint32_t _lastLoadUs;
+    uint32_t _loadCount;
+    uint64_t _loadTotalUs;
+
+    File _animUploadFile;
+    String _animUploadName;
+    size_t _animUploadSize;
+    size_t _animUploadWritten;
+
     String getImagePath(const String& name);
+    String getCompressedPath(const String& name);
+    bool storeImage(const String& name, const uint16_t* pixels);
+    bool installPng(const String& name, const char* tmpPath, bool resize);
+
+    bool loadManifest();
+    bool saveManifest();
+    int findEntry(const String& name) const;
+    void updateEntry(const String& name, uint32_t size, ImageFormat format, uint32_t crc);
+    bool removeEntry(const String& name);
+
+    // Job di caricamento corrente
+    File _loadFile;
+    uint16_t* _loadBuffer;
+    bool _loadCompressed;
+    size_t _loadOffset;             // Byte raw letti
+    size_t _loadRead;               // Byte del file letti (per il CRC)
+    uint32_t _loadCrc;
+    bool _loadVerify;               // Voce nel manifest: CRC da verificare
+    uint32_t _loadExpectedSize;
+    uint32_t _loadExpectedCrc;
+    QimDecoder _loadDecoder;
+    uint8_t _loadChunk[IMAGE_DECODE_CHUNK];
+    size_t _loadChunkLen;
+    uint32_t _loadUs;               // Tempo attivo (somma dei passi)
+    String getAnimationPath(const String& name);
+    std::vector<ImageInfo> listFiles(const char* dir, const char* ext);
     size_t base64Decode(const String& input, uint8_t* output, size_t maxLen);
 };
 
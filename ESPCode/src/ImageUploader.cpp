@@ -0,0 +1,377 @@
+#include "ImageUploader.h"
+#include "Debug.h"
+#include <rom/crc.h>
+
+static inline uint32_t read32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Record del job: u32 size, u32 crc, nome (IMAGE_NAME_MAX, terminato)
+struct UploadJob {
+    uint32_t size;
+    uint32_t crc;
+    char name[IMAGE_NAME_MAX];
+};
+
+ImageUploader::ImageUploader()
+    : _imageManager(nullptr)
+    , _name("")
+    , _size(0)
+    , _crc(0)
+    , _written(0)
+    , _active(false)
+    , _rxBusy(false)
+    , _rxValid(false)
+    , _owner(UPLOAD_OWNER_LOCAL)
+    , _touchMs(0)
+    , _png(nullptr)
+    , _pngPixels(nullptr)
+    , _mux(portMUX_INITIALIZER_UNLOCKED)
+    , _rxBytes(0)
+    , _statBinary(false)
+    , _statBytes(0)
+    , _statUs(0)
+    , _statMinHeap(0)
+    , _startUs(0)
+    , _lastUs(0)
+    , _minHeap(0)
+    , _resumed(0)
+    , _nacks(0)
+{
+}
+
+// ═══════════════════════════════════════════
+// Job (task di render)
+// ═══════════════════════════════════════════
+
+int32_t ImageUploader::begin(const String& name, uint32_t size, uint32_t crc, uint32_t owner) {
+    if (!_imageManager) {
+        return -1;
+    }
+    if (name.length() == 0 || name.length() >= IMAGE_NAME_MAX) {
+        DEBUG_PRINTF("[Upload] Invalid name length: %d\n", name.length());
+        return -1;
+    }
+    if (size <= QIM_HEADER_SIZE || size > IMAGE_UPLOAD_MAX_SIZE) {
+        DEBUG_PRINTF("[Upload] Invalid size: %u\n", size);
+        return -1;
+    }
+
+    // Stesso job ancora aperto (il client si è riconnesso con un nuovo id):
+    // si prosegue e il job passa al nuovo client
+    if (_active && name == _name && size == _size && crc == _crc) {
+        portENTER_CRITICAL(&_mux);
+        _owner = owner;
+        _touchMs = millis();
+        _rxValid = false;
+        portEXIT_CRITICAL(&_mux);
+        _resumed++;
+        DEBUG_PRINTF("[Upload] Resume '%s' at %u/%u\n", name.c_str(), _written, size);
+        return _written;
+    }
+
+    // Un job diverso non sostituisce quello di un altro client ancora attivo
+    if (_active && owner != _owner && millis() - _touchMs < UPLOAD_OWNER_TIMEOUT_MS) {
+        DEBUG_PRINTF("[Upload] Busy: '%s' owned by client %u\n", _name.c_str(), _owner);
+        return UPLOAD_BUSY;
+    }
+    close();
+    freePng();
+
+    // Job rimasto su flash (disconnessione lunga, reboot)
+    String jobName;
+    uint32_t jobSize;
+    uint32_t jobCrc;
+    uint32_t offset = 0;
+    if (readJob(jobName, jobSize, jobCrc) && jobName == name && jobSize == size && jobCrc == crc) {
+        _file = LittleFS.open(UPLOAD_TMP_PATH, "a");
+        if (_file && _file.size() <= size) {
+            offset = _file.size();
+            _resumed++;
+        } else if (_file) {
+            _file.close();
+        }
+    }
+
+    if (!_file) {
+        LittleFS.remove(UPLOAD_TMP_PATH);
+        LittleFS.remove(UPLOAD_JOB_PATH);
+        if (size > _imageManager->getFreeSpace()) {
+            DEBUG_PRINTF("[Upload] Not enough space: %u\n", size);
+            return -1;
+        }
+
+        _name = name;
+        _size = size;
+        _crc = crc;
+        _file = LittleFS.open(UPLOAD_TMP_PATH, "w");
+        if (!_file || !writeJob()) {
+            DEBUG_PRINTLN(F("[Upload] Failed to create upload file"));
+            if (_file) _file.close();
+            LittleFS.remove(UPLOAD_TMP_PATH);
+            return -1;
+        }
+    }
+
+    _name = name;
+    _size = size;
+    _crc = crc;
+    _rxBytes = 0;
+    _startUs = 0;
+    _minHeap = ESP.getFreeHeap();
+
+    portENTER_CRITICAL(&_mux);
+    _written = offset;
+    _rxValid = false;
+    _owner = owner;
+    _touchMs = millis();
+    _active = true;
+    portEXIT_CRITICAL(&_mux);
+
+    DEBUG_PRINTF("[Upload] '%s' ready at %u/%u\n", name.c_str(), offset, size);
+    return offset;
+}
+
+bool ImageUploader::commit(bool resize) {
+    if (!_active) {
+        return false;
+    }
+    close();
+
+    // Incompleto: il job resta su flash, un nuovo begin riprende
+    if (_written != _size) {
+        DEBUG_PRINTF("[Upload] Incomplete: %u/%u bytes\n", _written, _size);
+        return false;
+    }
+
+    // CRC sul file riletto da flash: copre trasporto e scrittura
+    uint8_t chunk[IMAGE_DECODE_CHUNK];
+    uint32_t crc = 0;
+    File file = LittleFS.open(UPLOAD_TMP_PATH, "r");
+    if (file) {
+        size_t got;
+        while ((got = file.read(chunk, sizeof(chunk))) > 0) {
+            crc = crc32_le(crc, chunk, got);
+        }
+        file.close();
+    }
+
+    if (crc != _crc) {
+        DEBUG_PRINTF("[Upload] CRC mismatch: %08X, expected %08X\n", crc, _crc);
+    }
+    bool ok = crc == _crc && (_png ? commitPng(resize)
+                                   : _imageManager->installImage(_name, UPLOAD_TMP_PATH, _size, _crc, resize));
+    if (!ok) {
+        LittleFS.remove(UPLOAD_TMP_PATH);
+    }
+    LittleFS.remove(UPLOAD_JOB_PATH);
+
+    if (ok) {
+        _statBinary = true;
+        _statBytes = _rxBytes;
+        _statUs = _startUs ? _lastUs - _startUs : 0;
+        _statMinHeap = _minHeap;
+        DEBUG_PRINTF("[Upload] '%s' committed: %u bytes in %u ms, min heap %u\n",
+                     _name.c_str(), _statBytes, getLastMs(), _statMinHeap);
+    }
+    clear();
+    return ok;
+}
+
+void ImageUploader::abort() {
+    close();
+    LittleFS.remove(UPLOAD_TMP_PATH);
+    LittleFS.remove(UPLOAD_JOB_PATH);
+    clear();
+}
+
+void ImageUploader::close() {
+    portENTER_CRITICAL(&_mux);
+    _active = false;
+    portEXIT_CRITICAL(&_mux);
+
+    // Un chunk già in scrittura finisce prima di chiudere il file
+    while (_rxBusy) {
+        vTaskDelay(1);
+    }
+
+    if (_file) {
+        _file.close();
+    }
+}
+
+void ImageUploader::clear() {
+    freePng();
+    _name = "";
+    _size = 0;
+    _crc = 0;
+    _written = 0;
+}
+
+// PNG già decodificato in ricezione: resta solo il salvataggio
+bool ImageUploader::commitPng(bool resize) {
+    if (!_png->isDone()) {
+        DEBUG_PRINTF("[Upload] PNG decode failed: %s\n", _png->getError() ? _png->getError() : "truncated");
+        return false;
+    }
+    if (!resize && (_png->getWidth() != IMAGE_WIDTH || _png->getHeight() != IMAGE_HEIGHT)) {
+        DEBUG_PRINTF("[Upload] PNG is %ux%u, resize disabled\n", _png->getWidth(), _png->getHeight());
+        return false;
+    }
+
+    return _imageManager->installDecoded(_name, UPLOAD_TMP_PATH, _pngPixels);
+}
+
+void ImageUploader::freePng() {
+    delete _png;
+    free(_pngPixels);
+    _png = nullptr;
+    _pngPixels = nullptr;
+}
+
+bool ImageUploader::readJob(String& name, uint32_t& size, uint32_t& crc) {
+    File file = LittleFS.open(UPLOAD_JOB_PATH, "r");
+    if (!file) return false;
+
+    UploadJob job;
+    bool ok = file.read((uint8_t*)&job, sizeof(job)) == sizeof(job);
+    file.close();
+    if (!ok) return false;
+
+    job.name[IMAGE_NAME_MAX - 1] = '\0';
+    name = job.name;
+    size = job.size;
+    crc = job.crc;
+    return true;
+}
+
+bool ImageUploader::writeJob() {
+    UploadJob job;
+    memset(&job, 0, sizeof(job));
+    job.size = _size;
+    job.crc = _crc;
+    strncpy(job.name, _name.c_str(), IMAGE_NAME_MAX - 1);
+
+    File file = LittleFS.open(UPLOAD_JOB_PATH, "w");
+    if (!file) return false;
+    bool ok = file.write((const uint8_t*)&job, sizeof(job)) == sizeof(job);
+    file.close();
+    return ok;
+}
+
+// ═══════════════════════════════════════════
+// Ricezione (task AsyncTCP)
+// ═══════════════════════════════════════════
+
+String ImageUploader::receive(uint32_t clientId, const uint8_t* data, size_t len, size_t index, size_t total) {
+    portENTER_CRITICAL(&_mux);
+    bool active = _active;
+    bool owned = active && clientId == _owner;
+    if (owned) _rxBusy = true;
+    portEXIT_CRITICAL(&_mux);
+
+    bool last = index + len == total;
+    if (!active) {
+        return last ? "ERR,No image upload in progress" : "";
+    }
+    if (!owned) {
+        // Messaggi di altri client intercalati non toccano _rxValid del proprietario
+        return last ? "ERR,Upload owned by another client" : "";
+    }
+
+    if (index == 0) {
+        // L'header arriva sempre nel primo chunk (segmento TCP ≥ 5 byte)
+        _rxValid = len >= UPLOAD_HEADER && read32(data + 1) == _written &&
+                   _written + (total - UPLOAD_HEADER) <= _size;
+        if (!_rxValid) _nacks++;
+        data += UPLOAD_HEADER;
+        len = len >= UPLOAD_HEADER ? len - UPLOAD_HEADER : 0;
+    }
+
+    if (_rxValid && len > 0) {
+        _rxValid = append(data, len);
+    }
+
+    String response;
+    if (last) {
+        if (_rxValid) {
+            // ACK = byte già su flash: dopo un reset si riprende da qui
+            _file.flush();
+            response = "UPLOAD_ACK," + String(_written);
+        } else {
+            response = "UPLOAD_NACK," + String(_written);
+        }
+    }
+
+    _rxBusy = false;
+    return response;
+}
+
+bool ImageUploader::write(uint32_t offset, const uint8_t* data, size_t len) {
+    portENTER_CRITICAL(&_mux);
+    bool owned = _active && _owner == UPLOAD_OWNER_LOCAL;
+    if (owned) _rxBusy = true;
+    portEXIT_CRITICAL(&_mux);
+    if (!owned) return false;
+
+    bool ok = offset == _written && offset + len <= _size && append(data, len);
+    if (ok && _written == _size) {
+        _file.flush();
+    }
+
+    _rxBusy = false;
+    return ok;
+}
+
+// Con _rxBusy già preso dal chiamante
+bool ImageUploader::append(const uint8_t* data, size_t len) {
+    if (_written == 0 && PngDecoder::isPng(data, len)) {
+        startPng();
+    }
+
+    size_t written = _file.write(data, len);
+    _written += written;
+    _rxBytes += written;
+
+    // Errore di decodifica: il decoder libera i buffer, commit lo riporta
+    if (_png && !_png->isDone() && _png->feed(data, written) && _png->isDone()) {
+        _png->end();
+    }
+
+    uint32_t now = micros();
+    if (_startUs == 0) _startUs = now;
+    _lastUs = now;
+    _touchMs = millis();
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < _minHeap) _minHeap = heap;
+
+    return written == len;
+}
+
+// Uscita sempre 64x64 con resize: la scelta di RESIZE arriva solo a commit
+void ImageUploader::startPng() {
+    freePng();
+    _pngPixels = (uint16_t*)malloc(IMAGE_SIZE);
+    _png = _pngPixels ? new PngDecoder() : nullptr;
+    if (_png && !_png->begin(_pngPixels, IMAGE_WIDTH, IMAGE_HEIGHT, true)) {
+        freePng();
+    }
+    if (!_png) {
+        DEBUG_PRINTLN(F("[Upload] No memory for PNG decoder, decoding at commit"));
+    }
+}
+
+// ═══════════════════════════════════════════
+// Statistiche
+// ═══════════════════════════════════════════
+
+void ImageUploader::recordBase64(size_t bytes, uint32_t us, uint32_t minFreeHeap) {
+    _statBinary = false;
+    _statBytes = bytes;
+    _statUs = us;
+    _statMinHeap = minFreeHeap;
+}
+
+uint32_t ImageUploader::getLastKBps() const {
+    return _statUs > 0 ? (uint32_t)((uint64_t)_statBytes * 1000000ULL / 1024 / _statUs) : 0;
+}
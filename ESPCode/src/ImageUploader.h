@@ -0,0 +1,124 @@
+#ifndef IMAGE_UPLOADER_H
+#define IMAGE_UPLOADER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include "ImageManager.h"
+#include "PngDecoder.h"
+
+// Messaggio binario WebSocket (App → ESP32), little endian:
+//   [0] tipo 0x20  [1-4] offset nel file  poi i byte del file
+// Il file è un'immagine .img raw (IMAGE_SIZE byte), .qim (header QIM1) o PNG.
+#define UPLOAD_MSG_CHUNK 0x20
+#define UPLOAD_HEADER 5
+
+// Job su flash: sopravvive a disconnessione e reboot (un upload alla volta)
+#define UPLOAD_TMP_PATH "/images/upload.tmp"
+#define UPLOAD_JOB_PATH "/images/upload.job"
+
+// Proprietario del job: id del client WebSocket che ha fatto begin, oppure
+// UPLOAD_OWNER_LOCAL per HTTP e seriale (gli id WebSocket partono da 1)
+#define UPLOAD_OWNER_LOCAL 0
+#define UPLOAD_OWNER_TIMEOUT_MS 10000           // Job fermo da più tempo: un altro client può sostituirlo
+#define UPLOAD_BUSY -2                          // begin: job attivo di un altro client
+
+/**
+ * ImageUploader - Upload binario e riprendibile delle immagini
+ *
+ *   image,begin,NAME,SIZE,CRC32   → UPLOAD_READY,NAME,OFFSET (0 o ripresa)
+ *   binario [0x20][offset][dati]   → UPLOAD_ACK,OFFSET / UPLOAD_NACK,OFFSET
+ *   image,commit[,RESIZE]          → verifica CRC, rename (o decodifica PNG) e manifest
+ *
+ * I chunk vanno direttamente dal buffer di AsyncTCP al file temporaneo:
+ * nessuna copia del messaggio in RAM. Un begin con gli stessi NAME, SIZE
+ * e CRC riprende dal punto in cui il file temporaneo si è fermato.
+ *
+ * receive() gira sul task AsyncTCP, il resto sul task di render: stato
+ * del job sotto spinlock, la scrittura su flash fuori (come StreamEffect).
+ * È l'unico accesso a LittleFS fuori dal task di render: scelta voluta per
+ * non copiare i chunk in RAM e per dare ACK solo su byte già in flash.
+ * Le operazioni di esp_littlefs sono serializzate dal lock del VFS, quindi
+ * prefetch e read-ahead del render aspettano al più una write di un chunk;
+ * l'attesa di erase della flash resta sul task AsyncTCP, non sul render.
+ *
+ * Solo il client che ha fatto begin può scrivere: i chunk di altri client
+ * vengono rifiutati senza toccare il job.
+ *
+ * Un PNG viene decodificato man mano che i chunk arrivano (task AsyncTCP,
+ * sempre con resize, RESIZE 0 controlla solo le dimensioni): a commit il
+ * render salva soltanto i 64x64 già pronti. Se il decoder non ha visto il
+ * file dall'inizio (ripresa da flash dopo reboot) il PNG si decodifica a
+ * commit, sul task di render.
+ */
+class ImageUploader {
+public:
+    ImageUploader();
+
+    void setImageManager(ImageManager* imageManager) { _imageManager = imageManager; }
+
+    // Task di render (comandi); begin ritorna l'offset di ripresa, -1 = errore,
+    // UPLOAD_BUSY = un altro client ha un job attivo
+    int32_t begin(const String& name, uint32_t size, uint32_t crc, uint32_t owner = UPLOAD_OWNER_LOCAL);
+    bool commit(bool resize = true);
+    void abort();
+    bool isActive() const { return _active; }
+    const String& getName() const { return _name; }
+
+    // Chunk di un messaggio binario del client clientId (task AsyncTCP); a
+    // fine messaggio ritorna la risposta per il client, altrimenti stringa vuota
+    String receive(uint32_t clientId, const uint8_t* data, size_t len, size_t index, size_t total);
+
+    // Byte del file senza header (corpo HTTP, task AsyncTCP); false = job
+    // chiuso, di un client WebSocket o offset diverso dai byte già scritti
+    bool write(uint32_t offset, const uint8_t* data, size_t len);
+
+    // Statistiche dell'ultimo upload (binario o base64)
+    void recordBase64(size_t bytes, uint32_t us, uint32_t minFreeHeap);
+    const char* getLastMode() const { return _statBinary ? "binary" : "base64"; }
+    uint32_t getLastBytes() const { return _statBytes; }
+    uint32_t getLastMs() const { return _statUs / 1000; }
+    uint32_t getLastKBps() const;
+    uint32_t getLastMinFreeHeap() const { return _statMinHeap; }
+    uint32_t getResumed() const { return _resumed; }
+    uint32_t getNacks() const { return _nacks; }
+
+private:
+    ImageManager* _imageManager;
+    File _file;
+    String _name;
+    uint32_t _size;
+    uint32_t _crc;
+    volatile uint32_t _written;
+    volatile bool _active;
+    volatile bool _rxBusy;
+    bool _rxValid;                  // Messaggio binario corrente (solo del proprietario)
+    uint32_t _owner;
+    volatile uint32_t _touchMs;     // begin o ultimo chunk del job
+    PngDecoder* _png;               // Decodifica in ricezione (solo PNG visti da offset 0)
+    uint16_t* _pngPixels;
+    portMUX_TYPE _mux;
+    uint32_t _rxBytes;              // Byte ricevuti nel job corrente
+
+    // Statistiche
+    bool _statBinary;
+    uint32_t _statBytes;
+    uint32_t _statUs;
+    uint32_t _statMinHeap;
+    uint32_t _startUs;              // Primo chunk del job corrente
+    uint32_t _lastUs;               // Ultimo chunk
+    uint32_t _minHeap;
+    uint32_t _resumed;
+    uint32_t _nacks;
+
+    bool append(const uint8_t* data, size_t len);
+    void startPng();
+    bool commitPng(bool resize);
+    void freePng();
+    bool readJob(String& name, uint32_t& size, uint32_t& crc);
+    bool writeJob();
+    void close();
+    void clear();
+};
+
+#endif // IMAGE_UPLOADER_H
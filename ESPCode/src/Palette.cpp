@@ -0,0 +1,113 @@
+#include "Palette.h"
+#include "PixelKernels.h"
+
+void Palette::reset() {
+    memset(colors, 0, sizeof(colors));
+    memset(slots, 0, sizeof(slots));
+    used = 0;
+    reservedStart = PALETTE_SIZE;
+    approximations = 0;
+    indexOf(0x0000);
+}
+
+void Palette::reclaim() {
+    memset(colors, 0, reservedStart * sizeof(uint16_t));
+    memset(slots, 0, sizeof(slots));
+    used = 0;
+    indexOf(0x0000);
+}
+
+uint8_t Palette::indexOf(uint16_t color) {
+    uint16_t s = hash(color);
+    while (slots[s]) {
+        uint8_t index = slots[s] - 1;
+        if (colors[index] == color) return index;
+        s = (s + 1) & (PALETTE_HASH_SLOTS - 1);
+    }
+
+    if (used < reservedStart) {
+        colors[used] = color;
+        slots[s] = used + 1;
+        return used++;
+    }
+
+    approximations++;
+    return nearest(color);
+}
+
+bool Palette::reserve(uint8_t count, uint8_t& first) {
+    if (count == 0 || used + count > reservedStart) return false;
+    reservedStart -= count;
+    first = reservedStart;
+    for (uint16_t i = reservedStart; i < reservedStart + count; i++) colors[i] = 0x0000;
+    return true;
+}
+
+void Palette::set(uint8_t index, uint16_t color) {
+    colors[index] = color;
+    // Le voci automatiche sono nel lookup: va riallineato
+    if (index < used) rebuild();
+}
+
+void Palette::rotate(uint8_t first, uint8_t count, int8_t step) {
+    if (count < 2 || first + count > PALETTE_SIZE) return;
+
+    int16_t shift = step % count;
+    if (shift < 0) shift += count;
+    if (shift == 0) return;
+
+    uint16_t tmp[PALETTE_SIZE];
+    for (uint16_t i = 0; i < count; i++) {
+        tmp[(i + shift) % count] = colors[first + i];
+    }
+    memcpy(&colors[first], tmp, count * sizeof(uint16_t));
+
+    if (first < used) rebuild();
+}
+
+void Palette::fade(uint16_t amount565) {
+    PixelKernels::fade(colors, PALETTE_SIZE, amount565);
+    rebuild();
+}
+
+void Palette::scale(uint8_t level) {
+    PixelKernels::scale(colors, PALETTE_SIZE, level);
+    rebuild();
+}
+
+// Colori duplicati (dopo fade/rotate): il lookup tiene il primo indice
+void Palette::rebuild() {
+    memset(slots, 0, sizeof(slots));
+    for (uint16_t i = 0; i < used; i++) {
+        uint16_t s = hash(colors[i]);
+        bool present = false;
+        while (slots[s]) {
+            if (colors[slots[s] - 1] == colors[i]) {
+                present = true;
+                break;
+            }
+            s = (s + 1) & (PALETTE_HASH_SLOTS - 1);
+        }
+        if (!present) slots[s] = i + 1;
+    }
+}
+
+// Distanza quadratica nello spazio 5/6/5 (verde pesato come nel formato)
+uint8_t Palette::nearest(uint16_t color) const {
+    int16_t r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+    uint32_t best = 0xFFFFFFFF;
+    uint8_t bestIndex = 0;
+
+    for (uint16_t i = 0; i < used; i++) {
+        uint16_t c = colors[i];
+        int16_t dr = (int16_t)(c >> 11) - r;
+        int16_t dg = (int16_t)((c >> 5) & 0x3F) - g;
+        int16_t db = (int16_t)(c & 0x1F) - b;
+        uint32_t d = 4 * dr * dr + dg * dg + 4 * db * db;
+        if (d < best) {
+            best = d;
+            bestIndex = i;
+        }
+    }
+    return bestIndex;
+}
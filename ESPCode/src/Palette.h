@@ -0,0 +1,68 @@
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include <Arduino.h>
+
+#define PALETTE_SIZE 256
+#define PALETTE_HASH_SLOTS 512      // Potenza di 2, riempimento massimo 50%
+
+/**
+ * Palette - 256 colori RGB565 per il framebuffer indicizzato a 8 bit.
+ *
+ * Due zone:
+ *   [0, used)              voci automatiche: indexOf() assegna un indice a
+ *                          ogni colore nuovo (lookup hash, O(1) in media)
+ *   [reservedStart, 256)   voci riservate da un effetto con reserve(): il
+ *                          colore si cambia con set()/rotate() senza
+ *                          ridisegnare i pixel (palette cycling)
+ * A palette piena indexOf() ripiega sul colore più vicino (getApproximations()).
+ * Le voci automatiche si liberano con reclaim(), che DisplayManager chiama
+ * quando fillScreen() copre tutto il canvas: un effetto indicizzato che non
+ * pulisce lo schermo a ogni frame deve usare colori fissi (o voci riservate).
+ */
+class Palette {
+public:
+    Palette() { reset(); }
+
+    // Solo il nero (indice 0), nessuna voce riservata
+    void reset();
+
+    // Libera le voci automatiche (resta il nero), le riservate non cambiano.
+    // Solo quando nessun pixel usa più quegli indici (schermo riempito)
+    void reclaim();
+
+    uint8_t indexOf(uint16_t color);
+    uint16_t color(uint8_t index) const { return colors[index]; }
+    const uint16_t* data() const { return colors; }
+
+    // Riserva count voci in cima alla palette (inizialmente nere)
+    bool reserve(uint8_t count, uint8_t& first);
+    void set(uint8_t index, uint16_t color);
+
+    // Ruota di step posizioni le voci [first, first+count)
+    void rotate(uint8_t first, uint8_t count, int8_t step);
+
+    // Kernel a schermo intero applicati ai 256 colori invece che ai pixel
+    void fade(uint16_t amount565);
+    void scale(uint8_t level);
+
+    uint16_t getUsed() const { return used; }
+    uint16_t getReserved() const { return PALETTE_SIZE - reservedStart; }
+    uint32_t getApproximations() const { return approximations; }
+
+private:
+    uint16_t colors[PALETTE_SIZE];
+    uint16_t slots[PALETTE_HASH_SLOTS];     // indice + 1, 0 = slot vuoto
+    uint16_t used;
+    uint16_t reservedStart;
+    uint32_t approximations;
+
+    static inline uint16_t hash(uint16_t color) {
+        return (uint16_t)(((uint32_t)color * 2654435761u) >> 23) & (PALETTE_HASH_SLOTS - 1);
+    }
+
+    void rebuild();
+    uint8_t nearest(uint16_t color) const;
+};
+
+#endif // PALETTE_H
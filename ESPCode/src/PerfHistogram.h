@@ -0,0 +1,91 @@
+#ifndef PERF_HISTOGRAM_H
+#define PERF_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// Bucket dell'istogramma: limiti superiori in µs, l'ultimo raccoglie il resto
+#define PERF_BUCKETS 20
+
+/**
+ * Istogramma a bucket fissi per tempi in microsecondi.
+ * Nessuna allocazione: ~100 byte, percentili approssimati al limite
+ * superiore del bucket (il massimo esatto è tenuto a parte).
+ */
+class PerfHistogram {
+private:
+    uint32_t buckets[PERF_BUCKETS];
+    uint32_t count;
+    uint64_t totalUs;
+    uint32_t maxUs;
+
+    static uint32_t upperBound(uint8_t index) {
+        static const uint32_t bounds[PERF_BUCKETS] = {
+            50, 100, 200, 300, 500, 750, 1000, 1500, 2000, 3000,
+            4000, 5000, 7500, 10000, 15000, 20000, 30000, 50000, 100000, 0xFFFFFFFF
+        };
+        return bounds[index];
+    }
+
+public:
+    PerfHistogram() { reset(); }
+
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        count = 0;
+        totalUs = 0;
+        maxUs = 0;
+    }
+
+    void record(uint32_t us) {
+        uint8_t i = 0;
+        while (i < PERF_BUCKETS - 1 && us > upperBound(i)) i++;
+        buckets[i]++;
+        count++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    // Percentile (0-100): limite superiore del bucket che lo contiene
+    uint32_t percentile(uint8_t p) const {
+        if (count == 0) return 0;
+
+        uint64_t target = ((uint64_t)count * p + 99) / 100;
+        uint64_t seen = 0;
+        for (uint8_t i = 0; i < PERF_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= target) {
+                uint32_t bound = upperBound(i);
+                return bound < maxUs ? bound : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMax() const { return maxUs; }
+    uint32_t getAvg() const { return count ? (uint32_t)(totalUs / count) : 0; }
+
+    // "p50,p95,p99,max" per le risposte CSV
+    String toCsv() const {
+        return String(percentile(50)) + "," + String(percentile(95)) + "," +
+               String(percentile(99)) + "," + String(maxUs);
+    }
+};
+
+/**
+ * Profilo per effetto: update() (tutti i tick del frame), draw() escluso
+ * il flush, e flush verso il pannello (endFrame() + present())
+ */
+struct EffectProfile {
+    PerfHistogram update;
+    PerfHistogram draw;
+    PerfHistogram flush;
+
+    void reset() {
+        update.reset();
+        draw.reset();
+        flush.reset();
+    }
+};
+
+#endif // PERF_HISTOGRAM_H
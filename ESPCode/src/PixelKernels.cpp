@@ -0,0 +1,183 @@
+#include "PixelKernels.h"
+
+// ═══════════════════════════════════════════
+// Riferimento scalare
+// ═══════════════════════════════════════════
+
+static inline void split565(uint16_t c, uint32_t& r, uint32_t& g, uint32_t& b) {
+    r = (c >> 11) & 0x1F;
+    g = (c >> 5) & 0x3F;
+    b = c & 0x1F;
+}
+
+static inline uint16_t join565(uint32_t r, uint32_t g, uint32_t b) {
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+uint16_t PixelKernels::refBlend(uint16_t a, uint16_t b, uint8_t alpha) {
+    uint32_t ar, ag, ab, br, bg, bb;
+    split565(a, ar, ag, ab);
+    split565(b, br, bg, bb);
+    uint32_t inv = 32 - alpha;
+    return join565((ar * alpha + br * inv) >> 5,
+                   (ag * alpha + bg * inv) >> 5,
+                   (ab * alpha + bb * inv) >> 5);
+}
+
+uint16_t PixelKernels::refScale(uint16_t a, uint8_t level) {
+    uint32_t r, g, b;
+    split565(a, r, g, b);
+    return join565((r * level) >> 5, (g * level) >> 5, (b * level) >> 5);
+}
+
+uint16_t PixelKernels::refAddSat(uint16_t a, uint16_t b) {
+    uint32_t ar, ag, ab, br, bg, bb;
+    split565(a, ar, ag, ab);
+    split565(b, br, bg, bb);
+    return join565(min(ar + br, (uint32_t)31), min(ag + bg, (uint32_t)63), min(ab + bb, (uint32_t)31));
+}
+
+uint16_t PixelKernels::refSubSat(uint16_t a, uint16_t amount) {
+    uint32_t ar, ag, ab, mr, mg, mb;
+    split565(a, ar, ag, ab);
+    split565(amount, mr, mg, mb);
+    return join565(ar > mr ? ar - mr : 0, ag > mg ? ag - mg : 0, ab > mb ? ab - mb : 0);
+}
+
+// ═══════════════════════════════════════════
+// Self test
+// ═══════════════════════════════════════════
+
+uint32_t PixelKernels::selfTest(uint32_t cases) {
+    uint32_t errors = 0;
+
+    for (uint32_t i = 0; i < cases; i++) {
+        uint32_t a = esp_random();
+        uint32_t b = esp_random();
+        uint16_t a0 = a, a1 = a >> 16;
+        uint16_t b0 = b, b1 = b >> 16;
+        uint8_t alpha = i % 33;
+
+        // Entrambe le metà della word contro il riferimento
+        uint32_t r = blend2(a, b, alpha);
+        if ((uint16_t)r != refBlend(a0, b0, alpha) || (uint16_t)(r >> 16) != refBlend(a1, b1, alpha)) errors++;
+
+        r = scale2(a, alpha);
+        if ((uint16_t)r != refScale(a0, alpha) || (uint16_t)(r >> 16) != refScale(a1, alpha)) errors++;
+
+        r = addSat2(a, b);
+        if ((uint16_t)r != refAddSat(a0, b0) || (uint16_t)(r >> 16) != refAddSat(a1, b1)) errors++;
+
+        r = subSat2(a, pack2(b0));
+        if ((uint16_t)r != refSubSat(a0, b0) || (uint16_t)(r >> 16) != refSubSat(a1, b0)) errors++;
+    }
+
+    // Bordi e code dispari dei kernel su buffer (anche non allineati)
+    uint16_t buf[9], src[9];
+    for (uint8_t offset = 0; offset < 2; offset++) {
+        size_t count = 9 - offset;
+        fill(buf + offset, count, 0xF81F);
+        for (size_t i = 0; i < count; i++) {
+            if (buf[offset + i] != 0xF81F) errors++;
+        }
+
+        for (size_t i = 0; i < 9; i++) {
+            buf[i] = esp_random();
+            src[i] = esp_random();
+        }
+        uint16_t expect[9];
+        for (size_t i = 0; i < count; i++) expect[i] = refAddSat(buf[offset + i], src[offset + i]);
+        addSat(buf + offset, src + offset, count);
+        for (size_t i = 0; i < count; i++) {
+            if (buf[offset + i] != expect[i]) errors++;
+        }
+
+        for (size_t i = 0; i < count; i++) expect[i] = refSubSat(buf[offset + i], 0x3186);
+        fade(buf + offset, count, 0x3186);
+        for (size_t i = 0; i < count; i++) {
+            if (buf[offset + i] != expect[i]) errors++;
+        }
+    }
+
+    return errors;
+}
+
+// ═══════════════════════════════════════════
+// Benchmark
+// ═══════════════════════════════════════════
+
+bool PixelKernels::benchmark(uint16_t width, uint16_t height, uint16_t iterations, BenchResult& result) {
+    size_t count = (size_t)width * height;
+    uint16_t* dst = (uint16_t*)malloc(count * sizeof(uint16_t));
+    uint16_t* src = (uint16_t*)malloc(count * sizeof(uint16_t));
+    if (!dst || !src || iterations == 0) {
+        free(dst);
+        free(src);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = esp_random();
+        src[i] = esp_random();
+    }
+
+    uint32_t start;
+    memset(&result, 0, sizeof(result));
+    result.errors = selfTest(4096);
+
+    // Riferimento: un pixel per volta
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) dst[i] = 0x07E0;
+    }
+    result.refUs[0] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) dst[i] = refSubSat(dst[i], 0x0841);
+    }
+    result.refUs[1] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) dst[i] = refBlend(src[i], dst[i], 16);
+    }
+    result.refUs[2] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) dst[i] = refAddSat(dst[i], src[i]);
+    }
+    result.refUs[3] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) {
+        for (size_t i = 0; i < count; i++) dst[i] = refScale(dst[i], 24);
+    }
+    result.refUs[4] = (micros() - start) / iterations;
+
+    // Kernel SWAR: due pixel per word
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) fill(dst, count, 0x07E0);
+    result.swarUs[0] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) fade(dst, count, 0x0841);
+    result.swarUs[1] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) blend(dst, src, dst, count, 16);
+    result.swarUs[2] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) addSat(dst, src, count);
+    result.swarUs[3] = (micros() - start) / iterations;
+
+    start = micros();
+    for (uint16_t n = 0; n < iterations; n++) scale(dst, count, 24);
+    result.swarUs[4] = (micros() - start) / iterations;
+
+    free(dst);
+    free(src);
+    return true;
+}
@@ -0,0 +1,185 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <Arduino.h>
+
+/**
+ * PixelKernels - Operazioni su buffer RGB565 a due pixel per word (SWAR)
+ *
+ * Ogni word da 32 bit contiene due pixel. Per le operazioni per canale i
+ * sei canali sono divisi in due gruppi con almeno 5 bit liberi sopra ogni
+ * canale, così somme e prodotti per 0-32 non sconfinano nel canale vicino:
+ *   X = word & MASK_X          → B0 (0-4), R0 (11-15), G1 (21-26)
+ *   Y = (word >> 5) & MASK_Y   → G0 (0-5), B1 (11-15), R1 (22-26)
+ * Il bit subito sopra ogni canale (OVF_*) segnala riporto o prestito.
+ *
+ * I buffer a 32 bit (framebuffer, malloc/new) vanno a due pixel per word;
+ * con puntatori non allineati si usa la stessa funzione a un pixel per volta.
+ * Le versioni ref*() per pixel sono il riferimento di selfTest().
+ */
+class PixelKernels {
+public:
+    static const uint32_t MASK_X = 0x07E0F81F;
+    static const uint32_t MASK_Y = 0x07C0F83F;
+    static const uint32_t OVF_X  = 0x08010020;
+    static const uint32_t OVF_Y  = 0x08010040;
+
+    // ─────────────────────────────────────────
+    // Coppie di pixel (anche un solo pixel nella metà bassa)
+    // ─────────────────────────────────────────
+
+    // alpha 0-32: 32 → tutto a, 0 → tutto b
+    static inline uint32_t blend2(uint32_t a, uint32_t b, uint32_t alpha) {
+        uint32_t inv = 32 - alpha;
+        uint32_t x = (((a & MASK_X) * alpha + (b & MASK_X) * inv) >> 5) & MASK_X;
+        uint32_t y = ((((a >> 5) & MASK_Y) * alpha + ((b >> 5) & MASK_Y) * inv) >> 5) & MASK_Y;
+        return x | (y << 5);
+    }
+
+    // level 0-32: 32 = invariato, 0 = nero
+    static inline uint32_t scale2(uint32_t a, uint32_t level) {
+        uint32_t x = (((a & MASK_X) * level) >> 5) & MASK_X;
+        uint32_t y = ((((a >> 5) & MASK_Y) * level) >> 5) & MASK_Y;
+        return x | (y << 5);
+    }
+
+    // Somma per canale con saturazione al massimo del canale
+    static inline uint32_t addSat2(uint32_t a, uint32_t b) {
+        uint32_t x = (a & MASK_X) + (b & MASK_X);
+        uint32_t y = ((a >> 5) & MASK_Y) + ((b >> 5) & MASK_Y);
+        x = (x | smear(x & OVF_X)) & MASK_X;
+        y = (y | smear(y & OVF_Y)) & MASK_Y;
+        return x | (y << 5);
+    }
+
+    // Sottrazione per canale con saturazione a zero (fade/decay).
+    // amount2 = quantità per canale in formato RGB565 su entrambe le metà
+    static inline uint32_t subSat2(uint32_t a, uint32_t amount2) {
+        uint32_t x = ((a & MASK_X) | OVF_X) - (amount2 & MASK_X);
+        uint32_t y = (((a >> 5) & MASK_Y) | OVF_Y) - ((amount2 >> 5) & MASK_Y);
+        // Bit di guardia ancora a 1 = nessun prestito: il canale resta
+        x &= smear(x & OVF_X);
+        y &= smear(y & OVF_Y);
+        return (x & MASK_X) | ((y & MASK_Y) << 5);
+    }
+
+    static inline uint32_t pack2(uint16_t color) {
+        return (uint32_t)color | ((uint32_t)color << 16);
+    }
+
+    // ─────────────────────────────────────────
+    // Buffer
+    // ─────────────────────────────────────────
+
+    static void fill(uint16_t* dst, size_t count, uint16_t color) {
+        if (count && ((uintptr_t)dst & 2)) {
+            *dst++ = color;
+            count--;
+        }
+        uint32_t c2 = pack2(color);
+        uint32_t* d = (uint32_t*)dst;
+        size_t pairs = count / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            d[i] = c2;
+        }
+        if (count & 1) dst[count - 1] = color;
+    }
+
+    // Sottrae amount (RGB565, per canale) da ogni pixel, saturando a zero
+    static void fade(uint16_t* dst, size_t count, uint16_t amount) {
+        uint32_t amount2 = pack2(amount);
+        if (count && ((uintptr_t)dst & 2)) {
+            *dst = (uint16_t)subSat2(*dst, amount2);
+            dst++;
+            count--;
+        }
+        uint32_t* d = (uint32_t*)dst;
+        size_t pairs = count / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            d[i] = subSat2(d[i], amount2);
+        }
+        if (count & 1) dst[count - 1] = (uint16_t)subSat2(dst[count - 1], amount2);
+    }
+
+    // Luminosità: level 0-32 (32 = invariato)
+    static void scale(uint16_t* dst, size_t count, uint8_t level) {
+        if (count && ((uintptr_t)dst & 2)) {
+            *dst = (uint16_t)scale2(*dst, level);
+            dst++;
+            count--;
+        }
+        uint32_t* d = (uint32_t*)dst;
+        size_t pairs = count / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            d[i] = scale2(d[i], level);
+        }
+        if (count & 1) dst[count - 1] = (uint16_t)scale2(dst[count - 1], level);
+    }
+
+    // dst = a * alpha + b * (32 - alpha), alpha 0-32 (dst può coincidere con a o b)
+    static void blend(uint16_t* dst, const uint16_t* a, const uint16_t* b,
+                      size_t count, uint8_t alpha) {
+        if (!aligned(dst, a, b)) {
+            for (size_t i = 0; i < count; i++) dst[i] = (uint16_t)blend2(a[i], b[i], alpha);
+            return;
+        }
+        uint32_t* d = (uint32_t*)dst;
+        const uint32_t* a2 = (const uint32_t*)a;
+        const uint32_t* b2 = (const uint32_t*)b;
+        size_t pairs = count / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            d[i] = blend2(a2[i], b2[i], alpha);
+        }
+        if (count & 1) dst[count - 1] = (uint16_t)blend2(a[count - 1], b[count - 1], alpha);
+    }
+
+    // dst = dst + src per canale, con saturazione
+    static void addSat(uint16_t* dst, const uint16_t* src, size_t count) {
+        if (!aligned(dst, src, src)) {
+            for (size_t i = 0; i < count; i++) dst[i] = (uint16_t)addSat2(dst[i], src[i]);
+            return;
+        }
+        uint32_t* d = (uint32_t*)dst;
+        const uint32_t* s = (const uint32_t*)src;
+        size_t pairs = count / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            d[i] = addSat2(d[i], s[i]);
+        }
+        if (count & 1) dst[count - 1] = (uint16_t)addSat2(dst[count - 1], src[count - 1]);
+    }
+
+    // ─────────────────────────────────────────
+    // Riferimento scalare (un pixel, canali separati)
+    // ─────────────────────────────────────────
+    static uint16_t refBlend(uint16_t a, uint16_t b, uint8_t alpha);
+    static uint16_t refScale(uint16_t a, uint8_t level);
+    static uint16_t refAddSat(uint16_t a, uint16_t b);
+    static uint16_t refSubSat(uint16_t a, uint16_t amount);
+
+    // Confronta i kernel con il riferimento su dati casuali: errori trovati
+    static uint32_t selfTest(uint32_t cases);
+
+    // Benchmark su un frame width x height: µs medi per passata
+    struct BenchResult {
+        uint32_t errors;
+        uint32_t refUs[5];      // fill, fade, blend, addSat, scale
+        uint32_t swarUs[5];
+    };
+    static bool benchmark(uint16_t width, uint16_t height, uint16_t iterations, BenchResult& result);
+
+private:
+    // Propaga il bit di overflow sui (al massimo 6) bit del canale sottostante
+    static inline uint32_t smear(uint32_t ovf) {
+        uint32_t m = ovf >> 1;
+        m |= m >> 1;
+        m |= m >> 2;
+        m |= m >> 4;
+        return m;
+    }
+
+    static inline bool aligned(const void* a, const void* b, const void* c) {
+        return (((uintptr_t)a | (uintptr_t)b | (uintptr_t)c) & 3) == 0;
+    }
+};
+
+#endif // PIXEL_KERNELS_H
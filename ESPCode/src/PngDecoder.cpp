@@ -0,0 +1,442 @@
+#include "PngDecoder.h"
+#include "Debug.h"
+#include <rom/crc.h>
+
+static const uint8_t PNG_SIGNATURE[PNG_SIGNATURE_SIZE] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+#define PNG_CHUNK(a, b, c, d) (((uint32_t)(a) << 24) | ((uint32_t)(b) << 16) | ((c) << 8) | (d))
+#define PNG_IHDR PNG_CHUNK('I', 'H', 'D', 'R')
+#define PNG_PLTE PNG_CHUNK('P', 'L', 'T', 'E')
+#define PNG_TRNS PNG_CHUNK('t', 'R', 'N', 'S')
+#define PNG_IDAT PNG_CHUNK('I', 'D', 'A', 'T')
+#define PNG_IEND PNG_CHUNK('I', 'E', 'N', 'D')
+
+static inline uint32_t readBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+PngDecoder::PngDecoder()
+    : _state(STATE_SIGNATURE)
+    , _error(nullptr)
+    , _headerLen(0)
+    , _chunkType(0)
+    , _chunkLeft(0)
+    , _chunkCrc(0)
+    , _metaLen(0)
+    , _width(0)
+    , _height(0)
+    , _bitDepth(0)
+    , _colorType(0)
+    , _channels(0)
+    , _bpp(0)
+    , _rowBytes(0)
+    , _hasPalette(false)
+    , _inflator(nullptr)
+    , _dict(nullptr)
+    , _dictPos(0)
+    , _inflateDone(false)
+    , _row(nullptr)
+    , _prev(nullptr)
+    , _rowPos(0)
+    , _y(0)
+    , _out(nullptr)
+    , _outWidth(0)
+    , _outHeight(0)
+    , _resize(false)
+    , _outY(0)
+    , _sums(nullptr)
+{
+}
+
+PngDecoder::~PngDecoder() {
+    freeBuffers();
+}
+
+bool PngDecoder::isPng(const uint8_t* data, size_t len) {
+    return len >= PNG_SIGNATURE_SIZE && memcmp(data, PNG_SIGNATURE, PNG_SIGNATURE_SIZE) == 0;
+}
+
+bool PngDecoder::begin(uint16_t* out, uint16_t outWidth, uint16_t outHeight, bool resize) {
+    freeBuffers();
+
+    _state = STATE_SIGNATURE;
+    _error = nullptr;
+    _headerLen = 0;
+    _width = 0;
+    _height = 0;
+    _dictPos = 0;
+    _inflateDone = false;
+    _rowPos = 0;
+    _y = 0;
+    _out = out;
+    _outWidth = outWidth;
+    _outHeight = outHeight;
+    _resize = resize;
+    _outY = 0;
+
+    // Indici oltre la palette: nero opaco
+    _hasPalette = false;
+    memset(_palette, 0, sizeof(_palette));
+    for (int i = 0; i < 256; i++) _palette[i][3] = 255;
+
+    _inflator = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+    _dict = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+    if (!_inflator || !_dict) {
+        return fail("Out of memory");
+    }
+    tinfl_init(_inflator);
+    return true;
+}
+
+void PngDecoder::end() {
+    freeBuffers();
+}
+
+void PngDecoder::freeBuffers() {
+    free(_inflator);
+    free(_dict);
+    free(_row);
+    free(_prev);
+    free(_sums);
+    _inflator = nullptr;
+    _dict = nullptr;
+    _row = nullptr;
+    _prev = nullptr;
+    _sums = nullptr;
+}
+
+bool PngDecoder::fail(const char* error) {
+    if (_state != STATE_ERROR) {
+        DEBUG_PRINTF("[PNG] %s\n", error);
+    }
+    _error = error;
+    _state = STATE_ERROR;
+    freeBuffers();
+    return false;
+}
+
+// ═══════════════════════════════════════════
+// Chunk
+// ═══════════════════════════════════════════
+
+bool PngDecoder::feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+
+    while (i < len && _state != STATE_DONE && _state != STATE_ERROR) {
+        switch (_state) {
+            case STATE_SIGNATURE: {
+                size_t n = min(len - i, (size_t)(PNG_SIGNATURE_SIZE - _headerLen));
+                memcpy(_header + _headerLen, data + i, n);
+                _headerLen += n;
+                i += n;
+                if (_headerLen == PNG_SIGNATURE_SIZE) {
+                    if (!isPng(_header, PNG_SIGNATURE_SIZE)) return fail("Not a PNG file");
+                    _headerLen = 0;
+                    _state = STATE_CHUNK_HEADER;
+                }
+                break;
+            }
+
+            case STATE_CHUNK_HEADER: {
+                size_t n = min(len - i, (size_t)(8 - _headerLen));
+                memcpy(_header + _headerLen, data + i, n);
+                _headerLen += n;
+                i += n;
+                if (_headerLen < 8) break;
+
+                _headerLen = 0;
+                _chunkLeft = readBE32(_header);
+                _chunkType = readBE32(_header + 4);
+                _chunkCrc = crc32_le(0, _header + 4, 4);
+                _metaLen = 0;
+
+                if (_width == 0 && _chunkType != PNG_IHDR) return fail("Missing IHDR");
+                bool meta = _chunkType == PNG_IHDR || _chunkType == PNG_PLTE || _chunkType == PNG_TRNS;
+                if (_chunkLeft > 0x7FFFFFFF || (meta && _chunkLeft > PNG_META_MAX)) {
+                    return fail("Invalid chunk length");
+                }
+                _state = _chunkLeft > 0 ? STATE_CHUNK_DATA : STATE_CHUNK_CRC;
+                break;
+            }
+
+            case STATE_CHUNK_DATA: {
+                size_t n = min(len - i, (size_t)_chunkLeft);
+                _chunkCrc = crc32_le(_chunkCrc, data + i, n);
+
+                if (_chunkType == PNG_IDAT) {
+                    if (_colorType == 3 && !_hasPalette) return fail("Missing PLTE");
+                    if (!inflate(data + i, n)) return false;
+                } else if (_chunkType == PNG_IHDR || _chunkType == PNG_PLTE || _chunkType == PNG_TRNS) {
+                    memcpy(_meta + _metaLen, data + i, n);
+                    _metaLen += n;
+                }
+                // Chunk ancillari (testo, gamma, ...) ignorati
+
+                _chunkLeft -= n;
+                i += n;
+                if (_chunkLeft == 0) _state = STATE_CHUNK_CRC;
+                break;
+            }
+
+            case STATE_CHUNK_CRC: {
+                size_t n = min(len - i, (size_t)(4 - _headerLen));
+                memcpy(_header + _headerLen, data + i, n);
+                _headerLen += n;
+                i += n;
+                if (_headerLen < 4) break;
+
+                _headerLen = 0;
+                if (readBE32(_header) != _chunkCrc) return fail("Chunk CRC mismatch");
+                if (!endChunk()) return false;
+                if (_state == STATE_CHUNK_CRC) _state = STATE_CHUNK_HEADER;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return _state != STATE_ERROR;
+}
+
+bool PngDecoder::endChunk() {
+    switch (_chunkType) {
+        case PNG_IHDR:
+            return parseHeader();
+
+        case PNG_PLTE:
+            if (_metaLen % 3 != 0) return fail("Invalid palette");
+            _hasPalette = true;
+            for (size_t i = 0; i < _metaLen / 3; i++) {
+                _palette[i][0] = _meta[i * 3];
+                _palette[i][1] = _meta[i * 3 + 1];
+                _palette[i][2] = _meta[i * 3 + 2];
+            }
+            return true;
+
+        case PNG_TRNS:
+            // Solo alpha della palette; il colore trasparente di grigio/RGB è raro
+            if (_colorType == 3) {
+                for (size_t i = 0; i < _metaLen && i < 256; i++) {
+                    _palette[i][3] = _meta[i];
+                }
+            }
+            return true;
+
+        case PNG_IEND:
+            if (_y < _height) return fail("Truncated image data");
+            _state = STATE_DONE;
+            return true;
+
+        default:
+            return true;
+    }
+}
+
+bool PngDecoder::parseHeader() {
+    if (_metaLen != 13 || _width != 0) return fail("Invalid IHDR");
+
+    uint32_t width = readBE32(_meta);
+    uint32_t height = readBE32(_meta + 4);
+    _bitDepth = _meta[8];
+    _colorType = _meta[9];
+    uint8_t interlace = _meta[12];
+
+    if (width == 0 || height == 0 || width > PNG_MAX_DIMENSION || height > PNG_MAX_DIMENSION) {
+        return fail("Unsupported PNG size");
+    }
+    if (_meta[10] != 0 || _meta[11] != 0) return fail("Invalid IHDR");
+    if (interlace != 0) return fail("Interlaced PNG not supported");
+
+    bool depthOk;
+    switch (_colorType) {
+        case 0: _channels = 1; depthOk = _bitDepth == 1 || _bitDepth == 2 || _bitDepth == 4 || _bitDepth == 8 || _bitDepth == 16; break;
+        case 2: _channels = 3; depthOk = _bitDepth == 8 || _bitDepth == 16; break;
+        case 3: _channels = 1; depthOk = _bitDepth == 1 || _bitDepth == 2 || _bitDepth == 4 || _bitDepth == 8; break;
+        case 4: _channels = 2; depthOk = _bitDepth == 8 || _bitDepth == 16; break;
+        case 6: _channels = 4; depthOk = _bitDepth == 8 || _bitDepth == 16; break;
+        default: depthOk = false; break;
+    }
+    if (!depthOk) return fail("Invalid color type");
+
+    if (!_resize && (width != _outWidth || height != _outHeight)) {
+        return fail("PNG size mismatch");
+    }
+
+    _width = width;
+    _height = height;
+    _rowBytes = ((size_t)_width * _channels * _bitDepth + 7) / 8;
+    _bpp = max(1, _channels * _bitDepth / 8);
+
+    _row = (uint8_t*)malloc(_rowBytes + 1);
+    _prev = (uint8_t*)calloc(_rowBytes + 1, 1);
+    _sums = (uint32_t*)calloc(_outWidth * 3, sizeof(uint32_t));
+    if (!_row || !_prev || !_sums) return fail("Out of memory");
+
+    DEBUG_PRINTF("[PNG] %ux%u, type %u, %u bit\n", _width, _height, _colorType, _bitDepth);
+    return true;
+}
+
+// ═══════════════════════════════════════════
+// Inflate e scanline
+// ═══════════════════════════════════════════
+
+bool PngDecoder::inflate(const uint8_t* data, size_t len) {
+    if (_inflateDone) return true;
+
+    while (true) {
+        size_t inBytes = len;
+        size_t outBytes = TINFL_LZ_DICT_SIZE - _dictPos;
+        tinfl_status status = tinfl_decompress(_inflator, data, &inBytes, _dict, _dict + _dictPos,
+                                               &outBytes, TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+        data += inBytes;
+        len -= inBytes;
+
+        if (outBytes > 0 && !pushBytes(_dict + _dictPos, outBytes)) return false;
+        _dictPos = (_dictPos + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+
+        if (status < TINFL_STATUS_DONE) return fail("Inflate error");
+        if (status == TINFL_STATUS_DONE) {
+            _inflateDone = true;
+            return true;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) return true;
+    }
+}
+
+bool PngDecoder::pushBytes(const uint8_t* data, size_t len) {
+    // Byte oltre l'ultima riga ignorati
+    while (len > 0 && _y < _height) {
+        size_t n = min(len, _rowBytes + 1 - _rowPos);
+        memcpy(_row + _rowPos, data, n);
+        _rowPos += n;
+        data += n;
+        len -= n;
+
+        if (_rowPos == _rowBytes + 1) {
+            if (!unfilter()) return false;
+            emitRow();
+
+            uint8_t* tmp = _prev;
+            _prev = _row;
+            _row = tmp;
+            _rowPos = 0;
+            _y++;
+        }
+    }
+    return true;
+}
+
+bool PngDecoder::unfilter() {
+    uint8_t filter = _row[0];
+    uint8_t* cur = _row + 1;
+    const uint8_t* up = _prev + 1;
+
+    switch (filter) {
+        case 0:
+            break;
+
+        case 1:     // Sub
+            for (size_t i = _bpp; i < _rowBytes; i++) cur[i] += cur[i - _bpp];
+            break;
+
+        case 2:     // Up
+            for (size_t i = 0; i < _rowBytes; i++) cur[i] += up[i];
+            break;
+
+        case 3:     // Average
+            for (size_t i = 0; i < _rowBytes; i++) {
+                uint8_t a = i >= _bpp ? cur[i - _bpp] : 0;
+                cur[i] += (a + up[i]) >> 1;
+            }
+            break;
+
+        case 4:     // Paeth
+            for (size_t i = 0; i < _rowBytes; i++) {
+                int a = i >= _bpp ? cur[i - _bpp] : 0;
+                int b = up[i];
+                int c = i >= _bpp ? up[i - _bpp] : 0;
+                int p = a + b - c;
+                int pa = abs(p - a);
+                int pb = abs(p - b);
+                int pc = abs(p - c);
+                cur[i] += (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+            }
+            break;
+
+        default:
+            return fail("Invalid filter");
+    }
+    return true;
+}
+
+void PngDecoder::readPixel(uint16_t x, uint8_t& r, uint8_t& g, uint8_t& b) const {
+    const uint8_t* row = _row + 1;
+    uint8_t s[4];
+
+    if (_bitDepth < 8) {
+        // Grigio o palette, più pixel per byte (MSB first)
+        size_t bit = (size_t)x * _bitDepth;
+        uint8_t mask = (1 << _bitDepth) - 1;
+        s[0] = (row[bit >> 3] >> (8 - _bitDepth - (bit & 7))) & mask;
+        if (_colorType == 0) s[0] = s[0] * 255 / mask;
+    } else {
+        uint8_t step = _bitDepth / 8;
+        const uint8_t* p = row + (size_t)x * _channels * step;
+        for (uint8_t c = 0; c < _channels; c++) s[c] = p[c * step];   // 16 bit: byte alto
+    }
+
+    uint8_t a = 255;
+    switch (_colorType) {
+        case 0: r = g = b = s[0]; break;
+        case 2: r = s[0]; g = s[1]; b = s[2]; break;
+        case 3: r = _palette[s[0]][0]; g = _palette[s[0]][1]; b = _palette[s[0]][2]; a = _palette[s[0]][3]; break;
+        case 4: r = g = b = s[0]; a = s[1]; break;
+        default: r = s[0]; g = s[1]; b = s[2]; a = s[3]; break;
+    }
+
+    if (a < 255) {
+        r = r * a / 255;
+        g = g * a / 255;
+        b = b * a / 255;
+    }
+}
+
+// Scanline _y (senza filtro) accumulata nelle righe di uscita che la coprono
+void PngDecoder::emitRow() {
+    while (_outY < _outHeight) {
+        uint32_t y0 = (uint32_t)_outY * _height / _outHeight;
+        uint32_t y1 = max(y0 + 1, (uint32_t)(_outY + 1) * _height / _outHeight);
+        if (_y < y0) return;
+
+        for (uint16_t tx = 0; tx < _outWidth; tx++) {
+            uint32_t x0 = (uint32_t)tx * _width / _outWidth;
+            uint32_t x1 = max(x0 + 1, (uint32_t)(tx + 1) * _width / _outWidth);
+            uint32_t* sum = _sums + tx * 3;
+            for (uint32_t x = x0; x < x1; x++) {
+                uint8_t r, g, b;
+                readPixel(x, r, g, b);
+                sum[0] += r;
+                sum[1] += g;
+                sum[2] += b;
+            }
+        }
+
+        if (_y + 1 < y1) return;
+
+        // Riga di uscita completa
+        for (uint16_t tx = 0; tx < _outWidth; tx++) {
+            uint32_t x0 = (uint32_t)tx * _width / _outWidth;
+            uint32_t x1 = max(x0 + 1, (uint32_t)(tx + 1) * _width / _outWidth);
+            uint32_t count = (x1 - x0) * (y1 - y0);
+            uint32_t* sum = _sums + tx * 3;
+            uint8_t r = sum[0] / count;
+            uint8_t g = sum[1] / count;
+            uint8_t b = sum[2] / count;
+            _out[(size_t)_outY * _outWidth + tx] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+            sum[0] = sum[1] = sum[2] = 0;
+        }
+        _outY++;
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef PNG_DECODER_H
+#define PNG_DECODER_H
+
+#include <Arduino.h>
+#include <rom/miniz.h>
+
+// Formati supportati: grigio, RGB, palette, grigio+alpha, RGBA; bit depth
+// 1-16 (16 bit troncati a 8), niente interlacciamento Adam7. L'alpha si
+// compone su nero (come i pixel spenti del pannello).
+#define PNG_SIGNATURE_SIZE 8
+#define PNG_MAX_DIMENSION 512           // Lato massimo della sorgente
+#define PNG_META_MAX 768                // IHDR/PLTE/tRNS bufferizzati (PLTE = 256*3)
+
+/**
+ * PngDecoder - Decodifica PNG a flusso in un buffer RGB565 di dimensione fissa
+ *
+ * feed() accetta il file a pezzi di qualsiasi dimensione: i chunk vengono
+ * analizzati al volo, gli IDAT passano al tinfl della ROM (finestra LZ da
+ * 32 KB) e ogni scanline, tolto il filtro, viene subito ridotta nell'uscita.
+ * RAM: inflater + finestra (~43 KB, solo durante la decodifica) più due
+ * scanline; mai il file o l'immagine sorgente intera.
+ *
+ * Ridimensionamento a box (media delle sorgenti che cadono in ogni pixel di
+ * uscita) se la sorgente è più grande, nearest se più piccola. Senza
+ * resize una sorgente di dimensione diversa dall'uscita è un errore.
+ */
+class PngDecoder {
+public:
+    PngDecoder();
+    ~PngDecoder();
+
+    bool begin(uint16_t* out, uint16_t outWidth, uint16_t outHeight, bool resize);
+    bool feed(const uint8_t* data, size_t len);     // false = errore (vedi getError)
+    void end();
+
+    bool isDone() const { return _state == STATE_DONE; }
+    const char* getError() const { return _error; }
+    uint16_t getWidth() const { return _width; }
+    uint16_t getHeight() const { return _height; }
+
+    static bool isPng(const uint8_t* data, size_t len);
+
+private:
+    enum State {
+        STATE_SIGNATURE,
+        STATE_CHUNK_HEADER,
+        STATE_CHUNK_DATA,
+        STATE_CHUNK_CRC,
+        STATE_DONE,
+        STATE_ERROR
+    };
+
+    State _state;
+    const char* _error;
+
+    // Parser dei chunk
+    uint8_t _header[8];                 // Firma o lunghezza + tipo del chunk
+    uint8_t _headerLen;
+    uint32_t _chunkType;
+    uint32_t _chunkLeft;
+    uint32_t _chunkCrc;
+    uint8_t _meta[PNG_META_MAX];
+    size_t _metaLen;
+
+    // IHDR e palette
+    uint16_t _width;
+    uint16_t _height;
+    uint8_t _bitDepth;
+    uint8_t _colorType;
+    uint8_t _channels;
+    uint8_t _bpp;                       // Byte per pixel del filtro (min 1)
+    size_t _rowBytes;
+    bool _hasPalette;
+    uint8_t _palette[256][4];           // RGBA
+
+    // Inflate
+    tinfl_decompressor* _inflator;
+    uint8_t* _dict;
+    size_t _dictPos;
+    bool _inflateDone;
+
+    // Scanline: filtro + dati, riga precedente per Up/Average/Paeth
+    uint8_t* _row;
+    uint8_t* _prev;
+    size_t _rowPos;
+    uint16_t _y;
+
+    // Uscita e riduzione
+    uint16_t* _out;
+    uint16_t _outWidth;
+    uint16_t _outHeight;
+    bool _resize;
+    uint16_t _outY;
+    uint32_t* _sums;                    // r, g, b per colonna di uscita
+
+    bool fail(const char* error);
+    bool endChunk();
+    bool parseHeader();
+    bool inflate(const uint8_t* data, size_t len);
+    bool pushBytes(const uint8_t* data, size_t len);
+    bool unfilter();
+    void emitRow();
+    void readPixel(uint16_t x, uint8_t& r, uint8_t& g, uint8_t& b) const;
+    void freeBuffers();
+};
+
+#endif // PNG_DECODER_H
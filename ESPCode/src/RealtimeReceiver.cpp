@@ -0,0 +1,485 @@
+#include "RealtimeReceiver.h"
+
+static inline uint16_t be16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+static inline uint16_t le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static inline uint32_t be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// DDP
+#define DDP_FLAGS_VER_MASK 0xC0
+#define DDP_FLAGS_VER1     0x40
+#define DDP_FLAGS_TIMECODE 0x10
+#define DDP_FLAGS_QUERY    0x02
+#define DDP_FLAGS_PUSH     0x01
+#define DDP_ID_DISPLAY     1
+#define DDP_ID_ALL         255
+#define DDP_TYPE_RGBW      3        // Bit 5-3 del data type
+
+// E1.31 (ANSI E1.31-2018)
+#define E131_ROOT_VECTOR_DATA      0x00000004
+#define E131_ROOT_VECTOR_EXTENDED  0x00000008
+#define E131_FRAME_VECTOR_DATA     0x00000002
+#define E131_EXTENDED_VECTOR_SYNC  0x00000001
+#define E131_OPT_PREVIEW           0x80
+#define E131_OPT_TERMINATED        0x40
+#define E131_DATA_OFFSET           126
+#define E131_SYNC_LENGTH           49
+
+// Art-Net
+#define ARTNET_OP_DMX  0x5000
+#define ARTNET_OP_SYNC 0x5200
+#define ARTNET_DATA_OFFSET 18
+
+static const uint8_t E131_ACN_ID[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+static const uint8_t ARTNET_ID[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+
+RealtimeReceiver::RealtimeReceiver()
+    : _width(0)
+    , _height(0)
+    , _pixels(0)
+    , _back(0)
+    , _ready(1)
+    , _front(2)
+    , _fresh(false)
+    , _mux(portMUX_INITIALIZER_UNLOCKED)
+    , _running(false)
+    , _busy(false)
+    , _dirty(false)
+    , _lastUniverse(-1)
+    , _syncUntilMs(0)
+    , _startUniverse(1)
+    , _universePixels(REALTIME_UNIVERSE_PIXELS)
+    , _owner(-1)
+{
+    memset(_buffers, 0, sizeof(_buffers));
+    memset(_sources, 0, sizeof(_sources));
+    resetStats();
+}
+
+RealtimeReceiver::~RealtimeReceiver() {
+    end();
+}
+
+// ═══════════════════════════════════════════
+// Avvio / arresto
+// ═══════════════════════════════════════════
+
+bool RealtimeReceiver::begin(uint16_t width, uint16_t height) {
+    if (_running) return true;
+
+    _width = width;
+    _height = height;
+    _pixels = (size_t)width * height;
+
+    uint16_t* block = (uint16_t*)malloc(3 * _pixels * sizeof(uint16_t));
+    if (!block) {
+        DEBUG_PRINTLN("[Realtime] Failed to allocate frame buffers");
+        return false;
+    }
+    memset(block, 0, 3 * _pixels * sizeof(uint16_t));
+    for (uint8_t i = 0; i < 3; i++) _buffers[i] = block + i * _pixels;
+    _back = 0;
+    _ready = 1;
+    _front = 2;
+    _fresh = false;
+    _dirty = false;
+    _lastUniverse = -1;
+    _syncUntilMs = 0;
+    memset(_sources, 0, sizeof(_sources));
+    _owner = -1;
+
+    bool ok = _ddp.begin(DDP_PORT);
+    ok = _e131.begin(E131_PORT) && ok;
+    ok = _artnet.begin(ARTNET_PORT) && ok;
+    if (!ok) {
+        DEBUG_PRINTLN("[Realtime] Failed to open one or more UDP ports");
+    }
+
+    portENTER_CRITICAL(&_mux);
+    _running = true;
+    portEXIT_CRITICAL(&_mux);
+
+    DEBUG_PRINTF("[Realtime] Listening DDP:%d E1.31:%d Art-Net:%d (%ux%u, universe %u x %u px)\n",
+                 DDP_PORT, E131_PORT, ARTNET_PORT, width, height, _startUniverse, _universePixels);
+    return true;
+}
+
+void RealtimeReceiver::end() {
+    if (!_buffers[0]) return;
+
+    portENTER_CRITICAL(&_mux);
+    _running = false;
+    portEXIT_CRITICAL(&_mux);
+
+    // update() in corso sul loop: finisce prima di chiudere e liberare
+    while (_busy) {
+        vTaskDelay(1);
+    }
+
+    _ddp.stop();
+    _e131.stop();
+    _artnet.stop();
+
+    free(_buffers[0]);
+    memset(_buffers, 0, sizeof(_buffers));
+    _fresh = false;
+    _owner = -1;
+    DEBUG_PRINTLN("[Realtime] Stopped");
+}
+
+void RealtimeReceiver::setUniverseMap(uint16_t startUniverse, uint8_t universePixels) {
+    _startUniverse = startUniverse;
+    _universePixels = universePixels > 0 && universePixels <= REALTIME_UNIVERSE_PIXELS
+                          ? universePixels : REALTIME_UNIVERSE_PIXELS;
+}
+
+void RealtimeReceiver::resetStats() {
+    _packets = 0;
+    _frames = 0;
+    _ignored = 0;
+    _errors = 0;
+    _syncs = 0;
+}
+
+// ═══════════════════════════════════════════
+// Loop
+// ═══════════════════════════════════════════
+
+void RealtimeReceiver::update() {
+    portENTER_CRITICAL(&_mux);
+    bool running = _running;
+    if (running) _busy = true;
+    portEXIT_CRITICAL(&_mux);
+    if (!running) return;
+
+    uint32_t now = millis();
+    poll(_ddp, RT_DDP, now);
+    poll(_e131, RT_E131, now);
+    poll(_artnet, RT_ARTNET, now);
+    expireSources(now);
+
+    _busy = false;
+}
+
+void RealtimeReceiver::poll(WiFiUDP& udp, RealtimeProtocol protocol, uint32_t nowMs) {
+    for (uint8_t i = 0; i < REALTIME_PACKETS_PER_UPDATE; i++) {
+        int size = udp.parsePacket();
+        if (size <= 0) return;
+
+        int len = udp.read(_packet, sizeof(_packet));
+        if (len <= 0) continue;
+        handlePacket(protocol, _packet, len, (uint32_t)udp.remoteIP(), nowMs);
+    }
+}
+
+void RealtimeReceiver::handlePacket(RealtimeProtocol protocol, const uint8_t* data, size_t len,
+                                    uint32_t sourceIp, uint32_t nowMs) {
+    _packets++;
+    switch (protocol) {
+        case RT_DDP:    parseDdp(data, len, sourceIp, nowMs); break;
+        case RT_E131:   parseE131(data, len, sourceIp, nowMs); break;
+        case RT_ARTNET: parseArtNet(data, len, sourceIp, nowMs); break;
+        default:        _errors++; break;
+    }
+}
+
+// ═══════════════════════════════════════════
+// Protocolli
+// ═══════════════════════════════════════════
+
+void RealtimeReceiver::parseDdp(const uint8_t* data, size_t len, uint32_t ip, uint32_t nowMs) {
+    if (len < 10 || (data[0] & DDP_FLAGS_VER_MASK) != DDP_FLAGS_VER1) {
+        _errors++;
+        return;
+    }
+
+    uint8_t flags = data[0];
+    if (flags & DDP_FLAGS_QUERY) return;           // Nessuna risposta alle query
+    if (data[3] != DDP_ID_DISPLAY && data[3] != DDP_ID_ALL) {
+        _ignored++;
+        return;
+    }
+
+    size_t header = (flags & DDP_FLAGS_TIMECODE) ? 14 : 10;
+    uint32_t offset = be32(data + 4);
+    uint16_t length = be16(data + 8);
+    if (header + length > len) {
+        _errors++;
+        return;
+    }
+
+    if (!acceptSource(RT_DDP, ip, REALTIME_DEFAULT_PRIORITY, nowMs)) return;
+
+    // Offset in byte: un pixel spezzato a inizio pacchetto si salta
+    uint8_t bpp = ((data[2] >> 3) & 0x07) == DDP_TYPE_RGBW ? 4 : 3;
+    size_t skip = (bpp - offset % bpp) % bpp;
+    if (length > skip) {
+        writePixels(offset / bpp + (skip ? 1 : 0), data + header + skip, (length - skip) / bpp, bpp);
+    }
+
+    if (flags & DDP_FLAGS_PUSH) {
+        _syncs++;
+        publish();
+    }
+}
+
+void RealtimeReceiver::parseE131(const uint8_t* data, size_t len, uint32_t ip, uint32_t nowMs) {
+    if (len < E131_SYNC_LENGTH || be16(data) != 0x0010 || memcmp(data + 4, E131_ACN_ID, sizeof(E131_ACN_ID)) != 0) {
+        _errors++;
+        return;
+    }
+
+    uint32_t rootVector = be32(data + 18);
+    uint32_t frameVector = be32(data + 40);
+
+    if (rootVector == E131_ROOT_VECTOR_EXTENDED && frameVector == E131_EXTENDED_VECTOR_SYNC) {
+        handleSync(RT_E131, ip, nowMs);
+        return;
+    }
+    if (rootVector != E131_ROOT_VECTOR_DATA || frameVector != E131_FRAME_VECTOR_DATA ||
+        len < E131_DATA_OFFSET || data[117] != 0x02 || data[125] != 0x00) {
+        // Start code diverso da 0 (es. 0xDD priorità per canale): non sono pixel
+        _ignored++;
+        return;
+    }
+
+    uint8_t priority = data[108];
+    uint16_t syncAddress = be16(data + 109);
+    uint8_t options = data[112];
+    uint16_t universe = be16(data + 113);
+    size_t channels = be16(data + 123);
+    channels = channels > 0 ? channels - 1 : 0;                 // Senza start code
+    if (E131_DATA_OFFSET + channels > len) channels = len - E131_DATA_OFFSET;
+
+    if (options & E131_OPT_TERMINATED) {
+        for (int8_t i = 0; i < REALTIME_MAX_SOURCES; i++) {
+            if (_sources[i].protocol == RT_E131 && _sources[i].ip == ip) removeSource(i);
+        }
+        return;
+    }
+    if (options & E131_OPT_PREVIEW) {
+        _ignored++;
+        return;
+    }
+
+    if (!acceptSource(RT_E131, ip, priority, nowMs)) return;
+    if (syncAddress != 0) _syncUntilMs = nowMs + REALTIME_SYNC_HOLD_MS;
+    writeUniverse(universe, data + E131_DATA_OFFSET, channels, nowMs);
+}
+
+void RealtimeReceiver::parseArtNet(const uint8_t* data, size_t len, uint32_t ip, uint32_t nowMs) {
+    if (len < 12 || memcmp(data, ARTNET_ID, sizeof(ARTNET_ID)) != 0) {
+        _errors++;
+        return;
+    }
+
+    uint16_t opcode = le16(data + 8);
+    if (opcode == ARTNET_OP_SYNC) {
+        handleSync(RT_ARTNET, ip, nowMs);
+        return;
+    }
+    if (opcode != ARTNET_OP_DMX) {
+        _ignored++;                                 // ArtPoll & co.: nessuna risposta
+        return;
+    }
+    if (len < ARTNET_DATA_OFFSET) {
+        _errors++;
+        return;
+    }
+
+    uint16_t universe = le16(data + 14) & 0x7FFF;   // Net + SubUni (port address 15 bit)
+    size_t channels = be16(data + 16);
+    if (ARTNET_DATA_OFFSET + channels > len) channels = len - ARTNET_DATA_OFFSET;
+
+    if (!acceptSource(RT_ARTNET, ip, REALTIME_DEFAULT_PRIORITY, nowMs)) return;
+    writeUniverse(universe, data + ARTNET_DATA_OFFSET, channels, nowMs);
+}
+
+void RealtimeReceiver::handleSync(RealtimeProtocol protocol, uint32_t ip, uint32_t nowMs) {
+    if (!isOwner(protocol, ip)) {
+        _ignored++;
+        return;
+    }
+    _syncs++;
+    _syncUntilMs = nowMs + REALTIME_SYNC_HOLD_MS;
+    publish();
+}
+
+// ═══════════════════════════════════════════
+// Sorgenti
+// ═══════════════════════════════════════════
+
+// true se i pixel della sorgente vanno mostrati
+bool RealtimeReceiver::acceptSource(RealtimeProtocol protocol, uint32_t ip, uint8_t priority, uint32_t nowMs) {
+    int8_t index = -1;
+    int8_t freeSlot = -1;
+    for (int8_t i = 0; i < REALTIME_MAX_SOURCES; i++) {
+        if (_sources[i].protocol == protocol && _sources[i].ip == ip) {
+            index = i;
+            break;
+        }
+        if (_sources[i].protocol == RT_NONE && freeSlot < 0) freeSlot = i;
+    }
+
+    if (index < 0) {
+        if (freeSlot < 0) {
+            _ignored++;
+            return false;
+        }
+        index = freeSlot;
+        _sources[index].protocol = protocol;
+        _sources[index].ip = ip;
+        DEBUG_PRINTF("[Realtime] New %s source %u.%u.%u.%u (priority %u)\n", protocolName(protocol),
+                     ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, ip >> 24, priority);
+    }
+    _sources[index].priority = priority;
+    _sources[index].lastSeenMs = nowMs;
+
+    if (_owner < 0 || (index != _owner && priority > _sources[_owner].priority)) {
+        electOwner();
+    }
+    if (index != _owner) {
+        _ignored++;
+        return false;
+    }
+    return true;
+}
+
+bool RealtimeReceiver::isOwner(RealtimeProtocol protocol, uint32_t ip) const {
+    int8_t owner = _owner;
+    return owner >= 0 && _sources[owner].protocol == protocol && _sources[owner].ip == ip;
+}
+
+// Priorità più alta; a pari priorità resta la sorgente corrente
+void RealtimeReceiver::electOwner() {
+    int8_t best = _owner >= 0 && _sources[_owner].protocol != RT_NONE ? _owner : -1;
+    for (int8_t i = 0; i < REALTIME_MAX_SOURCES; i++) {
+        if (_sources[i].protocol == RT_NONE) continue;
+        if (best < 0 || _sources[i].priority > _sources[best].priority) best = i;
+    }
+
+    if (best != _owner) {
+        // Nuova sorgente: niente pixel a metà dal frame della precedente
+        _dirty = false;
+        _lastUniverse = -1;
+        _syncUntilMs = 0;
+        if (best >= 0) {
+            uint32_t ip = _sources[best].ip;
+            DEBUG_PRINTF("[Realtime] Active source: %s %u.%u.%u.%u\n", protocolName(_sources[best].protocol),
+                         ip & 0xFF, (ip >> 8) & 0xFF, (ip >> 16) & 0xFF, ip >> 24);
+        }
+    }
+    _owner = best;
+}
+
+void RealtimeReceiver::removeSource(int8_t index) {
+    _sources[index].protocol = RT_NONE;
+    if (index == _owner) {
+        _owner = -1;
+        electOwner();
+        if (_owner < 0) DEBUG_PRINTLN("[Realtime] No active source");
+    }
+}
+
+void RealtimeReceiver::expireSources(uint32_t nowMs) {
+    for (int8_t i = 0; i < REALTIME_MAX_SOURCES; i++) {
+        if (_sources[i].protocol != RT_NONE && nowMs - _sources[i].lastSeenMs > REALTIME_SOURCE_TIMEOUT_MS) {
+            removeSource(i);
+        }
+    }
+}
+
+RealtimeProtocol RealtimeReceiver::getProtocol() const {
+    int8_t owner = _owner;
+    return owner >= 0 ? _sources[owner].protocol : RT_NONE;
+}
+
+uint32_t RealtimeReceiver::getSourceIp() const {
+    int8_t owner = _owner;
+    return owner >= 0 ? _sources[owner].ip : 0;
+}
+
+uint8_t RealtimeReceiver::getSourcePriority() const {
+    int8_t owner = _owner;
+    return owner >= 0 ? _sources[owner].priority : 0;
+}
+
+const char* RealtimeReceiver::protocolName(RealtimeProtocol protocol) {
+    switch (protocol) {
+        case RT_DDP:    return "ddp";
+        case RT_E131:   return "e131";
+        case RT_ARTNET: return "artnet";
+        default:        return "none";
+    }
+}
+
+// ═══════════════════════════════════════════
+// Pixel e frame
+// ═══════════════════════════════════════════
+
+void RealtimeReceiver::writeUniverse(uint16_t universe, const uint8_t* dmx, size_t channels, uint32_t nowMs) {
+    if (universe < _startUniverse) {
+        _ignored++;
+        return;
+    }
+    size_t pixel = (size_t)(universe - _startUniverse) * _universePixels;
+    if (pixel >= _pixels) {
+        _ignored++;
+        return;
+    }
+
+    bool sync = isSyncMode(nowMs);
+
+    // Universo già ricevuto nel frame corrente: il controller è ripartito dal primo
+    if (!sync && _dirty && (int32_t)universe <= _lastUniverse) publish();
+
+    size_t count = channels / 3;
+    if (count > _universePixels) count = _universePixels;
+    writePixels(pixel, dmx, count, 3);
+    _lastUniverse = universe;
+
+    uint16_t lastMapped = _startUniverse + (_pixels - 1) / _universePixels;
+    if (!sync && universe == lastMapped) publish();
+}
+
+void RealtimeReceiver::writePixels(size_t pixel, const uint8_t* src, size_t count, uint8_t bytesPerPixel) {
+    if (pixel >= _pixels) return;
+    if (count > _pixels - pixel) count = _pixels - pixel;
+
+    uint16_t* dst = _buffers[_back] + pixel;
+    for (size_t i = 0; i < count; i++, src += bytesPerPixel) {
+        dst[i] = ((src[0] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[2] >> 3);
+    }
+    if (count > 0) _dirty = true;
+}
+
+void RealtimeReceiver::publish() {
+    if (!_dirty) return;
+
+    portENTER_CRITICAL(&_mux);
+    int8_t published = _back;
+    _back = _ready;
+    _ready = published;
+    _fresh = true;
+    portEXIT_CRITICAL(&_mux);
+
+    // Il prossimo frame parte da quello appena pubblicato (solo il loop scrive _back)
+    memcpy(_buffers[_back], _buffers[published], _pixels * sizeof(uint16_t));
+    _dirty = false;
+    _lastUniverse = -1;
+    _frames++;
+}
+
+const uint16_t* RealtimeReceiver::takeFrame() {
+    if (!_fresh) return nullptr;
+
+    portENTER_CRITICAL(&_mux);
+    int8_t front = _front;
+    _front = _ready;
+    _ready = front;
+    _fresh = false;
+    const uint16_t* frame = _buffers[_front];
+    portEXIT_CRITICAL(&_mux);
+    return frame;
+}
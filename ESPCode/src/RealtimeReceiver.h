@@ -0,0 +1,156 @@
+#ifndef REALTIME_RECEIVER_H
+#define REALTIME_RECEIVER_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include "Debug.h"
+
+// Porte UDP standard
+#define DDP_PORT 4048
+#define E131_PORT 5568          // Solo unicast (niente gruppi multicast per universo)
+#define ARTNET_PORT 6454
+
+#define REALTIME_SOURCE_TIMEOUT_MS 2500     // E1.31: perdita dati dopo 2.5 s
+#define REALTIME_SYNC_HOLD_MS 4000          // Art-Net: modalità sync valida 4 s dopo l'ultimo sync
+#define REALTIME_MAX_SOURCES 4
+#define REALTIME_MAX_PACKET 1500
+#define REALTIME_PACKETS_PER_UPDATE 16      // Per socket e per giro di loop
+#define REALTIME_UNIVERSE_PIXELS 170        // 510 canali DMX RGB per universo
+#define REALTIME_DEFAULT_PRIORITY 100       // Priorità E1.31 di default (anche DDP/Art-Net)
+
+enum RealtimeProtocol : uint8_t {
+    RT_NONE,
+    RT_DDP,
+    RT_E131,
+    RT_ARTNET
+};
+
+/**
+ * RealtimeReceiver - Ricevitore UDP DDP / E1.31 (sACN) / Art-Net
+ *
+ * Servizio come DiscoveryService: update() nel loop legge i pacchetti e
+ * scrive i pixel RGB (convertiti in RGB565) in un frame in costruzione.
+ * Mappatura: DDP per offset in byte; E1.31/Art-Net per universo, a partire
+ * da startUniverse con universePixels pixel RGB ciascuno, riga per riga
+ * sul canvas.
+ *
+ * Fine frame:
+ *   DDP          flag PUSH
+ *   E1.31        pacchetto sync, oppure (senza sync) ultimo universo mappato
+ *   Art-Net      ArtSync, oppure (senza sync) ultimo universo mappato
+ * Un universo ripetuto prima della fine chiude comunque il frame.
+ *
+ * Sorgenti: una tabella per IP e protocollo con timeout; i pixel arrivano
+ * solo dalla sorgente attiva con priorità più alta (priorità E1.31).
+ *
+ * Triple buffer tra loop (scrittura) e task di render (takeFrame()): il
+ * frame nuovo parte da una copia dell'ultimo pubblicato (aggiornamenti
+ * parziali). handlePacket() non tocca i socket: testabile con pacchetti
+ * generati su un host.
+ */
+class RealtimeReceiver {
+public:
+    RealtimeReceiver();
+    ~RealtimeReceiver();
+
+    // Task di render/setup: alloca i buffer e apre i socket
+    bool begin(uint16_t width, uint16_t height);
+    void end();
+    bool isRunning() const { return _running; }
+
+    // Loop: legge i socket e scade le sorgenti
+    void update();
+
+    // Un pacchetto già letto (ip in formato IPAddress → uint32_t)
+    void handlePacket(RealtimeProtocol protocol, const uint8_t* data, size_t len,
+                      uint32_t sourceIp, uint32_t nowMs);
+    void expireSources(uint32_t nowMs);
+
+    void setUniverseMap(uint16_t startUniverse, uint8_t universePixels);
+    uint16_t getStartUniverse() const { return _startUniverse; }
+    uint8_t getUniversePixels() const { return _universePixels; }
+
+    // Task di render: ultimo frame completo, nullptr se non ce n'è uno nuovo
+    const uint16_t* takeFrame();
+    uint16_t getWidth() const { return _width; }
+    uint16_t getHeight() const { return _height; }
+
+    // Sorgente attiva
+    bool isActive() const { return _owner >= 0; }
+    RealtimeProtocol getProtocol() const;
+    uint32_t getSourceIp() const;
+    uint8_t getSourcePriority() const;
+    bool isSyncMode(uint32_t nowMs) const { return (int32_t)(_syncUntilMs - nowMs) > 0; }
+    static const char* protocolName(RealtimeProtocol protocol);
+
+    // Statistiche
+    uint32_t getPackets() const { return _packets; }
+    uint32_t getFrames() const { return _frames; }
+    uint32_t getIgnored() const { return _ignored; }
+    uint32_t getErrors() const { return _errors; }
+    uint32_t getSyncs() const { return _syncs; }
+    void resetStats();
+
+private:
+    struct Source {
+        uint32_t ip;
+        RealtimeProtocol protocol;      // RT_NONE = slot libero
+        uint8_t priority;
+        uint32_t lastSeenMs;
+    };
+
+    WiFiUDP _ddp;
+    WiFiUDP _e131;
+    WiFiUDP _artnet;
+
+    uint16_t _width;
+    uint16_t _height;
+    size_t _pixels;
+
+    // Triple buffer: _back scritto dal loop, _front letto dal render
+    uint16_t* _buffers[3];
+    int8_t _back;
+    int8_t _ready;
+    int8_t _front;
+    volatile bool _fresh;
+    portMUX_TYPE _mux;
+    volatile bool _running;
+    volatile bool _busy;
+
+    // Frame in costruzione
+    bool _dirty;
+    int32_t _lastUniverse;              // -1 = nessun universo nel frame corrente
+    uint32_t _syncUntilMs;
+
+    uint16_t _startUniverse;
+    uint8_t _universePixels;
+
+    Source _sources[REALTIME_MAX_SOURCES];
+    volatile int8_t _owner;
+
+    uint32_t _packets;
+    uint32_t _frames;
+    uint32_t _ignored;
+    uint32_t _errors;
+    uint32_t _syncs;
+
+    uint8_t _packet[REALTIME_MAX_PACKET];
+
+    void poll(WiFiUDP& udp, RealtimeProtocol protocol, uint32_t nowMs);
+
+    void parseDdp(const uint8_t* data, size_t len, uint32_t ip, uint32_t nowMs);
+    void parseE131(const uint8_t* data, size_t len, uint32_t ip, uint32_t nowMs);
+    void parseArtNet(const uint8_t* data, size_t len, uint32_t ip, uint32_t nowMs);
+
+    bool acceptSource(RealtimeProtocol protocol, uint32_t ip, uint8_t priority, uint32_t nowMs);
+    bool isOwner(RealtimeProtocol protocol, uint32_t ip) const;
+    void removeSource(int8_t index);
+    void electOwner();
+
+    void handleSync(RealtimeProtocol protocol, uint32_t ip, uint32_t nowMs);
+    void writeUniverse(uint16_t universe, const uint8_t* dmx, size_t channels, uint32_t nowMs);
+    void writePixels(size_t pixel, const uint8_t* src, size_t count, uint8_t bytesPerPixel);
+    void publish();
+};
+
+#endif // REALTIME_RECEIVER_H
@@ -0,0 +1,102 @@
+#include "RenderTask.h"
+
+RenderTask::RenderTask()
+    : _handle(nullptr)
+    , _frame(nullptr)
+    , _core(RENDER_TASK_CORE)
+    , _frameMs(RENDER_FRAME_MS)
+    , _lastStartUs(0)
+    , _frames(0)
+    , _periodTotalUs(0)
+    , _jitterTotalUs(0)
+    , _jitterMaxUs(0)
+    , _workMaxUs(0)
+    , _lateFrames(0)
+{}
+
+bool RenderTask::begin(FrameCallback frame, uint8_t core, uint32_t frameMs) {
+    if (_handle || !frame) return false;
+
+    _frame = frame;
+    _core = core;
+    _frameMs = frameMs > 0 ? frameMs : 1;
+
+    BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "render", RENDER_TASK_STACK,
+                                            this, RENDER_TASK_PRIORITY, &_handle, _core);
+    if (ok != pdPASS) {
+        _handle = nullptr;
+        DEBUG_PRINTLN(F("[Render] ✗ Task creation failed"));
+        return false;
+    }
+
+    DEBUG_PRINTF("[Render] Task started on core %u (prio %u, %lu ms/frame)\n",
+                 _core, RENDER_TASK_PRIORITY, (unsigned long)_frameMs);
+    return true;
+}
+
+void RenderTask::taskEntry(void* arg) {
+    static_cast<RenderTask*>(arg)->run();
+}
+
+void RenderTask::run() {
+    TickType_t lastWake = xTaskGetTickCount();
+
+    for (;;) {
+        // Il periodo può cambiare a runtime (setFrameMs da un comando)
+        TickType_t period = pdMS_TO_TICKS(_frameMs) > 0 ? pdMS_TO_TICKS(_frameMs) : 1;
+        uint32_t periodUs = _frameMs * 1000;
+
+        uint32_t start = micros();
+        if (_lastStartUs != 0) {
+            uint32_t interval = start - _lastStartUs;
+            uint32_t jitter = interval > periodUs ? interval - periodUs : periodUs - interval;
+            _frames++;
+            _periodTotalUs += interval;
+            _jitterTotalUs += jitter;
+            if (jitter > _jitterMaxUs) _jitterMaxUs = jitter;
+        }
+        _lastStartUs = start;
+
+        _frame();
+
+        uint32_t work = micros() - start;
+        if (work > _workMaxUs) _workMaxUs = work;
+
+        // Frame in ritardo: riparte da ora invece di recuperare a raffica,
+        // e cede un tick ai task a priorità più bassa
+        if (xTaskGetTickCount() - lastWake >= period) {
+            _lateFrames++;
+            vTaskDelay(1);
+            lastWake = xTaskGetTickCount();
+        } else {
+            vTaskDelayUntil(&lastWake, period);
+        }
+    }
+}
+
+void RenderTask::setFrameMs(uint32_t frameMs) {
+    _frameMs = frameMs > 0 ? frameMs : 1;
+    resetStats();
+}
+
+void RenderTask::resetStats() {
+    _frames = 0;
+    _periodTotalUs = 0;
+    _jitterTotalUs = 0;
+    _jitterMaxUs = 0;
+    _workMaxUs = 0;
+    _lateFrames = 0;
+}
+
+void RenderTask::printStats() {
+    if (_frames == 0) return;
+
+    DEBUG_PRINTF("[Stats] Render: core %u | period avg %lu us (target %lu) | jitter avg %lu us max %lu us | work max %lu us | late %lu\n",
+                 _core,
+                 (unsigned long)getAvgPeriodUs(),
+                 (unsigned long)(_frameMs * 1000),
+                 (unsigned long)getAvgJitterUs(),
+                 (unsigned long)_jitterMaxUs,
+                 (unsigned long)_workMaxUs,
+                 (unsigned long)_lateFrames);
+}
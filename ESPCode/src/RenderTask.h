@@ -0,0 +1,84 @@
+#ifndef RENDER_TASK_H
+#define RENDER_TASK_H
+
+#include <Arduino.h>
+#include "Debug.h"
+
+// ═══════════════════════════════════════════
+// Render Task Configuration
+// ═══════════════════════════════════════════
+// Core del task di rendering. AsyncTCP gira sull'altro core
+// (CONFIG_ASYNC_TCP_RUNNING_CORE in platformio.ini)
+#ifndef RENDER_TASK_CORE
+#define RENDER_TASK_CORE 1
+#endif
+
+// Sopra loopTask (1), così WiFi/discovery/seriale non rubano frame
+#ifndef RENDER_TASK_PRIORITY
+#define RENDER_TASK_PRIORITY 2
+#endif
+
+// Stack come loopTask, che finora eseguiva lo stesso lavoro
+#ifndef RENDER_TASK_STACK
+#define RENDER_TASK_STACK 8192
+#endif
+
+// Periodo frame (ms): 10 ms = il vecchio delay(10) del loop
+#ifndef RENDER_FRAME_MS
+#define RENDER_FRAME_MS 10
+#endif
+
+/**
+ * RenderTask - Task FreeRTOS dedicato al rendering
+ *
+ * Esegue la callback di frame a periodo fisso (vTaskDelayUntil) su un core
+ * dedicato e misura il jitter: scarto tra l'intervallo effettivo fra due
+ * inizi frame consecutivi e il periodo nominale.
+ */
+class RenderTask {
+public:
+    typedef void (*FrameCallback)();
+
+    RenderTask();
+
+    bool begin(FrameCallback frame,
+               uint8_t core = RENDER_TASK_CORE,
+               uint32_t frameMs = RENDER_FRAME_MS);
+    bool isRunning() const { return _handle != nullptr; }
+    bool isRenderTask() const { return _handle && xTaskGetCurrentTaskHandle() == _handle; }
+
+    // Periodo frame a runtime: gli effetti a passo fisso mantengono la
+    // stessa velocità, cambia solo quante volte al secondo si disegna
+    void setFrameMs(uint32_t frameMs);
+
+    // Statistiche jitter (lette e azzerate dal task di render stesso)
+    uint8_t getCore() const { return _core; }
+    uint32_t getFrameMs() const { return _frameMs; }
+    uint32_t getFrames() const { return _frames; }
+    uint32_t getAvgPeriodUs() const { return _frames ? (uint32_t)(_periodTotalUs / _frames) : 0; }
+    uint32_t getAvgJitterUs() const { return _frames ? (uint32_t)(_jitterTotalUs / _frames) : 0; }
+    uint32_t getMaxJitterUs() const { return _jitterMaxUs; }
+    uint32_t getMaxWorkUs() const { return _workMaxUs; }
+    uint32_t getLateFrames() const { return _lateFrames; }
+    void resetStats();
+    void printStats();
+
+private:
+    TaskHandle_t _handle;
+    FrameCallback _frame;
+    uint8_t _core;
+    uint32_t _frameMs;
+
+    uint32_t _lastStartUs;
+    uint32_t _frames;
+    uint64_t _periodTotalUs;
+    uint64_t _jitterTotalUs;
+    uint32_t _jitterMaxUs;
+    uint32_t _workMaxUs;
+    uint32_t _lateFrames;       // Frame più lunghi del periodo
+
+    static void taskEntry(void* arg);
+    void run();
+};
+
+#endif // RENDER_TASK_H
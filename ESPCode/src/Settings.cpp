@@ -15,11 +15,19 @@ void Settings::setDefaults() {
     config.brightnessNight = 30;
     config.nightStartHour = 22;
     config.nightEndHour = 7;
+    config.doubleBuffer = DISPLAY_DOUBLE_BUFFER;
+    config.gamma = COLOR_GAMMA_DEFAULT;
+    config.whiteR = 255;
+    config.whiteG = 255;
+    config.whiteB = 255;
+    config.ditherMode = DITHER_NIGHT;
     
     // Effects defaults
     config.effectDuration = 10000;  // 10 secondi
     config.autoSwitch = true;
     config.currentEffect = -1;  // Auto
+    config.transitionType = 1;  // Fade
+    config.transitionMs = 600;
     
     // Device defaults
     strcpy(config.deviceName, "ledmatrix");
@@ -31,6 +39,11 @@ void Settings::setDefaults() {
     // NTP/Timezone defaults
     config.ntpEnabled = true;
     strcpy(config.timezone, "CET-1CEST,M3.5.0,M10.5.0/3");  // Italia
+
+    // Realtime defaults (disattivato: porte UDP aperte solo su richiesta)
+    config.realtimeEnabled = false;
+    config.realtimeUniverse = 1;
+    config.realtimeUniversePixels = 170;
 }
 
 void Settings::begin() {
@@ -51,11 +64,19 @@ void Settings::load() {
     config.brightnessNight = preferences.getUChar("brightNight", 30);
     config.nightStartHour = preferences.getUChar("nightStart", 22);
     config.nightEndHour = preferences.getUChar("nightEnd", 7);
+    config.doubleBuffer = preferences.getBool("doubleBuf", DISPLAY_DOUBLE_BUFFER);
+    config.gamma = preferences.getUShort("gamma", COLOR_GAMMA_DEFAULT);
+    config.whiteR = preferences.getUChar("wbR", 255);
+    config.whiteG = preferences.getUChar("wbG", 255);
+    config.whiteB = preferences.getUChar("wbB", 255);
+    config.ditherMode = preferences.getUChar("dither", DITHER_NIGHT);
     
     // Effects
     config.effectDuration = preferences.getULong("effectDur", 10000);
     config.autoSwitch = preferences.getBool("autoSwitch", true);
     config.currentEffect = preferences.getInt("currEffect", -1);
+    config.transitionType = preferences.getUChar("transType", 1);
+    config.transitionMs = preferences.getUShort("transMs", 600);
     
     // Device
     String deviceName = preferences.getString("deviceName", "ledmatrix");
@@ -71,6 +92,11 @@ void Settings::load() {
     String timezone = preferences.getString("timezone", "CET-1CEST,M3.5.0,M10.5.0/3");
     strncpy(config.timezone, timezone.c_str(), sizeof(config.timezone) - 1);
 
+    // Realtime UDP
+    config.realtimeEnabled = preferences.getBool("rtEnabled", false);
+    config.realtimeUniverse = preferences.getUShort("rtUniverse", 1);
+    config.realtimeUniversePixels = preferences.getUChar("rtUniPixels", 170);
+
     dirty = false;
     
     DEBUG_PRINTLN(F("[Settings] Loaded from NVS"));
@@ -88,11 +114,19 @@ void Settings::save() {
     preferences.putUChar("brightNight", config.brightnessNight);
     preferences.putUChar("nightStart", config.nightStartHour);
     preferences.putUChar("nightEnd", config.nightEndHour);
+    preferences.putBool("doubleBuf", config.doubleBuffer);
+    preferences.putUShort("gamma", config.gamma);
+    preferences.putUChar("wbR", config.whiteR);
+    preferences.putUChar("wbG", config.whiteG);
+    preferences.putUChar("wbB", config.whiteB);
+    preferences.putUChar("dither", config.ditherMode);
     
     // Effects
     preferences.putULong("effectDur", config.effectDuration);
     preferences.putBool("autoSwitch", config.autoSwitch);
     preferences.putInt("currEffect", config.currentEffect);
+    preferences.putUChar("transType", config.transitionType);
+    preferences.putUShort("transMs", config.transitionMs);
     
     // Device
     preferences.putString("deviceName", config.deviceName);
@@ -105,6 +139,11 @@ void Settings::save() {
     preferences.putBool("ntpEnabled", config.ntpEnabled);
     preferences.putString("timezone", config.timezone);
 
+    // Realtime UDP
+    preferences.putBool("rtEnabled", config.realtimeEnabled);
+    preferences.putUShort("rtUniverse", config.realtimeUniverse);
+    preferences.putUChar("rtUniPixels", config.realtimeUniversePixels);
+
     dirty = false;
 
     DEBUG_PRINTLN(F("[Settings] Saved to NVS"));
@@ -151,6 +190,19 @@ void Settings::setNightHours(uint8_t start, uint8_t end) {
     dirty = true;
 }
 
+void Settings::setDoubleBuffer(bool enabled) {
+    config.doubleBuffer = enabled;
+    dirty = true;
+}
+
+void Settings::setColorCorrection(uint16_t gamma100, uint8_t whiteR, uint8_t whiteG, uint8_t whiteB) {
+    config.gamma = gamma100;
+    config.whiteR = whiteR;
+    config.whiteG = whiteG;
+    config.whiteB = whiteB;
+    dirty = true;
+}
+
 bool Settings::isNightTime(int currentHour) const {
     if (config.nightStartHour > config.nightEndHour) {
         // Notte passa per mezzanotte (es. 22-7)
@@ -165,6 +217,39 @@ uint8_t Settings::getCurrentBrightness(int currentHour) const {
     return isNightTime(currentHour) ? config.brightnessNight : config.brightnessDay;
 }
 
+void Settings::setDitherMode(uint8_t mode) {
+    config.ditherMode = mode <= DITHER_NIGHT ? mode : DITHER_NIGHT;
+    dirty = true;
+}
+
+bool Settings::isDitherActive(int currentHour) const {
+    if (config.ditherMode == DITHER_NIGHT) return isNightTime(currentHour);
+    return config.ditherMode == DITHER_ON;
+}
+
+const char* Settings::ditherModeName(uint8_t mode) {
+    switch (mode) {
+        case DITHER_OFF: return "off";
+        case DITHER_ON:  return "on";
+        default:         return "night";
+    }
+}
+
+// ═══════════════════════════════════════════
+// Realtime Setters
+// ═══════════════════════════════════════════
+
+void Settings::setRealtimeEnabled(bool enabled) {
+    config.realtimeEnabled = enabled;
+    dirty = true;
+}
+
+void Settings::setRealtimeMap(uint16_t universe, uint8_t universePixels) {
+    config.realtimeUniverse = universe;
+    config.realtimeUniversePixels = universePixels > 0 && universePixels <= 170 ? universePixels : 170;
+    dirty = true;
+}
+
 // ═══════════════════════════════════════════
 // Effects Setters
 // ═══════════════════════════════════════════
@@ -184,6 +269,12 @@ void Settings::setCurrentEffect(int index) {
     dirty = true;
 }
 
+void Settings::setTransition(uint8_t type, uint16_t ms) {
+    config.transitionType = type;
+    config.transitionMs = ms;
+    dirty = true;
+}
+
 // ═══════════════════════════════════════════
 // Device Setters
 // ═══════════════════════════════════════════
@@ -257,12 +348,19 @@ void Settings::print() const {
     DEBUG_PRINTF("║  Brightness Night: %-17d║\n", config.brightnessNight);
     DEBUG_PRINTF("║  Night Hours: %02d:00 - %02d:00        ║\n", 
                  config.nightStartHour, config.nightEndHour);
+    DEBUG_PRINTF("║  Double Buffer: %-20s║\n", config.doubleBuffer ? "ON" : "OFF");
+    DEBUG_PRINTF("║  Gamma: %u.%02u WB: %3u,%3u,%3u        ║\n",
+                 config.gamma / 100, config.gamma % 100, config.whiteR, config.whiteG, config.whiteB);
+    DEBUG_PRINTF("║  Dithering: %-24s║\n", ditherModeName(config.ditherMode));
     DEBUG_PRINTF("║  Effect Duration: %-14lu ms║\n", config.effectDuration);
     DEBUG_PRINTF("║ Current Effect: %-16s║\n", config.currentEffect >= 0 ? String(config.currentEffect).c_str() : "Auto");
     DEBUG_PRINTF("║  Auto Switch: %-22s║\n", config.autoSwitch ? "ON" : "OFF");
+    DEBUG_PRINTF("║  Transition: %u / %-15u ms║\n", config.transitionType, config.transitionMs);
     DEBUG_PRINTF("║  Device Name: %-22s║\n", config.deviceName);
     DEBUG_PRINTF("║  Scroll Text: %-22s║\n", config.scrollText[0] ? config.scrollText : "(not set)");
     DEBUG_PRINTF("║  NTP Enabled: %-22s║\n", config.ntpEnabled ? "ON" : "OFF");
     DEBUG_PRINTF("║  Timezone: %-25s║\n", config.timezone);
+    DEBUG_PRINTF("║  Realtime: %-3s univ %-5u x %-3u px  ║\n", config.realtimeEnabled ? "ON" : "OFF",
+                 config.realtimeUniverse, config.realtimeUniversePixels);
     DEBUG_PRINTLN(F("╚═════════════════════════════════════╝"));
 }
\ No newline at end of file
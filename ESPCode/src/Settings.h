@@ -4,7 +4,19 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include "Debug.h"
+#include "ColorCorrection.h"
 
+#ifndef DISPLAY_DOUBLE_BUFFER
+#define DISPLAY_DOUBLE_BUFFER 0
+#endif
+
+
+// Dithering temporale (luminosità bassa)
+enum DitherMode : uint8_t {
+    DITHER_OFF,
+    DITHER_ON,
+    DITHER_NIGHT    // Solo nella fascia notturna (default)
+};
 
 // Struttura configurazione
 struct Config {
@@ -18,11 +30,19 @@ struct Config {
     uint8_t brightnessNight;
     uint8_t nightStartHour;
     uint8_t nightEndHour;
+    bool doubleBuffer;  // Double buffering DMA (richiede riavvio)
+    uint16_t gamma;     // Gamma x100 (pipeline colore al flush)
+    uint8_t whiteR;     // Bilanciamento del bianco per canale (0-255)
+    uint8_t whiteG;
+    uint8_t whiteB;
+    uint8_t ditherMode;  // DitherMode
     
     // Effects
     unsigned long effectDuration;  // ms
     bool autoSwitch;
     int currentEffect;  // -1 = auto, >= 0 = fisso
+    uint8_t transitionType;  // 0 = nessuna, 1 = fade, 2 = wipe (TransitionType)
+    uint16_t transitionMs;   // Durata transizione
     
     // Device
     char deviceName[33];  // per mDNS
@@ -34,6 +54,11 @@ struct Config {
     // NTP/Timezone
     bool ntpEnabled;
     char timezone[48];  // Es: "CET-1CEST,M3.5.0,M10.5.0/3"
+
+    // Realtime UDP (DDP / E1.31 / Art-Net)
+    bool realtimeEnabled;
+    uint16_t realtimeUniverse;       // Primo universo E1.31/Art-Net mappato sul canvas
+    uint8_t realtimeUniversePixels;  // Pixel RGB per universo (max 170)
 };
 
 class Settings {
@@ -78,6 +103,20 @@ public:
     void setBrightnessDay(uint8_t value);
     void setBrightnessNight(uint8_t value);
     void setNightHours(uint8_t start, uint8_t end);
+
+    bool isDoubleBuffer() const { return config.doubleBuffer; }
+    void setDoubleBuffer(bool enabled);
+
+    uint16_t getGamma() const { return config.gamma; }
+    uint8_t getWhiteR() const { return config.whiteR; }
+    uint8_t getWhiteG() const { return config.whiteG; }
+    uint8_t getWhiteB() const { return config.whiteB; }
+    void setColorCorrection(uint16_t gamma100, uint8_t whiteR, uint8_t whiteG, uint8_t whiteB);
+
+    uint8_t getDitherMode() const { return config.ditherMode; }
+    void setDitherMode(uint8_t mode);
+    bool isDitherActive(int currentHour) const;
+    static const char* ditherModeName(uint8_t mode);
     
     // Calcola la luminosità corrente in base all'ora
     uint8_t getCurrentBrightness(int currentHour) const;
@@ -93,6 +132,10 @@ public:
     void setEffectDuration(unsigned long ms);
     void setAutoSwitch(bool enabled);
     void setCurrentEffect(int index);
+
+    uint8_t getTransitionType() const { return config.transitionType; }
+    uint16_t getTransitionMs() const { return config.transitionMs; }
+    void setTransition(uint8_t type, uint16_t ms);
     
     // ═══════════════════════════════════════════
     // Device
@@ -108,6 +151,15 @@ public:
     void setScrollText(const char* text);
     void setScrollTextColor(uint16_t color);
 
+    // ═══════════════════════════════════════════
+    // Realtime UDP
+    // ═══════════════════════════════════════════
+    bool isRealtimeEnabled() const { return config.realtimeEnabled; }
+    uint16_t getRealtimeUniverse() const { return config.realtimeUniverse; }
+    uint8_t getRealtimeUniversePixels() const { return config.realtimeUniversePixels; }
+    void setRealtimeEnabled(bool enabled);
+    void setRealtimeMap(uint16_t universe, uint8_t universePixels);
+
     // ═══════════════════════════════════════════
     // NTP/Timezone
     // ═══════════════════════════════════════════
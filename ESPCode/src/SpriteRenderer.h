@@ -3,51 +3,197 @@
 
 #include "DisplayManager.h"
 #include <Arduino.h>
+#include <vector>
 #include "assets.h"  // Per _MASK e sprite definitions
 
+/**
+ * Sprite compilato in run-length: per ogni riga
+ *   [numRun] poi per ogni run [skip][len][pixel RGB565 x len]
+ * skip = pixel trasparenti da saltare prima del run opaco.
+ * La variante specchiata (opzionale) usa lo stesso formato.
+ */
+struct CompiledSprite {
+    int16_t width;
+    int16_t height;
+    std::vector<uint16_t> runs;
+    std::vector<uint16_t> rowStart;          // Offset in runs di ogni riga
+    std::vector<uint16_t> runsFlipped;
+    std::vector<uint16_t> rowStartFlipped;
+
+    CompiledSprite() : width(0), height(0) {}
+    bool isEmpty() const { return width == 0 || height == 0; }
+    bool hasFlipped() const { return !runsFlipped.empty(); }
+};
+
 class SpriteRenderer {
 private:
     DisplayManager* display;
-    
+
+    // Cache degli sprite PROGMEM compilati al primo utilizzo
+    struct CacheEntry {
+        const uint16_t* source;
+        CompiledSprite sprite;
+    };
+    std::vector<CacheEntry> cache;
+
+    static void encodeRow(std::vector<uint16_t>& out, const uint16_t* row, int width,
+                          uint16_t mask, bool progmem, bool flipH) {
+        size_t countPos = out.size();
+        out.push_back(0);  // numRun, aggiornato a fine riga
+        uint16_t numRuns = 0;
+
+        int x = 0;
+        while (x < width) {
+            int skip = 0;
+            while (x < width && readPixel(row, flipH ? width - 1 - x : x, progmem) == mask) {
+                skip++;
+                x++;
+            }
+            if (x >= width) break;
+
+            out.push_back(skip);
+            size_t lenPos = out.size();
+            out.push_back(0);
+            uint16_t len = 0;
+            while (x < width) {
+                uint16_t c = readPixel(row, flipH ? width - 1 - x : x, progmem);
+                if (c == mask) break;
+                out.push_back(c);
+                len++;
+                x++;
+            }
+            out[lenPos] = len;
+            numRuns++;
+        }
+        out[countPos] = numRuns;
+    }
+
+    static inline uint16_t readPixel(const uint16_t* row, int x, bool progmem) {
+        return progmem ? pgm_read_word(&row[x]) : row[x];
+    }
+
+    const CompiledSprite& getCompiled(const uint16_t* sprite, int width, int height) {
+        for (auto& entry : cache) {
+            if (entry.source == sprite) return entry.sprite;
+        }
+        cache.push_back(CacheEntry());
+        cache.back().source = sprite;
+        compile(cache.back().sprite, sprite, width, height, _MASK, true, true);
+        return cache.back().sprite;
+    }
+
 public:
     SpriteRenderer(DisplayManager* dm) : display(dm) {}
-    
-    // Disegna sprite RGB565 da PROGMEM
-    void drawSprite(const uint16_t* sprite, int x, int y, int width, int height) {
-        for (int dy = 0; dy < height; dy++) {
-            for (int dx = 0; dx < width; dx++) {
-                uint16_t color = pgm_read_word(&sprite[dy * width + dx]);
-                
-                if (color != _MASK) {
-                    uint8_t r = (color >> 11) << 3;
-                    uint8_t g = ((color >> 5) & 0x3F) << 2;
-                    uint8_t b = (color & 0x1F) << 3;
-                    
-                    display->drawPixel(x + dx, y + dy, r, g, b);
+
+    // ═══════════════════════════════════════════
+    // Sprite compilati (run-length)
+    // ═══════════════════════════════════════════
+
+    /**
+     * Compila uno sprite RGB565 nel formato a run.
+     * @param pixels   sorgente (PROGMEM se progmem = true, altrimenti RAM)
+     * @param mask     colore trasparente (_MASK per assets.h, 0x0000 per PacMan)
+     * @param withFlipped genera anche la variante specchiata orizzontalmente
+     * Riutilizza la capacità dei vector: ricompilare non frammenta l'heap.
+     */
+    static void compile(CompiledSprite& out, const uint16_t* pixels, int width, int height,
+                        uint16_t mask, bool progmem, bool withFlipped) {
+        out.width = width;
+        out.height = height;
+        out.runs.clear();
+        out.rowStart.clear();
+        out.runsFlipped.clear();
+        out.rowStartFlipped.clear();
+
+        for (int y = 0; y < height; y++) {
+            out.rowStart.push_back(out.runs.size());
+            encodeRow(out.runs, &pixels[y * width], width, mask, progmem, false);
+        }
+        if (withFlipped) {
+            for (int y = 0; y < height; y++) {
+                out.rowStartFlipped.push_back(out.runsFlipped.size());
+                encodeRow(out.runsFlipped, &pixels[y * width], width, mask, progmem, true);
+            }
+        }
+    }
+
+    /**
+     * Disegna uno sprite compilato: clipping una volta per sprite,
+     * poi ogni run opaco è copiato nel framebuffer con writeSpan()
+     */
+    void blit(const CompiledSprite& sprite, int x, int y, bool flipH = false) {
+        if (sprite.isEmpty()) return;
+
+        int screenW = display->getWidth();
+        int screenH = display->getHeight();
+        if (x >= screenW || y >= screenH || x + sprite.width <= 0 || y + sprite.height <= 0) return;
+
+        bool useFlipped = flipH && sprite.hasFlipped();
+        const uint16_t* runs = useFlipped ? sprite.runsFlipped.data() : sprite.runs.data();
+        const uint16_t* rowStart = useFlipped ? sprite.rowStartFlipped.data() : sprite.rowStart.data();
+
+        int firstRow = y < 0 ? -y : 0;
+        int lastRow = (y + sprite.height > screenH) ? screenH - y : sprite.height;
+        bool clipX = x < 0 || x + sprite.width > screenW;
+
+        for (int row = firstRow; row < lastRow; row++) {
+            const uint16_t* p = runs + rowStart[row];
+            uint16_t numRuns = *p++;
+            int cx = x;
+            int py = y + row;
+
+            while (numRuns--) {
+                cx += *p++;
+                uint16_t len = *p++;
+                const uint16_t* pixels = p;
+                p += len;
+
+                if (!clipX) {
+                    display->writeSpan(cx, py, pixels, len);
+                } else {
+                    int a = cx < 0 ? 0 : cx;
+                    int b = (cx + len > screenW) ? screenW : cx + len;
+                    if (a < b) display->writeSpan(a, py, pixels + (a - cx), b - a);
                 }
+                cx += len;
             }
         }
     }
-    
+
+    // ═══════════════════════════════════════════
+    // Sprite PROGMEM (compilati al primo utilizzo)
+    // ═══════════════════════════════════════════
+
+    // Disegna sprite RGB565 da PROGMEM
+    void drawSprite(const uint16_t* sprite, int x, int y, int width, int height) {
+        blit(getCompiled(sprite, width, height), x, y, false);
+    }
+
     // Disegna sprite con flip orizzontale
-    void drawSpriteFlipped(const uint16_t* sprite, int x, int y, 
+    void drawSpriteFlipped(const uint16_t* sprite, int x, int y,
                           int width, int height, bool flipH) {
+        blit(getCompiled(sprite, width, height), x, y, flipH);
+    }
+
+    // Percorso originale pixel per pixel (riferimento per il benchmark)
+    void drawSpritePixels(const uint16_t* sprite, int x, int y,
+                          int width, int height, bool flipH = false) {
         for (int dy = 0; dy < height; dy++) {
             for (int dx = 0; dx < width; dx++) {
                 int srcX = flipH ? (width - 1 - dx) : dx;
                 uint16_t color = pgm_read_word(&sprite[dy * width + srcX]);
-                
+
                 if (color != _MASK) {
                     uint8_t r = (color >> 11) << 3;
                     uint8_t g = ((color >> 5) & 0x3F) << 2;
                     uint8_t b = (color & 0x1F) << 3;
-                    
+
                     display->drawPixel(x + dx, y + dy, r, g, b);
                 }
             }
         }
     }
-    
+
     // Disegna una tile ripetuta (per terreno, ecc.)
     void drawTile(const uint16_t* tile, int tileWidth, int tileHeight,
                   int x, int y, int width, int height) {
@@ -56,14 +202,14 @@ public:
                 int tileX = dx % tileWidth;
                 int tileY = dy % tileHeight;
                 int idx = tileY * tileWidth + tileX;
-                
+
                 uint16_t color = pgm_read_word(&tile[idx]);
-                
+
                 if (color != _MASK) {
                     uint8_t r = (color >> 11) << 3;
                     uint8_t g = ((color >> 5) & 0x3F) << 2;
                     uint8_t b = (color & 0x1F) << 3;
-                    
+
                     display->drawPixel(x + dx, y + dy, r, g, b);
                 }
             }
@@ -71,4 +217,4 @@ public:
     }
 };
 
-#endif
\ No newline at end of file
+#endif
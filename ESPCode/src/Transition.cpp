@@ -0,0 +1,118 @@
+#include "Transition.h"
+
+Transition::Transition()
+    : _type(TRANSITION_FADE)
+    , _durationMs(600)
+    , _active(false)
+    , _from(nullptr)
+    , _composite(nullptr)
+    , _width(0)
+    , _height(0)
+    , _startTime(0)
+    , _frames(0)
+    , _costTotalUs(0)
+    , _costMaxUs(0)
+{}
+
+Transition::~Transition() {
+    end();
+}
+
+bool Transition::begin(uint16_t width, uint16_t height) {
+    if (_type == TRANSITION_NONE || _durationMs == 0) return false;
+
+    // Buffer riusati se una transizione è già in corso: in quel caso
+    // si riparte dal composito, cioè da ciò che è a schermo
+    bool restart = _active;
+    size_t bytes = (size_t)width * height * sizeof(uint16_t);
+    if (!_from) _from = (uint16_t*)malloc(bytes);
+    if (!_composite) _composite = (uint16_t*)malloc(bytes);
+    if (!_from || !_composite) {
+        DEBUG_PRINTLN("[Transition] Not enough RAM, hard cut");
+        end();
+        return false;
+    }
+
+    if (restart) memcpy(_from, _composite, bytes);
+    _width = width;
+    _height = height;
+    _startTime = millis();
+    _frames = 0;
+    _costTotalUs = 0;
+    _costMaxUs = 0;
+    _active = true;
+    return true;
+}
+
+void Transition::end() {
+    if (_active && _frames > 0) {
+        DEBUG_PRINTF("[Transition] %s %u ms: %lu frames | compose avg %lu us max %lu us\n",
+                     typeName(_type), _durationMs, (unsigned long)_frames,
+                     (unsigned long)getAvgCostUs(), (unsigned long)_costMaxUs);
+    }
+
+    free(_from);
+    free(_composite);
+    _from = nullptr;
+    _composite = nullptr;
+    _active = false;
+}
+
+bool Transition::compose(const uint16_t* incoming) {
+    if (!_active) return true;
+
+    uint32_t start = micros();
+    unsigned long elapsed = millis() - _startTime;
+    bool done = elapsed >= _durationMs;
+    uint32_t progress = done ? 256 : (elapsed * 256) / _durationMs;  // 0-256
+
+    if (_type == TRANSITION_WIPE) {
+        composeWipe(incoming, (progress * _width) >> 8);
+    } else {
+        composeFade(incoming, progress >> 3);  // alpha 0-32
+    }
+
+    uint32_t cost = micros() - start;
+    _frames++;
+    _costTotalUs += cost;
+    if (cost > _costMaxUs) _costMaxUs = cost;
+
+    return done;
+}
+
+// Due pixel per word (PixelKernels::blend): 2048 iterazioni per un frame 64x64
+void Transition::composeFade(const uint16_t* incoming, uint32_t alpha) {
+    PixelKernels::blend(_composite, incoming, _from, (size_t)_width * _height, alpha);
+}
+
+// Colonne [0, edge) dall'effetto entrante, il resto dal frame uscente
+void Transition::composeWipe(const uint16_t* incoming, uint16_t edge) {
+    if (edge > _width) edge = _width;
+
+    for (uint16_t y = 0; y < _height; y++) {
+        size_t row = (size_t)y * _width;
+        if (incoming != _composite) memcpy(&_composite[row], &incoming[row], edge * sizeof(uint16_t));
+        memcpy(&_composite[row + edge], &_from[row + edge], (_width - edge) * sizeof(uint16_t));
+    }
+}
+
+const char* Transition::typeName(TransitionType type) {
+    switch (type) {
+        case TRANSITION_FADE: return "fade";
+        case TRANSITION_WIPE: return "wipe";
+        default:              return "none";
+    }
+}
+
+bool Transition::parseType(const String& name, TransitionType& type) {
+    if (name.equalsIgnoreCase("fade")) {
+        type = TRANSITION_FADE;
+    } else if (name.equalsIgnoreCase("wipe")) {
+        type = TRANSITION_WIPE;
+    } else if (name.equalsIgnoreCase("none")) {
+        type = TRANSITION_NONE;
+    } else {
+        return false;
+    }
+    return true;
+}
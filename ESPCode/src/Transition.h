@@ -0,0 +1,74 @@
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+#include <Arduino.h>
+#include "Debug.h"
+#include "PixelKernels.h"
+
+// Tipi di transizione tra effetti
+enum TransitionType : uint8_t {
+    TRANSITION_NONE,    // Taglio netto (comportamento originale)
+    TRANSITION_FADE,    // Crossfade RGB565
+    TRANSITION_WIPE     // Tendina da sinistra a destra
+};
+
+/**
+ * Transition - Transizione tra l'ultimo frame dell'effetto uscente e
+ * l'effetto entrante.
+ *
+ * Durante la transizione il DisplayManager è offscreen: l'effetto entrante
+ * disegna solo nel framebuffer, compose() produce il frame composito e
+ * DisplayManager::presentComposite() lo invia al pannello.
+ * Buffer (2 x frame RGB565) allocati solo per la durata della transizione.
+ */
+class Transition {
+public:
+    Transition();
+    ~Transition();
+
+    void setType(TransitionType type) { _type = type; }
+    void setDuration(uint16_t ms) { _durationMs = ms; }
+    TransitionType getType() const { return _type; }
+    uint16_t getDuration() const { return _durationMs; }
+
+    // Prepara i buffer; false = niente transizione (disabilitata o RAM).
+    // Se una transizione è già in corso il frame uscente è il composito
+    // corrente, altrimenti il chiamante lo copia in getOutgoing()
+    bool begin(uint16_t width, uint16_t height);
+    bool isActive() const { return _active; }
+    void end();
+    uint16_t* getOutgoing() { return _from; }
+
+    // Compone uscente + entrante; true quando la transizione è completa.
+    // incoming può essere getComposite() (frame entrante già convertito lì)
+    bool compose(const uint16_t* incoming);
+    const uint16_t* getComposite() const { return _composite; }
+    uint16_t* getComposite() { return _composite; }
+
+    // Costo per frame di compose() (ultima transizione completata)
+    uint32_t getAvgCostUs() const { return _frames ? _costTotalUs / _frames : 0; }
+    uint32_t getMaxCostUs() const { return _costMaxUs; }
+
+    static const char* typeName(TransitionType type);
+    static bool parseType(const String& name, TransitionType& type);
+
+private:
+    TransitionType _type;
+    uint16_t _durationMs;
+    bool _active;
+
+    uint16_t* _from;
+    uint16_t* _composite;
+    uint16_t _width;
+    uint16_t _height;
+    unsigned long _startTime;
+
+    uint32_t _frames;
+    uint32_t _costTotalUs;
+    uint32_t _costMaxUs;
+
+    void composeFade(const uint16_t* incoming, uint32_t alpha);
+    void composeWipe(const uint16_t* incoming, uint16_t edge);
+};
+
+#endif // TRANSITION_H
@@ -1,12 +1,16 @@
 #include "WebServerManager.h"
+#include <memory>
 
 WebServerManager::WebServerManager(uint16_t port)
     : _server(port)
     , _cmdHandler(nullptr)
+    , _frameMirror(nullptr)
+    , _imageUploader(nullptr)
 {}
 
-void WebServerManager::init(CommandHandler* cmdHandler) {
+void WebServerManager::init(CommandHandler* cmdHandler, FrameMirror* frameMirror) {
     _cmdHandler = cmdHandler;
+    _frameMirror = frameMirror;
     setupRoutes();
     _server.begin();
     DEBUG_PRINTLN("[HTTP] Web server started");
@@ -17,6 +21,7 @@ void WebServerManager::setupRoutes() {
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Origin", "*");
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Methods", "GET, POST, OPTIONS");
     DefaultHeaders::Instance().addHeader("Access-Control-Allow-Headers", "Content-Type");
+    DefaultHeaders::Instance().addHeader("Access-Control-Expose-Headers", "X-Frame-Width, X-Frame-Height, X-Frame-Format");
     
     // Root - Info
     _server.on("/", HTTP_GET, [](AsyncWebServerRequest* request) {
@@ -24,7 +29,8 @@ void WebServerManager::setupRoutes() {
             "LED Matrix Controller\n"
             "---------------------\n"
             "WebSocket: ws://<ip>/ws\n"
-            "API: /api/status, /api/effects, /api/settings\n"
+            "API: /api/status, /api/effects, /api/settings, /api/frame\n"
+            "Upload: POST /api/image?name=NAME&crc=CRC32[&resize=0] (PNG, .qim o raw RGB565)\n"
             "\n"
             "Protocol: CSV-based commands\n"
             "Example: getStatus, effect,next, brightness,200\n"
@@ -58,6 +64,47 @@ void WebServerManager::setupRoutes() {
         }
     });
     
+    // API - Frame corrente (RGB565 little endian, riga per riga)
+    _server.on("/api/frame", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (!_frameMirror) {
+            request->send(500, "text/plain", "ERR,not initialized");
+            return;
+        }
+
+        std::shared_ptr<FrameSnapshot> snapshot = _frameMirror->requestSnapshot();
+        if (!snapshot) {
+            request->send(503, "text/plain", "ERR,no frame");
+            return;
+        }
+
+        // Risposta differita: finché il render non pubblica il frame il corpo
+        // resta in attesa (RESPONSE_TRY_AGAIN), senza fermare il task AsyncTCP.
+        // Render fermo oltre FRAME_MIRROR_SNAPSHOT_WAIT_MS: frame nero
+        size_t bytes = _frameMirror->getFrameBytes();
+        uint32_t start = millis();
+        bool timedOut = false;
+        AsyncWebServerResponse* response = request->beginResponse("application/octet-stream", bytes,
+            [snapshot, bytes, start, timedOut](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+                if (!timedOut && !snapshot->ready.load(std::memory_order_acquire)) {
+                    if (millis() - start < FRAME_MIRROR_SNAPSHOT_WAIT_MS) return RESPONSE_TRY_AGAIN;
+                    DEBUG_PRINTLN("[HTTP] Frame snapshot timed out");
+                    timedOut = true;
+                }
+                size_t len = min(maxLen, bytes - index);
+                if (timedOut) {
+                    memset(buffer, 0, len);
+                } else {
+                    memcpy(buffer, (const uint8_t*)snapshot->pixels + index, len);
+                }
+                return len;
+            });
+        response->addHeader("X-Frame-Width", String(_frameMirror->getWidth()));
+        response->addHeader("X-Frame-Height", String(_frameMirror->getHeight()));
+        response->addHeader("X-Frame-Format", "rgb565le");
+        response->addHeader("Cache-Control", "no-store");
+        request->send(response);
+    });
+
     // API - Command (POST)
     _server.on("/api/cmd", HTTP_POST, [](AsyncWebServerRequest* request) {
         request->send(400, "text/plain", "ERR,use body");
@@ -68,19 +115,78 @@ void WebServerManager::setupRoutes() {
             for (size_t i = 0; i < len; i++) {
                 cmd += (char)data[i];
             }
-            String response = _cmdHandler->processCommand(cmd);
+            String response = _cmdHandler->executeBlocking(cmd);
             request->send(200, "text/plain", response);
         } else {
             request->send(500, "text/plain", "ERR,not initialized");
         }
     });
     
+    // API - Upload immagine: corpo scritto a chunk nel file temporaneo di
+    // ImageUploader, verifica e salvataggio a corpo completo. Un solo giro
+    // sul task di render per begin e uno per commit
+    _server.on("/api/image", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        if (!_cmdHandler || !_imageUploader) {
+            request->send(500, "text/plain", "ERR,not initialized");
+            return;
+        }
+        if (!request->hasParam("name") || !request->hasParam("crc")) {
+            request->send(400, "text/plain", "ERR,Upload requires: name, crc");
+            return;
+        }
+
+        // Stato del body handler: senza begin riuscito non si fa commit
+        // (il job attivo potrebbe essere di un altro client)
+        ImageUploadBody* body = (ImageUploadBody*)request->_tempObject;
+        if (!body || body->offset < 0) {
+            request->send(400, "text/plain", body ? body->error : "ERR,Empty body");
+            return;
+        }
+        String resize = request->hasParam("resize") ? request->getParam("resize")->value() : "1";
+        String response = _cmdHandler->executeBlocking("image,commit," + resize);
+        request->send(response.startsWith("OK") ? 200 : 400, "text/plain", response);
+    }, NULL, [this](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+        if (!_cmdHandler || !_imageUploader) return;
+
+        if (index == 0) {
+            if (!request->hasParam("name") || !request->hasParam("crc")) return;
+
+            // Liberato con free() dalla richiesta
+            ImageUploadBody* body = (ImageUploadBody*)malloc(sizeof(ImageUploadBody));
+            if (!body) return;
+            request->_tempObject = body;
+
+            // Nessun abort: begin riprende lo stesso job o rifiuta quello di
+            // un altro client ancora attivo
+            String response = _cmdHandler->executeBlocking("image,begin," + request->getParam("name")->value() +
+                                                           "," + String(total) + "," +
+                                                           request->getParam("crc")->value());
+            if (response.startsWith("UPLOAD_READY")) {
+                body->offset = response.substring(response.lastIndexOf(',') + 1).toInt();
+            } else {
+                DEBUG_PRINTF("[HTTP] Image upload rejected: %s\n", response.c_str());
+                body->offset = -1;
+                strncpy(body->error, response.c_str(), sizeof(body->error) - 1);
+                body->error[sizeof(body->error) - 1] = '\0';
+            }
+        }
+
+        ImageUploadBody* body = (ImageUploadBody*)request->_tempObject;
+        if (!body || body->offset < 0) return;
+
+        // Ripresa: i byte già su flash (stesso NAME, SIZE e CRC) si saltano
+        uint32_t offset = body->offset;
+        if (index + len <= offset) return;
+        size_t skip = index < offset ? offset - index : 0;
+        _imageUploader->write(index + skip, data + skip, len - skip);
+    });
+
     // API - Command (GET with query param)
     _server.on("/api/cmd", HTTP_GET, [this](AsyncWebServerRequest* request) {
         if (request->hasParam("c")) {
             String cmd = request->getParam("c")->value();
             if (_cmdHandler) {
-                String response = _cmdHandler->processCommand(cmd);
+                String response = _cmdHandler->executeBlocking(cmd);
                 request->send(200, "text/plain", response);
             } else {
                 request->send(500, "text/plain", "ERR,not initialized");
@@ -4,18 +4,29 @@
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
 #include "CommandHandler.h"
+#include "FrameMirror.h"
+#include "ImageUploader.h"
 #include "Debug.h"
 
+// Stato di un POST /api/image tra body handler e risposta (request->_tempObject)
+struct ImageUploadBody {
+    int32_t offset;                 // Offset di ripresa restituito da begin, -1 = rifiutato
+    char error[48];                 // Risposta di begin se rifiutato
+};
+
 class WebServerManager {
 public:
     WebServerManager(uint16_t port = 80);
     
-    void init(CommandHandler* cmdHandler);
+    void init(CommandHandler* cmdHandler, FrameMirror* frameMirror = nullptr);
     AsyncWebServer* getServer() { return &_server; }
+    void setImageUploader(ImageUploader* uploader) { _imageUploader = uploader; }
 
 private:
     AsyncWebServer _server;
     CommandHandler* _cmdHandler;
+    FrameMirror* _frameMirror;
+    ImageUploader* _imageUploader;
     
     void setupRoutes();
 };
@@ -3,19 +3,31 @@
 WebSocketManager::WebSocketManager()
     : _ws("/ws")
     , _cmdHandler(nullptr)
+    , _frameMirror(nullptr)
+    , _lock(nullptr)
+    , _outbox(nullptr)
+    , _outboxDropped(0)
     , _messagesReceived(0)
     , _messagesSent(0)
     , _lastCleanup(0)
+    , _binaryRouteCount(0)
+    , _binaryActive(-1)
+    , _binaryClientId(0)
+    , _binaryRejected(0)
     , _fragmentBuffer("")
     , _fragmentClientId(0)
 {}
 
 void WebSocketManager::init(AsyncWebServer* server, CommandHandler* cmdHandler) {
     _cmdHandler = cmdHandler;
-    
+    _lock = xSemaphoreCreateRecursiveMutex();
+    _outbox = xQueueCreate(WS_OUTBOX_SIZE, sizeof(OutboxMessage));
+
     _ws.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
                        AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
         this->onEvent(server, client, type, arg, data, len);
+        xSemaphoreGiveRecursive(_lock);
     });
     
     server->addHandler(&_ws);
@@ -23,24 +35,114 @@ void WebSocketManager::init(AsyncWebServer* server, CommandHandler* cmdHandler)
     DEBUG_PRINTLN("[WS] WebSocket initialized on /ws");
 }
 
+bool WebSocketManager::onBinary(uint8_t type, BinaryHandler handler) {
+    if (_binaryRouteCount >= WS_BINARY_HANDLERS) return false;
+    _binaryRoutes[_binaryRouteCount].type = type;
+    _binaryRoutes[_binaryRouteCount].handler = handler;
+    _binaryRouteCount++;
+    return true;
+}
+
 void WebSocketManager::update() {
     // Cleanup ogni secondo
     uint32_t now = millis();
     if (now - _lastCleanup >= 1000) {
-        _ws.cleanupClients();
+        cleanupClients();
         _lastCleanup = now;
     }
 }
 
 void WebSocketManager::cleanupClients() {
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
     _ws.cleanupClients();
+    xSemaphoreGiveRecursive(_lock);
 }
 
+uint32_t WebSocketManager::getClientsConnected() {
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    uint32_t count = _ws.count();
+    xSemaphoreGiveRecursive(_lock);
+    return count;
+}
+
+// ═══════════════════════════════════════════
+// Invio
+// ═══════════════════════════════════════════
+
 void WebSocketManager::broadcast(const String& message) {
-    if (_ws.count() > 0) {
+    post(WS_BROADCAST, message);
+}
+
+void WebSocketManager::sendToClient(uint32_t clientId, const String& message) {
+    post(clientId, message);
+}
+
+bool WebSocketManager::holdsLock() const {
+    return xSemaphoreGetMutexHolder(_lock) == xTaskGetCurrentTaskHandle();
+}
+
+void WebSocketManager::post(uint32_t clientId, const String& message) {
+    // Dentro onEvent il lock è già nostro: si invia subito
+    if (holdsLock()) {
+        send(clientId, message);
+        return;
+    }
+
+    // Altri task: il render non aspetta il lock (onEvent può scrivere in flash)
+    OutboxMessage out;
+    out.clientId = clientId;
+    out.text = new String(message);
+    if (xQueueSend(_outbox, &out, 0) != pdTRUE) {
+        delete out.text;
+        _outboxDropped++;
+        DEBUG_PRINTF("[WS] Outbox full, dropped message for #%u\n", clientId);
+    }
+}
+
+void WebSocketManager::flush() {
+    if (uxQueueMessagesWaiting(_outbox) == 0) return;
+
+    OutboxMessage out;
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    while (xQueueReceive(_outbox, &out, 0) == pdTRUE) {
+        send(out.clientId, *out.text);
+        delete out.text;
+    }
+    xSemaphoreGiveRecursive(_lock);
+}
+
+// Sotto _lock
+void WebSocketManager::send(uint32_t clientId, const String& message) {
+    if (clientId == WS_BROADCAST) {
+        if (_ws.count() == 0) return;
         _ws.textAll(message);
         _messagesSent++;
+        return;
     }
+
+    // Il client potrebbe essersi disconnesso mentre il comando era in coda
+    AsyncWebSocketClient* client = _ws.client(clientId);
+    if (!client) return;
+
+    client->text(message);
+    _messagesSent++;
+    DEBUG_PRINTF("[WS] Response: %s\n", message.c_str());
+}
+
+void WebSocketManager::streamPreview() {
+    if (!_frameMirror) return;
+
+    // Gira sul loop: lookup e invio sotto _lock come flush(). Preso prima
+    // del lock del mirror, nello stesso ordine di onEvent (preview,off)
+    xSemaphoreTakeRecursive(_lock, portMAX_DELAY);
+    _frameMirror->service([this](uint32_t clientId, const uint8_t* data, size_t len) {
+        AsyncWebSocketClient* client = _ws.client(clientId);
+        if (!client || !client->canSend()) return false;
+        client->binary(data, len);
+        _messagesSent++;
+        return true;
+    });
+    xSemaphoreGiveRecursive(_lock);
 }
 
 void WebSocketManager::notifyStatusChange() {
@@ -76,11 +178,20 @@ void WebSocketManager::onEvent(AsyncWebSocket* server, AsyncWebSocketClient* cli
             
         case WS_EVT_DISCONNECT:
             DEBUG_PRINTF("[WS] Client #%u disconnected\n", client->id());
+            if (_frameMirror) {
+                _frameMirror->unsubscribe(client->id());
+            }
             break;
             
         case WS_EVT_DATA: {
             AwsFrameInfo* info = (AwsFrameInfo*)arg;
 
+            // Binario: instradato per tipo, senza conversione in stringa
+            if (info->message_opcode == WS_BINARY) {
+                handleBinary(client, info, data, len);
+                break;
+            }
+
             // Messaggio completo in un singolo frame
             if (info->final && info->index == 0 && info->len == len) {
                 handleMessage(client, data, len);
@@ -146,15 +257,49 @@ void WebSocketManager::handleFragmentedMessage(AsyncWebSocketClient* client, Aws
             DEBUG_PRINTF("[WS] Received from #%u: %s\n", client->id(), message.c_str());
         }
 
-        if (_cmdHandler && !message.isEmpty()) {
-            String response = _cmdHandler->processCommand(message);
-            if (!response.isEmpty()) {
-                client->text(response);
-                _messagesSent++;
-                DEBUG_PRINTF("[WS] Response: %s\n", response.c_str());
+        dispatchCommand(client, message);
+    }
+}
+
+void WebSocketManager::handleBinary(AsyncWebSocketClient* client, AwsFrameInfo* info, uint8_t* data, size_t len) {
+    // Solo messaggi in un singolo frame WebSocket (anche se arrivano in più chunk TCP)
+    if (info->num > 0 || !info->final) {
+        if (info->index == 0) {
+            _binaryRejected++;
+            DEBUG_PRINTF("[WS] Fragmented binary message from #%u rejected\n", client->id());
+        }
+        return;
+    }
+
+    if (info->index == 0) {
+        _messagesReceived++;
+        _binaryActive = -1;
+        _binaryClientId = client->id();
+        for (uint8_t i = 0; i < _binaryRouteCount && len > 0; i++) {
+            if (_binaryRoutes[i].type == data[0]) {
+                _binaryActive = i;
+                break;
             }
         }
+        if (_binaryActive < 0) {
+            _binaryRejected++;
+            return;
+        }
+    }
+    if (_binaryActive < 0) return;
+
+    // AsyncTCP alterna i segmenti di connessioni diverse: un seguito di un
+    // altro client non appartiene al messaggio in corso (come _fragmentClientId)
+    if (client->id() != _binaryClientId) {
+        if (info->index + len == info->len) {
+            _binaryRejected++;
+            DEBUG_PRINTF("[WS] Binary chunk from #%u during message from #%u dropped\n",
+                         client->id(), _binaryClientId);
+        }
+        return;
     }
+
+    _binaryRoutes[_binaryActive].handler(client->id(), data, len, info->index, info->len);
 }
 
 void WebSocketManager::handleMessage(AsyncWebSocketClient* client, uint8_t* data, size_t len) {
@@ -178,12 +323,56 @@ void WebSocketManager::handleMessage(AsyncWebSocketClient* client, uint8_t* data
         DEBUG_PRINTF("[WS] Received from #%u: %s\n", client->id(), message.c_str());
     }
 
-    if (_cmdHandler && !message.isEmpty()) {
-        String response = _cmdHandler->processCommand(message);
-        if (!response.isEmpty()) {
-            client->text(response);
-            _messagesSent++;
-            DEBUG_PRINTF("[WS] Response: %s\n", response.c_str());
+    dispatchCommand(client, message);
+}
+
+void WebSocketManager::dispatchCommand(AsyncWebSocketClient* client, const String& message) {
+    if (!_cmdHandler || message.isEmpty()) return;
+
+    // Sottoscrizione legata alla connessione: resta sul task di rete
+    if (message.startsWith("preview")) {
+        handlePreview(client, message);
+        return;
+    }
+
+    // Eseguito dal task di render: la risposta arriva con sendToClient()
+    if (!_cmdHandler->enqueueWsCommand(client->id(), message)) {
+        client->text("ERR,busy");
+        _messagesSent++;
+        DEBUG_PRINTF("[WS] Queue full, rejected command from #%u\n", client->id());
+    }
+}
+
+// preview,FPS (1-30) | preview,off | preview,stats
+void WebSocketManager::handlePreview(AsyncWebSocketClient* client, const String& message) {
+    String response;
+    int comma = message.indexOf(',');
+    String arg = comma >= 0 ? message.substring(comma + 1) : "";
+    arg.trim();
+
+    if (!_frameMirror) {
+        response = "ERR,preview not available";
+    } else if (arg.equalsIgnoreCase("stats")) {
+        response = "MIRROR," + String(_frameMirror->getSubscribers()) + "," +
+                   String(_frameMirror->getFramesSent()) + "," +
+                   String(_frameMirror->getBytesSent()) + "," +
+                   String(_frameMirror->getCapturesSkipped());
+    } else if (arg.equalsIgnoreCase("off") || arg == "0") {
+        _frameMirror->unsubscribe(client->id());
+        response = "OK,preview,off";
+    } else {
+        int fps = arg.toInt();
+        if (fps < 1) {
+            response = "ERR,invalid fps";
+        } else if (!_frameMirror->subscribe(client->id(), min(fps, FRAME_MIRROR_MAX_FPS))) {
+            response = "ERR,preview unavailable (clients or memory)";
+        } else {
+            response = "PREVIEW," + String(min(fps, FRAME_MIRROR_MAX_FPS)) + "," +
+                       String(_frameMirror->getWidth()) + "," +
+                       String(_frameMirror->getHeight());
         }
     }
-}
\ No newline at end of file
+
+    client->text(response);
+    _messagesSent++;
+}
@@ -3,20 +3,46 @@
 
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
+#include <functional>
 #include "CommandHandler.h"
+#include "FrameMirror.h"
 #include "Debug.h"
 
 
+// Messaggi binari: il primo byte sceglie il gestore
+#define WS_BINARY_HANDLERS 4
+
+// Risposte in attesa di flush() (id 0 = tutti i client: gli id partono da 1)
+#define WS_OUTBOX_SIZE 32
+#define WS_BROADCAST 0
+
 class WebSocketManager {
 public:
+    // Chunk di un messaggio binario: index/total riferiti al messaggio intero
+    typedef std::function<void(uint32_t clientId, const uint8_t* data, size_t len,
+                               size_t index, size_t total)> BinaryHandler;
+
     WebSocketManager();
     
     void init(AsyncWebServer* server, CommandHandler* cmdHandler);
+    void setFrameMirror(FrameMirror* mirror) { _frameMirror = mirror; }
+    bool onBinary(uint8_t type, BinaryHandler handler);
     void update();
     void cleanupClients();
-    
-    // Broadcast a tutti i client
+
+    // ESPAsyncWebServer 1.2.4 non è thread-safe: lista dei client e code
+    // dei messaggi si toccano solo sotto _lock, preso anche da onEvent.
+    // Da onEvent (task AsyncTCP) l'invio è immediato; dagli altri task
+    // (render, seriale) il messaggio va nella outbox e parte con flush()
     void broadcast(const String& message);
+    void sendToClient(uint32_t clientId, const String& message);
+
+    // Invia la outbox (loop)
+    void flush();
+
+    // Anteprima del framebuffer ai client iscritti (preview,FPS), dal loop
+    // sotto _lock
+    void streamPreview();
     
     // Notifiche specifiche
     void notifyStatusChange();
@@ -24,27 +50,58 @@ public:
     void notifyTimeChange();
     
     // Stats
-    uint32_t getClientsConnected() const { return _ws.count(); }
+    uint32_t getClientsConnected();
     uint32_t getMessagesReceived() const { return _messagesReceived; }
     uint32_t getMessagesSent() const { return _messagesSent; }
+    uint32_t getBinaryRejected() const { return _binaryRejected; }
+    uint32_t getOutboxDropped() const { return _outboxDropped; }
 
 private:
     AsyncWebSocket _ws;
     CommandHandler* _cmdHandler;
+    FrameMirror* _frameMirror;
+
+    // Ricorsivo: onEvent → comando eseguito subito → sendToClient
+    SemaphoreHandle_t _lock;
+
+    struct OutboxMessage {
+        uint32_t clientId;          // WS_BROADCAST = tutti
+        String* text;               // Allocato da chi accoda, liberato da flush()
+    };
+    QueueHandle_t _outbox;
+    uint32_t _outboxDropped;
 
     uint32_t _messagesReceived;
     uint32_t _messagesSent;
     uint32_t _lastCleanup;
 
+    // Gestori binari (nessun buffer: i chunk passano direttamente al gestore)
+    struct BinaryRoute {
+        uint8_t type;
+        BinaryHandler handler;
+    };
+    BinaryRoute _binaryRoutes[WS_BINARY_HANDLERS];
+    uint8_t _binaryRouteCount;
+    int8_t _binaryActive;           // Gestore del messaggio in corso, -1 = scartato
+    uint32_t _binaryClientId;       // Client del messaggio in corso
+    uint32_t _binaryRejected;
+
     // Buffer per messaggi frammentati
     String _fragmentBuffer;
     uint32_t _fragmentClientId;
 
+    bool holdsLock() const;
+    void post(uint32_t clientId, const String& message);
+    void send(uint32_t clientId, const String& message);
+
     void onEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
                  AwsEventType type, void* arg, uint8_t* data, size_t len);
 
     void handleMessage(AsyncWebSocketClient* client, uint8_t* data, size_t len);
+    void dispatchCommand(AsyncWebSocketClient* client, const String& message);
+    void handlePreview(AsyncWebSocketClient* client, const String& message);
     void handleFragmentedMessage(AsyncWebSocketClient* client, AwsFrameInfo* info, uint8_t* data, size_t len);
+    void handleBinary(AsyncWebSocketClient* client, AwsFrameInfo* info, uint8_t* data, size_t len);
 };
 
 #endif // WEBSOCKET_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Converts animated GIF/WebP/PNG files to the .anm format played by AnimationEffect
+(keyframes + delta frames, RGB565 little-endian). Upload with anim,start/data/end.
+"""
+
+from PIL import Image, ImageSequence
+import argparse
+import struct
+import sys
+
+FRAME_KEY = 0x01
+FRAME_DELTA = 0x02
+
+
+def to_rgb565(img):
+    """RGB image -> list of RGB565 values (row-major)"""
+    return [((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3) for r, g, b in img.getdata()]
+
+
+def encode_delta(prev, cur):
+    """Blocks (u16 skip, u16 count, count pixels) over the changed pixels"""
+    out = bytearray()
+    i = 0
+    last = 0
+    n = len(cur)
+    while i < n:
+        if cur[i] == prev[i]:
+            i += 1
+            continue
+        start = i
+        # Runs separated by 1-2 equal pixels are merged: a block header costs 4 bytes
+        while i < n and i - start < 0xFFFF and (cur[i] != prev[i] or cur[i + 1:i + 3] != prev[i + 1:i + 3]):
+            i += 1
+        skip = start - last
+        while skip > 0xFFFF:
+            out += struct.pack('<HH', 0xFFFF, 0)
+            skip -= 0xFFFF
+        out += struct.pack('<HH', skip, i - start)
+        out += struct.pack('<%dH' % (i - start), *cur[start:i])
+        last = i
+    return bytes(out)
+
+
+def convert(input_path, output_path, width, height, keyframe_interval, loops):
+    img = Image.open(input_path)
+    if loops is None:
+        # GIF: loop 0 = infinite; without the NETSCAPE extension it plays once
+        loops = 0 if img.info.get('loop', 1) == 0 else 1
+
+    frames = bytearray()
+    count = 0
+    prev = None
+    key_bytes = width * height * 2
+
+    for frame in ImageSequence.Iterator(img):
+        delay = frame.info.get('duration', 100)
+        rgb = frame.convert('RGB')
+        if rgb.size != (width, height):
+            rgb = rgb.resize((width, height), Image.Resampling.LANCZOS)
+        cur = to_rgb565(rgb)
+
+        payload = None
+        if prev is not None and count % keyframe_interval != 0:
+            delta = encode_delta(prev, cur)
+            if len(delta) < key_bytes:
+                payload = (FRAME_DELTA, delta)
+        if payload is None:
+            payload = (FRAME_KEY, struct.pack('<%dH' % len(cur), *cur))
+
+        frame_type, data = payload
+        frames += struct.pack('<BBHI', frame_type, 0, min(int(delay), 0xFFFF), len(data))
+        frames += data
+        prev = cur
+        count += 1
+
+    if count == 0 or count > 0xFFFF:
+        print(f"Invalid frame count: {count}")
+        return False
+
+    header = b'ANM1' + struct.pack('<HHHHI', width, height, count, loops, 0)
+    with open(output_path, 'wb') as f:
+        f.write(header)
+        f.write(frames)
+
+    total = len(header) + len(frames)
+    print(f"Written: {output_path}")
+    print(f"Frames: {count}, size: {width}x{height}, loops: {loops or 'infinite'}")
+    print(f"File size: {total} bytes ({total / (count * key_bytes) * 100:.1f}% of raw)")
+    return True
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert animated images to .anm')
+    parser.add_argument('input')
+    parser.add_argument('output', nargs='?')
+    parser.add_argument('--width', type=int, default=64)
+    parser.add_argument('--height', type=int, default=64)
+    parser.add_argument('--keyframe', type=int, default=60, help='Keyframe every N frames')
+    parser.add_argument('--loops', type=int, default=None, help='0 = infinite (default: from GIF)')
+    args = parser.parse_args()
+
+    output = args.output or args.input.rsplit('.', 1)[0] + '.anm'
+    if not convert(args.input, output, args.width, args.height, max(1, args.keyframe), args.loops):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
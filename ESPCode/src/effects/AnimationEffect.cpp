@@ -0,0 +1,129 @@
+#include "AnimationEffect.h"
+#include "../Debug.h"
+
+AnimationEffect::AnimationEffect(DisplayManager* dm, ImageManager* imgMgr)
+    : Effect(dm)
+    , _imageManager(imgMgr)
+    , _name("")
+    , _x(0)
+    , _y(0)
+    , _dirty(false)
+    , _nextFrameMs(0)
+    , _playStartMs(0)
+    , _shown(0)
+    , _late(0)
+{
+}
+
+AnimationEffect::~AnimationEffect() {
+    _player.close();
+}
+
+void AnimationEffect::init() {
+    displayManager->fillScreen(0, 0, 0);
+
+    // play() da comando apre già il file prima dello switch
+    if (!_player.isOpen()) {
+        openCurrent();
+    }
+}
+
+void AnimationEffect::cleanup() {
+    // Fuori schermo niente RAM occupata: al rientro si riparte dal primo frame
+    _player.close();
+}
+
+void AnimationEffect::update() {
+    if (!_player.isOpen()) return;
+
+    unsigned long now = millis();
+    if ((long)(now - _nextFrameMs) < 0) {
+        // In attesa del frame: si riempie la finestra un blocco per volta
+        _player.readAhead();
+        return;
+    }
+
+    if (!_player.nextFrame()) return;
+    _dirty = true;
+
+    // Più di un intervallo di ritardo: si riallinea invece di accelerare
+    _nextFrameMs += _player.getFrameDelay();
+    if ((long)(now - _nextFrameMs) >= 0) {
+        _late++;
+        _nextFrameMs = now + _player.getFrameDelay();
+    }
+}
+
+void AnimationEffect::draw() {
+    if (!_dirty) return;
+
+    const AnimationHeader& header = _player.getHeader();
+    displayManager->blitRect(_x, _y, header.width, header.height, _player.getFrame(), header.width);
+    _dirty = false;
+    _shown++;
+}
+
+// ═══════════════════════════════════════════
+// Controllo
+// ═══════════════════════════════════════════
+
+bool AnimationEffect::play(const String& name) {
+    _name = name;
+    return openCurrent();
+}
+
+void AnimationEffect::stop() {
+    _player.close();
+    _dirty = false;
+    displayManager->fillScreen(0, 0, 0);
+}
+
+bool AnimationEffect::openCurrent() {
+    if (!_imageManager) return false;
+
+    if (_name.length() == 0) {
+        std::vector<ImageInfo> anims = _imageManager->listAnimations();
+        if (anims.empty()) {
+            DEBUG_PRINTLN(F("[AnimationEffect] No animations found"));
+            return false;
+        }
+        _name = anims[0].name;
+    }
+
+    File file = _imageManager->openAnimation(_name);
+    uint16_t canvasWidth = displayManager->getCanvasWidth();
+    uint16_t canvasHeight = displayManager->getCanvasHeight();
+    if (!file || !_player.open(file, canvasWidth, canvasHeight)) {
+        DEBUG_PRINTF("[AnimationEffect] Failed to open: %s\n", _name.c_str());
+        return false;
+    }
+
+    const AnimationHeader& header = _player.getHeader();
+    _x = (canvasWidth - header.width) / 2;
+    _y = (canvasHeight - header.height) / 2;
+    _dirty = false;
+    _nextFrameMs = millis();
+    _playStartMs = _nextFrameMs;
+    _shown = 0;
+    _late = 0;
+
+    // Animazione più piccola del canvas: margini neri
+    displayManager->fillScreen(0, 0, 0);
+
+    DEBUG_PRINTF("[AnimationEffect] Playing: %s\n", _name.c_str());
+    return true;
+}
+
+// ═══════════════════════════════════════════
+// Statistiche
+// ═══════════════════════════════════════════
+
+float AnimationEffect::getPlaybackFPS() const {
+    unsigned long elapsed = millis() - _playStartMs;
+    return elapsed > 0 ? _shown * 1000.0f / elapsed : 0;
+}
+
+uint32_t AnimationEffect::getReadKBps() const {
+    uint32_t us = _player.getReadUs();
+    return us > 0 ? (uint32_t)((uint64_t)_player.getBytesRead() * 1000000ULL / 1024 / us) : 0;
+}
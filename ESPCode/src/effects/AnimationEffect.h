@@ -0,0 +1,59 @@
+#ifndef ANIMATION_EFFECT_H
+#define ANIMATION_EFFECT_H
+
+#include "../Effect.h"
+#include "../ImageManager.h"
+#include "../AnimationPlayer.h"
+
+/**
+ * AnimationEffect - Riproduce animazioni .anm da LittleFS
+ *
+ * Un frame per volta con AnimationPlayer: RAM fissa (frame + finestra di
+ * read-ahead) anche per animazioni di centinaia di frame. L'animazione è
+ * centrata sul canvas; senza play() parte la prima della lista. Completo a
+ * fine loop (header loops > 0) o senza animazioni: l'auto-switch prosegue.
+ */
+class AnimationEffect : public Effect {
+public:
+    AnimationEffect(DisplayManager* dm, ImageManager* imgMgr);
+    ~AnimationEffect();
+
+    void init() override;
+    void update() override;
+    void draw() override;
+    void cleanup() override;
+    const char* getName() override { return "Animation"; }
+    bool isComplete() override { return !_player.isOpen() || _player.isFinished() || _player.hasError(); }
+    bool isAutoSwitchable() const override { return false; }
+
+    // Task di render (comandi)
+    bool play(const String& name);
+    void stop();
+
+    const String& getAnimationName() const { return _name; }
+    const AnimationPlayer& getPlayer() const { return _player; }
+
+    // Statistiche: frame mostrati al secondo e lettura flash dall'avvio
+    float getPlaybackFPS() const;
+    uint32_t getReadKBps() const;
+    uint32_t getShown() const { return _shown; }
+    uint32_t getLate() const { return _late; }
+
+private:
+    ImageManager* _imageManager;
+    AnimationPlayer _player;
+    String _name;
+
+    int16_t _x;
+    int16_t _y;
+    bool _dirty;
+    unsigned long _nextFrameMs;
+
+    unsigned long _playStartMs;
+    uint32_t _shown;
+    uint32_t _late;             // Frame in ritardo di più di un intervallo
+
+    bool openCurrent();
+};
+
+#endif // ANIMATION_EFFECT_H
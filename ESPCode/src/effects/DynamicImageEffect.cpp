@@ -4,7 +4,15 @@
 DynamicImageEffect::DynamicImageEffect(DisplayManager* dm, ImageManager* imgMgr, unsigned long displayDuration)
     : Effect(dm)
     , _imageManager(imgMgr)
-    , _imageBuffer(nullptr)
+    , _currentSlot(-1)
+    , _prefetchSlot(-1)
+    , _prefetchFailed(-1)
+    , _useCounter(0)
+    , _generation(0)
+    , _cacheHits(0)
+    , _cacheMisses(0)
+    , _prefetched(0)
+    , _lastSwapUs(0)
     , _currentIndex(-1)
     , _currentImageName("")
     , _imageLoaded(false)
@@ -13,17 +21,11 @@ DynamicImageEffect::DynamicImageEffect(DisplayManager* dm, ImageManager* imgMgr,
     , _displayDuration(displayDuration)
     , _lastChangeTime(0)
 {
-    // Alloca buffer per immagine 64x64 RGB565
-    _imageBuffer = (uint16_t*)malloc(IMAGE_SIZE);
-    if (!_imageBuffer) {
-        DEBUG_PRINTLN(F("[DynamicImageEffect] Failed to allocate image buffer!"));
-    }
 }
 
 DynamicImageEffect::~DynamicImageEffect() {
-    if (_imageBuffer) {
-        free(_imageBuffer);
-    }
+    cancelPrefetch();
+    freeCache();
 }
 
 void DynamicImageEffect::init() {
@@ -33,6 +35,7 @@ void DynamicImageEffect::init() {
 
     // Carica lista immagini disponibili
     loadImageList();
+    allocateCache();
 
     if (_imageList.empty()) {
         DEBUG_PRINTLN(F("[DynamicImageEffect] No images found"));
@@ -50,17 +53,30 @@ void DynamicImageEffect::init() {
     _lastChangeTime = millis();
 }
 
+void DynamicImageEffect::cleanup() {
+    // Fuori schermo la cache non occupa heap
+    cancelPrefetch();
+    freeCache();
+    _imageLoaded = false;
+}
+
 void DynamicImageEffect::update() {
-    if (!_autoSlideshow || _imageList.empty()) {
+    if (_imageManager && _imageManager->getGeneration() != _generation) {
+        refreshImages();
+    }
+
+    if (_imageList.empty()) {
         return;
     }
 
     // Slideshow automatico
     unsigned long now = millis();
-    if (now - _lastChangeTime >= _displayDuration) {
+    if (_autoSlideshow && now - _lastChangeTime >= _displayDuration) {
         nextImage();
         _lastChangeTime = now;
     }
+
+    servicePrefetch();
 }
 
 void DynamicImageEffect::draw() {
@@ -68,7 +84,7 @@ void DynamicImageEffect::draw() {
         return;
     }
 
-    if (!_imageLoaded || !_imageBuffer) {
+    if (!_imageLoaded || _currentSlot < 0) {
         // Nessuna immagine caricata - schermo nero
         displayManager->fillScreen(0, 0, 0);
         _needsRedraw = false;
@@ -172,6 +188,7 @@ void DynamicImageEffect::loadImageList() {
         return;
     }
 
+    _generation = _imageManager->getGeneration();
     _imageList = _imageManager->listImages();
     DEBUG_PRINTF("[DynamicImageEffect] Loaded %d images from storage\n", _imageList.size());
 
@@ -180,8 +197,34 @@ void DynamicImageEffect::loadImageList() {
     }
 }
 
+// Immagini cambiate mentre l'effetto è attivo: gli slot possono contenere
+// una versione vecchia, si scartano tutti e si ricarica l'immagine corrente
+void DynamicImageEffect::refreshImages() {
+    cancelPrefetch();
+    for (auto& slot : _cache) {
+        slot.valid = false;
+    }
+    _currentSlot = -1;
+    _prefetchFailed = -1;
+
+    String current = _currentImageName;
+    loadImageList();
+
+    _currentIndex = _imageList.empty() ? -1 : 0;
+    for (int i = 0; i < _imageList.size(); i++) {
+        if (_imageList[i].name == current) {
+            _currentIndex = i;
+            break;
+        }
+    }
+    _imageLoaded = loadCurrentImage();
+    _needsRedraw = true;
+}
+
+// Cambio immagine: dalla cache se c'è (o se il prefetch è in corso),
+// altrimenti caricamento sincrono nello slot meno usato
 bool DynamicImageEffect::loadCurrentImage() {
-    if (!_imageManager || !_imageBuffer) {
+    if (!_imageManager || _cache.empty()) {
         return false;
     }
 
@@ -189,47 +232,172 @@ bool DynamicImageEffect::loadCurrentImage() {
         return false;
     }
 
+    uint32_t t0 = micros();
     const ImageInfo& img = _imageList[_currentIndex];
     _currentImageName = img.name;
+    _prefetchFailed = -1;
+
+    int8_t slot = findSlot(img.name);
+
+    // Prefetch non ancora finito: si completa ora (resta un hit parziale)
+    if (slot < 0 && _prefetchSlot >= 0 && _cache[_prefetchSlot].name == img.name) {
+        ImageLoadStatus status;
+        do {
+            status = _imageManager->stepLoad(IMAGE_SIZE);
+        } while (status == IMAGE_LOAD_PENDING);
+        if (status == IMAGE_LOAD_DONE) {
+            _cache[_prefetchSlot].valid = true;
+            slot = _prefetchSlot;
+        }
+        _prefetchSlot = -1;
+    }
 
-    DEBUG_PRINTF("[DynamicImageEffect] Loading image: %s\n", img.name.c_str());
-
-    // Carica immagine da LittleFS
-    bool success = _imageManager->loadImage(img.name, _imageBuffer);
-
-    if (!success) {
-        DEBUG_PRINTF("[DynamicImageEffect] Failed to load image: %s\n", img.name.c_str());
-        _currentImageName = "";
-        return false;
+    if (slot >= 0) {
+        _cacheHits++;
+    } else {
+        cancelPrefetch();
+        slot = victimSlot();
+        if (slot < 0) slot = _currentSlot;     // Un solo slot: si riusa
+        _cache[slot].valid = false;
+        _cache[slot].name = img.name;
+        _cacheMisses++;
+
+        DEBUG_PRINTF("[DynamicImageEffect] Loading image: %s\n", img.name.c_str());
+        if (!_imageManager->loadImage(img.name, _cache[slot].pixels)) {
+            DEBUG_PRINTF("[DynamicImageEffect] Failed to load image: %s\n", img.name.c_str());
+            _currentImageName = "";
+            _currentSlot = -1;
+            return false;
+        }
+        _cache[slot].valid = true;
     }
 
-    DEBUG_PRINTF("[DynamicImageEffect] Successfully loaded: %s\n", img.name.c_str());
+    _currentSlot = slot;
+    _cache[slot].lastUsed = ++_useCounter;
+    _lastSwapUs = micros() - t0;
     return true;
 }
 
 void DynamicImageEffect::drawCurrentImage() {
-    if (!_imageBuffer || !displayManager) {
+    if (_currentSlot < 0 || !displayManager) {
         return;
     }
 
-    auto* display = displayManager->getDisplay();
-    if (!display) {
-        return;
+    // Disegna immagine nel framebuffer: il flush invia solo i pixel cambiati
+    // Il buffer è RGB565 little-endian
+    displayManager->beginFrame();
+    displayManager->blitRect(0, 0, IMAGE_WIDTH, IMAGE_HEIGHT, _cache[_currentSlot].pixels, IMAGE_WIDTH);
+    displayManager->endFrame();
+}
+
+// ═══════════════════════════════════════════
+// Cache e Prefetch
+// ═══════════════════════════════════════════
+
+void DynamicImageEffect::allocateCache() {
+    if (!_cache.empty()) return;
+
+    // Slot in base all'heap libero. Con heap scarso resta solo lo slot a
+    // schermo: victimSlot() non trova slot liberi e il prefetch si ferma
+    uint32_t heap = ESP.getFreeHeap();
+    size_t slots = heap > IMAGE_CACHE_HEAP_RESERVE ? (heap - IMAGE_CACHE_HEAP_RESERVE) / IMAGE_SIZE : 0;
+    if (slots < 1) slots = 1;
+    if (slots > IMAGE_CACHE_MAX_SLOTS) slots = IMAGE_CACHE_MAX_SLOTS;
+
+    for (size_t i = 0; i < slots; i++) {
+        uint16_t* pixels = (uint16_t*)malloc(IMAGE_SIZE);
+        if (!pixels) break;
+        CacheSlot slot;
+        slot.pixels = pixels;
+        slot.lastUsed = 0;
+        slot.valid = false;
+        _cache.push_back(slot);
     }
 
-    // Disegna immagine pixel per pixel
-    // Il buffer è RGB565 little-endian
-    for (int y = 0; y < IMAGE_HEIGHT; y++) {
-        for (int x = 0; x < IMAGE_WIDTH; x++) {
-            int index = y * IMAGE_WIDTH + x;
-            uint16_t rgb565 = _imageBuffer[index];
+    if (_cache.empty()) {
+        DEBUG_PRINTLN(F("[DynamicImageEffect] Failed to allocate image cache!"));
+    } else {
+        DEBUG_PRINTF("[DynamicImageEffect] Image cache: %u slots (%u bytes, heap %u)\n",
+                     _cache.size(), _cache.size() * IMAGE_SIZE, heap);
+    }
+}
 
-            // Converti RGB565 → RGB888 per drawPixelRGB888
-            uint8_t r = ((rgb565 >> 11) & 0x1F) << 3;  // 5 bit → 8 bit
-            uint8_t g = ((rgb565 >> 5) & 0x3F) << 2;   // 6 bit → 8 bit
-            uint8_t b = (rgb565 & 0x1F) << 3;          // 5 bit → 8 bit
+void DynamicImageEffect::freeCache() {
+    for (auto& slot : _cache) {
+        free(slot.pixels);
+    }
+    _cache.clear();
+    _currentSlot = -1;
+    _prefetchSlot = -1;
+}
 
-            display->drawPixelRGB888(x, y, r, g, b);
+uint8_t DynamicImageEffect::getCacheUsed() const {
+    uint8_t used = 0;
+    for (const auto& slot : _cache) {
+        if (slot.valid) used++;
+    }
+    return used;
+}
+
+int8_t DynamicImageEffect::findSlot(const String& name) const {
+    for (int8_t i = 0; i < _cache.size(); i++) {
+        if (_cache[i].valid && _cache[i].name == name) return i;
+    }
+    return -1;
+}
+
+// Slot libero o meno usato di recente, mai quello a schermo o in prefetch
+int8_t DynamicImageEffect::victimSlot() const {
+    int8_t victim = -1;
+    for (int8_t i = 0; i < _cache.size(); i++) {
+        if (i == _currentSlot || i == _prefetchSlot) continue;
+        if (!_cache[i].valid) return i;
+        if (victim < 0 || _cache[i].lastUsed < _cache[victim].lastUsed) victim = i;
+    }
+    return victim;
+}
+
+void DynamicImageEffect::cancelPrefetch() {
+    if (_prefetchSlot < 0) return;
+    _imageManager->cancelLoad();
+    _cache[_prefetchSlot].valid = false;
+    _prefetchSlot = -1;
+}
+
+// Un blocco per frame del caricamento in corso, oppure avvia quello
+// dell'immagine successiva se non è già in cache
+void DynamicImageEffect::servicePrefetch() {
+    if (_cache.empty()) return;
+
+    if (_prefetchSlot >= 0) {
+        ImageLoadStatus status = _imageManager->stepLoad(IMAGE_PREFETCH_BYTES);
+        if (status == IMAGE_LOAD_DONE) {
+            _cache[_prefetchSlot].valid = true;
+            _cache[_prefetchSlot].lastUsed = _useCounter;
+            _prefetched++;
+            _prefetchSlot = -1;
+        } else if (status == IMAGE_LOAD_ERROR) {
+            // Errore o job annullato da un altro caricamento
+            _cache[_prefetchSlot].valid = false;
+            _prefetchSlot = -1;
         }
+        return;
+    }
+
+    if (_imageList.size() < 2 || _imageManager->isLoading()) return;
+
+    int next = (_currentIndex + 1) % _imageList.size();
+    const String& name = _imageList[next].name;
+    if (next == _prefetchFailed || findSlot(name) >= 0) return;
+
+    int8_t slot = victimSlot();
+    if (slot < 0) return;
+
+    _cache[slot].valid = false;
+    _cache[slot].name = name;
+    if (_imageManager->beginLoad(name, _cache[slot].pixels)) {
+        _prefetchSlot = slot;
+    } else {
+        _prefetchFailed = next;
     }
 }
@@ -4,11 +4,22 @@
 #include "../Effect.h"
 #include "../ImageManager.h"
 
+#define IMAGE_CACHE_MAX_SLOTS 6
+#define IMAGE_CACHE_HEAP_RESERVE (64 * 1024)    // Heap lasciato agli altri effetti
+#define IMAGE_PREFETCH_BYTES 1024               // Flash letta per frame durante il prefetch
+
 /**
  * DynamicImageEffect - Slideshow di immagini caricate su LittleFS
  *
  * Carica e mostra immagini dinamiche salvate dall'app.
  * Supporta cambio manuale o slideshow automatico.
+ *
+ * Cache LRU di immagini decodificate (slot allocati in init() in base
+ * all'heap libero, liberati in cleanup()). La successiva viene
+ * precaricata a blocchi di IMAGE_PREFETCH_BYTES per frame: il cambio
+ * immagine è uno scambio di slot, senza accessi a flash.
+ * Se ImageManager cambia generazione (upload, sostituzione, cancellazione)
+ * la cache viene svuotata e lista e immagine corrente ricaricate.
  */
 class DynamicImageEffect : public Effect {
 public:
@@ -18,7 +29,9 @@ public:
     void init() override;
     void update() override;
     void draw() override;
+    void cleanup() override;
     const char* getName() override;
+    bool isFixedScene() const override { return true; }  // Immagini IMAGE_WIDTH x IMAGE_HEIGHT
 
     // Controllo manuale
     void showImage(const String& name);      // Mostra immagine specifica
@@ -32,11 +45,37 @@ public:
     int getCurrentIndex() const { return _currentIndex; }
     int getImageCount() const { return _imageList.size(); }
 
+    // Cache: hit = cambio senza flash, miss = caricamento sincrono
+    uint8_t getCacheSlots() const { return _cache.size(); }
+    uint8_t getCacheUsed() const;
+    uint32_t getCacheHits() const { return _cacheHits; }
+    uint32_t getCacheMisses() const { return _cacheMisses; }
+    uint32_t getPrefetched() const { return _prefetched; }
+    uint32_t getLastSwapUs() const { return _lastSwapUs; }
+
 private:
+    struct CacheSlot {
+        String name;
+        uint16_t* pixels;               // RGB565 IMAGE_WIDTH x IMAGE_HEIGHT
+        uint32_t lastUsed;
+        bool valid;
+    };
+
     ImageManager* _imageManager;
-    uint16_t* _imageBuffer;              // Buffer RGB565 per immagine corrente
     std::vector<ImageInfo> _imageList;   // Lista immagini disponibili
 
+    std::vector<CacheSlot> _cache;
+    int8_t _currentSlot;                // Slot a schermo
+    int8_t _prefetchSlot;               // Slot in caricamento, -1 = nessuno
+    int _prefetchFailed;                // Indice da non ritentare
+    uint32_t _useCounter;
+    uint32_t _generation;               // Di ImageManager al caricamento della lista
+
+    uint32_t _cacheHits;
+    uint32_t _cacheMisses;
+    uint32_t _prefetched;
+    uint32_t _lastSwapUs;
+
     int _currentIndex;
     String _currentImageName;
     bool _imageLoaded;
@@ -51,6 +90,14 @@ private:
     void loadImageList();
     bool loadCurrentImage();
     void drawCurrentImage();
+
+    void refreshImages();
+    void allocateCache();
+    void freeCache();
+    int8_t findSlot(const String& name) const;
+    int8_t victimSlot() const;
+    void cancelPrefetch();
+    void servicePrefetch();
 };
 
 #endif // DYNAMIC_IMAGE_EFFECT_H
@@ -12,6 +12,10 @@ MarioClockEffect::MarioClockEffect(DisplayManager* dm, TimeManager* tm)
       minuteBlock(new MarioBlock()),
       marioSprite(new MarioSprite()),
       isDayTheme(true),
+      backgroundLayer(nullptr),
+      renderTarget(nullptr),
+      backgroundValid(false),
+      backgroundIsDay(true),
       transitionState(TRANSITION_NONE),
       transitionProgress(0.0f),
       lastTransitionUpdate(0),
@@ -42,6 +46,7 @@ MarioClockEffect::~MarioClockEffect() {
     delete hourBlock;
     delete minuteBlock;
     delete marioSprite;
+    delete[] backgroundLayer;
 #if ENABLE_PIPE_ANIMATION
     delete pipe;
 #endif
@@ -59,6 +64,12 @@ void MarioClockEffect::init() {
     initPipe();
 #endif
 
+    // Layer di sfondo (~8KB), liberato in cleanup()
+    if (!backgroundLayer) {
+        backgroundLayer = new uint16_t[displayManager->getWidth() * displayManager->getHeight()];
+    }
+    backgroundValid = false;
+
     displayManager->setTextSize(1);
     displayManager->setFont(&Super_Mario_Bros__24pt7b);
 
@@ -104,6 +115,9 @@ void MarioClockEffect::init() {
 
 void MarioClockEffect::cleanup() {
     timeManager->removeCallback(minuteCallbackId);
+    delete[] backgroundLayer;
+    backgroundLayer = nullptr;
+    backgroundValid = false;
     DEBUG_PRINTLN("[MarioClockEffect] Cleanup - removing TimeManager callback");
 }
 
@@ -264,51 +278,12 @@ void MarioClockEffect::drawPipe() {
             int idx = dy * pipe->width + dx;
             uint16_t color = pgm_read_word(&PIPE_SPRITE[idx]);
             
-            uint8_t r, g, b;
-
-            // Se pixel trasparente, ridisegna lo sfondo
+            // Se pixel trasparente, ridisegna lo sfondo dal layer
             if (color == _MASK) {
-                // Default: colore cielo (theme-dependent)
-                if (isDayTheme) {
-                    r = 0; g = 145; b = 206;
-                } else {
-                    r = 10; g = 20; b = 50;
-                }
-                
-                // Controlla se è nella collina
-                if (screenX < 20 && screenY >= 34 && screenY < 56) {
-                    int hillX = screenX;
-                    int hillY = screenY - 34;
-                    if (hillY < 22 && hillX < 20) {
-                        uint16_t hillColor = pgm_read_word(&HILL[hillY * 20 + hillX]);
-                        if (hillColor != _MASK) {
-                            r = (hillColor >> 11) << 3;
-                            g = ((hillColor >> 5) & 0x3F) << 2;
-                            b = (hillColor & 0x1F) << 3;
-                        }
-                    }
-                }
-                // Controlla cespuglio
-                else if (screenX >= 43 && screenX < 64 && screenY >= 47 && screenY < 56) {
-                    int bushX = screenX - 43;
-                    int bushY = screenY - 47;
-                    if (bushY < 9 && bushX < 21) {
-                        uint16_t bushColor = pgm_read_word(&BUSH[bushY * 21 + bushX]);
-                        if (bushColor != _MASK) {
-                            r = (bushColor >> 11) << 3;
-                            g = ((bushColor >> 5) & 0x3F) << 2;
-                            b = (bushColor & 0x1F) << 3;
-                        }
-                    }
-                }
-            } else {
-                // Pixel del tubo
-                r = (color >> 11) << 3;
-                g = ((color >> 5) & 0x3F) << 2;
-                b = (color & 0x1F) << 3;
+                color = backgroundLayer[screenY * screenWidth + screenX];
             }
-            
-            displayManager->drawPixel(screenX, screenY, r, g, b);
+
+            displayManager->drawPixel(screenX, screenY, color);
         }
     }
 }
@@ -389,6 +364,15 @@ void MarioClockEffect::update() {
     // Update transition animation
     updateTransition();
 
+    // Il layer serve ai ripristini incrementali: va pronto prima del primo frame
+    if (!backgroundValid || backgroundIsDay != isDayTheme) {
+        renderBackgroundLayer();
+    }
+
+    // Gli aggiornamenti incrementali (ripristino sfondo + sprite) finiscono
+    // nello stesso frame: il flush invia solo i pixel netti cambiati
+    displayManager->beginFrame();
+
     updateMario();
 
 #if ENABLE_PIPE_ANIMATION
@@ -400,6 +384,8 @@ void MarioClockEffect::update() {
 
     updateBlock(*hourBlock, lastHourUpdate);
     updateBlock(*minuteBlock, lastMinuteUpdate);
+
+    displayManager->endFrame();
 }
 
 void MarioClockEffect::draw() {
@@ -420,31 +406,19 @@ void MarioClockEffect::draw() {
 }
 
 void MarioClockEffect::drawScene() {
+    if (!backgroundValid || backgroundIsDay != isDayTheme) {
+        renderBackgroundLayer();
+    }
+
     displayManager->beginFrame();
 
-    // Theme-dependent sky color
-    if (isDayTheme) {
-        displayManager->fillScreen(0, 145, 206);
-    } else {
-        displayManager->fillScreen(10, 20, 50);
-    }
+    // Sfondo statico dal layer in cache
+    displayManager->blitRect(0, 0, displayManager->getWidth(), displayManager->getHeight(),
+                             backgroundLayer, displayManager->getWidth());
 
     displayManager->setTextSize(1);
     displayManager->setFont(&Super_Mario_Bros__24pt7b);
 
-    spriteRenderer->drawSprite(HILL, 0, 34, 20, 22);
-    spriteRenderer->drawSprite(BUSH, 43, 47, 21, 9);
-
-    if (isDayTheme) {
-        spriteRenderer->drawSprite(CLOUD1, 0, 21, 13, 12);
-        spriteRenderer->drawSprite(CLOUD2, 51, 7, 13, 12);
-    } else {
-        drawMoon(51, 7);
-        drawStars();
-    }
-
-    drawGround();
-
     drawBlock(*hourBlock);
     drawBlock(*minuteBlock);
 
@@ -461,6 +435,65 @@ void MarioClockEffect::drawScene() {
     displayManager->endFrame();
 }
 
+void MarioClockEffect::renderBackgroundLayer() {
+    if (!backgroundLayer) return;
+
+    int width = displayManager->getWidth();
+    int height = displayManager->getHeight();
+
+    // Theme-dependent sky color
+    uint16_t sky = isDayTheme ? DisplayManager::color565(0, 145, 206)
+                              : DisplayManager::color565(10, 20, 50);
+    PixelKernels::fill(backgroundLayer, width * height, sky);
+
+    layerSprite(HILL, 0, 34, 20, 22);
+    layerSprite(BUSH, 43, 47, 21, 9);
+
+    // Luna, stelle e terreno usano plot(): con renderTarget finiscono nel layer
+    renderTarget = backgroundLayer;
+    if (isDayTheme) {
+        layerSprite(CLOUD1, 0, 21, 13, 12);
+        layerSprite(CLOUD2, 51, 7, 13, 12);
+    } else {
+        drawMoon(51, 7);
+        drawStars();
+    }
+    drawGround();
+    renderTarget = nullptr;
+
+    backgroundValid = true;
+    backgroundIsDay = isDayTheme;
+
+    DEBUG_PRINTF("[MarioClockEffect] Background layer rendered (%s)\n", isDayTheme ? "DAY" : "NIGHT");
+}
+
+void MarioClockEffect::layerSprite(const uint16_t* sprite, int x, int y, int w, int h) {
+    int width = displayManager->getWidth();
+    int height = displayManager->getHeight();
+
+    for (int dy = 0; dy < h; dy++) {
+        int py = y + dy;
+        if (py < 0 || py >= height) continue;
+        for (int dx = 0; dx < w; dx++) {
+            int px = x + dx;
+            if (px < 0 || px >= width) continue;
+            uint16_t color = pgm_read_word(&sprite[dy * w + dx]);
+            if (color != _MASK) {
+                backgroundLayer[py * width + px] = color;
+            }
+        }
+    }
+}
+
+void MarioClockEffect::plot(int x, int y, uint8_t r, uint8_t g, uint8_t b) {
+    if (renderTarget) {
+        if (x < 0 || x >= displayManager->getWidth() || y < 0 || y >= displayManager->getHeight()) return;
+        renderTarget[y * displayManager->getWidth() + x] = DisplayManager::color565(r, g, b);
+    } else {
+        displayManager->drawPixel(x, y, r, g, b);
+    }
+}
+
 void MarioClockEffect::drawGround() {
     int width = displayManager->getWidth();
     int height = displayManager->getHeight();
@@ -473,7 +506,7 @@ void MarioClockEffect::drawGround() {
                 uint8_t r = (color >> 11) << 3;
                 uint8_t g = ((color >> 5) & 0x3F) << 2;
                 uint8_t b = (color & 0x1F) << 3;
-                displayManager->drawPixel(x, height - 8 + y, r, g, b);
+                plot(x, height - 8 + y, r, g, b);
             }
         }
     }
@@ -529,86 +562,12 @@ void MarioClockEffect::updateBlock(MarioBlock& block, unsigned long& lastUpdate)
 }
 
 void MarioClockEffect::redrawBackground(int x, int y, int width, int height) {
-    int screenWidth = displayManager->getWidth();
-    int screenHeight = displayManager->getHeight();
-
-    for (int dy = 0; dy < height; dy++) {
-        for (int dx = 0; dx < width; dx++) {
-            int px = x + dx;
-            int py = y + dy;
-
-            if (px < 0 || px >= screenWidth || py < 0 || py >= screenHeight) continue;
+    if (!backgroundLayer) return;
 
-            // Theme-dependent sky color
-            uint8_t r, g, b;
-            if (isDayTheme) {
-                r = 0; g = 145; b = 206; // Day sky
-            } else {
-                r = 10; g = 20; b = 50; // Night sky
-            }
-            
-            if (py >= screenHeight - 8) {
-                int groundY = py - (screenHeight - 8);
-                int idx = (groundY * 8 + (px % 8));
-                if (idx < 64) {
-                    uint16_t color = GROUND[idx];
-                    r = (color >> 11) << 3;
-                    g = ((color >> 5) & 0x3F) << 2;
-                    b = (color & 0x1F) << 3;
-                }
-            }
-            else if (px < 20 && py >= 34 && py < 56) {
-                int hillX = px;
-                int hillY = py - 34;
-                if (hillY < 22 && hillX < 20) {
-                    uint16_t color = pgm_read_word(&HILL[hillY * 20 + hillX]);
-                    if (color != _MASK) {
-                        r = (color >> 11) << 3;
-                        g = ((color >> 5) & 0x3F) << 2;
-                        b = (color & 0x1F) << 3;
-                    }
-                }
-            }
-            else if (px >= 43 && px < 64 && py >= 47 && py < 56) {
-                int bushX = px - 43;
-                int bushY = py - 47;
-                if (bushY < 9 && bushX < 21) {
-                    uint16_t color = pgm_read_word(&BUSH[bushY * 21 + bushX]);
-                    if (color != _MASK) {
-                        r = (color >> 11) << 3;
-                        g = ((color >> 5) & 0x3F) << 2;
-                        b = (color & 0x1F) << 3;
-                    }
-                }
-            }
-            else if (px < 13 && py >= 21 && py < 33) {
-                int cloudX = px;
-                int cloudY = py - 21;
-                if (cloudY < 12 && cloudX < 13) {
-                    uint16_t color = pgm_read_word(&CLOUD1[cloudY * 13 + cloudX]);
-                    if (color != _MASK) {
-                        r = (color >> 11) << 3;
-                        g = ((color >> 5) & 0x3F) << 2;
-                        b = (color & 0x1F) << 3;
-                    }
-                }
-            }
-            else if (px >= 51 && px < 64 && py >= 7 && py < 19) {
-                int cloudX = px - 51;
-                int cloudY = py - 7;
-                if (cloudY < 12 && cloudX < 13) {
-                    uint16_t color = pgm_read_word(&CLOUD2[cloudY * 13 + cloudX]);
-                    if (color != _MASK) {
-                        r = (color >> 11) << 3;
-                        g = ((color >> 5) & 0x3F) << 2;
-                        b = (color & 0x1F) << 3;
-                    }
-                }
-            }
-            
-            displayManager->drawPixel(px, py, r, g, b);
-        }
-    }
+    // Ripristino dal layer: blitRect gestisce il clipping sui bordi
+    int screenWidth = displayManager->getWidth();
+    displayManager->blitRect(x, y, width, height,
+                             backgroundLayer + y * screenWidth + x, screenWidth);
 }
 
 void MarioClockEffect::drawMoon(int x, int y) {
@@ -624,7 +583,7 @@ void MarioClockEffect::drawMoon(int x, int y) {
                 int py = y + dy + moonRadius;
                 if (px >= 0 && px < displayManager->getWidth() &&
                     py >= 0 && py < displayManager->getHeight()) {
-                    displayManager->drawPixel(px, py, moonR, moonG, moonB);
+                    plot(px, py, moonR, moonG, moonB);
                 }
             }
         }
@@ -657,12 +616,12 @@ void MarioClockEffect::drawStarsWithAlpha(uint8_t alpha) {
         int sy = starPositions[i][1];
 
         // Draw a small cross-shaped star
-        displayManager->drawPixel(sx, sy, starR, starG, starB);
+        plot(sx, sy, starR, starG, starB);
         if (i % 2 == 0) { // Some stars are bigger
-            displayManager->drawPixel(sx-1, sy, starR, starG, starB);
-            displayManager->drawPixel(sx+1, sy, starR, starG, starB);
-            displayManager->drawPixel(sx, sy-1, starR, starG, starB);
-            displayManager->drawPixel(sx, sy+1, starR, starG, starB);
+            plot(sx-1, sy, starR, starG, starB);
+            plot(sx+1, sy, starR, starG, starB);
+            plot(sx, sy-1, starR, starG, starB);
+            plot(sx, sy+1, starR, starG, starB);
         }
     }
 }
@@ -762,7 +721,7 @@ void MarioClockEffect::drawMoonWithAlpha(int x, int y, uint8_t alpha) {
                 int py = y + dy + moonRadius;
                 if (px >= 0 && px < displayManager->getWidth() &&
                     py >= 0 && py < displayManager->getHeight()) {
-                    displayManager->drawPixel(px, py, moonR, moonG, moonB);
+                    plot(px, py, moonR, moonG, moonB);
                 }
             }
         }
@@ -52,6 +52,16 @@ private:
     bool isDayTheme;
     void updateTheme();
 
+    // Sfondo statico (cielo, collina, cespuglio, nuvole/luna+stelle, terreno)
+    // pre-renderizzato una volta per tema e ripristinato con memcpy per riga
+    uint16_t* backgroundLayer;
+    uint16_t* renderTarget;     // != nullptr mentre si costruisce il layer
+    bool backgroundValid;
+    bool backgroundIsDay;
+    void renderBackgroundLayer();
+    void layerSprite(const uint16_t* sprite, int x, int y, int w, int h);
+    void plot(int x, int y, uint8_t r, uint8_t g, uint8_t b);
+
     // Theme transition animation
     enum TransitionState {
         TRANSITION_NONE,
@@ -140,6 +150,7 @@ public:
     void draw() override;
     void cleanup() override;
     const char* getName() override { return "Mario Clock"; }
+    bool isFixedScene() const override { return true; }  // Scena a sprite 64x64
     void reset() override;
     void onThemeChange(bool isDay) override;
 };
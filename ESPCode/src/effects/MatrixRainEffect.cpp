@@ -2,6 +2,8 @@
 
 MatrixRainEffect::MatrixRainEffect(DisplayManager* dm) 
     : Effect(dm) {
+    // Gocce a passo fisso: speed pixel per tick
+    setTickRate(EFFECT_TICK_HZ);
 }
 
 void MatrixRainEffect::init() {
@@ -13,7 +15,8 @@ void MatrixRainEffect::init() {
 void MatrixRainEffect::initDrops() {
     int width = displayManager->getWidth();
     
-    for (int i = 0; i < MAX_DROPS; i++) {
+    drops.resize(max(1, DROPS_PER_64_COLUMNS * width / 64));
+    for (size_t i = 0; i < drops.size(); i++) {
         drops[i].x = random(width);
         drops[i].y = random(-50, 0);
         drops[i].speed = random(1, 4);
@@ -26,7 +29,7 @@ void MatrixRainEffect::update() {
     int width = displayManager->getWidth();
     int height = displayManager->getHeight();
     
-    for (int i = 0; i < MAX_DROPS; i++) {
+    for (size_t i = 0; i < drops.size(); i++) {
         if (drops[i].active) {
             drops[i].y += drops[i].speed;
             
@@ -42,18 +45,16 @@ void MatrixRainEffect::update() {
 }
 
 void MatrixRainEffect::draw() {
-    int width = displayManager->getWidth();
     int height = displayManager->getHeight();
     
-    // Fade dello sfondo (effetto scia)
-    for (int x = 0; x < width; x++) {
-        for (int y = 0; y < height; y++) {
-            displayManager->drawPixel(x, y, 0, 2, 0);
-        }
-    }
+    displayManager->beginFrame();
+
+    // Sfondo: il vecchio passaggio (0,2,0) per pixel era nero in RGB565,
+    // ora un solo fill sul framebuffer
+    displayManager->fillScreen(0, 0, 0);
     
     // Disegna le gocce
-    for (int i = 0; i < MAX_DROPS; i++) {
+    for (size_t i = 0; i < drops.size(); i++) {
         if (drops[i].active) {
             for (int j = 0; j < drops[i].length; j++) {
                 int y = drops[i].y - j;
@@ -67,4 +68,6 @@ void MatrixRainEffect::draw() {
             }
         }
     }
-}
\ No newline at end of file
+
+    displayManager->endFrame();
+}
@@ -2,8 +2,10 @@
 #define MATRIX_RAIN_EFFECT_H
 
 #include "../Effect.h"
+#include <vector>
 
-#define MAX_DROPS 20
+// Gocce ogni 64 colonne: il numero cresce con la larghezza del canvas
+#define DROPS_PER_64_COLUMNS 20
 
 struct Drop {
     int x;
@@ -15,7 +17,7 @@ struct Drop {
 
 class MatrixRainEffect : public Effect {
 private:
-    Drop drops[MAX_DROPS];
+    std::vector<Drop> drops;
     
     void initDrops();
     
@@ -10,16 +10,22 @@ PacManClockEffect::PacManClockEffect(DisplayManager* dm, TimeManager* tm)
       pacAnimFrame(false),
       pacColor(PACMAN_COLOR),
       invincibleTimeout(0),
+      spriteRenderer(new SpriteRenderer(dm)),
       lastPacmanUpdate(0),
       lastClockUpdate(0),
       lastSecondBlink(0),
       showSeconds(true),
       needsRedraw(true),
+      superFoodIndex(0),
+      superFoodBlink(false),
+      superFoodVisible(true),
+      lastSuperBlink(0),
       _callbackID(-1)
 {
 }
 
 PacManClockEffect::~PacManClockEffect() {
+    delete spriteRenderer;
 }
 
 void PacManClockEffect::init() {
@@ -55,6 +61,7 @@ void PacManClockEffect::init() {
     // Copia sprite iniziale (direzione RIGHT)
     memcpy(currentSprite[0], PACMAN_SPRITE_1, sizeof(PACMAN_SPRITE_1));
     memcpy(currentSprite[1], PACMAN_SPRITE_2, sizeof(PACMAN_SPRITE_2));
+    compileSprites();
 
     randomSeed(millis() + timeManager->getSecond());
 
@@ -67,6 +74,12 @@ void PacManClockEffect::init() {
     showSeconds = true;
     needsRedraw = true;
 
+    // Palette appena azzerata da activate(): voce per il super cibo
+    superFoodBlink = displayManager->reservePalette(1, superFoodIndex);
+    superFoodVisible = true;
+    if (superFoodBlink) displayManager->setPaletteColor(superFoodIndex, PACMAN_SUPER_COLOR);
+    lastSuperBlink = millis();
+
     DEBUG_PRINTF("[PacManClockEffect] Pacman start position: %d, %d\n", pacX, pacY);
 }
 
@@ -129,6 +142,12 @@ void PacManClockEffect::update() {
         lastSecondBlink = now;
     }
 
+    // Super cibo lampeggiante di giorno, acceso di notte
+    if (superFoodBlink && now - lastSuperBlink >= SUPER_BLINK_MS) {
+        setSuperFoodVisible(isDayTheme ? !superFoodVisible : true);
+        lastSuperBlink = now;
+    }
+
     // Night theme: PacMan sleeps, no movement
     if (!isDayTheme) {
         return;  // Skip all PacMan updates during night
@@ -158,18 +177,18 @@ void PacManClockEffect::drawMap() {
     uint8_t g = ((PACMAN_WALL_COLOR >> 5) & 0x3F) << 2;
     uint8_t b = (PACMAN_WALL_COLOR & 0x1F) << 3;
 
-    // Rettangolo esterno
-    for (int x = 0; x < 64; x++) {
+    // Rettangolo esterno (bordo della scena)
+    for (int x = 0; x < SCENE_SIZE; x++) {
         displayManager->drawPixel(x, 0, r, g, b);
         displayManager->drawPixel(x, 1, r, g, b);
-        displayManager->drawPixel(x, 62, r, g, b);
-        displayManager->drawPixel(x, 63, r, g, b);
+        displayManager->drawPixel(x, SCENE_SIZE - 2, r, g, b);
+        displayManager->drawPixel(x, SCENE_SIZE - 1, r, g, b);
     }
-    for (int y = 0; y < 64; y++) {
+    for (int y = 0; y < SCENE_SIZE; y++) {
         displayManager->drawPixel(0, y, r, g, b);
         displayManager->drawPixel(1, y, r, g, b);
-        displayManager->drawPixel(62, y, r, g, b);
-        displayManager->drawPixel(63, y, r, g, b);
+        displayManager->drawPixel(SCENE_SIZE - 2, y, r, g, b);
+        displayManager->drawPixel(SCENE_SIZE - 1, y, r, g, b);
     }
 
     // Disegna elementi mappa
@@ -216,15 +235,7 @@ void PacManClockEffect::drawMap() {
                     break;
 
                 case BLOCK_SUPER_FOOD:
-                    // Super cibo (3x3 pixel arancione)
-                    fr = (PACMAN_SUPER_COLOR >> 11) << 3;
-                    fg = ((PACMAN_SUPER_COLOR >> 5) & 0x3F) << 2;
-                    fb = (PACMAN_SUPER_COLOR & 0x1F) << 3;
-                    for (int dy = 1; dy < 4; dy++) {
-                        for (int dx = 1; dx < 4; dx++) {
-                            displayManager->drawPixel(px + dx, py + dy, fr, fg, fb);
-                        }
-                    }
+                    drawSuperFood(px, py);
                     break;
 
                 case BLOCK_PACMAN:
@@ -307,6 +318,35 @@ void PacManClockEffect::drawClock() {
     displayManager->print(timeStr);
 }
 
+// Super cibo (3x3 pixel arancione) con la voce di palette riservata
+void PacManClockEffect::drawSuperFood(int px, int py) {
+    for (int dy = 1; dy < 4; dy++) {
+        for (int dx = 1; dx < 4; dx++) {
+            if (superFoodBlink) {
+                displayManager->drawPixelIndex(px + dx, py + dy, superFoodIndex);
+            } else {
+                displayManager->drawPixel(px + dx, py + dy, PACMAN_SUPER_COLOR);
+            }
+        }
+    }
+}
+
+void PacManClockEffect::setSuperFoodVisible(bool visible) {
+    if (visible == superFoodVisible) return;
+    superFoodVisible = visible;
+    displayManager->setPaletteColor(superFoodIndex, visible ? PACMAN_SUPER_COLOR : 0x0000);
+
+    // Framebuffer RGB565 (RAM insufficiente per l'indicizzato): il colore
+    // della voce non cambia i pixel già scritti, vanno ridisegnati
+    if (displayManager->getPixelFormat() != PIXEL_INDEXED8) {
+        for (int j = 0; j < MAP_SIZE; j++) {
+            for (int i = 0; i < MAP_SIZE; i++) {
+                if (gameMap[j][i] == BLOCK_SUPER_FOOD) drawSuperFood(mapToPixel(i), mapToPixel(j));
+            }
+        }
+    }
+}
+
 void PacManClockEffect::drawColonBlink() {
     uint8_t cr, cg, cb;
 
@@ -368,19 +408,7 @@ void PacManClockEffect::drawPacman() {
 
     // Day theme: Normal animated PacMan
     // Seleziona frame animazione
-    const uint16_t* sprite = pacAnimFrame ? currentSprite[1] : currentSprite[0];
-
-    for (int dy = 0; dy < PACMAN_SPRITE_SIZE; dy++) {
-        for (int dx = 0; dx < PACMAN_SPRITE_SIZE; dx++) {
-            uint16_t color = sprite[dy * PACMAN_SPRITE_SIZE + dx];
-            if (color != 0x0000) {  // Non trasparente
-                uint8_t r = (color >> 11) << 3;
-                uint8_t g = ((color >> 5) & 0x3F) << 2;
-                uint8_t b = (color & 0x1F) << 3;
-                displayManager->drawPixel(pacX + dx, pacY + dy, r, g, b);
-            }
-        }
-    }
+    spriteRenderer->blit(compiledSprite[pacAnimFrame ? 1 : 0], pacX, pacY);
 }
 
 void PacManClockEffect::updatePacman() {
@@ -536,6 +564,15 @@ void PacManClockEffect::changePacmanColor(uint16_t newColor) {
             currentSprite[1][i] = newColor;
         }
     }
+    compileSprites();
+}
+
+void PacManClockEffect::compileSprites() {
+    // 0x0000 = trasparente per gli sprite PacMan (in RAM, già ruotati)
+    for (int i = 0; i < 2; i++) {
+        SpriteRenderer::compile(compiledSprite[i], currentSprite[i],
+                                PACMAN_SPRITE_SIZE, PACMAN_SPRITE_SIZE, 0x0000, false, false);
+    }
 }
 
 MapBlock PacManClockEffect::getNextBlock() {
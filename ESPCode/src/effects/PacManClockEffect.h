@@ -2,6 +2,7 @@
 #define PACMAN_CLOCK_EFFECT_H
 
 #include "../Effect.h"
+#include "../SpriteRenderer.h"
 #include "../TimeManager.h"
 #include "../../include/pacman_assets.h"
 
@@ -62,6 +63,9 @@ private:
 
     // Sprite ruotati/flippati per direzione corrente
     uint16_t currentSprite[2][25];
+    CompiledSprite compiledSprite[2];  // Versione a run, ricompilata a ogni cambio
+    SpriteRenderer* spriteRenderer;
+    void compileSprites();
 
     // BFS per pathfinding
     static const int MAX_QUEUE_SIZE = MAP_SIZE * MAP_SIZE;
@@ -79,6 +83,13 @@ private:
     bool showSeconds;
     bool needsRedraw;
 
+    // Super cibo lampeggiante: voce di palette riservata, il lampeggio
+    // cambia solo il colore della voce (nessun pixel ridisegnato)
+    uint8_t superFoodIndex;
+    bool superFoodBlink;        // false = palette piena, colore fisso
+    bool superFoodVisible;
+    unsigned long lastSuperBlink;
+
     // Blocchi validi per movimento
     const int movingBlocks[4] = {3, BLOCK_EMPTY, BLOCK_FOOD, BLOCK_GATE};
     const int blockingBlocks[4] = {3, BLOCK_OUT_OF_MAP, BLOCK_WALL, BLOCK_CLOCK};
@@ -86,14 +97,17 @@ private:
     // Costanti mappa
     static const int MAP_BORDER_SIZE = 2;
     static const int MAP_MIN_POS = 0 + MAP_BORDER_SIZE;
-    static const int MAP_MAX_POS = 64 - MAP_BORDER_SIZE;
+    static const int MAP_MAX_POS = SCENE_SIZE - MAP_BORDER_SIZE;
     static const int BLOCK_SIZE = 5;  // Pixel per blocco
+    static const unsigned long SUPER_BLINK_MS = 250;
 
     // Metodi privati - Disegno
     void drawMap();
     void drawClock();
     void drawPacman();
     void drawColonBlink();
+    void drawSuperFood(int px, int py);
+    void setSuperFoodVisible(bool visible);
 
     // Metodi privati - Logica Pacman
     void updatePacman();
@@ -130,6 +144,8 @@ public:
     void draw() override;
     void cleanup() override;
     const char* getName() override { return "Pac-Man Clock"; }
+    bool isFixedScene() const override { return true; }  // Scena a sprite 64x64
+    PixelFormat getPixelFormat() const override { return PIXEL_INDEXED8; }  // Pochi colori
     void reset() override;
     void onThemeChange(bool isDay) override;
 };
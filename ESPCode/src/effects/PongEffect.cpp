@@ -3,6 +3,7 @@
 PongEffect::PongEffect(DisplayManager* dm)
     : Effect(dm),
       ballX(0), ballY(0),
+      prevBallX(0), prevBallY(0),
       ballSpeedX(0), ballSpeedY(0),
       baseBallSpeed(1.0),
       paddle1Y(0), paddle2Y(0),
@@ -15,6 +16,8 @@ PongEffect::PongEffect(DisplayManager* dm)
       paddleSpeed(2),
       countdownValue(0),
       countdownStart(0) {
+    // Fisica a passo fisso: velocità in pixel per tick
+    setTickRate(EFFECT_TICK_HZ);
 }
 
 void PongEffect::init() {
@@ -25,6 +28,8 @@ void PongEffect::init() {
 
     ballX = width / 2;
     ballY = height / 2;
+    prevBallX = ballX;
+    prevBallY = ballY;
     paddle1Y = (height - PADDLE_HEIGHT) / 2;
     paddle2Y = (height - PADDLE_HEIGHT) / 2;
     score1 = 0;
@@ -45,6 +50,10 @@ void PongEffect::init() {
 }
 
 void PongEffect::update() {
+    // Stato al tick precedente: se la pallina è ferma non oscilla in draw()
+    prevBallX = ballX;
+    prevBallY = ballY;
+
     switch (gameState) {
         case PongGameState::WAITING:
             // Non fare nulla, aspetta giocatori
@@ -154,6 +163,8 @@ void PongEffect::resetBall() {
 
     ballX = width / 2;
     ballY = height / 2;
+    prevBallX = ballX;      // Niente interpolazione attraverso il reset
+    prevBallY = ballY;
 
     // Direzione casuale
     ballSpeedX = (random(2) == 0 ? 1 : -1) * baseBallSpeed;
@@ -173,7 +184,7 @@ void PongEffect::draw() {
             // Aggiungi "PAUSED" overlay
             displayManager->setTextSize(1);
             displayManager->setTextColor(0xFFFF);
-            displayManager->setCursor(18, 28);
+            displayManager->setCursor(displayManager->getWidth() / 2 - 14, displayManager->getHeight() / 2 - 4);
             displayManager->print("PAUSED");
             break;
         case PongGameState::GAME_OVER:
@@ -217,9 +228,9 @@ void PongEffect::drawGame() {
         }
     }
 
-    // Disegna pallina (2x2)
-    int bx = (int)ballX;
-    int by = (int)ballY;
+    // Disegna pallina (2x2), interpolata tra gli ultimi due tick
+    int bx = (int)interpolate(prevBallX, ballX);
+    int by = (int)interpolate(prevBallY, ballY);
     displayManager->drawPixel(bx, by, 255, 255, 255);
     displayManager->drawPixel(bx + 1, by, 255, 255, 255);
     displayManager->drawPixel(bx, by + 1, 255, 255, 255);
@@ -227,23 +238,28 @@ void PongEffect::drawGame() {
 }
 
 void PongEffect::drawScore() {
+    int center = displayManager->getWidth() / 2;
+
     displayManager->setFont(nullptr);
     displayManager->setTextSize(1);
 
     // Score P1 (verde)
     displayManager->setTextColor(player1Mode == PlayerMode::HUMAN ? 0x07E0 : 0x39E7);
-    displayManager->setCursor(20, 2);
+    displayManager->setCursor(center - 12, 2);
     displayManager->print(String(score1));
 
     // Score P2 (rosso)
     displayManager->setTextColor(player2Mode == PlayerMode::HUMAN ? 0xF800 : 0x39E7);
-    displayManager->setCursor(40, 2);
+    displayManager->setCursor(center + 8, 2);
     displayManager->print(String(score2));
 }
 
 void PongEffect::drawWaiting() {
     displayManager->fillScreen(0, 0, 0);
 
+    // Schermata testuale impaginata per 64x64: centrata sul canvas
+    displayManager->centerViewport(SCENE_SIZE, SCENE_SIZE);
+
     displayManager->setFont(nullptr);
     displayManager->setTextSize(1);
     displayManager->setTextColor(0xFFFF);
@@ -269,10 +285,13 @@ void PongEffect::drawWaiting() {
         displayManager->setTextColor(0xFFE0);
         displayManager->print("Ready? START!");
     }
+
+    displayManager->resetViewport();
 }
 
 void PongEffect::drawGameOver() {
     displayManager->fillScreen(0, 0, 0);
+    displayManager->centerViewport(SCENE_SIZE, SCENE_SIZE);
 
     displayManager->setFont(nullptr);
     displayManager->setTextSize(1);
@@ -295,6 +314,8 @@ void PongEffect::drawGameOver() {
     displayManager->setTextColor(0x7BEF);
     displayManager->setCursor(8, 52);
     displayManager->print("Send RESET");
+
+    displayManager->resetViewport();
 }
 
 // ═══════════════════════════════════════════
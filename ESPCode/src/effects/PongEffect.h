@@ -21,6 +21,7 @@ class PongEffect : public Effect {
 private:
     // Game state
     float ballX, ballY;
+    float prevBallX, prevBallY;     // Posizione al tick precedente (interpolazione)
     float ballSpeedX, ballSpeedY;
     float baseBallSpeed;
     int paddle1Y, paddle2Y;
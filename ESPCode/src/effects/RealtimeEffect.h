@@ -0,0 +1,39 @@
+#ifndef REALTIME_EFFECT_H
+#define REALTIME_EFFECT_H
+
+#include "../Effect.h"
+#include "../RealtimeReceiver.h"
+
+/**
+ * RealtimeEffect - Mostra i frame ricevuti da RealtimeReceiver
+ * (DDP / E1.31 / Art-Net). Fuori dalla rotazione: lo attiva il
+ * takeover quando arriva una sorgente, completo quando non è più attiva.
+ */
+class RealtimeEffect : public Effect {
+public:
+    RealtimeEffect(DisplayManager* dm, RealtimeReceiver* receiver)
+        : Effect(dm), _receiver(receiver) {}
+
+    void init() override {
+        displayManager->fillScreen(0, 0, 0);
+    }
+
+    void update() override {}
+
+    void draw() override {
+        const uint16_t* frame = _receiver->takeFrame();
+        if (frame) {
+            displayManager->blitRect(0, 0, _receiver->getWidth(), _receiver->getHeight(),
+                                     frame, _receiver->getWidth());
+        }
+    }
+
+    const char* getName() override { return "Realtime"; }
+    bool isComplete() override { return !_receiver->isActive(); }
+    bool isAutoSwitchable() const override { return false; }
+
+private:
+    RealtimeReceiver* _receiver;
+};
+
+#endif // REALTIME_EFFECT_H
@@ -5,6 +5,7 @@ ScrollTextEffect::ScrollTextEffect(DisplayManager* dm, const String& scrollText,
     : Effect(dm),
       text(scrollText),
       scrollX(0),
+      prevScrollX(0),
       scrollSpeed(1),
       textWidth(0),
       textHeight(0),
@@ -13,12 +14,15 @@ ScrollTextEffect::ScrollTextEffect(DisplayManager* dm, const String& scrollText,
       completed(false),
       loopCount(0),      // Default: infinito
       currentLoop(0) {
+    // Scorrimento a passo fisso: scrollSpeed pixel per tick
+    setTickRate(EFFECT_TICK_HZ);
 }
 
 void ScrollTextEffect::init() {
     DEBUG_PRINTF("[ScrollTextEffect] Initializing: \"%s\" (loops: %d)\n", text.c_str(), loopCount);
 
     scrollX = displayManager->getWidth();
+    prevScrollX = scrollX;
     completed = false;
     currentLoop = 0;
 
@@ -35,11 +39,13 @@ void ScrollTextEffect::init() {
 
 void ScrollTextEffect::resetScroll() {
     scrollX = displayManager->getWidth();
+    prevScrollX = scrollX;
     currentLoop++;
     DEBUG_PRINTF("[ScrollTextEffect] Loop %d/%d\n", currentLoop, loopCount);
 }
 
 void ScrollTextEffect::update() {
+    prevScrollX = scrollX;
     scrollX -= scrollSpeed;
 
     // Controlla se il testo è completamente uscito dallo schermo
@@ -62,6 +68,10 @@ void ScrollTextEffect::update() {
 
 void ScrollTextEffect::draw() {
     if (!completed) {
+        // Frame bufferizzato: clear + testo arrivano al pannello come un
+        // unico flush delle sole righe cambiate (niente flicker)
+        displayManager->beginFrame();
+
         // Cancella schermo
         displayManager->fillScreen(0, 0, 0);
         
@@ -76,8 +86,11 @@ void ScrollTextEffect::draw() {
         int yPos = (height / 2) - (textHeight / 2);
         
         // Disegna testo
-        displayManager->setCursor(scrollX, yPos);
+        int x = (int)roundf(interpolate(prevScrollX, scrollX));
+        displayManager->setCursor(x, yPos);
         displayManager->print(text);
+
+        displayManager->endFrame();
     }
 }
 
@@ -7,6 +7,7 @@ class ScrollTextEffect : public Effect {
 private:
     String text;
     int scrollX;
+    int prevScrollX;         // scrollX al tick precedente (interpolazione)
     int scrollSpeed;
     int textWidth;
     int textHeight;
@@ -20,6 +20,10 @@ SnakeEffect::SnakeEffect(DisplayManager* dm)
       showGrid(true),
       playerJoined(false),
       foodType(FoodType::NORMAL) {
+    // Griglia dimensionata sul canvas
+    gridWidth = displayManager->getWidth() / GRID_SIZE;
+    gridHeight = displayManager->getHeight() / GRID_SIZE;
+
     // Pre-alloca spazio per snake (lunghezza massima ragionevole)
     snake.reserve(100);
 }
@@ -39,8 +43,8 @@ void SnakeEffect::resetGame() {
     snake.clear();
 
     // Posizione iniziale al centro
-    int startX = GRID_WIDTH / 2;
-    int startY = GRID_HEIGHT / 2;
+    int startX = gridWidth / 2;
+    int startY = gridHeight / 2;
 
     for (int i = 0; i < INITIAL_LENGTH; i++) {
         snake.push_back({startX - i, startY});
@@ -63,8 +67,8 @@ void SnakeEffect::resetGame() {
 void SnakeEffect::spawnFood() {
     int attempts = 0;
     do {
-        food.x = random(1, GRID_WIDTH - 1);  // Evita i bordi
-        food.y = random(1, GRID_HEIGHT - 1);
+        food.x = random(1, gridWidth - 1);  // Evita i bordi
+        food.y = random(1, gridHeight - 1);
         attempts++;
     } while (isPositionOnSnake(food.x, food.y) && attempts < 100);
 
@@ -194,8 +198,8 @@ bool SnakeEffect::checkCollision() {
     const SnakeSegment& head = snake[0];
 
     // Collisione con bordi
-    if (head.x < 0 || head.x >= GRID_WIDTH ||
-        head.y < 0 || head.y >= GRID_HEIGHT) {
+    if (head.x < 0 || head.x >= gridWidth ||
+        head.y < 0 || head.y >= gridHeight) {
         return true;
     }
 
@@ -262,7 +266,8 @@ void SnakeEffect::drawGame() {
 
     // Overlay pausa
     if (gameState == SnakeGameState::PAUSED) {
-        // Sfondo semi-trasparente (pattern scacchiera)
+        // Sfondo semi-trasparente (pattern scacchiera), centrato sul canvas
+        displayManager->centerViewport(SCENE_SIZE, SCENE_SIZE);
         for (int y = 20; y < 44; y++) {
             for (int x = 10; x < 54; x++) {
                 if ((x + y) % 2 == 0) {
@@ -276,6 +281,7 @@ void SnakeEffect::drawGame() {
         displayManager->setTextColor(0xFFFF);
         displayManager->setCursor(14, 28);
         displayManager->print("PAUSED");
+        displayManager->resetViewport();
     }
 }
 
@@ -418,20 +424,24 @@ void SnakeEffect::drawScore() {
     displayManager->print(String(score));
 
     // Level (in alto a destra)
-    for (int x = 50; x < 64; x++) {
+    int width = displayManager->getWidth();
+    for (int x = width - 14; x < width; x++) {
         for (int y = 0; y < 8; y++) {
             displayManager->drawPixel(x, y, 0, 0, 20);
         }
     }
     displayManager->setTextColor(0xFFE0);  // Giallo
-    displayManager->setCursor(51, 1);
+    displayManager->setCursor(width - 13, 1);
     displayManager->print("L" + String(level));
 }
 
 void SnakeEffect::drawGrid() {
     // Griglia molto sottile
-    for (int x = 0; x < 64; x += GRID_SIZE) {
-        for (int y = 8; y < 64; y++) {  // Inizia sotto score
+    int width = displayManager->getWidth();
+    int height = displayManager->getHeight();
+
+    for (int x = 0; x < width; x += GRID_SIZE) {
+        for (int y = 8; y < height; y++) {  // Inizia sotto score
             if (y % GRID_SIZE == 0 || x == 0) {
                 displayManager->drawPixel(x, y, 10, 10, 20);
             }
@@ -445,22 +455,28 @@ void SnakeEffect::drawBorder() {
     uint8_t g = 50;
     uint8_t b = max(150 - level * 10, 50);
 
+    int width = displayManager->getWidth();
+    int height = displayManager->getHeight();
+
     // Linee orizzontali (alto e basso)
-    for (int x = 0; x < 64; x++) {
-        displayManager->drawPixel(x, 8, r, g, b);   // Sotto score
-        displayManager->drawPixel(x, 63, r, g, b);  // Fondo
+    for (int x = 0; x < width; x++) {
+        displayManager->drawPixel(x, 8, r, g, b);           // Sotto score
+        displayManager->drawPixel(x, height - 1, r, g, b);  // Fondo
     }
 
     // Linee verticali (sinistra e destra)
-    for (int y = 8; y < 64; y++) {
+    for (int y = 8; y < height; y++) {
         displayManager->drawPixel(0, y, r, g, b);
-        displayManager->drawPixel(63, y, r, g, b);
+        displayManager->drawPixel(width - 1, y, r, g, b);
     }
 }
 
 void SnakeEffect::drawWaiting() {
     displayManager->fillScreen(0, 0, 0);
 
+    // Schermata testuale impaginata per 64x64: centrata sul canvas
+    displayManager->centerViewport(SCENE_SIZE, SCENE_SIZE);
+
     // Titolo "SNAKE" con animazione
     displayManager->setFont(nullptr);
     displayManager->setTextSize(1);
@@ -517,10 +533,13 @@ void SnakeEffect::drawWaiting() {
         displayManager->setCursor(4, 2);
         displayManager->print("HI:" + String(highScore));
     }
+
+    displayManager->resetViewport();
 }
 
 void SnakeEffect::drawGameOver() {
     displayManager->fillScreen(0, 0, 0);
+    displayManager->centerViewport(SCENE_SIZE, SCENE_SIZE);
 
     // "GAME OVER" lampeggiante
     displayManager->setFont(nullptr);
@@ -559,6 +578,8 @@ void SnakeEffect::drawGameOver() {
     if (animationFrame % 60 < 40) {
         displayManager->print("Press RESET");
     }
+
+    displayManager->resetViewport();
 }
 
 void SnakeEffect::getSnakeHeadColor(uint8_t& r, uint8_t& g, uint8_t& b) {
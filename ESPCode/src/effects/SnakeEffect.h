@@ -63,8 +63,8 @@ private:
 
     // Game constants
     static const int GRID_SIZE = 4;       // Ogni cella e' 4x4 pixel
-    static const int GRID_WIDTH = 16;     // 64/4 = 16 celle
-    static const int GRID_HEIGHT = 16;    // 64/4 = 16 celle
+    int gridWidth;                        // Celle dal canvas (16x16 su 64x64)
+    int gridHeight;
     static const int INITIAL_LENGTH = 3;
     static const int BASE_MOVE_INTERVAL = 200;  // ms
     static const int MIN_MOVE_INTERVAL = 80;    // Velocita' massima
@@ -205,7 +205,7 @@ void SpaceInvadersClockEffect::startShooting(int digitIndex) {
 
     // Clamp to screen
     if (shipTargetX < 0) shipTargetX = 0;
-    if (shipTargetX > 64 - SHIP_WIDTH) shipTargetX = 64 - SHIP_WIDTH;
+    if (shipTargetX > SCENE_SIZE - SHIP_WIDTH) shipTargetX = SCENE_SIZE - SHIP_WIDTH;
 
     shipMovingRight = (shipTargetX > shipX);
     shipState = SHIP_MOVING;
@@ -251,7 +251,7 @@ void SpaceInvadersClockEffect::updateGame() {
     if (nearestAlien >= 0 && !bullet.active) {
         int targetX = aliens[nearestAlien].x + ALIEN_WIDTH / 2 - SHIP_WIDTH / 2;
         if (targetX < 0) targetX = 0;
-        if (targetX > 64 - SHIP_WIDTH) targetX = 64 - SHIP_WIDTH;
+        if (targetX > SCENE_SIZE - SHIP_WIDTH) targetX = SCENE_SIZE - SHIP_WIDTH;
 
         if (abs(shipX - targetX) > 2) {
             shipDirection = (targetX > shipX) ? 1 : -1;
@@ -310,7 +310,7 @@ void SpaceInvadersClockEffect::updateShip() {
             if (shipDirection != 0) {
                 shipX += shipDirection * 2;
                 if (shipX < 0) shipX = 0;
-                if (shipX > 64 - SHIP_WIDTH) shipX = 64 - SHIP_WIDTH;
+                if (shipX > SCENE_SIZE - SHIP_WIDTH) shipX = SCENE_SIZE - SHIP_WIDTH;
                 needsRedraw = true;
             }
             break;
@@ -443,7 +443,7 @@ void SpaceInvadersClockEffect::updateAliens() {
     lastAlienUpdate = now;
 
     // Find edges
-    int leftMost = 64, rightMost = 0;
+    int leftMost = SCENE_SIZE, rightMost = 0;
     for (int i = 0; i < MAX_ALIENS; i++) {
         if (aliens[i].alive) {
             if (aliens[i].x < leftMost) leftMost = aliens[i].x;
@@ -556,7 +556,7 @@ void SpaceInvadersClockEffect::drawShip() {
             if (rowData & (1 << (10 - col))) {
                 int px = shipX + col;
                 int py = shipY + row;
-                if (px >= 0 && px < 64 && py >= 0 && py < 64) {
+                if (px >= 0 && px < SCENE_SIZE && py >= 0 && py < SCENE_SIZE) {
                     displayManager->drawPixel(px, py, SHIP_COLOR_R, SHIP_COLOR_G, SHIP_COLOR_B);
                 }
             }
@@ -572,7 +572,7 @@ void SpaceInvadersClockEffect::drawBullet() {
         for (int dx = 0; dx < 2; dx++) {
             int px = bullet.x + dx - 1;
             int py = bullet.y + dy;
-            if (px >= 0 && px < 64 && py >= 0 && py < 64) {
+            if (px >= 0 && px < SCENE_SIZE && py >= 0 && py < SCENE_SIZE) {
                 displayManager->drawPixel(px, py, BULLET_COLOR_R, BULLET_COLOR_G, BULLET_COLOR_B);
             }
         }
@@ -645,7 +645,7 @@ void SpaceInvadersClockEffect::drawAlien(int x, int y, int type, bool frame) {
             if (sprite[row] & (1 << (7 - col))) {
                 int px = x + col;
                 int py = y + row;
-                if (px >= 0 && px < 64 && py >= 0 && py < 64) {
+                if (px >= 0 && px < SCENE_SIZE && py >= 0 && py < SCENE_SIZE) {
                     displayManager->drawPixel(px, py, r, g, b);
                 }
             }
@@ -670,7 +670,7 @@ void SpaceInvadersClockEffect::drawAlienExplosions() {
                 int px = cx + (int)(cos(a) * radius);
                 int py = cy + (int)(sin(a) * radius);
 
-                if (px >= 0 && px < 64 && py >= 0 && py < 64) {
+                if (px >= 0 && px < SCENE_SIZE && py >= 0 && py < SCENE_SIZE) {
                     displayManager->drawPixel(px, py, brightness, brightness / 2, 0);
                 }
             }
@@ -701,7 +701,7 @@ void SpaceInvadersClockEffect::drawDigit(int digit, int x, int y, uint8_t r, uin
                     for (int sx = 0; sx < scale; sx++) {
                         int px = x + col * scale + sx;
                         int py = y + row * scale + sy;
-                        if (px >= 0 && px < 64 && py >= 0 && py < 64) {
+                        if (px >= 0 && px < SCENE_SIZE && py >= 0 && py < SCENE_SIZE) {
                             displayManager->drawPixel(px, py, r, g, b);
                         }
                     }
@@ -754,7 +754,7 @@ void SpaceInvadersClockEffect::drawExplosion(int digitIndex) {
             for (int dx = -1; dx <= 1; dx++) {
                 int ppx = px + dx;
                 int ppy = py + dy;
-                if (ppx >= 0 && ppx < 64 && ppy >= 0 && ppy < 64) {
+                if (ppx >= 0 && ppx < SCENE_SIZE && ppy >= 0 && ppy < SCENE_SIZE) {
                     displayManager->drawPixel(ppx, ppy, r, g, b);
                 }
             }
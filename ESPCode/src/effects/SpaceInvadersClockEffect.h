@@ -156,6 +156,8 @@ public:
     void draw() override;
     void cleanup() override;
     const char* getName() override { return "Space Invaders"; }
+    bool isFixedScene() const override { return true; }  // Scena a sprite 64x64
+    PixelFormat getPixelFormat() const override { return PIXEL_INDEXED8; }  // Pochi colori
     void reset() override;
 };
 
@@ -0,0 +1,309 @@
+#include "StreamEffect.h"
+#include "../Debug.h"
+
+static inline uint16_t read16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+StreamEffect::StreamEffect(DisplayManager* dm)
+    : Effect(dm)
+    , _slots(nullptr)
+    , _pixels(0)
+    , _width(0)
+    , _height(0)
+    , _open(false)
+    , _rxBusy(false)
+    , _owner(STREAM_OWNER_ANY)
+    , _jitterUs(STREAM_JITTER_MS_DEFAULT * 1000UL)
+    , _lastFrameMs(0)
+    , _mux(portMUX_INITIALIZER_UNLOCKED)
+    , _assembling(-1)
+    , _lastPublished(-1)
+    , _showing(-1)
+    , _queueHead(0)
+    , _queued(0)
+    , _rxValid(false)
+    , _rxFrameOpen(false)
+    , _rxFlags(0)
+    , _rxSeq(0)
+    , _rxX(0), _rxY(0), _rxW(0), _rxH(0)
+    , _lastSeq(0)
+    , _haveSeq(false)
+{
+    resetStats();
+}
+
+StreamEffect::~StreamEffect() {
+    close();
+}
+
+void StreamEffect::init() {
+    displayManager->fillScreen(0, 0, 0);
+}
+
+void StreamEffect::update() {
+    // Tutto in draw(): il frame da mostrare dipende solo dal jitter buffer
+}
+
+// ═══════════════════════════════════════════
+// Riproduzione (task di render)
+// ═══════════════════════════════════════════
+
+void StreamEffect::draw() {
+    if (!_open || _queued == 0) return;
+
+    uint32_t now = micros();
+    int8_t pick = -1;
+
+    portENTER_CRITICAL(&_mux);
+    while (_queued > 0) {
+        int8_t index = _queue[_queueHead];
+        if (now - _slotUs[index] < _jitterUs) break;
+        // Più frame scaduti nello stesso giro: si mostra solo l'ultimo
+        if (pick >= 0) _dropped++;
+        pick = index;
+        _queueHead = (_queueHead + 1) % STREAM_QUEUE_DEPTH;
+        _queued--;
+    }
+    _showing = pick;
+    portEXIT_CRITICAL(&_mux);
+
+    if (pick < 0) return;
+
+    displayManager->blitRect(0, 0, _width, _height, slot(pick), _width);
+
+    uint32_t latency = micros() - _slotUs[pick];
+    _latencyTotalUs += latency;
+    if (latency > _latencyMaxUs) _latencyMaxUs = latency;
+    _shown++;
+
+    portENTER_CRITICAL(&_mux);
+    _showing = -1;
+    portEXIT_CRITICAL(&_mux);
+}
+
+// ═══════════════════════════════════════════
+// Sessione
+// ═══════════════════════════════════════════
+
+bool StreamEffect::open(uint32_t owner) {
+    if (_open) {
+        portENTER_CRITICAL(&_mux);
+        _owner = owner;
+        portEXIT_CRITICAL(&_mux);
+        return true;
+    }
+
+    _width = displayManager->getCanvasWidth();
+    _height = displayManager->getCanvasHeight();
+    _pixels = (size_t)_width * _height;
+    _slots = (uint16_t*)malloc(STREAM_SLOTS * _pixels * sizeof(uint16_t));
+    if (!_slots) {
+        DEBUG_PRINTLN(F("[Stream] Failed to allocate frame slots!"));
+        return false;
+    }
+    memset(_slots, 0, STREAM_SLOTS * _pixels * sizeof(uint16_t));
+
+    _assembling = 0;
+    _lastPublished = -1;
+    _showing = -1;
+    _queueHead = 0;
+    _queued = 0;
+    _rxValid = false;
+    _rxFrameOpen = false;
+    _haveSeq = false;
+    _lastFrameMs = millis();
+    resetStats();
+
+    portENTER_CRITICAL(&_mux);
+    _owner = owner;
+    _open = true;
+    portEXIT_CRITICAL(&_mux);
+
+    DEBUG_PRINTF("[Stream] Open %ux%u, %u slots (%u bytes), jitter %u ms\n",
+                 _width, _height, STREAM_SLOTS,
+                 (unsigned)(STREAM_SLOTS * _pixels * sizeof(uint16_t)), getJitterMs());
+    return true;
+}
+
+void StreamEffect::close() {
+    if (!_slots) return;
+
+    portENTER_CRITICAL(&_mux);
+    _open = false;
+    portEXIT_CRITICAL(&_mux);
+
+    // Un chunk già in scrittura finisce prima di liberare gli slot
+    while (_rxBusy) {
+        vTaskDelay(1);
+    }
+
+    free(_slots);
+    _slots = nullptr;
+    _queued = 0;
+    DEBUG_PRINTF("[Stream] Closed: %u received, %u shown, %u dropped, %u lost\n",
+                 _received, _shown, _dropped, _lost);
+}
+
+bool StreamEffect::isIdle() const {
+    return _open && millis() - _lastFrameMs > STREAM_IDLE_TIMEOUT_MS;
+}
+
+void StreamEffect::resetStats() {
+    _received = 0;
+    _shown = 0;
+    _dropped = 0;
+    _lost = 0;
+    _errors = 0;
+    _latencyTotalUs = 0;
+    _latencyMaxUs = 0;
+}
+
+// ═══════════════════════════════════════════
+// Ricezione (task AsyncTCP)
+// ═══════════════════════════════════════════
+
+void StreamEffect::receive(uint32_t clientId, const uint8_t* data, size_t len, size_t index, size_t total) {
+    portENTER_CRITICAL(&_mux);
+    // Sessione aperta da seriale: la prende il primo client
+    if (_open && _owner == STREAM_OWNER_ANY && index == 0) _owner = clientId;
+    bool owned = _open && clientId == _owner;
+    if (owned) _rxBusy = true;
+    portEXIT_CRITICAL(&_mux);
+    if (!owned) return;
+
+    bool last = index + len == total;
+    size_t offset;
+
+    if (index == 0) {
+        // L'header arriva sempre nel primo chunk (segmento TCP ≥ 12 byte)
+        _rxValid = len >= STREAM_HEADER && beginMessage(data, total);
+        if (!_rxValid) _errors++;
+        data += STREAM_HEADER;
+        len = len >= STREAM_HEADER ? len - STREAM_HEADER : 0;
+        offset = 0;
+    } else {
+        offset = index - STREAM_HEADER;
+    }
+
+    if (_rxValid && len > 0 && !writePayload(offset, data, len)) {
+        _rxValid = false;
+        _errors++;
+    }
+
+    if (last && _rxValid && (_rxFlags & STREAM_FLAG_END)) {
+        publish();
+        _rxFrameOpen = false;
+    }
+
+    _rxBusy = false;
+}
+
+bool StreamEffect::beginMessage(const uint8_t* header, size_t total) {
+    uint8_t flags = header[1];
+    uint16_t seq = read16(header + 2);
+    uint16_t x = read16(header + 4);
+    uint16_t y = read16(header + 6);
+    uint16_t w = read16(header + 8);
+    uint16_t h = read16(header + 10);
+
+    if (header[0] != STREAM_MSG_FRAME || w == 0 || h == 0 ||
+        (uint32_t)x + w > _width || (uint32_t)y + h > _height ||
+        total != STREAM_HEADER + (size_t)w * h * sizeof(uint16_t)) {
+        return false;
+    }
+
+    // Nuovo frame: si parte dal frame precedente (aggiornamenti parziali)
+    if (!_rxFrameOpen || seq != _rxSeq) {
+        if (_rxFrameOpen) _dropped++;       // Frame precedente senza STREAM_FLAG_END
+        bool full = w == _width && h == _height;
+        if (!full) {
+            if (_lastPublished >= 0) {
+                memcpy(slot(_assembling), slot(_lastPublished), _pixels * sizeof(uint16_t));
+            } else {
+                memset(slot(_assembling), 0, _pixels * sizeof(uint16_t));
+            }
+        }
+        _rxFrameOpen = true;
+        _rxSeq = seq;
+    }
+
+    _rxFlags = flags;
+    _rxX = x;
+    _rxY = y;
+    _rxW = w;
+    _rxH = h;
+    return true;
+}
+
+// Byte [offset, offset+len) del rettangolo: una memcpy per tratto di riga
+// (i chunk TCP possono tagliare un pixel a metà). false = fuori dal
+// rettangolo dell'header, nulla viene scritto
+bool StreamEffect::writePayload(size_t offset, const uint8_t* src, size_t len) {
+    uint8_t* dst = (uint8_t*)slot(_assembling);
+    size_t rowBytes = (size_t)_rxW * sizeof(uint16_t);
+    if (offset + len > rowBytes * _rxH) {
+        return false;
+    }
+
+    while (len > 0) {
+        size_t row = offset / rowBytes;
+        size_t col = offset % rowBytes;
+        size_t n = rowBytes - col;
+        if (n > len) n = len;
+
+        size_t pos = ((size_t)(_rxY + row) * _width + _rxX) * sizeof(uint16_t) + col;
+        memcpy(dst + pos, src, n);
+
+        src += n;
+        offset += n;
+        len -= n;
+    }
+    return true;
+}
+
+void StreamEffect::publish() {
+    // Buchi di sequenza = frame persi in rete; seq all'indietro = duplicato/vecchio
+    if (_haveSeq) {
+        uint16_t gap = _rxSeq - (uint16_t)(_lastSeq + 1);
+        if (gap >= 0x8000) {
+            _dropped++;
+            return;
+        }
+        _lost += gap;
+    }
+    _lastSeq = _rxSeq;
+    _haveSeq = true;
+    _lastFrameMs = millis();
+
+    portENTER_CRITICAL(&_mux);
+    _slotUs[_assembling] = micros();
+    if (_queued == STREAM_QUEUE_DEPTH) {
+        _queueHead = (_queueHead + 1) % STREAM_QUEUE_DEPTH;
+        _queued--;
+        _dropped++;
+    }
+    _queue[(_queueHead + _queued) % STREAM_QUEUE_DEPTH] = _assembling;
+    _queued++;
+    _lastPublished = _assembling;
+    _assembling = findFreeSlot();
+    portEXIT_CRITICAL(&_mux);
+
+    _received++;
+}
+
+// Con STREAM_SLOTS = coda + 2 c'è sempre uno slot libero
+int8_t StreamEffect::findFreeSlot() const {
+    for (int8_t s = 0; s < STREAM_SLOTS; s++) {
+        if (s == _showing) continue;
+        bool queued = false;
+        for (uint8_t i = 0; i < _queued; i++) {
+            if (_queue[(_queueHead + i) % STREAM_QUEUE_DEPTH] == s) {
+                queued = true;
+                break;
+            }
+        }
+        if (!queued) return s;
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+#ifndef STREAM_EFFECT_H
+#define STREAM_EFFECT_H
+
+#include "../Effect.h"
+
+// ═══════════════════════════════════════════
+// Stream Configuration
+// ═══════════════════════════════════════════
+// Slot a frame intero: 1 in scrittura + 1 a schermo + coda (jitter buffer)
+#ifndef STREAM_SLOTS
+#define STREAM_SLOTS 4
+#endif
+#define STREAM_QUEUE_DEPTH (STREAM_SLOTS - 2)
+
+#define STREAM_JITTER_MS_DEFAULT 35     // ~1 frame a 30 fps
+#define STREAM_JITTER_MS_MAX 500
+#define STREAM_IDLE_TIMEOUT_MS 10000    // Nessun frame: lo stream si chiude
+
+// Messaggio binario WebSocket (App → ESP32), little endian:
+//   [0] tipo 0x10  [1] flag (bit 0 = ultimo rettangolo del frame)
+//   [2-3] seq  [4-5] x  [6-7] y  [8-9] w  [10-11] h
+//   w*h pixel RGB565
+#define STREAM_MSG_FRAME 0x10
+#define STREAM_FLAG_END 0x01
+#define STREAM_HEADER 12
+#define STREAM_OWNER_ANY 0              // Sessione aperta da seriale: il primo client valido
+
+/**
+ * StreamEffect - Display di rete: frame RGB565 interi o parziali inviati
+ * dall'app come messaggi binari WebSocket.
+ *
+ * Ogni frame (uno o più rettangoli con lo stesso seq, l'ultimo con
+ * STREAM_FLAG_END) viene composto in uno slot a frame intero sopra il
+ * frame precedente, poi accodato. Il task di render lo mostra dopo il
+ * ritardo di jitter; a coda piena si scarta il frame più vecchio (gli slot
+ * sono frame completi, non si perde nulla a schermo).
+ *
+ * receive() gira sul task AsyncTCP, draw() sul task di render: indici
+ * degli slot sotto spinlock, le copie dei pixel fuori. La sessione
+ * appartiene al client che ha fatto stream,start: AsyncTCP alterna i
+ * chunk di connessioni diverse e lo stato di ricezione è uno solo, i
+ * messaggi degli altri client vengono scartati.
+ */
+class StreamEffect : public Effect {
+public:
+    StreamEffect(DisplayManager* dm);
+    ~StreamEffect();
+
+    void init() override;
+    void update() override;
+    void draw() override;
+    const char* getName() override { return "Stream"; }
+    bool isComplete() override { return !_open; }
+    bool isAutoSwitchable() const override { return false; }
+
+    // Sessione (task di render): alloca/libera gli slot; owner = client
+    // WebSocket che può inviare frame (una riapertura passa la sessione)
+    bool open(uint32_t owner = STREAM_OWNER_ANY);
+    void close();
+    bool isOpen() const { return _open; }
+    bool isIdle() const;
+
+    // Chunk di un messaggio binario del client clientId (task AsyncTCP);
+    // index/total sul messaggio
+    void receive(uint32_t clientId, const uint8_t* data, size_t len, size_t index, size_t total);
+
+    void setJitterMs(uint16_t ms) { _jitterUs = (uint32_t)(ms > STREAM_JITTER_MS_MAX ? STREAM_JITTER_MS_MAX : ms) * 1000; }
+    uint16_t getJitterMs() const { return _jitterUs / 1000; }
+
+    // Statistiche
+    uint32_t getReceived() const { return _received; }
+    uint32_t getShown() const { return _shown; }
+    uint32_t getDropped() const { return _dropped; }
+    uint32_t getLost() const { return _lost; }
+    uint32_t getErrors() const { return _errors; }
+    uint32_t getAvgLatencyUs() const { return _shown ? (uint32_t)(_latencyTotalUs / _shown) : 0; }
+    uint32_t getMaxLatencyUs() const { return _latencyMaxUs; }
+    uint8_t getQueued() const { return _queued; }
+    void resetStats();
+
+private:
+    uint16_t* _slots;
+    size_t _pixels;
+    uint16_t _width;
+    uint16_t _height;
+    volatile bool _open;
+    volatile bool _rxBusy;
+    uint32_t _owner;                // Sotto _mux
+    uint32_t _jitterUs;
+    uint32_t _lastFrameMs;
+
+    // Slot (indici protetti da _mux)
+    portMUX_TYPE _mux;
+    int8_t _assembling;
+    int8_t _lastPublished;
+    int8_t _showing;
+    int8_t _queue[STREAM_QUEUE_DEPTH];
+    uint8_t _queueHead;
+    volatile uint8_t _queued;
+    uint32_t _slotUs[STREAM_SLOTS];
+
+    // Ricezione (solo task AsyncTCP)
+    bool _rxValid;
+    bool _rxFrameOpen;
+    uint8_t _rxFlags;
+    uint16_t _rxSeq;
+    uint16_t _rxX, _rxY, _rxW, _rxH;
+    uint16_t _lastSeq;
+    bool _haveSeq;
+
+    // Statistiche
+    uint32_t _received;
+    uint32_t _shown;
+    uint32_t _dropped;
+    uint32_t _lost;
+    uint32_t _errors;
+    uint64_t _latencyTotalUs;
+    uint32_t _latencyMaxUs;
+
+    uint16_t* slot(int8_t index) { return _slots + (size_t)index * _pixels; }
+    bool beginMessage(const uint8_t* header, size_t total);
+    bool writePayload(size_t offset, const uint8_t* src, size_t len);
+    void publish();
+    int8_t findFreeSlot() const;
+};
+
+#endif // STREAM_EFFECT_H
@@ -15,8 +15,12 @@
 #include "WebSocketManager.h"
 #include "CommandHandler.h"
 #include "Discovery.h"
+#include "RealtimeReceiver.h"
 #include "ImageManager.h"
+#include "ImageUploader.h"
 #include "TextScheduleManager.h"
+#include "RenderTask.h"
+#include "FrameMirror.h"
 
 // Effects
 #include "effects/PongEffect.h"
@@ -31,6 +35,9 @@
 #include "effects/ImageEffect.h"
 #include "effects/DynamicImageEffect.h"
 #include "effects/SpaceInvadersClockEffect.h"
+#include "effects/StreamEffect.h"
+#include "effects/RealtimeEffect.h"
+#include "effects/AnimationEffect.h"
 
 
 // ═══════════════════════════════════════════
@@ -38,9 +45,21 @@
 // ═══════════════════════════════════════════
 #define PANEL_WIDTH 64
 #define PANEL_HEIGHT 64
-#define PANELS_NUMBER 1
 #define PIN_E 32
 
+// Pannelli concatenati (sovrascrivibili da build_flags in platformio.ini):
+// es. 128x64 = -DPANELS_NUMBER=2, 128x128 = -DPANELS_NUMBER=4 -DPANEL_ROWS=2
+// -DPANEL_LAYOUT=CHAIN_SERPENTINE
+#ifndef PANELS_NUMBER
+#define PANELS_NUMBER 1
+#endif
+#ifndef PANEL_ROWS
+#define PANEL_ROWS 1
+#endif
+#ifndef PANEL_LAYOUT
+#define PANEL_LAYOUT CHAIN_HORIZONTAL
+#endif
+
 // ═══════════════════════════════════════════
 // Global Objects
 // ═══════════════════════════════════════════
@@ -59,6 +78,13 @@ DynamicImageEffect* dynamicImageEffect = nullptr;
 ScrollTextEffect* scrollTextEffect = nullptr;
 PongEffect* pongEffect = nullptr;
 SnakeEffect* snakeEffect = nullptr;
+StreamEffect* streamEffect = nullptr;
+RealtimeEffect* realtimeEffect = nullptr;
+AnimationEffect* animationEffect = nullptr;
+RealtimeReceiver realtimeReceiver;
+ImageUploader imageUploader;
+RenderTask renderTask;
+FrameMirror frameMirror;
 
 // ═══════════════════════════════════════════
 // Timers
@@ -81,6 +107,8 @@ int previousEffectIndex = -1;  // Indice dell'effetto prima della scritta progra
 // ═══════════════════════════════════════════
 String serialBuffer = "";
 
+void renderFrame();
+
 // ═══════════════════════════════════════════
 // Setup
 // ═══════════════════════════════════════════
@@ -111,7 +139,8 @@ void setup() {
     // 2. Display
     // ─────────────────────────────────────────
     DEBUG_PRINTLN(F("[Setup] Initializing display..."));
-    displayManager = new DisplayManager(PANEL_WIDTH, PANEL_HEIGHT, PANELS_NUMBER, PIN_E);
+    displayManager = new DisplayManager(PANEL_WIDTH, PANEL_HEIGHT, PANELS_NUMBER, PIN_E,
+                                        settings.isDoubleBuffer(), PANEL_ROWS, PANEL_LAYOUT);
     
     if (!displayManager->begin()) {
         DEBUG_PRINTLN(F("FATAL: Display initialization failed!"));
@@ -119,6 +148,9 @@ void setup() {
     }
     
     displayManager->setBrightness(settings.getBrightnessDay());
+    displayManager->setColorCorrection(settings.getGamma(), settings.getWhiteR(),
+                                       settings.getWhiteG(), settings.getWhiteB());
+    frameMirror.begin(displayManager->getCanvasWidth(), displayManager->getCanvasHeight());
     displayManager->fillScreen(0, 0, 0);
     DEBUG_PRINTLN(F("[Setup] ✓ Display OK"));
     
@@ -156,6 +188,9 @@ void setup() {
     
     // Applica impostazioni salvate
     effectManager->setAutoSwitch(settings.isAutoSwitch());
+    effectManager->setTransition(settings.getTransitionType() <= TRANSITION_WIPE
+                                     ? (TransitionType)settings.getTransitionType() : TRANSITION_FADE,
+                                 settings.getTransitionMs());
 
     if (!settings.isAutoSwitch()) {
         DEBUG_PRINTLN(F("[Setup] Setting current effect from settings..."));
@@ -188,8 +223,18 @@ void setup() {
         dynamicImageEffect = new DynamicImageEffect(displayManager, imageManager, 5000); // 5 sec per immagine
         effectManager->addEffect(dynamicImageEffect);
         DEBUG_PRINTLN(F("[Setup] ✓ DynamicImageEffect added"));
+
+        imageUploader.setImageManager(imageManager);
     }
 
+    // Stream in coda alla lista: gli indici salvati degli altri effetti non cambiano
+    streamEffect = new StreamEffect(displayManager);
+    effectManager->addEffect(streamEffect);
+    realtimeEffect = new RealtimeEffect(displayManager, &realtimeReceiver);
+    effectManager->addEffect(realtimeEffect);
+    animationEffect = new AnimationEffect(displayManager, imageManager);
+    effectManager->addEffect(animationEffect);
+
     // ─────────────────────────────────────────
     // 7. Text Schedule Manager
     // ─────────────────────────────────────────
@@ -205,13 +250,19 @@ void setup() {
     commandHandler.setScrollTextEffect(scrollTextEffect);
     commandHandler.setPongEffect(pongEffect);
     commandHandler.setSnakeEffect(snakeEffect);
+    commandHandler.setStreamEffect(streamEffect);
+    commandHandler.setRealtime(&realtimeReceiver, realtimeEffect);
+    commandHandler.setAnimationEffect(animationEffect);
+    commandHandler.setDynamicImageEffect(dynamicImageEffect);
+    commandHandler.setImageUploader(&imageUploader);
     
     // ─────────────────────────────────────────
     // 8. Web Server
     // ─────────────────────────────────────────
     DEBUG_PRINTLN(F("[Setup] Initializing WebServer..."));
     webServer = new WebServerManager(80);
-    webServer->init(&commandHandler);
+    webServer->init(&commandHandler, &frameMirror);
+    webServer->setImageUploader(&imageUploader);
     DEBUG_PRINTLN(F("[Setup] ✓ WebServer OK"));
 
     // ─────────────────────────────────────────
@@ -221,6 +272,18 @@ void setup() {
     wsManager = new WebSocketManager();
     wsManager->init(webServer->getServer(), &commandHandler);
     commandHandler.setWebSocketManager(wsManager);
+    wsManager->setFrameMirror(&frameMirror);
+    wsManager->onBinary(STREAM_MSG_FRAME, [](uint32_t clientId, const uint8_t* data, size_t len,
+                                             size_t index, size_t total) {
+        streamEffect->receive(clientId, data, len, index, total);
+    });
+    wsManager->onBinary(UPLOAD_MSG_CHUNK, [](uint32_t clientId, const uint8_t* data, size_t len,
+                                             size_t index, size_t total) {
+        String response = imageUploader.receive(clientId, data, len, index, total);
+        if (response.length() > 0) {
+            wsManager->sendToClient(clientId, response);
+        }
+    });
     DEBUG_PRINTLN(F("[Setup] ✓ WebSocket OK"));
 
     // ─────────────────────────────────────────
@@ -269,6 +332,19 @@ void setup() {
     discoveryService->begin();
     DEBUG_PRINTLN(F("[Setup] ✓ Discovery Service OK"));
 
+    // ─────────────────────────────────────────
+    // 12. Realtime UDP (DDP / E1.31 / Art-Net)
+    // ─────────────────────────────────────────
+    realtimeReceiver.setUniverseMap(settings.getRealtimeUniverse(),
+                                    settings.getRealtimeUniversePixels());
+    if (settings.isRealtimeEnabled()) {
+        DEBUG_PRINTLN(F("[Setup] Starting Realtime receiver..."));
+        if (realtimeReceiver.begin(displayManager->getCanvasWidth(),
+                                   displayManager->getCanvasHeight())) {
+            DEBUG_PRINTLN(F("[Setup] ✓ Realtime receiver OK"));
+        }
+    }
+
 
     // ─────────────────────────────────────────
     // Setup complete
@@ -298,21 +374,48 @@ void setup() {
     
     // Start effects
     effectManager->start();
+
+    // ─────────────────────────────────────────
+    // 12. Render Task
+    // ─────────────────────────────────────────
+    // Da qui in poi effetti, tempo e comandi girano sul task di render;
+    // loop() resta per WiFi, discovery, cleanup WS e lettura seriale
+    commandHandler.setRenderTask(&renderTask);
+    if (!renderTask.begin(renderFrame)) {
+        DEBUG_PRINTLN(F("[Setup] ⚠ Render task failed, rendering from loop()"));
+    } else {
+        effectManager->setFramePeriod(renderTask.getFrameMs());
+    }
 }
 
 // ═══════════════════════════════════════════
-// Loop
+// Render Frame (task di render, core RENDER_TASK_CORE)
 // ═══════════════════════════════════════════
-void loop() {
+void renderFrame() {
     unsigned long now = millis();
 
+    // ─────────────────────────────────────────
+    // Comandi accodati da WebSocket/HTTP/seriale
+    // ─────────────────────────────────────────
+    commandHandler.processQueuedCommands();
+
     // ─────────────────────────────────────────
     // OTA Watchdog (controlla timeout durante OTA)
     // ─────────────────────────────────────────
     commandHandler.checkOTAWatchdog();
 
     // ─────────────────────────────────────────
-    // Time Manager update
+    // Stream: chiusura automatica senza frame
+    // ─────────────────────────────────────────
+    commandHandler.checkStreamIdle();
+
+    // ─────────────────────────────────────────
+    // Realtime UDP: sorgente attiva → effetto Realtime
+    // ─────────────────────────────────────────
+    commandHandler.checkRealtime();
+
+    // ─────────────────────────────────────────
+    // Time Manager update (i callback cambiano effetto)
     // ─────────────────────────────────────────
     timeManager->update();
 
@@ -321,6 +424,11 @@ void loop() {
     // ─────────────────────────────────────────
     effectManager->update();
 
+    // ─────────────────────────────────────────
+    // Frame Mirror: copia per /api/frame e anteprima WS (solo se richiesta)
+    // ─────────────────────────────────────────
+    frameMirror.capture(displayManager);
+
     // ─────────────────────────────────────────
     // Scheduled Text: ritorna all'effetto precedente
     // ─────────────────────────────────────────
@@ -331,6 +439,41 @@ void loop() {
         previousEffectIndex = -1;  // Reset
     }
 
+    // ─────────────────────────────────────────
+    // Brightness check (ogni minuto)
+    // ─────────────────────────────────────────
+    if (now - brightnessTimer >= BRIGHTNESS_INTERVAL) {
+        commandHandler.updateBrightness();
+        brightnessTimer = now;
+    }
+
+    // ─────────────────────────────────────────
+    // Stats (ogni 30 secondi)
+    // ─────────────────────────────────────────
+    if (now - statsTimer >= STATS_INTERVAL) {
+        effectManager->printStats();
+        renderTask.printStats();
+        renderTask.resetStats();
+        DEBUG_PRINTF("[Stats] Heap: %u bytes | WS Clients: %u\n", 
+                     ESP.getFreeHeap(), 
+                     wsManager->getClientsConnected());
+        statsTimer = now;
+    }
+}
+
+// ═══════════════════════════════════════════
+// Loop
+// ═══════════════════════════════════════════
+void loop() {
+    unsigned long now = millis();
+
+    // ─────────────────────────────────────────
+    // Fallback: senza task di render il frame gira qui
+    // ─────────────────────────────────────────
+    if (!renderTask.isRunning()) {
+        renderFrame();
+    }
+
     // ─────────────────────────────────────────
     // WiFi check
     // ─────────────────────────────────────────
@@ -340,6 +483,11 @@ void loop() {
     // Discovery Service update
     // ─────────────────────────────────────────
     discoveryService->update();
+
+    // ─────────────────────────────────────────
+    // Realtime UDP (DDP / E1.31 / Art-Net)
+    // ─────────────────────────────────────────
+    realtimeReceiver.update();
     
     // ─────────────────────────────────────────
     // WebSocket cleanup
@@ -348,35 +496,26 @@ void loop() {
         wsManager->cleanupClients();
         wsCleanupTimer = now;
     }
-    
+
     // ─────────────────────────────────────────
-    // Brightness check (ogni minuto)
+    // Risposte WebSocket dagli altri task (render, seriale)
     // ─────────────────────────────────────────
-    if (now - brightnessTimer >= BRIGHTNESS_INTERVAL) {
-        commandHandler.updateBrightness();
-        brightnessTimer = now;
-    }
-    
+    wsManager->flush();
+
     // ─────────────────────────────────────────
-    // Stats (ogni 30 secondi)
+    // Anteprima WebSocket (codifica delta fuori dal task di render)
     // ─────────────────────────────────────────
-    if (now - statsTimer >= STATS_INTERVAL) {
-        effectManager->printStats();
-        DEBUG_PRINTF("[Stats] Heap: %u bytes | WS Clients: %u\n", 
-                     ESP.getFreeHeap(), 
-                     wsManager->getClientsConnected());
-        statsTimer = now;
-    }
+    wsManager->streamPreview();
     
     // ─────────────────────────────────────────
-    // Serial command processing
+    // Serial command processing (eseguiti dal task di render)
     // ─────────────────────────────────────────
     while (Serial.available()) {
         char c = Serial.read();
         
         if (c == '\n' || c == '\r') {
             if (serialBuffer.length() > 0) {
-                commandHandler.processSerial(serialBuffer);
+                commandHandler.enqueueSerial(serialBuffer);
                 serialBuffer = "";
             }
         } else {
@@ -388,4 +527,4 @@ void loop() {
     // Small delay
     // ─────────────────────────────────────────
     delay(10);
-}
\ No newline at end of file
+}
@@ -0,0 +1,173 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// ═══════════════════════════════════════════
+// Arduino minimo per i test sul PC (env native)
+// Solo quello che usano i moduli compilati in platformio.ini [env:native]:
+// String, Serial, tempo, heap e i tipi FreeRTOS delle loro dichiarazioni
+// ═══════════════════════════════════════════
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+#define F(s) (s)
+#define PROGMEM
+
+// ─────────────────────────────────────────
+// String (sottoinsieme di WString su std::string)
+// ─────────────────────────────────────────
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v) : _s(std::to_string(v)) {}
+    String(unsigned int v) : _s(std::to_string(v)) {}
+    String(long v) : _s(std::to_string(v)) {}
+    String(unsigned long v) : _s(std::to_string(v)) {}
+    String(float v, unsigned char decimals = 2) { format(v, decimals); }
+    String(double v, unsigned char decimals = 2) { format(v, decimals); }
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    void reserve(unsigned int n) { _s.reserve(n); }
+
+    char charAt(unsigned int i) const { return i < _s.size() ? _s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    char& operator[](unsigned int i) { return _s[i]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return find(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return find(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return find(_s.rfind(c)); }
+
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) std::swap(from, to);
+        if (from >= _s.size()) return String();
+        return String(_s.substr(from, to - from));
+    }
+
+    bool startsWith(const String& p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+    bool endsWith(const String& p) const {
+        return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+    }
+    bool equals(const String& o) const { return _s == o._s; }
+    bool equalsIgnoreCase(const String& o) const {
+        if (_s.size() != o._s.size()) return false;
+        for (size_t i = 0; i < _s.size(); i++) {
+            if (tolower((unsigned char)_s[i]) != tolower((unsigned char)o._s[i])) return false;
+        }
+        return true;
+    }
+
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return atof(_s.c_str()); }
+
+    void toLowerCase() { for (auto& c : _s) c = tolower((unsigned char)c); }
+    void toUpperCase() { for (auto& c : _s) c = toupper((unsigned char)c); }
+    void trim() {
+        size_t a = _s.find_first_not_of(" \t\r\n");
+        size_t b = _s.find_last_not_of(" \t\r\n");
+        _s = a == std::string::npos ? std::string() : _s.substr(a, b - a + 1);
+    }
+    void replace(const String& from, const String& to) {
+        if (from._s.empty()) return;
+        for (size_t p = 0; (p = _s.find(from._s, p)) != std::string::npos; p += to._s.size()) {
+            _s.replace(p, from._s.size(), to._s);
+        }
+    }
+    void remove(unsigned int index) { if (index < _s.size()) _s.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < _s.size()) _s.erase(index, count); }
+
+    String& operator+=(const String& o) { _s += o._s; return *this; }
+    String& operator+=(const char* o) { _s += o; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    template<typename T> String& operator+=(T v) { return *this += String(v); }
+
+    bool operator==(const String& o) const { return _s == o._s; }
+    bool operator==(const char* o) const { return _s == o; }
+    bool operator!=(const String& o) const { return _s != o._s; }
+    bool operator!=(const char* o) const { return _s != o; }
+    bool operator<(const String& o) const { return _s < o._s; }
+
+private:
+    std::string _s;
+
+    static int find(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    void format(double v, unsigned char decimals) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        _s = buf;
+    }
+};
+
+inline String operator+(const String& a, const String& b) { String s(a); s += b; return s; }
+inline String operator+(const String& a, const char* b) { String s(a); s += b; return s; }
+inline String operator+(const char* a, const String& b) { String s(a); s += b; return s; }
+template<typename T> String operator+(const String& a, T b) { String s(a); s += String(b); return s; }
+
+// ─────────────────────────────────────────
+// Serial su stdout
+// ─────────────────────────────────────────
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    template<typename... Args> int printf(const char* fmt, Args... args) { return ::printf(fmt, args...); }
+    void print(const String& s) { fputs(s.c_str(), stdout); }
+    void print(long v) { ::printf("%ld", v); }
+    void println(const String& s = String()) { puts(s.c_str()); }
+    void println(long v) { ::printf("%ld\n", v); }
+    int available() { return 0; }
+    int read() { return -1; }
+};
+inline HostSerial Serial;
+
+// ─────────────────────────────────────────
+// Tempo: orologio manuale, i test lo fanno avanzare con hostAdvanceMs()
+// ─────────────────────────────────────────
+inline unsigned long hostNowUs = 0;
+inline void hostAdvanceMs(unsigned long ms) { hostNowUs += ms * 1000UL; }
+inline unsigned long millis() { return hostNowUs / 1000; }
+inline unsigned long micros() { return hostNowUs; }
+inline void delay(unsigned long ms) { hostAdvanceMs(ms); }
+inline void yield() {}
+
+// ─────────────────────────────────────────
+// Heap e FreeRTOS (un solo task: lock e sezioni critiche vuoti)
+// ─────────────────────────────────────────
+class HostEsp {
+public:
+    uint32_t getFreeHeap() { return 200000; }
+    uint32_t getMaxAllocHeap() { return 100000; }
+    uint32_t getMinFreeHeap() { return 150000; }
+};
+inline HostEsp ESP;
+
+#define MALLOC_CAP_8BIT 2
+#define MALLOC_CAP_INTERNAL 4
+inline size_t heap_caps_get_free_size(uint32_t) { return 200000; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return 100000; }
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int portMUX_TYPE;
+#define pdMS_TO_TICKS(ms) (ms)
+inline void vTaskDelay(TickType_t ticks) { hostAdvanceMs(ticks); }
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,160 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// ═══════════════════════════════════════════
+// File system in RAM con l'interfaccia fs::FS / fs::File di Arduino-ESP32
+// I file sono condivisi tra gli handle aperti (come su flash): un
+// "riavvio" nei test è un nuovo oggetto sopra lo stesso LittleFS
+// ═══════════════════════════════════════════
+
+#include "Arduino.h"
+#include <map>
+#include <set>
+#include <memory>
+#include <vector>
+
+namespace fs {
+
+enum SeekMode { SeekSet, SeekCur, SeekEnd };
+
+typedef std::shared_ptr<std::vector<uint8_t>> FileData;
+
+class File {
+public:
+    File() : _pos(0), _writable(false), _dir(false), _next(0) {}
+    File(const std::string& path, FileData data, bool writable, size_t pos)
+        : _path(path), _data(data), _pos(pos), _writable(writable), _dir(false), _next(0) {}
+
+    operator bool() const { return _data != nullptr || _dir; }
+
+    size_t read(uint8_t* buf, size_t len) {
+        if (!_data || _pos >= _data->size()) return 0;
+        size_t n = min(len, _data->size() - _pos);
+        memcpy(buf, _data->data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!_data || !_writable) return 0;
+        if (_data->size() < _pos + len) _data->resize(_pos + len);
+        memcpy(_data->data() + _pos, buf, len);
+        _pos += len;
+        return len;
+    }
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+        if (!_data) return false;
+        size_t base = mode == SeekSet ? 0 : (mode == SeekCur ? _pos : _data->size());
+        if (base + pos > _data->size()) return false;
+        _pos = base + pos;
+        return true;
+    }
+
+    size_t position() const { return _pos; }
+    size_t size() const { return _data ? _data->size() : 0; }
+    void flush() {}
+    void close() { _data = nullptr; _dir = false; }
+
+    // Nome come LittleFS su Arduino-ESP32 2.x: solo la parte finale
+    const char* name() const {
+        size_t slash = _path.rfind('/');
+        return _path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    }
+    const char* path() const { return _path.c_str(); }
+
+    bool isDirectory() const { return _dir; }
+    File openNextFile() {
+        if (_next >= _children.size()) return File();
+        return _children[_next++];
+    }
+
+    static File directory(const std::string& path, const std::vector<File>& children) {
+        File dir;
+        dir._path = path;
+        dir._dir = true;
+        dir._children = children;
+        return dir;
+    }
+
+private:
+    std::string _path;
+    FileData _data;
+    size_t _pos;
+    bool _writable;
+    bool _dir;
+    std::vector<File> _children;
+    size_t _next;
+};
+
+class FS {
+public:
+    // Modi: "r" lettura, "w" crea/tronca, "a" crea/accoda, "r+" lettura e scrittura
+    File open(const char* path, const char* mode = "r") {
+        std::string key = path;
+        auto it = _files.find(key);
+
+        if (mode[0] == 'w') {
+            FileData data = std::make_shared<std::vector<uint8_t>>();
+            _files[key] = data;
+            return File(key, data, true, 0);
+        }
+        if (mode[0] == 'a') {
+            if (it == _files.end()) it = _files.emplace(key, std::make_shared<std::vector<uint8_t>>()).first;
+            return File(key, it->second, true, it->second->size());
+        }
+        if (it != _files.end()) {
+            return File(key, it->second, mode[1] == '+', 0);
+        }
+        if (_dirs.count(key)) {
+            std::vector<File> children;
+            std::string prefix = key + "/";
+            for (auto& f : _files) {
+                if (f.first.compare(0, prefix.size(), prefix) == 0 &&
+                    f.first.find('/', prefix.size()) == std::string::npos) {
+                    children.push_back(File(f.first, f.second, false, 0));
+                }
+            }
+            return File::directory(key, children);
+        }
+        return File();
+    }
+    File open(const String& path, const char* mode = "r") { return open(path.c_str(), mode); }
+
+    bool exists(const char* path) { return _files.count(path) || _dirs.count(path); }
+    bool exists(const String& path) { return exists(path.c_str()); }
+
+    bool remove(const char* path) { return _files.erase(path) > 0; }
+    bool remove(const String& path) { return remove(path.c_str()); }
+
+    bool rename(const char* from, const char* to) {
+        auto it = _files.find(from);
+        if (it == _files.end()) return false;
+        FileData data = it->second;
+        _files.erase(it);
+        _files[to] = data;
+        return true;
+    }
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+
+    bool mkdir(const char* path) { _dirs.insert(path); return true; }
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+
+    // Accesso diretto per i test (corruzione, verifica dei file scritti)
+    FileData data(const char* path) {
+        auto it = _files.find(path);
+        return it == _files.end() ? nullptr : it->second;
+    }
+    void format() { _files.clear(); _dirs.clear(); }
+
+private:
+    std::map<std::string, FileData> _files;
+    std::set<std::string> _dirs;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // HOST_FS_H
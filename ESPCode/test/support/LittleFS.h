@@ -0,0 +1,16 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+class HostLittleFS : public fs::FS {
+public:
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+    void end() {}
+    size_t totalBytes() { return 1024 * 1024; }
+    size_t usedBytes() { return 0; }
+};
+
+inline HostLittleFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
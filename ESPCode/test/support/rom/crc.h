@@ -0,0 +1,12 @@
+#ifndef HOST_ROM_CRC_H
+#define HOST_ROM_CRC_H
+
+// crc32_le della ROM ESP32 (CRC-32 IEEE, come zlib)
+#include <stdint.h>
+#include <zlib.h>
+
+static inline uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+    return crc32(crc, buf, len);
+}
+
+#endif // HOST_ROM_CRC_H
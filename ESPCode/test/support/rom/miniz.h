@@ -0,0 +1,72 @@
+#ifndef HOST_ROM_MINIZ_H
+#define HOST_ROM_MINIZ_H
+
+// ═══════════════════════════════════════════
+// tinfl della ROM ESP32 sopra zlib
+// Stessa interfaccia a flusso: ingresso a pezzi, uscita nella finestra
+// circolare da TINFL_LZ_DICT_SIZE fornita dal chiamante
+// ═══════════════════════════════════════════
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+typedef uint8_t mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4
+};
+
+typedef enum {
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+// Allocato con malloc senza distruttore (come sul dispositivo): lo stato
+// zlib vive qui dentro e viene chiuso a fine stream o al prossimo init
+typedef struct {
+    z_stream z;
+    bool open;
+} tinfl_decompressor;
+
+#define tinfl_init(r) do { memset((r), 0, sizeof(*(r))); (r)->open = inflateInit(&(r)->z) == Z_OK; } while (0)
+
+static inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* in, size_t* inSize,
+                                            mz_uint8* outStart, mz_uint8* outNext, size_t* outSize,
+                                            const mz_uint32 flags) {
+    (void)outStart;
+    (void)flags;
+    if (!r->open) return TINFL_STATUS_FAILED;
+
+    r->z.next_in = (Bytef*)in;
+    r->z.avail_in = *inSize;
+    r->z.next_out = outNext;
+    r->z.avail_out = *outSize;
+    int ret = inflate(&r->z, Z_NO_FLUSH);
+    *inSize -= r->z.avail_in;
+    *outSize -= r->z.avail_out;
+
+    if (ret == Z_STREAM_END) {
+        inflateEnd(&r->z);
+        r->open = false;
+        return TINFL_STATUS_DONE;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        inflateEnd(&r->z);
+        r->open = false;
+        return TINFL_STATUS_FAILED;
+    }
+    return r->z.avail_out == 0 ? TINFL_STATUS_HAS_MORE_OUTPUT : TINFL_STATUS_NEEDS_MORE_INPUT;
+}
+
+#endif // HOST_ROM_MINIZ_H
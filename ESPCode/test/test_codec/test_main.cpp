@@ -0,0 +1,270 @@
+// ═══════════════════════════════════════════
+// ImageCodec: andata e ritorno qimEncode → QimDecoder::feed con blocchi
+// di ogni dimensione (op a cavallo dei blocchi), tutti gli op, errori e
+// rapporti di compressione sulle immagini di riferimento
+// ═══════════════════════════════════════════
+
+#include <unity.h>
+#include <math.h>
+#include <vector>
+#include "ImageCodec.h"
+#include "ImageManager.h"
+
+#define PIXELS (IMAGE_WIDTH * IMAGE_HEIGHT)
+
+// Stessa capacità di ImageManager: il .qim deve essere più piccolo del raw
+#define QIM_CAPACITY (IMAGE_SIZE - QIM_HEADER_SIZE - 1)
+
+static uint16_t rgb565(int r, int g, int b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+// ═══════════════════════════════════════════
+// Immagini di riferimento (64x64)
+// ═══════════════════════════════════════════
+
+// Due colori piatti, metà superiore e inferiore
+static std::vector<uint16_t> flatTiles() {
+    std::vector<uint16_t> px(PIXELS);
+    for (int i = 0; i < PIXELS; i++) px[i] = i / IMAGE_WIDTH < IMAGE_HEIGHT / 2 ? 0xF800 : 0x001F;
+    return px;
+}
+
+// Disco sfumato verticalmente, bordo antialias, fondo scuro con vignetta
+static std::vector<uint16_t> logo() {
+    std::vector<uint16_t> px(PIXELS);
+    for (int i = 0; i < PIXELS; i++) {
+        int x = i % IMAGE_WIDTH, y = i / IMAGE_WIDTH;
+        double r = sqrt((x - 32) * (x - 32) + (y - 32) * (y - 32));
+        double edge = fmin(1.0, fmax(0.0, (24 - r) / 2));
+        int bg = 16 + (int)(16 * (1 - r / 45));
+        int g = 160 + (int)(60 * (32 - y) / 32.0);
+        px[i] = rgb565((int)(255 * edge + bg * (1 - edge)),
+                       (int)(g * edge + bg * (1 - edge)),
+                       (int)(bg * 2 * (1 - edge)));
+    }
+    return px;
+}
+
+static std::vector<uint16_t> gradient() {
+    std::vector<uint16_t> px(PIXELS);
+    for (int i = 0; i < PIXELS; i++) {
+        int x = i % IMAGE_WIDTH, y = i / IMAGE_WIDTH;
+        px[i] = rgb565(x * 4, y * 4, (x + y) * 2);
+    }
+    return px;
+}
+
+static std::vector<uint16_t> noise() {
+    std::vector<uint16_t> px(PIXELS);
+    uint32_t state = 1;
+    for (int i = 0; i < PIXELS; i++) {
+        state = state * 1103515245u + 12345u;
+        px[i] = state >> 12;
+    }
+    return px;
+}
+
+// ═══════════════════════════════════════════
+// Codifica e decodifica a blocchi (come ImageManager::stepLoad: i byte
+// non consumati restano in testa al blocco successivo)
+// ═══════════════════════════════════════════
+
+static std::vector<uint8_t> encode(const std::vector<uint16_t>& px, size_t capacity = QIM_CAPACITY) {
+    std::vector<uint8_t> out(capacity);
+    out.resize(qimEncode(px.data(), px.size(), out.data(), capacity));
+    return out;
+}
+
+static bool decodeInBlocks(const std::vector<uint8_t>& data, size_t block, std::vector<uint16_t>& out) {
+    QimDecoder decoder;
+    decoder.begin(out.data(), out.size());
+    std::vector<uint8_t> pending;
+    size_t pos = 0;
+
+    while (!decoder.isDone()) {
+        size_t n = min(block, data.size() - pos);
+        pending.insert(pending.end(), data.begin() + pos, data.begin() + pos + n);
+        pos += n;
+
+        size_t used = decoder.feed(pending.data(), pending.size());
+        if (decoder.hasError() || (n == 0 && used == 0)) return false;
+        pending.erase(pending.begin(), pending.begin() + used);
+    }
+    // Il .qim finisce con l'ultimo op: nessun byte avanzato
+    return pos == data.size() && pending.empty();
+}
+
+static void checkRoundTrip(const char* name, const std::vector<uint16_t>& px) {
+    std::vector<uint8_t> qim = encode(px);
+    TEST_ASSERT_TRUE_MESSAGE(!qim.empty(), name);
+
+    static const size_t blocks[] = {1, 2, 3, 4, 5, 7, 13, 64, IMAGE_DECODE_CHUNK, IMAGE_SIZE};
+    for (size_t block : blocks) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "%s, blocchi da %zu byte", name, block);
+        std::vector<uint16_t> out(px.size(), 0xDEAD);
+        TEST_ASSERT_TRUE_MESSAGE(decodeInBlocks(qim, block, out), msg);
+        TEST_ASSERT_EQUAL_UINT16_ARRAY_MESSAGE(px.data(), out.data(), px.size(), msg);
+    }
+}
+
+// Conteggio degli op nel flusso codificato
+struct OpCount {
+    int index, diff, luma, run, rgb;
+};
+
+static OpCount countOps(const std::vector<uint8_t>& qim) {
+    OpCount c = {0, 0, 0, 0, 0};
+    for (size_t i = 0; i < qim.size();) {
+        uint8_t op = qim[i];
+        if (op == QIM_OP_RGB) { c.rgb++; i += 3; continue; }
+        switch (op & QIM_MASK) {
+            case QIM_OP_INDEX: c.index++; i++; break;
+            case QIM_OP_DIFF: c.diff++; i++; break;
+            case QIM_OP_LUMA: c.luma++; i += 2; break;
+            default: c.run++; i++; break;
+        }
+    }
+    return c;
+}
+
+void setUp() {}
+void tearDown() {}
+
+// ═══════════════════════════════════════════
+// Test
+// ═══════════════════════════════════════════
+
+void test_round_trip_reference_images() {
+    checkRoundTrip("flat", flatTiles());
+    checkRoundTrip("logo", logo());
+    checkRoundTrip("gradient", gradient());
+}
+
+// Ogni op, con i componenti che girano attorno (0 ↔ 31/63)
+void test_round_trip_every_op() {
+    std::vector<uint16_t> px;
+    uint16_t seq[] = {
+        0x0000,                                 // RUN dal nero iniziale
+        rgb565(8, 4, 8),                        // DIFF +1
+        0x0000,                                 // INDEX
+        0xFFFF,                                 // DIFF -1 su tutti (giro da 0)
+        0x0000,                                 // DIFF +1 (giro da 31/63)
+        (uint16_t)((2 << 11) | (20 << 5) | 3),  // LUMA
+        (uint16_t)((31 << 11) | (50 << 5) | 30),// LUMA con giro su r/b
+        0x1234,                                 // RGB
+        0xF00F,                                 // RGB
+    };
+    for (uint16_t p : seq) px.insert(px.end(), 3, p);
+    for (uint16_t p : seq) px.push_back(p);     // Tutti già nella tabella: INDEX
+    while (px.size() < 300) px.push_back(px.size() * 97);
+
+    std::vector<uint8_t> qim = encode(px, px.size() * 2);
+    OpCount c = countOps(qim);
+    TEST_ASSERT_GREATER_THAN(0, c.index);
+    TEST_ASSERT_GREATER_THAN(0, c.diff);
+    TEST_ASSERT_GREATER_THAN(0, c.luma);
+    TEST_ASSERT_GREATER_THAN(0, c.run);
+    TEST_ASSERT_GREATER_THAN(0, c.rgb);
+
+    for (size_t block = 1; block <= 8; block++) {
+        std::vector<uint16_t> out(px.size());
+        TEST_ASSERT_TRUE(decodeInBlocks(qim, block, out));
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(px.data(), out.data(), px.size());
+    }
+}
+
+// RUN al limite di QIM_RUN_MAX, spezzati e in fondo all'immagine
+void test_runs() {
+    for (size_t len : {(size_t)1, (size_t)61, (size_t)62, (size_t)63, (size_t)124, (size_t)PIXELS}) {
+        std::vector<uint16_t> px(PIXELS, 0x07E0);
+        for (size_t i = 0; i < PIXELS - len; i++) px[i] = i & 0xFF;
+
+        std::vector<uint8_t> qim = encode(px, IMAGE_SIZE);
+        std::vector<uint16_t> out(PIXELS);
+        TEST_ASSERT_TRUE(decodeInBlocks(qim, 1, out));
+        TEST_ASSERT_EQUAL_UINT16_ARRAY(px.data(), out.data(), PIXELS);
+    }
+}
+
+// Op incompleto in fondo al blocco: non consumato, resta al chiamante
+void test_partial_op_is_kept() {
+    uint16_t out[2];
+    QimDecoder decoder;
+
+    const uint8_t rgb[] = {QIM_OP_RGB, 0x34, 0x12};
+    decoder.begin(out, 1);
+    TEST_ASSERT_EQUAL(0, decoder.feed(rgb, 1));
+    TEST_ASSERT_EQUAL(0, decoder.feed(rgb, 2));
+    TEST_ASSERT_EQUAL(3, decoder.feed(rgb, 3));
+    TEST_ASSERT_TRUE(decoder.isDone());
+    TEST_ASSERT_EQUAL(0x1234, out[0]);
+
+    const uint8_t luma[] = {QIM_OP_LUMA | 33, 0x88, QIM_OP_DIFF | 0x2A};
+    decoder.begin(out, 2);
+    TEST_ASSERT_EQUAL(0, decoder.feed(luma, 1));
+    TEST_ASSERT_EQUAL(3, decoder.feed(luma, 3));
+    TEST_ASSERT_EQUAL((1 << 11) | (1 << 5) | 1, out[0]);
+    TEST_ASSERT_EQUAL(out[0], out[1]);
+}
+
+void test_corrupt_stream() {
+    uint16_t out[8];
+    QimDecoder decoder;
+
+    // RUN oltre la fine dell'immagine
+    const uint8_t run[] = {QIM_OP_RUN | 9};
+    decoder.begin(out, 8);
+    decoder.feed(run, sizeof(run));
+    TEST_ASSERT_TRUE(decoder.hasError());
+
+    // 0xFF non è un op (RUN da 64)
+    const uint8_t bad[] = {0xFF};
+    decoder.begin(out, 8);
+    decoder.feed(bad, sizeof(bad));
+    TEST_ASSERT_TRUE(decoder.hasError());
+}
+
+// Non sta nella capacità: 0, il chiamante salva il raw
+void test_incompressible() {
+    TEST_ASSERT_TRUE(encode(noise()).empty());
+    std::vector<uint16_t> px = gradient();
+    size_t full = encode(px).size();
+    TEST_ASSERT_TRUE(encode(px, full - 1).empty());
+    TEST_ASSERT_EQUAL(full, encode(px, full).size());
+}
+
+// Rapporti sulle immagini di riferimento (dimensione .qim senza header
+// rispetto ai IMAGE_SIZE byte del raw); stampati per il confronto
+void test_compression_ratios() {
+    struct Ratio {
+        const char* name;
+        std::vector<uint16_t> px;
+        size_t maxBytes;
+    };
+    Ratio ratios[] = {
+        {"flat", flatTiles(), IMAGE_SIZE / 100},
+        {"logo", logo(), IMAGE_SIZE * 21 / 100},
+        {"gradient", gradient(), IMAGE_SIZE * 52 / 100},
+    };
+    for (Ratio& r : ratios) {
+        size_t bytes = encode(r.px).size();
+        char msg[80];
+        snprintf(msg, sizeof(msg), "%s: %zu byte (%zu%% del raw)", r.name, bytes, bytes * 100 / IMAGE_SIZE);
+        TEST_MESSAGE(msg);
+        TEST_ASSERT_TRUE_MESSAGE(bytes > 0 && bytes <= r.maxBytes, msg);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_reference_images);
+    RUN_TEST(test_round_trip_every_op);
+    RUN_TEST(test_runs);
+    RUN_TEST(test_partial_op_is_kept);
+    RUN_TEST(test_corrupt_stream);
+    RUN_TEST(test_incompressible);
+    RUN_TEST(test_compression_ratios);
+    return UNITY_END();
+}
@@ -0,0 +1,498 @@
+// ═══════════════════════════════════════════
+// PngDecoder: tutti i tipi colore, i cinque filtri, CRC e file troncati
+//
+// Le immagini di prova sono generate qui: pixel deterministici, encoder
+// PNG di riferimento (filtri per riga + zlib) e uscita attesa calcolata
+// sui pixel sorgente, indipendente dal decoder.
+// ═══════════════════════════════════════════
+
+#include <unity.h>
+#include <vector>
+#include <zlib.h>
+#include "PngDecoder.h"
+
+#define OUT_W 64
+#define OUT_H 64
+
+struct Rgba {
+    uint16_t r, g, b, a;            // Alla profondità del file (16 bit = 0-65535)
+};
+
+struct PngCase {
+    const char* name;
+    uint8_t colorType;
+    uint8_t bitDepth;
+    uint16_t width;
+    uint16_t height;
+};
+
+// Filtro per riga: -1 = y % 5 (tutti e cinque in ogni immagine)
+#define FILTER_CYCLE -1
+
+static uint32_t rngState;
+
+static uint32_t rng() {
+    rngState = rngState * 1103515245u + 12345u;
+    return rngState >> 8;
+}
+
+static void put32(std::vector<uint8_t>& v, uint32_t x) {
+    v.push_back(x >> 24);
+    v.push_back(x >> 16);
+    v.push_back(x >> 8);
+    v.push_back(x);
+}
+
+static void putChunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data) {
+    put32(png, data.size());
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    put32(png, crc32(0, png.data() + start, png.size() - start));
+}
+
+// ═══════════════════════════════════════════
+// Immagine sorgente
+// ═══════════════════════════════════════════
+
+struct Source {
+    PngCase c;
+    std::vector<Rgba> pixels;           // Valori dei campioni (palette: indice in r)
+    std::vector<Rgba> palette;          // RGBA 8 bit (alpha da tRNS)
+    std::vector<uint8_t> rows;          // Scanline senza filtro, senza byte di filtro
+    size_t rowBytes;
+    uint8_t bpp;
+};
+
+static uint8_t channels(uint8_t colorType) {
+    switch (colorType) {
+        case 2: return 3;
+        case 4: return 2;
+        case 6: return 4;
+        default: return 1;
+    }
+}
+
+static uint16_t sample(uint8_t bitDepth, uint16_t x, uint16_t y, uint8_t channel) {
+    uint32_t max = (1u << bitDepth) - 1;
+    // Gradienti (i filtri predittivi hanno qualcosa da fare) più rumore
+    uint32_t v = (x * 37 + y * 11 + channel * 80) & 0xFF;
+    if ((x + y + channel) % 7 == 0) v = rng() & 0xFF;
+    if (bitDepth == 16) return (v << 8) | (rng() & 0xFF);
+    return v * max / 255;
+}
+
+static Source makeSource(const PngCase& c) {
+    Source s;
+    s.c = c;
+    uint8_t ch = channels(c.colorType);
+    s.rowBytes = ((size_t)c.width * ch * c.bitDepth + 7) / 8;
+    s.bpp = max(1, ch * c.bitDepth / 8);
+    s.rows.assign(s.rowBytes * c.height, 0);
+    rngState = c.colorType * 131 + c.bitDepth * 7 + c.width;
+
+    if (c.colorType == 3) {
+        uint16_t entries = 1 << c.bitDepth;
+        for (uint16_t i = 0; i < entries; i++) {
+            // Alpha varia: opaco, trasparente e semitrasparente
+            uint8_t alpha = i % 3 == 0 ? 255 : (i % 3 == 1 ? 0 : 128);
+            s.palette.push_back({(uint16_t)(rng() & 0xFF), (uint16_t)(rng() & 0xFF), (uint16_t)(rng() & 0xFF), alpha});
+        }
+    }
+
+    for (uint16_t y = 0; y < c.height; y++) {
+        uint8_t* row = &s.rows[(size_t)y * s.rowBytes];
+        for (uint16_t x = 0; x < c.width; x++) {
+            uint16_t v[4];
+            for (uint8_t k = 0; k < ch; k++) v[k] = sample(c.bitDepth, x, y, k);
+            if (c.colorType == 3) v[0] = (x * 3 + y * 5 + (rng() & 1)) % (1 << c.bitDepth);
+            // Alpha: opaco, trasparente e intermedio
+            if (c.colorType == 4 || c.colorType == 6) {
+                uint32_t max = (1u << c.bitDepth) - 1;
+                uint8_t pick = (x + 2 * y) % 4;
+                v[ch - 1] = pick == 0 ? 0 : (pick == 1 ? max / 2 : (pick == 2 ? max / 3 : max));
+            }
+
+            Rgba px = {v[0], 0, 0, 0};
+            if (ch >= 3) { px.g = v[1]; px.b = v[2]; }
+            if (ch == 2) px.a = v[1];
+            if (ch == 4) px.a = v[3];
+            s.pixels.push_back(px);
+
+            if (c.bitDepth < 8) {
+                size_t bit = (size_t)x * c.bitDepth;
+                row[bit >> 3] |= v[0] << (8 - c.bitDepth - (bit & 7));
+            } else {
+                for (uint8_t k = 0; k < ch; k++) {
+                    size_t pos = ((size_t)x * ch + k) * (c.bitDepth / 8);
+                    if (c.bitDepth == 16) {
+                        row[pos] = v[k] >> 8;
+                        row[pos + 1] = v[k] & 0xFF;
+                    } else {
+                        row[pos] = v[k];
+                    }
+                }
+            }
+        }
+    }
+    return s;
+}
+
+// ═══════════════════════════════════════════
+// Encoder di riferimento
+// ═══════════════════════════════════════════
+
+static int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+}
+
+static std::vector<uint8_t> filterRows(const Source& s, int filter) {
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> prev(s.rowBytes, 0);
+    for (uint16_t y = 0; y < s.c.height; y++) {
+        const uint8_t* cur = &s.rows[(size_t)y * s.rowBytes];
+        uint8_t f = filter == FILTER_CYCLE ? y % 5 : filter;
+        out.push_back(f);
+        for (size_t i = 0; i < s.rowBytes; i++) {
+            int a = i >= s.bpp ? cur[i - s.bpp] : 0;
+            int b = prev[i];
+            int c = i >= s.bpp ? prev[i - s.bpp] : 0;
+            int pred = 0;
+            switch (f) {
+                case 1: pred = a; break;
+                case 2: pred = b; break;
+                case 3: pred = (a + b) >> 1; break;
+                case 4: pred = paeth(a, b, c); break;
+            }
+            out.push_back((uint8_t)(cur[i] - pred));
+        }
+        prev.assign(cur, cur + s.rowBytes);
+    }
+    return out;
+}
+
+static std::vector<uint8_t> deflate(const std::vector<uint8_t>& raw) {
+    uLongf len = compressBound(raw.size());
+    std::vector<uint8_t> z(len);
+    compress2(z.data(), &len, raw.data(), raw.size(), 9);
+    z.resize(len);
+    return z;
+}
+
+// IDAT diviso in tre chunk, più un chunk ancillare da ignorare
+static std::vector<uint8_t> encodePng(const Source& s, const std::vector<uint8_t>& zdata) {
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    std::vector<uint8_t> png(signature, signature + 8);
+
+    std::vector<uint8_t> ihdr;
+    put32(ihdr, s.c.width);
+    put32(ihdr, s.c.height);
+    ihdr.push_back(s.c.bitDepth);
+    ihdr.push_back(s.c.colorType);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    putChunk(png, "IHDR", ihdr);
+    putChunk(png, "tEXt", std::vector<uint8_t>{'k', 0, 'v'});
+
+    if (s.c.colorType == 3) {
+        std::vector<uint8_t> plte, trns;
+        for (const Rgba& p : s.palette) {
+            plte.push_back(p.r);
+            plte.push_back(p.g);
+            plte.push_back(p.b);
+            trns.push_back(p.a);
+        }
+        putChunk(png, "PLTE", plte);
+        putChunk(png, "tRNS", trns);
+    }
+
+    size_t part = max<size_t>(1, zdata.size() / 3);
+    for (size_t i = 0; i < zdata.size(); i += part) {
+        size_t n = min(part, zdata.size() - i);
+        putChunk(png, "IDAT", std::vector<uint8_t>(zdata.begin() + i, zdata.begin() + i + n));
+    }
+    putChunk(png, "IEND", std::vector<uint8_t>());
+    return png;
+}
+
+static std::vector<uint8_t> encodePng(const Source& s, int filter = FILTER_CYCLE) {
+    return encodePng(s, deflate(filterRows(s, filter)));
+}
+
+// ═══════════════════════════════════════════
+// Uscita attesa: RGB 8 bit composto su nero, box (riduzione) o nearest
+// (ingrandimento) su OUT_W x OUT_H, poi RGB565
+// ═══════════════════════════════════════════
+
+static void toRgb8(const Source& s, const Rgba& p, uint32_t& r, uint32_t& g, uint32_t& b) {
+    uint8_t depth = s.c.bitDepth;
+    auto to8 = [depth](uint16_t v) -> uint32_t {
+        if (depth == 16) return v >> 8;
+        return v * 255 / ((1u << depth) - 1);
+    };
+    uint32_t a = 255;
+    switch (s.c.colorType) {
+        case 0: r = g = b = to8(p.r); break;
+        case 2: r = to8(p.r); g = to8(p.g); b = to8(p.b); break;
+        case 3: {
+            const Rgba& e = s.palette[p.r];
+            r = e.r; g = e.g; b = e.b; a = e.a;
+            break;
+        }
+        case 4: r = g = b = to8(p.r); a = to8(p.a); break;
+        default: r = to8(p.r); g = to8(p.g); b = to8(p.b); a = to8(p.a); break;
+    }
+    r = r * a / 255;
+    g = g * a / 255;
+    b = b * a / 255;
+}
+
+static std::vector<uint16_t> expected(const Source& s) {
+    std::vector<uint16_t> out;
+    uint32_t w = s.c.width, h = s.c.height;
+    for (uint32_t ty = 0; ty < OUT_H; ty++) {
+        uint32_t y0 = ty * h / OUT_H;
+        uint32_t y1 = max(y0 + 1, (ty + 1) * h / OUT_H);
+        for (uint32_t tx = 0; tx < OUT_W; tx++) {
+            uint32_t x0 = tx * w / OUT_W;
+            uint32_t x1 = max(x0 + 1, (tx + 1) * w / OUT_W);
+            uint32_t sum[3] = {0, 0, 0};
+            for (uint32_t y = y0; y < y1; y++) {
+                for (uint32_t x = x0; x < x1; x++) {
+                    uint32_t r, g, b;
+                    toRgb8(s, s.pixels[y * w + x], r, g, b);
+                    sum[0] += r;
+                    sum[1] += g;
+                    sum[2] += b;
+                }
+            }
+            uint32_t count = (x1 - x0) * (y1 - y0);
+            uint8_t r = sum[0] / count, g = sum[1] / count, b = sum[2] / count;
+            out.push_back(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+        }
+    }
+    return out;
+}
+
+// ═══════════════════════════════════════════
+// Decodifica a pezzi
+// ═══════════════════════════════════════════
+
+struct DecodeResult {
+    bool fed;
+    bool done;
+    const char* error;
+    std::vector<uint16_t> pixels;
+};
+
+static DecodeResult decode(const std::vector<uint8_t>& png, size_t piece, bool resize = true) {
+    DecodeResult res;
+    res.pixels.assign(OUT_W * OUT_H, 0xDEAD);
+    PngDecoder decoder;
+    res.fed = decoder.begin(res.pixels.data(), OUT_W, OUT_H, resize);
+    for (size_t i = 0; i < png.size() && res.fed; i += piece) {
+        res.fed = decoder.feed(&png[i], min(piece, png.size() - i));
+    }
+    res.done = decoder.isDone();
+    res.error = decoder.getError() ? decoder.getError() : "";
+    return res;
+}
+
+static const size_t PIECES[] = {1, 7, 256, 1 << 20};
+
+static void checkCase(const PngCase& c) {
+    Source s = makeSource(c);
+    std::vector<uint8_t> png = encodePng(s);
+    std::vector<uint16_t> want = expected(s);
+
+    for (size_t piece : PIECES) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "%s, feed da %zu byte", c.name, piece);
+        DecodeResult res = decode(png, piece);
+        TEST_ASSERT_TRUE_MESSAGE(res.fed, msg);
+        TEST_ASSERT_TRUE_MESSAGE(res.done, msg);
+        TEST_ASSERT_EQUAL_UINT16_ARRAY_MESSAGE(want.data(), res.pixels.data(), OUT_W * OUT_H, msg);
+    }
+}
+
+// ═══════════════════════════════════════════
+// Test
+// ═══════════════════════════════════════════
+
+void setUp() {}
+void tearDown() {}
+
+// Grigio: tutte le profondità; 1 bit ridotto, 4 bit ingrandito
+void test_grayscale() {
+    checkCase({"gray1", 0, 1, 200, 200});
+    checkCase({"gray2", 0, 2, 64, 64});
+    checkCase({"gray4", 0, 4, 40, 50});
+    checkCase({"gray8", 0, 8, 64, 64});
+    checkCase({"gray16", 0, 16, 100, 37});
+}
+
+void test_rgb() {
+    checkCase({"rgb8", 2, 8, 64, 64});
+    checkCase({"rgb16", 2, 16, 100, 37});
+}
+
+// Palette con tRNS, tutte le profondità
+void test_palette() {
+    checkCase({"pal1", 3, 1, 64, 64});
+    checkCase({"pal2", 3, 2, 65, 129});
+    checkCase({"pal4", 3, 4, 30, 90});
+    checkCase({"pal8", 3, 8, 128, 128});
+}
+
+void test_gray_alpha() {
+    checkCase({"ga8", 4, 8, 64, 64});
+    checkCase({"ga16", 4, 16, 48, 80});
+}
+
+void test_rgba() {
+    checkCase({"rgba8", 6, 8, 64, 64});
+    checkCase({"rgba16", 6, 16, 512, 300});
+}
+
+// Ogni filtro da solo su tutte le righe: bpp 1 (sotto-byte), 3 e 8
+void test_each_filter() {
+    static const PngCase cases[] = {
+        {"gray1", 0, 1, 64, 64},
+        {"rgb8", 2, 8, 64, 64},
+        {"rgba16", 6, 16, 64, 64},
+    };
+    for (const PngCase& c : cases) {
+        Source s = makeSource(c);
+        std::vector<uint16_t> want = expected(s);
+        for (int filter = 0; filter <= 4; filter++) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "%s, filtro %d", c.name, filter);
+            DecodeResult res = decode(encodePng(s, filter), 333);
+            TEST_ASSERT_TRUE_MESSAGE(res.fed && res.done, msg);
+            TEST_ASSERT_EQUAL_UINT16_ARRAY_MESSAGE(want.data(), res.pixels.data(), OUT_W * OUT_H, msg);
+        }
+    }
+}
+
+void test_invalid_filter() {
+    Source s = makeSource({"rgb8", 2, 8, 64, 64});
+    std::vector<uint8_t> raw = filterRows(s, 0);
+    raw[(s.rowBytes + 1) * 10] = 5;
+    DecodeResult res = decode(encodePng(s, deflate(raw)), 100);
+    TEST_ASSERT_FALSE(res.fed);
+    TEST_ASSERT_EQUAL_STRING("Invalid filter", res.error);
+}
+
+// CRC sbagliato su ogni chunk (IHDR, tEXt, PLTE, tRNS, IDAT, IEND)
+void test_bad_chunk_crc() {
+    Source s = makeSource({"pal4", 3, 4, 30, 90});
+    std::vector<uint8_t> png = encodePng(s);
+
+    for (size_t pos = 8; pos + 12 <= png.size();) {
+        uint32_t len = ((uint32_t)png[pos] << 24) | (png[pos + 1] << 16) | (png[pos + 2] << 8) | png[pos + 3];
+        std::vector<uint8_t> bad = png;
+        bad[pos + 8 + len] ^= 0x10;
+
+        char msg[48];
+        snprintf(msg, sizeof(msg), "chunk %.4s", (const char*)&png[pos + 4]);
+        DecodeResult res = decode(bad, 64);
+        TEST_ASSERT_FALSE_MESSAGE(res.fed, msg);
+        TEST_ASSERT_FALSE_MESSAGE(res.done, msg);
+        TEST_ASSERT_EQUAL_STRING("Chunk CRC mismatch", res.error);
+        pos += 12 + len;
+    }
+}
+
+// File interrotto a metà: nessun errore (può arrivare altro) ma non finito
+void test_truncated_file() {
+    Source s = makeSource({"rgba8", 6, 8, 64, 64});
+    std::vector<uint8_t> png = encodePng(s);
+    for (size_t cut : {(size_t)5, (size_t)20, png.size() / 2, png.size() - 1}) {
+        DecodeResult res = decode(std::vector<uint8_t>(png.begin(), png.begin() + cut), 100);
+        TEST_ASSERT_TRUE(res.fed);
+        TEST_ASSERT_FALSE(res.done);
+    }
+}
+
+// Chunk validi ma dati compressi con metà delle righe: IEND rifiutato
+void test_truncated_image_data() {
+    Source s = makeSource({"gray8", 0, 8, 64, 64});
+    std::vector<uint8_t> raw = filterRows(s, FILTER_CYCLE);
+    raw.resize(raw.size() / 2);
+    DecodeResult res = decode(encodePng(s, deflate(raw)), 256);
+    TEST_ASSERT_FALSE(res.fed);
+    TEST_ASSERT_EQUAL_STRING("Truncated image data", res.error);
+}
+
+// Flusso zlib corrotto con CRC dei chunk corretti
+void test_corrupt_deflate() {
+    Source s = makeSource({"rgb8", 2, 8, 64, 64});
+    std::vector<uint8_t> z = deflate(filterRows(s, FILTER_CYCLE));
+    for (size_t i = 2; i < 12; i++) z[i] = 0xFF;
+    DecodeResult res = decode(encodePng(s, z), 256);
+    TEST_ASSERT_FALSE(res.fed);
+    TEST_ASSERT_EQUAL_STRING("Inflate error", res.error);
+}
+
+void test_rejected_headers() {
+    Source s = makeSource({"rgb8", 2, 8, 100, 37});
+    std::vector<uint8_t> png = encodePng(s);
+
+    // Senza resize solo la dimensione esatta
+    DecodeResult res = decode(png, 1 << 20, false);
+    TEST_ASSERT_FALSE(res.fed);
+    TEST_ASSERT_EQUAL_STRING("PNG size mismatch", res.error);
+
+    std::vector<uint8_t> notPng = png;
+    notPng[1] = 'J';
+    TEST_ASSERT_FALSE(PngDecoder::isPng(notPng.data(), notPng.size()));
+    TEST_ASSERT_EQUAL_STRING("Not a PNG file", decode(notPng, 3).error);
+
+    // Lato oltre PNG_MAX_DIMENSION, interlacciato, profondità non valida
+    Source big = makeSource({"big", 0, 1, PNG_MAX_DIMENSION + 1, 2});
+    TEST_ASSERT_EQUAL_STRING("Unsupported PNG size", decode(encodePng(big), 64).error);
+
+    std::vector<uint8_t> laced = png;
+    laced[8 + 8 + 12] = 1;
+    uint32_t crc = crc32(0, &laced[12], 17);
+    laced[29] = crc >> 24; laced[30] = crc >> 16; laced[31] = crc >> 8; laced[32] = crc;
+    TEST_ASSERT_EQUAL_STRING("Interlaced PNG not supported", decode(laced, 64).error);
+
+    Source rgb4 = makeSource({"rgb4", 2, 8, 8, 8});
+    rgb4.c.bitDepth = 4;
+    TEST_ASSERT_EQUAL_STRING("Invalid color type", decode(encodePng(rgb4), 64).error);
+}
+
+void test_palette_missing_plte() {
+    Source s = makeSource({"pal8", 3, 8, 64, 64});
+    s.c.colorType = 0;
+    std::vector<uint8_t> png = encodePng(s);                // Nessun PLTE
+    png[8 + 8 + 9] = 3;
+    uint32_t crc = crc32(0, &png[12], 17);
+    png[29] = crc >> 24; png[30] = crc >> 16; png[31] = crc >> 8; png[32] = crc;
+
+    DecodeResult res = decode(png, 256);
+    TEST_ASSERT_FALSE(res.fed);
+    TEST_ASSERT_EQUAL_STRING("Missing PLTE", res.error);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_grayscale);
+    RUN_TEST(test_rgb);
+    RUN_TEST(test_palette);
+    RUN_TEST(test_gray_alpha);
+    RUN_TEST(test_rgba);
+    RUN_TEST(test_each_filter);
+    RUN_TEST(test_invalid_filter);
+    RUN_TEST(test_bad_chunk_crc);
+    RUN_TEST(test_truncated_file);
+    RUN_TEST(test_truncated_image_data);
+    RUN_TEST(test_corrupt_deflate);
+    RUN_TEST(test_rejected_headers);
+    RUN_TEST(test_palette_missing_plte);
+    return UNITY_END();
+}
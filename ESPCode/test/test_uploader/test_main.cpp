@@ -0,0 +1,366 @@
+// ═══════════════════════════════════════════
+// ImageUploader su LittleFS in RAM: ripresa (stessa sessione e dopo un
+// riavvio), NACK, CRC sbagliato, installazione raw / .qim / PNG e
+// proprietario del job
+// ═══════════════════════════════════════════
+
+#include <unity.h>
+#include <vector>
+#include <zlib.h>
+#include <rom/crc.h>
+#include "ImageUploader.h"
+
+#define CLIENT_A 5
+#define CLIENT_B 6
+#define CLIENT_A_RECONNECTED 7
+
+static std::vector<uint8_t> rawImage() {
+    std::vector<uint8_t> img(IMAGE_SIZE);
+    for (size_t i = 0; i < img.size(); i++) img[i] = i * 7;
+    return img;
+}
+
+// Messaggio binario [0x20][offset LE][dati] consegnato in chunk TCP da piece byte
+static String send(ImageUploader& up, uint32_t offset, const uint8_t* data, size_t len,
+                   uint32_t clientId = UPLOAD_OWNER_LOCAL, size_t piece = 300) {
+    std::vector<uint8_t> msg(UPLOAD_HEADER + len);
+    msg[0] = UPLOAD_MSG_CHUNK;
+    for (int i = 0; i < 4; i++) msg[1 + i] = offset >> (8 * i);
+    memcpy(&msg[UPLOAD_HEADER], data, len);
+
+    String response;
+    for (size_t i = 0; i < msg.size(); i += piece) {
+        response = up.receive(clientId, &msg[i], min(piece, msg.size() - i), i, msg.size());
+    }
+    return response;
+}
+
+static String ack(uint32_t offset) {
+    return "UPLOAD_ACK," + String((unsigned long)offset);
+}
+
+static String nack(uint32_t offset) {
+    return "UPLOAD_NACK," + String((unsigned long)offset);
+}
+
+// PNG RGB 8 bit con filtro 0 e i pixel RGB565 attesi
+static std::vector<uint8_t> makePng(uint16_t width, uint16_t height, std::vector<uint16_t>& rgb565) {
+    std::vector<uint8_t> raw;
+    rgb565.clear();
+    for (uint16_t y = 0; y < height; y++) {
+        raw.push_back(0);
+        for (uint16_t x = 0; x < width; x++) {
+            uint8_t r = x * 4, g = y * 4, b = (x ^ y) * 4;
+            raw.push_back(r);
+            raw.push_back(g);
+            raw.push_back(b);
+            rgb565.push_back(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+        }
+    }
+    uLongf zlen = compressBound(raw.size());
+    std::vector<uint8_t> z(zlen);
+    compress2(z.data(), &zlen, raw.data(), raw.size(), 9);
+    z.resize(zlen);
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    auto chunk = [&png](const char* type, const std::vector<uint8_t>& data) {
+        uint32_t len = data.size();
+        for (int i = 3; i >= 0; i--) png.push_back(len >> (8 * i));
+        size_t start = png.size();
+        png.insert(png.end(), type, type + 4);
+        png.insert(png.end(), data.begin(), data.end());
+        uint32_t crc = crc32(0, &png[start], png.size() - start);
+        for (int i = 3; i >= 0; i--) png.push_back(crc >> (8 * i));
+    };
+    chunk("IHDR", {0, 0, (uint8_t)(width >> 8), (uint8_t)width, 0, 0, (uint8_t)(height >> 8), (uint8_t)height, 8, 2, 0, 0, 0});
+    chunk("IDAT", z);
+    chunk("IEND", {});
+    return png;
+}
+
+static uint32_t crcOf(const std::vector<uint8_t>& data) {
+    return crc32_le(0, data.data(), data.size());
+}
+
+static bool noJobFiles() {
+    return !LittleFS.exists(UPLOAD_TMP_PATH) && !LittleFS.exists(UPLOAD_JOB_PATH);
+}
+
+void setUp() {
+    LittleFS.format();
+    hostNowUs = 0;
+}
+
+void tearDown() {}
+
+// ═══════════════════════════════════════════
+// Test
+// ═══════════════════════════════════════════
+
+void test_raw_upload_with_resume() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint8_t> img = rawImage();
+    uint32_t crc = crcOf(img);
+
+    TEST_ASSERT_EQUAL(0, up.begin("pic", IMAGE_SIZE, crc));
+    TEST_ASSERT_TRUE(send(up, 0, img.data(), 2048) == ack(2048));
+
+    // Riconnessione: stesso job, si riprende dai byte già su flash
+    TEST_ASSERT_EQUAL(2048, up.begin("pic", IMAGE_SIZE, crc));
+    TEST_ASSERT_TRUE(send(up, 2048, &img[2048], IMAGE_SIZE - 2048, UPLOAD_OWNER_LOCAL, 1460) == ack(IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(1, up.getResumed());
+
+    TEST_ASSERT_TRUE(up.commit());
+    TEST_ASSERT_TRUE(LittleFS.exists("/images/pic.img"));
+    TEST_ASSERT_TRUE(noJobFiles());
+    TEST_ASSERT_FALSE(up.isActive());
+
+    std::vector<uint16_t> out(IMAGE_WIDTH * IMAGE_HEIGHT);
+    TEST_ASSERT_TRUE(images.loadImage("pic", out.data()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(img.data(), (uint8_t*)out.data(), IMAGE_SIZE);
+    TEST_ASSERT_EQUAL(1, images.getImageCount());
+    TEST_ASSERT_EQUAL_UINT32(crc, images.getImageEntry(0)->crc);
+    TEST_ASSERT_EQUAL_STRING("binary", up.getLastMode());
+}
+
+// Riavvio: uploader e manager nuovi, il job si riprende da flash
+void test_resume_after_reboot() {
+    std::vector<uint8_t> img = rawImage();
+    uint32_t crc = crcOf(img);
+    {
+        ImageManager images;
+        images.begin();
+        ImageUploader up;
+        up.setImageManager(&images);
+        TEST_ASSERT_EQUAL(0, up.begin("pic", IMAGE_SIZE, crc));
+        TEST_ASSERT_TRUE(send(up, 0, img.data(), 4096) == ack(4096));
+    }
+
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+
+    TEST_ASSERT_EQUAL(4096, up.begin("pic", IMAGE_SIZE, crc));
+
+    // Commit incompleto: fallisce ma il job resta
+    TEST_ASSERT_FALSE(up.commit());
+    TEST_ASSERT_EQUAL(4096, up.begin("pic", IMAGE_SIZE, crc));
+
+    TEST_ASSERT_TRUE(send(up, 4096, &img[4096], IMAGE_SIZE - 4096, UPLOAD_OWNER_LOCAL, 1000) == ack(IMAGE_SIZE));
+    TEST_ASSERT_TRUE(up.commit());
+
+    std::vector<uint16_t> out(IMAGE_WIDTH * IMAGE_HEIGHT);
+    TEST_ASSERT_TRUE(images.loadImage("pic", out.data()));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(img.data(), (uint8_t*)out.data(), IMAGE_SIZE);
+}
+
+void test_job_with_other_crc_starts_over() {
+    ImageManager images;
+    images.begin();
+    std::vector<uint8_t> img = rawImage();
+    {
+        ImageUploader up;
+        up.setImageManager(&images);
+        up.begin("pic", IMAGE_SIZE, crcOf(img));
+        send(up, 0, img.data(), 4096);
+    }
+    ImageUploader up;
+    up.setImageManager(&images);
+    TEST_ASSERT_EQUAL(0, up.begin("pic", IMAGE_SIZE, crcOf(img) ^ 1));
+    TEST_ASSERT_EQUAL(0, LittleFS.data(UPLOAD_TMP_PATH)->size());
+}
+
+// Offset diverso dai byte scritti o oltre SIZE: NACK con l'offset giusto
+void test_nack() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint8_t> img = rawImage();
+
+    up.begin("pic", IMAGE_SIZE, crcOf(img));
+    TEST_ASSERT_TRUE(send(up, 0, img.data(), 2048) == ack(2048));
+    TEST_ASSERT_TRUE(send(up, 0, img.data(), 2048) == nack(2048));         // Duplicato
+    TEST_ASSERT_TRUE(send(up, 4096, img.data(), 2048) == nack(2048));      // Buco
+    TEST_ASSERT_TRUE(send(up, 2048, img.data(), IMAGE_SIZE) == nack(2048)); // Oltre SIZE
+    TEST_ASSERT_EQUAL(3, up.getNacks());
+
+    // Corpo HTTP: stesso controllo sull'offset
+    TEST_ASSERT_FALSE(up.write(0, img.data(), 100));
+    TEST_ASSERT_TRUE(up.write(2048, &img[2048], 100));
+    TEST_ASSERT_TRUE(send(up, 2148, &img[2148], 100) == ack(2248));
+    TEST_ASSERT_EQUAL(2248, LittleFS.data(UPLOAD_TMP_PATH)->size());
+}
+
+void test_crc_mismatch() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint8_t> img = rawImage();
+
+    TEST_ASSERT_EQUAL(0, up.begin("bad", IMAGE_SIZE, crcOf(img) ^ 1));
+    TEST_ASSERT_TRUE(send(up, 0, img.data(), IMAGE_SIZE, UPLOAD_OWNER_LOCAL, 1460) == ack(IMAGE_SIZE));
+    TEST_ASSERT_FALSE(up.commit());
+    TEST_ASSERT_FALSE(images.exists("bad"));
+    TEST_ASSERT_EQUAL(0, images.getImageCount());
+    TEST_ASSERT_TRUE(noJobFiles());
+}
+
+// Un file rovinato su flash dopo l'ACK: il CRC a commit lo riconosce
+void test_crc_checked_on_flash() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint8_t> img = rawImage();
+
+    up.begin("pic", IMAGE_SIZE, crcOf(img));
+    send(up, 0, img.data(), IMAGE_SIZE, UPLOAD_OWNER_LOCAL, 1460);
+    (*LittleFS.data(UPLOAD_TMP_PATH))[100] ^= 1;
+    TEST_ASSERT_FALSE(up.commit());
+    TEST_ASSERT_FALSE(images.exists("pic"));
+}
+
+// .qim sostituisce la .img con lo stesso nome
+void test_qim_install() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint8_t> img = rawImage();
+    up.begin("pic", IMAGE_SIZE, crcOf(img));
+    send(up, 0, img.data(), IMAGE_SIZE, UPLOAD_OWNER_LOCAL, 1460);
+    TEST_ASSERT_TRUE(up.commit());
+
+    std::vector<uint16_t> flat(IMAGE_WIDTH * IMAGE_HEIGHT, 0x1234);
+    std::vector<uint8_t> qim(IMAGE_SIZE);
+    memcpy(qim.data(), QIM_MAGIC, 4);
+    qim[4] = IMAGE_WIDTH;
+    qim[6] = IMAGE_HEIGHT;
+    qim.resize(QIM_HEADER_SIZE + qimEncode(flat.data(), flat.size(), &qim[QIM_HEADER_SIZE], IMAGE_SIZE - QIM_HEADER_SIZE));
+
+    TEST_ASSERT_EQUAL(0, up.begin("pic", qim.size(), crcOf(qim)));
+    TEST_ASSERT_TRUE(send(up, 0, qim.data(), qim.size()) == ack(qim.size()));
+    TEST_ASSERT_TRUE(up.commit());
+    TEST_ASSERT_TRUE(LittleFS.exists("/images/pic.qim"));
+    TEST_ASSERT_FALSE(LittleFS.exists("/images/pic.img"));
+    TEST_ASSERT_EQUAL(1, images.getImageCount());
+
+    std::vector<uint16_t> out(IMAGE_WIDTH * IMAGE_HEIGHT);
+    TEST_ASSERT_TRUE(images.loadImage("pic", out.data()));
+    TEST_ASSERT_TRUE(out == flat);
+}
+
+// PNG decodificato in ricezione; dopo un riavvio decodificato a commit
+void test_png_install() {
+    ImageManager images;
+    images.begin();
+    std::vector<uint16_t> want;
+    std::vector<uint8_t> png = makePng(IMAGE_WIDTH, IMAGE_HEIGHT, want);
+    std::vector<uint16_t> out(IMAGE_WIDTH * IMAGE_HEIGHT);
+
+    ImageUploader up;
+    up.setImageManager(&images);
+    TEST_ASSERT_EQUAL(0, up.begin("png", png.size(), crcOf(png)));
+    for (size_t i = 0; i < png.size(); i += 500) {
+        TEST_ASSERT_TRUE(up.write(i, &png[i], min<size_t>(500, png.size() - i)));
+    }
+    TEST_ASSERT_TRUE(up.commit(false));
+    TEST_ASSERT_TRUE(images.loadImage("png", out.data()));
+    TEST_ASSERT_TRUE(out == want);
+    TEST_ASSERT_TRUE(noJobFiles());
+
+    {
+        ImageUploader first;
+        first.setImageManager(&images);
+        first.begin("again", png.size(), crcOf(png));
+        TEST_ASSERT_TRUE(send(first, 0, png.data(), 300) == ack(300));
+    }
+    ImageUploader resumed;
+    resumed.setImageManager(&images);
+    TEST_ASSERT_EQUAL(300, resumed.begin("again", png.size(), crcOf(png)));
+    TEST_ASSERT_TRUE(send(resumed, 300, &png[300], png.size() - 300) == ack(png.size()));
+    TEST_ASSERT_TRUE(resumed.commit());
+    TEST_ASSERT_TRUE(images.loadImage("again", out.data()));
+    TEST_ASSERT_TRUE(out == want);
+}
+
+// RESIZE 0: solo PNG 64x64
+void test_png_without_resize() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint16_t> pixels;
+    std::vector<uint8_t> png = makePng(100, 50, pixels);
+
+    up.begin("wide", png.size(), crcOf(png));
+    up.write(0, png.data(), png.size());
+    TEST_ASSERT_FALSE(up.commit(false));
+    TEST_ASSERT_FALSE(images.exists("wide"));
+    TEST_ASSERT_TRUE(noJobFiles());
+}
+
+void test_owner() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+    std::vector<uint8_t> img = rawImage();
+    uint32_t crc = crcOf(img);
+
+    TEST_ASSERT_EQUAL(0, up.begin("a", IMAGE_SIZE, crc, CLIENT_A));
+    TEST_ASSERT_TRUE(send(up, 0, img.data(), 100, CLIENT_B) == "ERR,Upload owned by another client");
+    TEST_ASSERT_FALSE(up.write(0, img.data(), 100));                    // HTTP: job di un client WS
+    TEST_ASSERT_EQUAL(UPLOAD_BUSY, up.begin("b", IMAGE_SIZE, crc, CLIENT_B));
+    TEST_ASSERT_TRUE(send(up, 0, img.data(), 100, CLIENT_A) == ack(100));
+
+    // Riconnessione con un nuovo id: il job passa al nuovo client
+    TEST_ASSERT_EQUAL(100, up.begin("a", IMAGE_SIZE, crc, CLIENT_A_RECONNECTED));
+    TEST_ASSERT_TRUE(send(up, 100, &img[100], 100, CLIENT_A) == "ERR,Upload owned by another client");
+    TEST_ASSERT_TRUE(send(up, 100, &img[100], 100, CLIENT_A_RECONNECTED) == ack(200));
+
+    // Job fermo da UPLOAD_OWNER_TIMEOUT_MS: un altro client può sostituirlo
+    hostAdvanceMs(UPLOAD_OWNER_TIMEOUT_MS);
+    TEST_ASSERT_EQUAL(0, up.begin("b", IMAGE_SIZE, crc, CLIENT_B));
+    TEST_ASSERT_TRUE(up.getName() == "b");
+}
+
+void test_abort_and_no_job() {
+    ImageManager images;
+    images.begin();
+    ImageUploader up;
+    up.setImageManager(&images);
+
+    static const uint8_t chunk[] = {UPLOAD_MSG_CHUNK, 0, 0, 0, 0, 'x'};
+    TEST_ASSERT_TRUE(up.receive(1, chunk, sizeof(chunk), 0, sizeof(chunk)) == "ERR,No image upload in progress");
+    TEST_ASSERT_EQUAL(-1, up.begin("tiny", QIM_HEADER_SIZE, 0));
+    TEST_ASSERT_EQUAL(-1, up.begin("huge", IMAGE_UPLOAD_MAX_SIZE + 1, 0));
+
+    TEST_ASSERT_EQUAL(0, up.begin("x", 100, 1));
+    up.abort();
+    TEST_ASSERT_FALSE(up.isActive());
+    TEST_ASSERT_TRUE(noJobFiles());
+    TEST_ASSERT_FALSE(up.commit());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_raw_upload_with_resume);
+    RUN_TEST(test_resume_after_reboot);
+    RUN_TEST(test_job_with_other_crc_starts_over);
+    RUN_TEST(test_nack);
+    RUN_TEST(test_crc_mismatch);
+    RUN_TEST(test_crc_checked_on_flash);
+    RUN_TEST(test_qim_install);
+    RUN_TEST(test_png_install);
+    RUN_TEST(test_png_without_resize);
+    RUN_TEST(test_owner);
+    RUN_TEST(test_abort_and_no_job);
+    return UNITY_END();
+}